@@ -13,6 +13,8 @@
 //
 //	Change History (most recent first):
 //	   
+//	   <6>	 	10/17/26	rtm		the Get First Picture and Get Second Picture menu items now decode the picture in the
+//									background (see QTEffects_GetPictureInBackground)
 //	   <5>	 	03/20/00	rtm		made changes to get things running under CarbonLib
 //	   <4>	 	02/20/98	rtm		revised custom dialog box handling; now works on Windows (yippee!)
 //	   <3>	 	02/12/98	rtm		added support for stepping through the effect
@@ -369,6 +371,10 @@ Boolean QTApp_HandleMenu (UInt16 theMenuItem)
 			break;
 
 		case IDM_GET_FIRST_PICTURE:
+#if USES_NATIVE_RENDERER
+			// the picture is decoded in the background, and replaces the first source when it's ready
+			QTEffects_GetPictureInBackground(kFirstSource, kWidth, kHeight, kDepth);
+#else
 			myErr = QTEffects_GetPictureAsGWorld(kWidth, kHeight, kDepth, &gGW1);
 			if (myErr == noErr) {
 			
@@ -377,10 +383,14 @@ Boolean QTApp_HandleMenu (UInt16 theMenuItem)
 				QTEffects_SetUpEffectSequence();
 				QTEffects_DrawEffectsWindow();
 			}
+#endif
 			myIsHandled = true;
 			break;
 			
 		case IDM_GET_SECOND_PICTURE:
+#if USES_NATIVE_RENDERER
+			QTEffects_GetPictureInBackground(kSecondSource, kWidth, kHeight, kDepth);
+#else
 			myErr = QTEffects_GetPictureAsGWorld(kWidth, kHeight, kDepth, &gGW2);
 			if (myErr == noErr) {
 				// we need to refresh image descriptions, etc.
@@ -388,6 +398,7 @@ Boolean QTApp_HandleMenu (UInt16 theMenuItem)
 				QTEffects_SetUpEffectSequence();
 				QTEffects_DrawEffectsWindow();
 			}
+#endif
 			myIsHandled = true;
 			break;
 			
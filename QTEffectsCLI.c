@@ -0,0 +1,932 @@
+//////////
+//
+//	File:		QTEffectsCLI.c
+//
+//	Contains:	A command-line program that renders the native effects without a window, for batch jobs.
+//
+//	Change History (most recent first):
+//
+//	   <7>	 	10/17/26	rtm		the usage and the error for an unreadable source say that netpbm files must have 8-bit samples
+//	   <6>	 	10/17/26	rtm		-t counts the main thread, which renders too, so -t N starts N - 1 worker threads
+//	   <5>	 	10/17/26	rtm		the frames of a baked movie between key frames are delta frames (see -k)
+//	   <4>	 	10/17/26	rtm		movie frames are compressed with the Animation codec (see QTNativeAnimation.c), rather than
+//									written as raw pixels
+//	   <3>	 	10/17/26	rtm		added QuickTime movie output, baked or live, through QTNativeMovieFile.c
+//	   <2>	 	10/17/26	rtm		added YUV4MPEG2 and raw RGBA streams, written as the steps are rendered
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This program renders the steps of an effect (and any filters layered over it) with the same native
+//	renderer that QTShowEffect uses, and writes them out as image files or as a single raw frame dump. It
+//	doesn't need QuickTime or a window system, so it can run on the machines of a render farm. The steps are
+//	rendered in bands on all the processors (see QTNativeThreads.c), and the number of frames per second is
+//	printed at the end.
+//
+//	The sources are files of raw frames (see QTNativeRawFile.h): a binary PPM, PGM, or PAM file with 8-bit
+//	samples (a maximum value of 255; 16-bit files aren't supported), or a raw frame dump. A file that holds
+//	several frames is played as a clip: step n uses frame n - 1, wrapping around at the end of the file. A frame that isn't the size of the output is scaled to fit with the Lanczos-3 filter;
+//	otherwise the renderer reads it straight from the mapped pages of the file.
+//
+//	If the output name contains a printf format for the step number (like frame%04d.ppm), each step is written
+//	to its own file: a PAM file with an alpha channel if the name ends in .pam, or a PPM file otherwise. If not,
+//	the steps are written one after another to a single raw frame dump of 32-bit ARGB pixels, which can be
+//	read back as a source; an output name of - writes the dump to the standard output.
+//
+//	An output name that ends in .y4m, or any output with -o y4m or -o rgba, is a stream instead (see
+//	QTNativeStream.c): each step is written as soon as it's rendered, as a YUV4MPEG2 frame or as bare RGBA
+//	pixels, so the output can be a pipe into an encoder that runs while we render. For example:
+//
+//		QTEffectsCLI -a a.ppm -b b.ppm -n 150 -o y4m - | ffmpeg -i - -c:v libx264 out.mp4
+//
+//	If the encoder falls behind, we wait for it (with at most a few frames waiting to be written); if it exits,
+//	we stop.
+//
+//	An output name that ends in .mov is a QuickTime movie (see QTNativeMovieFile.c). By default, the rendered
+//	steps are "baked" into its only video track, one frame per step at the frame rate of -r, compressed with the
+//	Animation codec (which is lossless, and keeps the alpha channel). Every -k frames is a key frame; the frames
+//	in between are delta frames, which hold only the parts of the frame that changed since the step before (in a
+//	wipe, just the part near the edge). With -m live, the
+//	steps aren't rendered at all: the movie is an effect movie like the ones QTShowEffect makes, with a video
+//	track holding the first frame of each source, and an effect track (plus a track for each filter) that
+//	QuickTime renders as the movie plays.
+//
+//	Usage:	QTEffectsCLI [options] output
+//
+//		-e type			the effect to render, as a four-character effect type (the default is dslv, the cross fade)
+//		-f type			a filter to layer over the effect (up to three, rendered in order)
+//		-p name=value	a parameter of the effect or filter named just before it: a four-character name and a
+//						number, which may be in hexadecimal (for example, -p kcol=0x00FF00)
+//		-a file			the first source
+//		-b file			the second source
+//		-s widthxheight	the size of the output (the default is the size of the first source, or 640x480)
+//		-n steps		the number of steps to render (the default is 30)
+//		-t threads		the number of threads that render, counting the main thread (the default is one per processor)
+//		-o kind			write a stream of the specified kind (y4m or rgba) rather than a raw frame dump
+//		-r rate			the frame rate of a YUV4MPEG2 stream or a movie, as frames per second or as a
+//						fraction like 30000:1001 (the default is 30)
+//		-m kind			the kind of movie to write: baked (the rendered steps) or live (an effect track)
+//		-k frames		the number of frames from one key frame of a baked movie to the next, or 0 for only the
+//						first (the default is 30; 1 makes every frame a key frame)
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <stdio.h>
+#include "QTNativeAnimation.h"
+#include "QTNativeBlend.h"
+#include "QTNativeConvert.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeGenerators.h"
+#include "QTNativeMovieFile.h"
+#include "QTNativePipeline.h"
+#include "QTNativeRawFile.h"
+#include "QTNativeResample.h"
+#include "QTNativeStream.h"
+#include "QTNativeThreads.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kCLIDefaultWidth				640
+#define kCLIDefaultHeight				480
+#define kCLIDefaultSteps				30
+#define kCLINumSources					2
+#define kCLIMaxFileName					1024
+#define kCLIDefaultFrameRate			30
+#define kCLIMovieTimeScale				600
+#define kCLIDefaultKeyFrameInterval		30
+
+// kinds of output
+#define kCLIOutputPPM					1
+#define kCLIOutputPAM					2
+#define kCLIOutputDump					3
+#define kCLIOutputY4M					4
+#define kCLIOutputRGBA					5
+#define kCLIOutputMovie					6
+
+// the names of the sources in an effect description (the same as QTShowEffect's kSourceOneName and so on)
+#define kCLISourceOneName				FOUR_CHAR_CODE('srcA')
+#define kCLISourceTwoName				FOUR_CHAR_CODE('srcB')
+#define kCLISourceThreeName				FOUR_CHAR_CODE('srcC')
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a source of the effect
+typedef struct {
+	const char *			fPath;
+	NativeRawFile			fFile;
+	Boolean					fIsOpen;
+	NativePixelBuffer		fScaled;					// the current frame, scaled to the size of the output (if need be)
+	NativePixelBuffer		fFrame;						// what the renderer reads: a frame of the file, or fScaled
+} CLISource;
+
+
+//////////
+//
+// QTCLI_Usage
+// Describe the options, and return the exit status for bad arguments.
+//
+//////////
+
+static int QTCLI_Usage (const char *theProgram)
+{
+	fprintf(stderr, "usage: %s [options] output\n", theProgram);
+	fprintf(stderr, "  -e type          the effect (default dslv)\n");
+	fprintf(stderr, "  -f type          a filter layered over the effect\n");
+	fprintf(stderr, "  -p name=value    a parameter of the preceding effect or filter\n");
+	fprintf(stderr, "  -a file          the first source (8-bit PPM, PGM, or PAM, or a raw frame dump)\n");
+	fprintf(stderr, "  -b file          the second source\n");
+	fprintf(stderr, "  -s widthxheight  the size of the output (default: the first source, or %dx%d)\n", kCLIDefaultWidth, kCLIDefaultHeight);
+	fprintf(stderr, "  -n steps         the number of steps (default %d)\n", kCLIDefaultSteps);
+	fprintf(stderr, "  -t threads       the number of threads that render, counting this one (default: one per processor)\n");
+	fprintf(stderr, "  -o kind          write a y4m or rgba stream rather than a raw frame dump\n");
+	fprintf(stderr, "  -r rate          the frame rate of a y4m stream or movie, like 25 or 30000:1001 (default %d)\n", kCLIDefaultFrameRate);
+	fprintf(stderr, "  -m kind          a baked movie of the rendered steps (default), or a live effect movie\n");
+	fprintf(stderr, "  -k frames        the frames from one key frame of a baked movie to the next (default %d)\n", kCLIDefaultKeyFrameInterval);
+	fprintf(stderr, "output is a file name with a step number format (frame%%04d.ppm, frame%%04d.pam),\n");
+	fprintf(stderr, "the name of a y4m stream (out.y4m) or a movie (out.mov), or the name of a raw frame dump or stream\n");
+	fprintf(stderr, "(- for the standard output; a named pipe works too)\n");
+
+	return(1);
+}
+
+
+//////////
+//
+// QTCLI_GetFourCharCode
+// Convert a string of up to four characters to an OSType, padding it with spaces; return false if it's too long
+// or empty.
+//
+//////////
+
+static Boolean QTCLI_GetFourCharCode (const char *theString, long theLength, OSType *theCode)
+{
+	long					myIndex;
+
+	if ((theLength <= 0) || (theLength > 4))
+		return(false);
+
+	*theCode = 0;
+	for (myIndex = 0; myIndex < 4; myIndex++)
+		*theCode = (*theCode << 8) | (unsigned char)((myIndex < theLength) ? theString[myIndex] : ' ');
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCLI_GetTypeString
+// Return a four-character code as a string, for messages.
+//
+//////////
+
+static char *QTCLI_GetTypeString (OSType theCode, char theString[5])
+{
+	theString[0] = (char)((theCode >> 24) & 0xFF);
+	theString[1] = (char)((theCode >> 16) & 0xFF);
+	theString[2] = (char)((theCode >> 8) & 0xFF);
+	theString[3] = (char)(theCode & 0xFF);
+	theString[4] = '\0';
+
+	return(theString);
+}
+
+
+//////////
+//
+// QTCLI_GetOutputKind
+// Return the kind of output that the specified name asks for, or 0 if it has a bad step number format. A name
+// with a step number format must have exactly one, a d or i conversion with at most two digits of width.
+//
+//////////
+
+static short QTCLI_GetOutputKind (const char *theName)
+{
+	const char				*myFormat = strchr(theName, '%');
+	const char				*myChar = NULL;
+	long					myLength = (long)strlen(theName);
+	long					myDigits = 0;
+
+	if (myFormat == NULL) {
+		if ((myLength >= 4) && ((strcmp(theName + myLength - 4, ".y4m") == 0) || (strcmp(theName + myLength - 4, ".Y4M") == 0)))
+			return(kCLIOutputY4M);
+		if ((myLength >= 4) && ((strcmp(theName + myLength - 4, ".mov") == 0) || (strcmp(theName + myLength - 4, ".MOV") == 0)))
+			return(kCLIOutputMovie);
+		return(kCLIOutputDump);
+	}
+
+	myChar = myFormat + 1;
+	if (*myChar == '0')
+		myChar++;
+	while ((*myChar >= '0') && (*myChar <= '9')) {
+		myChar++;
+		myDigits++;
+	}
+
+	if ((myDigits > 2) || ((*myChar != 'd') && (*myChar != 'i')) || (strchr(myChar, '%') != NULL))
+		return(0);
+
+	if ((myLength >= 4) && ((strcmp(theName + myLength - 4, ".pam") == 0) || (strcmp(theName + myLength - 4, ".PAM") == 0)))
+		return(kCLIOutputPAM);
+
+	return(kCLIOutputPPM);
+}
+
+
+//////////
+//
+// QTCLI_OpenSource
+// Open the file of a source.
+//
+//////////
+
+static OSErr QTCLI_OpenSource (CLISource *theSource)
+{
+	OSErr					myErr = noErr;
+
+	myErr = QTNative_OpenRawFile(theSource->fPath, &theSource->fFile);
+	if (myErr != noErr) {
+		fprintf(stderr, "can't read %s as an 8-bit PPM, PGM, or PAM file, or a raw frame file (error %d)\n", theSource->fPath, (int)myErr);
+		return(myErr);
+	}
+
+	theSource->fIsOpen = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCLI_GetSourceFrame
+// Get the frame of a source for the specified step (counting from 1), scaling it to the size of the output
+// if need be.
+//
+//////////
+
+static OSErr QTCLI_GetSourceFrame (CLISource *theSource, long theStep, long theWidth, long theHeight)
+{
+	NativePixelBuffer		myFrame;
+	long					myIndex = (theStep - 1) % theSource->fFile.fNumFrames;
+	OSErr					myErr = noErr;
+
+	myErr = QTNative_GetRawFileFrame(&theSource->fFile, myIndex, &myFrame);
+	if (myErr != noErr)
+		return(myErr);
+
+	// let the system read the next frame while this one is rendered, and drop the pages of the last one
+	if (theSource->fFile.fNumFrames > 1) {
+		QTNative_PrefetchRawFileFrame(&theSource->fFile, (myIndex + 1) % theSource->fFile.fNumFrames);
+		QTNative_ReleaseRawFileFrame(&theSource->fFile, (myIndex + theSource->fFile.fNumFrames - 1) % theSource->fFile.fNumFrames);
+	}
+
+	if ((myFrame.fWidth == theWidth) && (myFrame.fHeight == theHeight)) {
+		theSource->fFrame = myFrame;
+		return(noErr);
+	}
+
+	if (theSource->fScaled.fBaseAddr == NULL) {
+		myErr = QTNative_NewPixelBuffer(&theSource->fScaled, theWidth, theHeight, QTNative_GetHostPixelFormat());
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	theSource->fFrame = theSource->fScaled;
+
+	return(QTNative_ConvertAndScalePixelBuffer(&myFrame, &theSource->fScaled, kNativeResampleLanczos3));
+}
+
+
+//////////
+//
+// QTCLI_CloseSource
+// Close the file of a source, and dispose of its scaled frame.
+//
+//////////
+
+static void QTCLI_CloseSource (CLISource *theSource)
+{
+	if (theSource->fIsOpen)
+		QTNative_CloseRawFile(&theSource->fFile);
+
+	QTNative_DisposePixelBuffer(&theSource->fScaled);
+	theSource->fIsOpen = false;
+}
+
+
+//////////
+//
+// QTCLI_WriteImageFile
+// Write a step to a PPM file (from a 24-bit RGB buffer) or a PAM file (from a 32-bit RGBA buffer).
+//
+//////////
+
+static OSErr QTCLI_WriteImageFile (const char *theFormat, long theStep, const NativePixelBuffer *theFrame)
+{
+	FILE					*myFile = NULL;
+	char					myName[kCLIMaxFileName + 32];
+	long					myRowLength = theFrame->fWidth * QTNative_GetBytesPerPixel(theFrame->fPixelFormat);
+	long					myRow;
+	OSErr					myErr = noErr;
+
+	sprintf(myName, theFormat, (int)theStep);
+
+	myFile = fopen(myName, "wb");
+	if (myFile == NULL) {
+		fprintf(stderr, "can't create %s\n", myName);
+		return(paramErr);
+	}
+
+	if (theFrame->fPixelFormat == kNativePixelFormat_32RGBA)
+		fprintf(myFile, "P7\nWIDTH %ld\nHEIGHT %ld\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", theFrame->fWidth, theFrame->fHeight);
+	else
+		fprintf(myFile, "P6\n%ld %ld\n255\n", theFrame->fWidth, theFrame->fHeight);
+
+	for (myRow = 0; myRow < theFrame->fHeight; myRow++)
+		if (fwrite(theFrame->fBaseAddr + (myRow * theFrame->fRowBytes), 1, (size_t)myRowLength, myFile) != (size_t)myRowLength)
+			break;
+
+	if ((myRow < theFrame->fHeight) || (fclose(myFile) != 0)) {
+		fprintf(stderr, "can't write %s\n", myName);
+		myErr = paramErr;
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCLI_WriteDumpFrame
+// Write a step to a raw frame dump, padded to the frame stride that QTNative_MakeRawFileHeader promised.
+//
+//////////
+
+static OSErr QTCLI_WriteDumpFrame (FILE *theFile, const NativePixelBuffer *theFrame)
+{
+	static const unsigned char	myZeros[kNativeRawFileAlignment] = {0};
+	long						myFrameBytes = theFrame->fRowBytes * theFrame->fHeight;
+	long						myPadding = ((myFrameBytes + kNativeRawFileAlignment - 1) & ~(kNativeRawFileAlignment - 1)) - myFrameBytes;
+
+	if (fwrite(theFrame->fBaseAddr, 1, (size_t)myFrameBytes, theFile) != (size_t)myFrameBytes)
+		return(paramErr);
+
+	if ((myPadding > 0) && (fwrite(myZeros, 1, (size_t)myPadding, theFile) != (size_t)myPadding))
+		return(paramErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCLI_AddMovieFrame
+// Add a frame to a video track of a movie as a sample compressed with the Animation codec, converting it to 32-bit
+// ARGB first if need be; theARGB is a scratch buffer of the same size as the frame (which may be NULL if the frame
+// is already 32-bit ARGB), and theEncoder is the track's encoder, which decides whether it's a key frame.
+//
+//////////
+
+static OSErr QTCLI_AddMovieFrame (NativeMovieFile *theMovie, NativeMovieTrack *theTrack, const NativePixelBuffer *theFrame, NativePixelBuffer *theARGB, NativeAnimationEncoder *theEncoder, long theDuration)
+{
+	const NativePixelBuffer	*myFrame = theFrame;
+	const unsigned char		*mySample = NULL;
+	long					mySize;
+	Boolean					isKeyFrame;
+	OSErr					myErr = noErr;
+
+	if (theFrame->fPixelFormat != kNativePixelFormat_32ARGB) {
+		myErr = QTNative_ConvertPixelBuffer(theFrame, theARGB);
+		if (myErr != noErr)
+			return(myErr);
+		myFrame = theARGB;
+	}
+
+	myErr = QTNative_EncodeAnimationFrame(theEncoder, myFrame, &mySample, &mySize, &isKeyFrame);
+	if (myErr != noErr)
+		return(myErr);
+
+	return(QTNative_AddMovieSample(theMovie, theTrack, mySample, mySize, theDuration, isKeyFrame));
+}
+
+
+//////////
+//
+// QTCLI_AddEffectTrack
+// Add an effect track to a movie, with a single sample (the effect description) lasting theDuration, that reads the
+// specified tracks as its sources.
+//
+//////////
+
+static OSErr QTCLI_AddEffectTrack (NativeMovieFile *theMovie, const NativeEffectParams *theParams, NativeMovieTrack **theSrcTracks, const OSType *theSrcNames, short theNumSources, long theWidth, long theHeight, long theTimeScale, long theDuration, NativeMovieTrack **theTrack)
+{
+	unsigned char			myEffectDesc[kNativeMaxAtomContainerSize];
+	long					myDescSize;
+	short					myIndex;
+	OSErr					myErr = noErr;
+
+	myErr = QTNative_MakeEffectDescription(theParams, (theNumSources > 0) ? theSrcNames[0] : 0, (theNumSources > 1) ? theSrcNames[1] : 0, myEffectDesc, &myDescSize);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTNative_NewMovieTrack(theMovie, theWidth, theHeight, theTimeScale, theTrack);
+	if (myErr != noErr)
+		return(myErr);
+
+	// an effect track's sample description has the effect type as its codec type
+	myErr = QTNative_SetTrackImageDescription(*theTrack, theParams->fEffectType, 0, NULL);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTNative_AddMovieSample(theMovie, *theTrack, myEffectDesc, myDescSize, theDuration, true);
+	if (myErr != noErr)
+		return(myErr);
+
+	for (myIndex = 0; myIndex < theNumSources; myIndex++) {
+		myErr = QTNative_AddTrackReferenceToInputMap(*theTrack, theSrcTracks[myIndex], theSrcNames[myIndex]);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCLI_WriteLiveMovie
+// Write an effect movie, as QTEffects_CreateEffectsMovie does: a video track for the first frame of each source,
+// an effect track that reads them, and a track for each filter that reads the track before it. QuickTime renders
+// the effect as the movie plays, over theDuration units of theTimeScale.
+//
+//////////
+
+static OSErr QTCLI_WriteLiveMovie (const char *thePath, const NativeEffectParams *theStages, short theNumStages, CLISource *theSources, short theNumSources, long theWidth, long theHeight, long theTimeScale, long theDuration)
+{
+	static const OSType		kSourceNames[kCLINumSources] = {kCLISourceOneName, kCLISourceTwoName};
+	NativeMovieFile			myMovie;
+	NativeMovieTrack		*mySrcTracks[kCLINumSources];
+	NativeMovieTrack		*myEffectTrack = NULL;
+	NativeMovieTrack		*myFilterInput = NULL;
+	NativePixelBuffer		myARGB;
+	NativeAnimationEncoder	myEncoder;
+	OSType					myFilterSource = kCLISourceThreeName;
+	short					myIndex;
+	OSErr					myErr = noErr;
+
+	memset(&myARGB, 0, sizeof(myARGB));
+	memset(&myEncoder, 0, sizeof(myEncoder));
+
+	myErr = QTNative_CreateMovieFile(thePath, kCLIMovieTimeScale, &myMovie);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTNative_NewPixelBuffer(&myARGB, theWidth, theHeight, kNativePixelFormat_32ARGB);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTNative_NewAnimationEncoder(theWidth, theHeight, &myEncoder);
+	if (myErr != noErr)
+		goto bail;
+
+	// the source tracks, which start and end with the effect track
+	for (myIndex = 0; myIndex < theNumSources; myIndex++) {
+		myErr = QTCLI_GetSourceFrame(&theSources[myIndex], 1, theWidth, theHeight);
+		if (myErr == noErr)
+			myErr = QTNative_NewMovieTrack(&myMovie, theWidth, theHeight, theTimeScale, &mySrcTracks[myIndex]);
+		if (myErr == noErr)
+			myErr = QTNative_SetTrackImageDescription(mySrcTracks[myIndex], kNativeAnimationCodecType, kNativeAnimationDepth, kNativeAnimationCompressorName);
+		if (myErr == noErr)
+			myErr = QTCLI_AddMovieFrame(&myMovie, mySrcTracks[myIndex], &theSources[myIndex].fFrame, &myARGB, &myEncoder, theDuration);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+	// the effect track
+	myErr = QTCLI_AddEffectTrack(&myMovie, &theStages[0], mySrcTracks, kSourceNames, theNumSources, theWidth, theHeight, theTimeScale, theDuration, &myEffectTrack);
+	if (myErr != noErr)
+		goto bail;
+
+	// and the filters, each one reading the track before it
+	for (myIndex = 1; myIndex < theNumStages; myIndex++) {
+		myFilterInput = myEffectTrack;
+		myErr = QTCLI_AddEffectTrack(&myMovie, &theStages[myIndex], &myFilterInput, &myFilterSource, 1, theWidth, theHeight, theTimeScale, theDuration, &myEffectTrack);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+bail:
+	QTNative_DisposeAnimationEncoder(&myEncoder);
+	QTNative_DisposePixelBuffer(&myARGB);
+
+	if (QTNative_CloseMovieFile(&myMovie) != noErr)
+		myErr = kNativeMovieWriteErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// main
+//
+//////////
+
+int main (int argc, char *argv[])
+{
+	NativeEffectParams		myStages[kNativeMaxStages];
+	NativePipeline			myPipeline;
+	CLISource				mySources[kCLINumSources];
+	const NativePixelBuffer	*myFrames[kCLINumSources];
+	const NativeEffectEntry	*myEntry = NULL;
+	NativePixelBuffer		myDest;
+	NativeStream			myStream;
+	NativeMovieFile			myMovie;
+	NativeMovieTrack		*myMovieTrack = NULL;
+	NativeAnimationEncoder	myEncoder;
+	unsigned char			myHeader[kNativeRawFileHeaderSize];
+	unsigned char			myPadding[kNativeRawFileAlignment];
+	FILE					*myDumpFile = NULL;
+	const char				*myOutput = NULL;
+	const char				*myStreamKind = NULL;
+	const char				*myMovieKind = NULL;
+	char					myString[5];
+	OSType					myType;
+	OSType					myFormat = kNativePixelFormat_32ARGB;
+	long					myWidth = 0;
+	long					myHeight = 0;
+	long					mySteps = kCLIDefaultSteps;
+	long					myThreads = 0;
+	long					myRateNum = kCLIDefaultFrameRate;
+	long					myRateDen = 1;
+	long					myKeyFrameInterval = kCLIDefaultKeyFrameInterval;
+	long					myStep;
+	long					myArg;
+	double					myStart, myFinish, myRenderStart, myRenderTime = 0.0;
+	short					myNumStages = 1;
+	short					myNumSources;
+	short					myOutputKind;
+	short					myIndex;
+	Boolean					isStreamOpen = false;
+	Boolean					isMovieOpen = false;
+	int						myResult = 1;
+	OSErr					myErr = noErr;
+
+	memset(mySources, 0, sizeof(mySources));
+	memset(&myDest, 0, sizeof(myDest));
+	memset(&myStream, 0, sizeof(myStream));
+	memset(&myEncoder, 0, sizeof(myEncoder));
+	memset(myPadding, 0, sizeof(myPadding));
+
+	// each -e or -f starts a stage, and each -p adds a parameter to the stage started last
+	QTNative_InitEffectParams(&myStages[0], kNativeCrossFadeType);
+
+	for (myArg = 1; myArg < argc; myArg++) {
+		const char			*myOption = argv[myArg];
+		const char			*myValue = NULL;
+		const char			*myEquals = NULL;
+
+		if ((myOption[0] != '-') || (myOption[1] == '\0')) {
+			if (myOutput != NULL)
+				return(QTCLI_Usage(argv[0]));
+			myOutput = myOption;
+			continue;
+		}
+
+		if ((myOption[2] != '\0') || (myArg + 1 >= argc))
+			return(QTCLI_Usage(argv[0]));
+		myValue = argv[++myArg];
+
+		switch (myOption[1]) {
+			case 'e':
+				if (!QTCLI_GetFourCharCode(myValue, (long)strlen(myValue), &myType))
+					return(QTCLI_Usage(argv[0]));
+				QTNative_InitEffectParams(&myStages[0], myType);
+				break;
+
+			case 'f':
+				if ((myNumStages >= kNativeMaxStages) || !QTCLI_GetFourCharCode(myValue, (long)strlen(myValue), &myType))
+					return(QTCLI_Usage(argv[0]));
+				QTNative_InitEffectParams(&myStages[myNumStages++], myType);
+				break;
+
+			case 'p':
+				myEquals = strchr(myValue, '=');
+				if ((myEquals == NULL) || !QTCLI_GetFourCharCode(myValue, (long)(myEquals - myValue), &myType))
+					return(QTCLI_Usage(argv[0]));
+				if (QTNative_SetEffectParam(&myStages[myNumStages - 1], myType, strtol(myEquals + 1, NULL, 0)) != noErr) {
+					fprintf(stderr, "too many parameters for '%s'\n", QTCLI_GetTypeString(myStages[myNumStages - 1].fEffectType, myString));
+					return(1);
+				}
+				break;
+
+			case 'a':
+				mySources[0].fPath = myValue;
+				break;
+
+			case 'b':
+				mySources[1].fPath = myValue;
+				break;
+
+			case 's':
+				if (sscanf(myValue, "%ldx%ld", &myWidth, &myHeight) != 2)
+					return(QTCLI_Usage(argv[0]));
+				break;
+
+			case 'n':
+				mySteps = atol(myValue);
+				break;
+
+			case 't':
+				myThreads = atol(myValue);
+				break;
+
+			case 'o':
+				if ((strcmp(myValue, "y4m") != 0) && (strcmp(myValue, "rgba") != 0))
+					return(QTCLI_Usage(argv[0]));
+				myStreamKind = myValue;
+				break;
+
+			case 'm':
+				if ((strcmp(myValue, "baked") != 0) && (strcmp(myValue, "live") != 0))
+					return(QTCLI_Usage(argv[0]));
+				myMovieKind = myValue;
+				break;
+
+			case 'r':
+				if (sscanf(myValue, "%ld:%ld", &myRateNum, &myRateDen) < 1)
+					return(QTCLI_Usage(argv[0]));
+				break;
+
+			case 'k':
+				myKeyFrameInterval = atol(myValue);
+				break;
+
+			default:
+				return(QTCLI_Usage(argv[0]));
+		}
+	}
+
+	if ((myOutput == NULL) || (mySteps <= 0) || (myThreads < 0) || (myRateNum <= 0) || (myRateDen <= 0) || (myKeyFrameInterval < 0))
+		return(QTCLI_Usage(argv[0]));
+
+	myOutputKind = QTCLI_GetOutputKind(myOutput);
+	if ((myOutputKind == 0) || (strlen(myOutput) > kCLIMaxFileName)) {
+		fprintf(stderr, "bad output name %s: it may have one step number format, like frame%%04d.ppm\n", myOutput);
+		return(1);
+	}
+
+	// -o turns a single output file into a stream
+	if (myStreamKind != NULL) {
+		if ((myOutputKind != kCLIOutputDump) && (myOutputKind != kCLIOutputY4M)) {
+			fprintf(stderr, "a stream goes to a single file, not to %s\n", myOutput);
+			return(1);
+		}
+		myOutputKind = (strcmp(myStreamKind, "rgba") == 0) ? kCLIOutputRGBA : kCLIOutputY4M;
+	}
+
+	if ((myMovieKind != NULL) && (myOutputKind != kCLIOutputMovie)) {
+		fprintf(stderr, "-m is for a movie, and %s isn't one\n", myOutput);
+		return(1);
+	}
+
+	// put the effect and the filters together
+	QTNative_InitPipeline(&myPipeline);
+	for (myIndex = 0; myIndex < myNumStages; myIndex++) {
+		if (QTNative_AddPipelineStage(&myPipeline, &myStages[myIndex]) != noErr) {
+			fprintf(stderr, "'%s' isn't a native %s\n", QTCLI_GetTypeString(myStages[myIndex].fEffectType, myString), (myIndex > 0) ? "filter" : "effect");
+			return(1);
+		}
+	}
+
+	myEntry = QTNative_FindEffect(myStages[0].fEffectType);
+	myNumSources = myEntry->fNumSources;
+	if (myNumSources > kCLINumSources) {
+		fprintf(stderr, "'%s' needs more sources than this program can give it\n", QTCLI_GetTypeString(myStages[0].fEffectType, myString));
+		return(1);
+	}
+
+	// open the sources that the effect reads
+	for (myIndex = 0; myIndex < myNumSources; myIndex++) {
+		if (mySources[myIndex].fPath == NULL) {
+			fprintf(stderr, "'%s' needs %d source%s (-a and -b)\n", QTCLI_GetTypeString(myStages[0].fEffectType, myString), (int)myNumSources, (myNumSources > 1) ? "s" : "");
+			goto bail;
+		}
+
+		if (QTCLI_OpenSource(&mySources[myIndex]) != noErr)
+			goto bail;
+	}
+
+	if (myWidth == 0) {
+		myWidth = (myNumSources > 0) ? mySources[0].fFile.fWidth : kCLIDefaultWidth;
+		myHeight = (myNumSources > 0) ? mySources[0].fFile.fHeight : kCLIDefaultHeight;
+	}
+
+	if ((myWidth <= 0) || (myHeight <= 0) || (myWidth > kNativeMaxResampleSize) || (myHeight > kNativeMaxResampleSize)) {
+		fprintf(stderr, "bad output size %ldx%ld\n", myWidth, myHeight);
+		goto bail;
+	}
+
+	// render straight into the format that's written out
+	if (myOutputKind == kCLIOutputPPM)
+		myFormat = kNativePixelFormat_24RGB;
+	else if ((myOutputKind == kCLIOutputPAM) || (myOutputKind == kCLIOutputRGBA))
+		myFormat = kNativePixelFormat_32RGBA;
+
+	QTNative_InitBlendKernels();
+	QTNative_StartFramePool();
+	// the main thread renders too, so -t 1 needs no worker threads at all
+	if (myThreads != 1)
+		QTNative_StartThreads((myThreads > 1) ? myThreads - 1 : 0);
+
+	if (QTNative_NewPixelBuffer(&myDest, myWidth, myHeight, myFormat) != noErr) {
+		fprintf(stderr, "not enough memory for %ldx%ld frames\n", myWidth, myHeight);
+		goto bail;
+	}
+
+	// a raw frame dump starts with a header, padded to the first frame
+	if (myOutputKind == kCLIOutputDump) {
+		if (strcmp(myOutput, "-") == 0) {
+#if defined(_WIN32)
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			myDumpFile = stdout;
+		} else {
+			myDumpFile = fopen(myOutput, "wb");
+		}
+
+		if (myDumpFile == NULL) {
+			fprintf(stderr, "can't create %s\n", myOutput);
+			goto bail;
+		}
+
+		QTNative_MakeRawFileHeader(&myDest, mySteps, myHeader);
+		if ((fwrite(myHeader, 1, sizeof(myHeader), myDumpFile) != sizeof(myHeader)) ||
+			(fwrite(myPadding, 1, kNativeRawFileAlignment - kNativeRawFileHeaderSize, myDumpFile) != kNativeRawFileAlignment - kNativeRawFileHeaderSize)) {
+			fprintf(stderr, "can't write %s\n", myOutput);
+			goto bail;
+		}
+	}
+
+	// a stream writes the frames on a thread of its own, while we render the next ones
+	if ((myOutputKind == kCLIOutputY4M) || (myOutputKind == kCLIOutputRGBA)) {
+		myErr = QTNative_OpenStream(myOutput, (myOutputKind == kCLIOutputY4M) ? kNativeStreamY4M : kNativeStreamRGBA,
+									myWidth, myHeight, myRateNum, myRateDen, kNativeDefaultStreamFrames, &myStream);
+		if (myErr != noErr) {
+			fprintf(stderr, "can't create %s (error %d)\n", myOutput, (int)myErr);
+			goto bail;
+		}
+		isStreamOpen = true;
+	}
+
+	// a live movie holds only the sources and the effect, and QuickTime renders the steps as it plays
+	if ((myOutputKind == kCLIOutputMovie) && (myMovieKind != NULL) && (strcmp(myMovieKind, "live") == 0)) {
+		myErr = QTCLI_WriteLiveMovie(myOutput, myStages, myNumStages, mySources, myNumSources, myWidth, myHeight, myRateNum, mySteps * myRateDen);
+		if (myErr != noErr) {
+			fprintf(stderr, "can't write %s (error %d)\n", myOutput, (int)myErr);
+			goto bail;
+		}
+
+		fprintf(stderr, "wrote an effect movie of '%s' at %ldx%ld, %ld steps long\n", QTCLI_GetTypeString(myStages[0].fEffectType, myString), myWidth, myHeight, mySteps);
+		myResult = 0;
+		goto bail;
+	}
+
+	// a baked movie gets a frame for each step
+	if (myOutputKind == kCLIOutputMovie) {
+		myErr = QTNative_CreateMovieFile(myOutput, kCLIMovieTimeScale, &myMovie);
+		if (myErr != noErr) {
+			fprintf(stderr, "can't create %s (error %d)\n", myOutput, (int)myErr);
+			goto bail;
+		}
+		isMovieOpen = true;
+
+		myErr = QTNative_NewMovieTrack(&myMovie, myWidth, myHeight, myRateNum, &myMovieTrack);
+		if (myErr == noErr)
+			myErr = QTNative_SetTrackImageDescription(myMovieTrack, kNativeAnimationCodecType, kNativeAnimationDepth, kNativeAnimationCompressorName);
+		if (myErr == noErr)
+			myErr = QTNative_NewAnimationEncoder(myWidth, myHeight, &myEncoder);
+		if (myErr == noErr)
+			myErr = QTNative_SetAnimationKeyFrameInterval(&myEncoder, myKeyFrameInterval);
+
+		if (myErr != noErr) {
+			fprintf(stderr, "can't create %s (error %d)\n", myOutput, (int)myErr);
+			goto bail;
+		}
+	}
+
+	fprintf(stderr, "rendering %ld steps of '%s' at %ldx%ld on %ld thread%s\n", mySteps, QTCLI_GetTypeString(myStages[0].fEffectType, myString),
+			myWidth, myHeight, QTNative_GetNumberOfThreads(), (QTNative_GetNumberOfThreads() > 1) ? "s" : "");
+
+	myStart = QTNative_GetSeconds();
+
+	for (myStep = 1; myStep <= mySteps; myStep++) {
+		for (myIndex = 0; myIndex < myNumSources; myIndex++) {
+			myErr = QTCLI_GetSourceFrame(&mySources[myIndex], myStep, myWidth, myHeight);
+			if (myErr != noErr) {
+				fprintf(stderr, "can't get a frame of %s for step %ld (error %d)\n", mySources[myIndex].fPath, myStep, (int)myErr);
+				goto bail;
+			}
+
+			myFrames[myIndex] = &mySources[myIndex].fFrame;
+		}
+
+		myRenderStart = QTNative_GetSeconds();
+		myErr = QTNative_RenderPipeline(&myPipeline, myStep, mySteps, myFrames, myNumSources, &myDest);
+		myRenderTime += QTNative_GetSeconds() - myRenderStart;
+		if (myErr != noErr) {
+			fprintf(stderr, "can't render step %ld (error %d)\n", myStep, (int)myErr);
+			goto bail;
+		}
+
+		if (isStreamOpen)
+			myErr = QTNative_WriteStreamFrame(&myStream, myStep - 1, &myDest);
+		else if (isMovieOpen)
+			myErr = QTCLI_AddMovieFrame(&myMovie, myMovieTrack, &myDest, NULL, &myEncoder, myRateDen);
+		else if (myDumpFile != NULL)
+			myErr = QTCLI_WriteDumpFrame(myDumpFile, &myDest);
+		else
+			myErr = QTCLI_WriteImageFile(myOutput, myStep, &myDest);
+
+		if (myErr != noErr) {
+			if (isStreamOpen || isMovieOpen || (myDumpFile != NULL))
+				fprintf(stderr, "can't write %s\n", myOutput);
+			goto bail;
+		}
+	}
+
+	// write the movie's sample tables
+	if (isMovieOpen) {
+		isMovieOpen = false;
+		if (QTNative_CloseMovieFile(&myMovie) != noErr) {
+			fprintf(stderr, "can't write %s\n", myOutput);
+			goto bail;
+		}
+	}
+
+	// wait for the stream to write the last frames
+	if (isStreamOpen) {
+		isStreamOpen = false;
+		if (QTNative_CloseStream(&myStream) != noErr) {
+			fprintf(stderr, "can't write %s\n", myOutput);
+			goto bail;
+		}
+	}
+
+	if ((myDumpFile != NULL) && (fflush(myDumpFile) != 0)) {
+		fprintf(stderr, "can't write %s\n", myOutput);
+		goto bail;
+	}
+
+	myFinish = QTNative_GetSeconds();
+
+	fprintf(stderr, "%ld steps in %.2f s: %.1f frames/s (%.1f frames/s rendering alone)\n", mySteps, myFinish - myStart,
+			mySteps / (myFinish - myStart), (myRenderTime > 0.0) ? mySteps / myRenderTime : 0.0);
+
+	myResult = 0;
+
+bail:
+	if (isStreamOpen)
+		QTNative_CloseStream(&myStream);
+
+	if (isMovieOpen)
+		QTNative_CloseMovieFile(&myMovie);
+
+	QTNative_DisposeAnimationEncoder(&myEncoder);
+
+	if ((myDumpFile != NULL) && (myDumpFile != stdout) && (fclose(myDumpFile) != 0) && (myResult == 0)) {
+		fprintf(stderr, "can't write %s\n", myOutput);
+		myResult = 1;
+	}
+
+	for (myIndex = 0; myIndex < kCLINumSources; myIndex++)
+		QTCLI_CloseSource(&mySources[myIndex]);
+
+	QTNative_DisposePixelBuffer(&myDest);
+	QTNative_StopThreads();
+	QTNative_FlushGenerators();
+	QTNative_StopFramePool();
+
+	return(myResult);
+}
@@ -0,0 +1,233 @@
+# Microsoft Developer Studio Project File - Name="QTEffectsCLI" - Package Owner=<4>
+# Microsoft Developer Studio Generated Build File, Format Version 5.00
+# ** DO NOT EDIT **
+
+# TARGTYPE "Win32 (x86) Console Application" 0x0103
+
+CFG=QTEffectsCLI - Win32 Release
+!MESSAGE This is not a valid makefile. To build this project using NMAKE,
+!MESSAGE use the Export Makefile command and run
+!MESSAGE 
+!MESSAGE NMAKE /f "QTEffectsCLI.mak".
+!MESSAGE 
+!MESSAGE You can specify a configuration when running NMAKE
+!MESSAGE by defining the macro CFG on the command line. For example:
+!MESSAGE 
+!MESSAGE NMAKE /f "QTEffectsCLI.mak" CFG="QTEffectsCLI - Win32 Release"
+!MESSAGE 
+!MESSAGE Possible choices for configuration are:
+!MESSAGE 
+!MESSAGE "QTEffectsCLI - Win32 Release" (based on "Win32 (x86) Console Application")
+!MESSAGE "QTEffectsCLI - Win32 Debug" (based on "Win32 (x86) Console Application")
+!MESSAGE 
+
+# Begin Project
+# PROP Scc_ProjName ""
+# PROP Scc_LocalPath ""
+CPP=cl.exe
+RSC=rc.exe
+
+!IF  "$(CFG)" == "QTEffectsCLI - Win32 Release"
+
+# PROP BASE Use_MFC 0
+# PROP BASE Use_Debug_Libraries 0
+# PROP BASE Output_Dir ".\CLIRelease"
+# PROP BASE Intermediate_Dir ".\CLIRelease"
+# PROP BASE Target_Dir ""
+# PROP Use_MFC 0
+# PROP Use_Debug_Libraries 0
+# PROP Output_Dir ".\CLIRelease"
+# PROP Intermediate_Dir ".\CLIRelease"
+# PROP Ignore_Export_Lib 0
+# PROP Target_Dir ""
+# ADD BASE CPP /nologo /W3 /GX /O2 /D "WIN32" /D "NDEBUG" /D "_CONSOLE" /YX /c
+# ADD CPP /nologo /W3 /GX /O2 /I "." /D "WIN32" /D "NDEBUG" /D "_CONSOLE" /YX /FD /c
+# ADD BASE RSC /l 0x409 /d "NDEBUG"
+# ADD RSC /l 0x409 /d "NDEBUG"
+BSC32=bscmake.exe
+# ADD BASE BSC32 /nologo
+# ADD BSC32 /nologo
+LINK32=link.exe
+# ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:console /machine:I386
+# ADD LINK32 kernel32.lib /nologo /subsystem:console /machine:I386
+
+!ELSEIF  "$(CFG)" == "QTEffectsCLI - Win32 Debug"
+
+# PROP BASE Use_MFC 0
+# PROP BASE Use_Debug_Libraries 1
+# PROP BASE Output_Dir ".\CLIDebug"
+# PROP BASE Intermediate_Dir ".\CLIDebug"
+# PROP BASE Target_Dir ""
+# PROP Use_MFC 0
+# PROP Use_Debug_Libraries 1
+# PROP Output_Dir ".\CLIDebug"
+# PROP Intermediate_Dir ".\CLIDebug"
+# PROP Ignore_Export_Lib 0
+# PROP Target_Dir ""
+# ADD BASE CPP /nologo /W3 /Gm /GX /Zi /Od /D "WIN32" /D "_DEBUG" /D "_CONSOLE" /YX /c
+# ADD CPP /nologo /W3 /Gm /GX /Zi /Od /I "." /D "WIN32" /D "_DEBUG" /D "_CONSOLE" /YX /FD /c
+# ADD BASE RSC /l 0x409 /d "_DEBUG"
+# ADD RSC /l 0x409 /d "_DEBUG"
+BSC32=bscmake.exe
+# ADD BASE BSC32 /nologo
+# ADD BSC32 /nologo
+LINK32=link.exe
+# ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:console /debug /machine:I386
+# ADD LINK32 kernel32.lib /nologo /subsystem:console /debug /machine:I386
+
+!ENDIF 
+
+# Begin Target
+
+# Name "QTEffectsCLI - Win32 Release"
+# Name "QTEffectsCLI - Win32 Debug"
+# Begin Group "Source Files"
+
+# PROP Default_Filter "cpp;c;cxx;rc;def;r;odl;hpj;bat;for;f90"
+# Begin Source File
+
+SOURCE=.\QTEffectsCLI.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeAnimation.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeBlend.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvert.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvolve.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeCPU.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeEffects.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFormats.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFramePool.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGenerators.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeKey.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeMovieFile.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeNoise.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativePipeline.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeRawFile.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeResample.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeStream.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeThreads.c
+# End Source File
+# End Group
+# Begin Group "Header Files"
+
+# PROP Default_Filter "h;hpp;hxx;hm;inl;fi;fd"
+# Begin Source File
+
+SOURCE=.\QTNativeAnimation.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeBlend.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvert.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvolve.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeCPU.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeEffects.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFormats.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFramePool.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGenerators.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeKey.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeMovieFile.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeNoise.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativePipeline.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeRawFile.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeResample.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeStream.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeThreads.h
+# End Source File
+# End Group
+# End Target
+# End Project
@@ -0,0 +1,798 @@
+//////////
+//
+//	File:		QTNativeAnimation.c
+//
+//	Contains:	A native encoder for QuickTime's Animation codec (run-length encoded 32-bit pixels), which encodes
+//				the bands of a frame in parallel into buffers that are kept from one frame to the next.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		added delta frames, which encode only the lines and the spans of pixels that changed since the
+//									previous frame, and a key frame interval for each encoder
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	QTEffects_AddVideoTrackFromGWorld used to compress its pictures with CompressImage, which runs the Animation
+//	compressor on the calling thread and needs a new buffer (sized by GetMaxCompressionSize) for every picture.
+//	This file writes the same compressed data that the Animation decompressor reads, at a depth of 32:
+//
+//		4 bytes			the size of the frame, including these 4 bytes
+//		2 bytes			a header: 0 if every line of the frame follows, or 8 if some lines follow
+//		(if the header is 8)
+//		2 bytes			the number of the first line that follows
+//		2 bytes			0
+//		2 bytes			the number of lines that follow
+//		2 bytes			0
+//		then, for each line:
+//		1 byte			one more than the number of pixels to skip at the start of the line (so 1 skips none)
+//		then codes, each a signed byte:
+//			1..127		that many pixels follow, each as 4 bytes of A, R, G, B
+//			-2..-128	one pixel follows, to be repeated that many times
+//			0			one more than the number of pixels to skip follows, as 1 byte
+//			-1			the end of the line
+//		1 byte			0, at the end of the frame
+//
+//	Every line starts afresh, so the lines can be encoded independently. We split the frame into bands of rows,
+//	as the renderer does, and encode the bands in parallel on the worker threads. Each band writes its lines
+//	into its own part of the encoder's output buffer (which has room for the largest line at every row), and
+//	the bands are then moved down next to each other behind the header. The output buffer belongs to the
+//	encoder, so a movie of many frames reuses it rather than allocating one for each frame.
+//
+//	A line is encoded by looking for runs: a run of 2 or more equal pixels becomes a run code (5 bytes instead
+//	of 8 or more), and the pixels up to the next pair of equal pixels are copied. The searches for the end of a
+//	run and for the next pair of equal pixels are the inner loops of the encoder; their AVX2 versions compare 8
+//	pixels at a time and produce exactly the same results as the scalar versions.
+//
+//	The codec is also temporal: a frame that isn't a key frame is drawn over the frame before it, so the pixels it
+//	skips keep their old values. The encoder keeps a copy of the last frame it encoded, and encodes each frame
+//	between key frames as a delta frame: a line that's the same as before is reduced to a skip byte and the end of
+//	the line, and in a line that changed, the spans of pixels that are the same are skipped (with the code 0) and
+//	only the spans that changed are encoded. Only the lines from the first one that changed to the last one follow
+//	the header. In a transition like a wipe, where only the part of the frame near the edge of the wipe changes
+//	from one step to the next, a delta frame is a small fraction of the size of a key frame. The searches for the
+//	spans of changed and unchanged pixels also have AVX2 versions, which compare 8 pixels with the pixels of the
+//	last frame at a time.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeAnimation.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeThreads.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeAnimationFrameHeader			6			// the size and the header of a frame of every line
+#define kNativeAnimationMaxFrameHeader		14			// the size and the header of a frame of some lines
+#define kNativeAnimationSomeLines			0x0008		// the header of a frame of some lines
+#define kNativeAnimationSkipCode			0			// the code before a skip byte
+#define kNativeAnimationEndOfLine			0xFF		// the code -1
+#define kNativeAnimationMaxSkip				254			// the most pixels skipped by one skip byte
+#define kNativeAnimationSameLineSize		2			// the size of a line that's the same as before (a skip byte and -1)
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// return the number of pixels in a search of thePixels (see QTNative_CountRunScalar and QTNative_FindPairScalar)
+typedef long (*NativeRunSearchProcPtr) (const unsigned int *thePixels, long theCount);
+
+// return the number of pixels in a search of thePixels and the same pixels of the last frame (see
+// QTNative_CountSameScalar and QTNative_CountChangedScalar)
+typedef long (*NativeDeltaSearchProcPtr) (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount);
+
+// what the encoder of each band needs to know
+typedef struct {
+	NativeAnimationEncoder *	fEncoder;
+	const NativePixelBuffer *	fFrame;
+	long						fBandHeight;
+	Boolean						fIsKeyFrame;
+	NativeRunSearchProcPtr		fCountRun;
+	NativeRunSearchProcPtr		fFindPair;
+	NativeDeltaSearchProcPtr	fCountSame;
+	NativeDeltaSearchProcPtr	fCountChanged;
+} NativeAnimationInfo;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static OSErr						QTNative_EncodeAnimationBand (void *theRefCon, long theIndex);
+static long							QTNative_EncodeAnimationLine (const NativeAnimationInfo *theInfo, const unsigned int *theRow, unsigned char *theData);
+static long							QTNative_EncodeAnimationDeltaLine (const NativeAnimationInfo *theInfo, const unsigned int *theRow, const unsigned int *theLastRow, unsigned char *theData);
+static long							QTNative_EncodeAnimationSpan (const NativeAnimationInfo *theInfo, const unsigned int *thePixels, long theCount, unsigned char *theData);
+static long							QTNative_EncodeAnimationSkip (long theCount, unsigned char *theData);
+static long							QTNative_CountRunScalar (const unsigned int *thePixels, long theCount);
+static long							QTNative_FindPairScalar (const unsigned int *thePixels, long theCount);
+static long							QTNative_CountSameScalar (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount);
+static long							QTNative_CountChangedScalar (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount);
+#if NATIVE_HAS_AVX2
+static long							QTNative_CountRunAVX2 (const unsigned int *thePixels, long theCount);
+static long							QTNative_FindPairAVX2 (const unsigned int *thePixels, long theCount);
+static long							QTNative_CountSameAVX2 (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount);
+static long							QTNative_CountChangedAVX2 (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount);
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Encoder functions.
+//
+// Use these functions to encode frames with the Animation codec.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_NewAnimationEncoder
+// Prepare an encoder for frames of the specified size. Every frame it encodes is a key frame, unless a longer
+// key frame interval is set with QTNative_SetAnimationKeyFrameInterval.
+//
+//////////
+
+OSErr QTNative_NewAnimationEncoder (long theWidth, long theHeight, NativeAnimationEncoder *theEncoder)
+{
+	if (theEncoder == NULL)
+		return(paramErr);
+
+	theEncoder->fData = NULL;
+	theEncoder->fBandSizes = NULL;
+	theEncoder->fChangedLines = NULL;
+	theEncoder->fLastFrame = NULL;
+
+	if ((theWidth <= 0) || (theHeight <= 0) || (theHeight > kNativeAnimationMaxLines))
+		return(paramErr);
+
+	theEncoder->fWidth = theWidth;
+	theEncoder->fHeight = theHeight;
+	theEncoder->fKeyFrameInterval = 1;
+	theEncoder->fNumFrames = 0;
+
+	// the largest line is a skip byte, the pixels copied 127 at a time, and the end of the line
+	theEncoder->fMaxLineSize = 1 + (4 * theWidth) + ((theWidth + kNativeAnimationMaxLiteral - 1) / kNativeAnimationMaxLiteral) + 1;
+
+	theEncoder->fData = (unsigned char *)QTNative_NewPoolBlock(QTNative_GetMaxAnimationFrameSize(theWidth, theHeight));
+	theEncoder->fBandSizes = (long *)QTNative_NewPoolBlock(theHeight * (long)sizeof(long));
+	theEncoder->fChangedLines = (long *)QTNative_NewPoolBlock(2 * theHeight * (long)sizeof(long));
+	if ((theEncoder->fData == NULL) || (theEncoder->fBandSizes == NULL) || (theEncoder->fChangedLines == NULL)) {
+		QTNative_DisposeAnimationEncoder(theEncoder);
+		return(memFullErr);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_DisposeAnimationEncoder
+// Free the buffers of an encoder.
+//
+//////////
+
+void QTNative_DisposeAnimationEncoder (NativeAnimationEncoder *theEncoder)
+{
+	if (theEncoder == NULL)
+		return;
+
+	QTNative_DisposePoolBlock(theEncoder->fData);
+	QTNative_DisposePoolBlock(theEncoder->fBandSizes);
+	QTNative_DisposePoolBlock(theEncoder->fChangedLines);
+	QTNative_DisposePoolBlock(theEncoder->fLastFrame);
+
+	theEncoder->fData = NULL;
+	theEncoder->fBandSizes = NULL;
+	theEncoder->fChangedLines = NULL;
+	theEncoder->fLastFrame = NULL;
+}
+
+
+//////////
+//
+// QTNative_SetAnimationKeyFrameInterval
+// Set the number of frames from one key frame to the next (1 makes every frame a key frame, and 0 makes only the
+// first frame one); the frames in between are delta frames. The next frame is a key frame in any case.
+//
+//////////
+
+OSErr QTNative_SetAnimationKeyFrameInterval (NativeAnimationEncoder *theEncoder, long theInterval)
+{
+	if ((theEncoder == NULL) || (theInterval < 0))
+		return(paramErr);
+
+	// a delta frame needs a copy of the frame before it
+	if ((theInterval != 1) && (theEncoder->fLastFrame == NULL)) {
+		theEncoder->fLastFrame = (unsigned char *)QTNative_NewPoolBlock(theEncoder->fWidth * theEncoder->fHeight * 4);
+		if (theEncoder->fLastFrame == NULL)
+			return(memFullErr);
+	}
+
+	theEncoder->fKeyFrameInterval = theInterval;
+	theEncoder->fNumFrames = 0;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetMaxAnimationFrameSize
+// Return the most bytes that an encoded frame of the specified size can take.
+//
+//////////
+
+long QTNative_GetMaxAnimationFrameSize (long theWidth, long theHeight)
+{
+	long			myMaxLineSize = 1 + (4 * theWidth) + ((theWidth + kNativeAnimationMaxLiteral - 1) / kNativeAnimationMaxLiteral) + 1;
+
+	return(kNativeAnimationMaxFrameHeader + (theHeight * myMaxLineSize) + 1);
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationFrame
+// Encode a frame in the 32-bit ARGB format, of the size the encoder was prepared for; return the encoded frame,
+// its size, and whether it's a key frame. The encoded frame is in the encoder's buffer, and stays there until the
+// next frame is encoded.
+//
+//////////
+
+OSErr QTNative_EncodeAnimationFrame (NativeAnimationEncoder *theEncoder, const NativePixelBuffer *theFrame, const unsigned char **theData, long *theSize, Boolean *isKeyFrame)
+{
+	NativeAnimationInfo			myInfo;
+	unsigned char				*myData = NULL;
+	long						myNumBands;
+	long						myBand;
+	long						myFirstLine;
+	long						myLastLine;
+	OSErr						myErr = noErr;
+
+	if ((theEncoder == NULL) || (theEncoder->fData == NULL) || (theFrame == NULL) || (theFrame->fBaseAddr == NULL) || (theData == NULL) || (theSize == NULL) || (isKeyFrame == NULL))
+		return(paramErr);
+
+	if ((theFrame->fPixelFormat != kNativePixelFormat_32ARGB) || (theFrame->fWidth != theEncoder->fWidth) || (theFrame->fHeight != theEncoder->fHeight))
+		return(paramErr);
+
+	myInfo.fEncoder = theEncoder;
+	myInfo.fFrame = theFrame;
+	myInfo.fBandHeight = QTNative_GetBandHeight(theFrame);
+	myInfo.fIsKeyFrame = (theEncoder->fLastFrame == NULL) || (theEncoder->fNumFrames == 0) || ((theEncoder->fKeyFrameInterval > 0) && (theEncoder->fNumFrames % theEncoder->fKeyFrameInterval == 0));
+	myInfo.fCountRun = QTNative_CountRunScalar;
+	myInfo.fFindPair = QTNative_FindPairScalar;
+	myInfo.fCountSame = QTNative_CountSameScalar;
+	myInfo.fCountChanged = QTNative_CountChangedScalar;
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels()) {
+		myInfo.fCountRun = QTNative_CountRunAVX2;
+		myInfo.fFindPair = QTNative_FindPairAVX2;
+		myInfo.fCountSame = QTNative_CountSameAVX2;
+		myInfo.fCountChanged = QTNative_CountChangedAVX2;
+	}
+#endif
+
+	// encode the bands, each into its own part of the buffer
+	myNumBands = (theFrame->fHeight + myInfo.fBandHeight - 1) / myInfo.fBandHeight;
+
+	myErr = QTNative_ParallelFor(myNumBands, QTNative_EncodeAnimationBand, &myInfo);
+	if (myErr != noErr) {
+		// the copy of the last frame may be partly overwritten, so start again with a key frame
+		theEncoder->fNumFrames = 0;
+		return(myErr);
+	}
+
+	theEncoder->fNumFrames++;
+
+	// a key frame has every line; a delta frame has the lines from the first one that changed to the last one
+	// (or, if none changed, just the first line, which is then the same as before)
+	myFirstLine = 0;
+	myLastLine = theFrame->fHeight - 1;
+	if (!myInfo.fIsKeyFrame) {
+		myFirstLine = theFrame->fHeight;
+		myLastLine = -1;
+		for (myBand = 0; myBand < myNumBands; myBand++) {
+			if (theEncoder->fChangedLines[2 * myBand] < myFirstLine)
+				myFirstLine = theEncoder->fChangedLines[2 * myBand];
+			if (theEncoder->fChangedLines[(2 * myBand) + 1] > myLastLine)
+				myLastLine = theEncoder->fChangedLines[(2 * myBand) + 1];
+		}
+
+		if (myLastLine < 0) {
+			myFirstLine = 0;
+			myLastLine = 0;
+		}
+	}
+
+	// move the bands (or the parts of them with those lines) down behind the header, in order; each one moves toward
+	// the start of the buffer, so it never overwrites a band that hasn't been moved yet
+	myData = theEncoder->fData + (myInfo.fIsKeyFrame ? kNativeAnimationFrameHeader : kNativeAnimationMaxFrameHeader);
+	for (myBand = 0; myBand < myNumBands; myBand++) {
+		unsigned char		*myBandData = theEncoder->fData + kNativeAnimationMaxFrameHeader + (myBand * myInfo.fBandHeight * theEncoder->fMaxLineSize);
+		long				myBandSize = theEncoder->fBandSizes[myBand];
+		long				myFirstRow = myBand * myInfo.fBandHeight;
+		long				myLastRow = myFirstRow + myInfo.fBandHeight - 1;
+
+		if (myLastRow > theFrame->fHeight - 1)
+			myLastRow = theFrame->fHeight - 1;
+
+		if ((myLastRow < myFirstLine) || (myFirstRow > myLastLine))
+			continue;
+
+		// the lines of the band outside those lines are all the same as before, and so all the same size
+		if (myFirstRow < myFirstLine) {
+			myBandData += kNativeAnimationSameLineSize * (myFirstLine - myFirstRow);
+			myBandSize -= kNativeAnimationSameLineSize * (myFirstLine - myFirstRow);
+		}
+		if (myLastRow > myLastLine)
+			myBandSize -= kNativeAnimationSameLineSize * (myLastRow - myLastLine);
+
+		memmove(myData, myBandData, (size_t)myBandSize);
+		myData += myBandSize;
+	}
+
+	*myData++ = 0;
+
+	*theSize = (long)(myData - theEncoder->fData);
+	theEncoder->fData[0] = (unsigned char)(*theSize >> 24);
+	theEncoder->fData[1] = (unsigned char)(*theSize >> 16);
+	theEncoder->fData[2] = (unsigned char)(*theSize >> 8);
+	theEncoder->fData[3] = (unsigned char)*theSize;
+	theEncoder->fData[4] = 0;
+	theEncoder->fData[5] = 0;
+
+	if (!myInfo.fIsKeyFrame) {
+		theEncoder->fData[5] = kNativeAnimationSomeLines;
+		theEncoder->fData[6] = (unsigned char)(myFirstLine >> 8);
+		theEncoder->fData[7] = (unsigned char)myFirstLine;
+		theEncoder->fData[8] = 0;
+		theEncoder->fData[9] = 0;
+		theEncoder->fData[10] = (unsigned char)((myLastLine - myFirstLine + 1) >> 8);
+		theEncoder->fData[11] = (unsigned char)(myLastLine - myFirstLine + 1);
+		theEncoder->fData[12] = 0;
+		theEncoder->fData[13] = 0;
+	}
+
+	*theData = theEncoder->fData;
+	*isKeyFrame = myInfo.fIsKeyFrame;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationBand
+// Encode the lines of one band of a frame, and keep a copy of them for the next frame (if there'll be delta
+// frames); this is called on a worker thread by QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_EncodeAnimationBand (void *theRefCon, long theIndex)
+{
+	const NativeAnimationInfo	*myInfo = (const NativeAnimationInfo *)theRefCon;
+	NativeAnimationEncoder		*myEncoder = myInfo->fEncoder;
+	const NativePixelBuffer		*myFrame = myInfo->fFrame;
+	long						myFirstRow = theIndex * myInfo->fBandHeight;
+	long						myLastRow = myFirstRow + myInfo->fBandHeight;
+	unsigned char				*myData = myEncoder->fData + kNativeAnimationMaxFrameHeader + (myFirstRow * myEncoder->fMaxLineSize);
+	unsigned char				*myStart = myData;
+	const unsigned int			*myRow = NULL;
+	long						mySize;
+	long						myY;
+
+	if (myLastRow > myFrame->fHeight)
+		myLastRow = myFrame->fHeight;
+
+	myEncoder->fChangedLines[2 * theIndex] = myFrame->fHeight;
+	myEncoder->fChangedLines[(2 * theIndex) + 1] = -1;
+
+	for (myY = myFirstRow; myY < myLastRow; myY++) {
+		myRow = (const unsigned int *)(myFrame->fBaseAddr + (myY * myFrame->fRowBytes));
+
+		if (myInfo->fIsKeyFrame) {
+			myData += QTNative_EncodeAnimationLine(myInfo, myRow, myData);
+		} else {
+			mySize = QTNative_EncodeAnimationDeltaLine(myInfo, myRow, (const unsigned int *)(myEncoder->fLastFrame + (myY * myFrame->fWidth * 4)), myData);
+			if (mySize > kNativeAnimationSameLineSize) {
+				if (myEncoder->fChangedLines[2 * theIndex] > myY)
+					myEncoder->fChangedLines[2 * theIndex] = myY;
+				myEncoder->fChangedLines[(2 * theIndex) + 1] = myY;
+			}
+			myData += mySize;
+		}
+
+		if (myEncoder->fLastFrame != NULL)
+			memcpy(myEncoder->fLastFrame + (myY * myFrame->fWidth * 4), myRow, (size_t)myFrame->fWidth * 4);
+	}
+
+	myEncoder->fBandSizes[theIndex] = (long)(myData - myStart);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationLine
+// Encode one line of a frame; return the number of bytes written.
+//
+//////////
+
+static long QTNative_EncodeAnimationLine (const NativeAnimationInfo *theInfo, const unsigned int *theRow, unsigned char *theData)
+{
+	unsigned char				*myData = theData;
+
+	// skip no pixels
+	*myData++ = 1;
+
+	myData += QTNative_EncodeAnimationSpan(theInfo, theRow, theInfo->fFrame->fWidth, myData);
+
+	*myData++ = kNativeAnimationEndOfLine;
+
+	return((long)(myData - theData));
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationDeltaLine
+// Encode one line of a delta frame: skip the spans of pixels that are the same as in theLastRow, and encode the
+// others. Return the number of bytes written, which is kNativeAnimationSameLineSize if the line is the same as before.
+//
+//////////
+
+static long QTNative_EncodeAnimationDeltaLine (const NativeAnimationInfo *theInfo, const unsigned int *theRow, const unsigned int *theLastRow, unsigned char *theData)
+{
+	unsigned char				*myData = theData;
+	long						myWidth = theInfo->fFrame->fWidth;
+	long						myX;
+	long						myCount;
+
+	myX = theInfo->fCountSame(theRow, theLastRow, myWidth);
+	if (myX == myWidth) {
+		*myData++ = 1;
+		*myData++ = kNativeAnimationEndOfLine;
+		return(kNativeAnimationSameLineSize);
+	}
+
+	// the skip byte at the start of the line, and then skip codes for any more pixels that are the same
+	if (myX <= kNativeAnimationMaxSkip) {
+		*myData++ = (unsigned char)(myX + 1);
+	} else {
+		*myData++ = kNativeAnimationMaxSkip + 1;
+		myData += QTNative_EncodeAnimationSkip(myX - kNativeAnimationMaxSkip, myData);
+	}
+
+	while (myX < myWidth) {
+		// a span of pixels that changed
+		myCount = theInfo->fCountChanged(theRow + myX, theLastRow + myX, myWidth - myX);
+		myData += QTNative_EncodeAnimationSpan(theInfo, theRow + myX, myCount, myData);
+		myX += myCount;
+
+		// and a span of pixels that didn't, which needn't be skipped at the end of the line
+		if (myX < myWidth) {
+			myCount = theInfo->fCountSame(theRow + myX, theLastRow + myX, myWidth - myX);
+			if (myX + myCount < myWidth)
+				myData += QTNative_EncodeAnimationSkip(myCount, myData);
+			myX += myCount;
+		}
+	}
+
+	*myData++ = kNativeAnimationEndOfLine;
+
+	return((long)(myData - theData));
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationSpan
+// Encode a span of pixels as runs and copied pixels; return the number of bytes written.
+//
+//////////
+
+static long QTNative_EncodeAnimationSpan (const NativeAnimationInfo *theInfo, const unsigned int *thePixels, long theCount, unsigned char *theData)
+{
+	unsigned char				*myData = theData;
+	long						myX = 0;
+	long						myCount;
+
+	while (myX < theCount) {
+		myCount = theCount - myX;
+		if (myCount > kNativeAnimationMaxRun)
+			myCount = kNativeAnimationMaxRun;
+
+		myCount = theInfo->fCountRun(thePixels + myX, myCount);
+		if (myCount >= 2) {
+			// a run of equal pixels
+			*myData++ = (unsigned char)(256 - myCount);
+			memcpy(myData, thePixels + myX, 4);
+			myData += 4;
+			myX += myCount;
+		} else {
+			// the pixels up to the next run, copied as they are (they're already A, R, G, B in memory)
+			myCount = theInfo->fFindPair(thePixels + myX, theCount - myX);
+			while (myCount > 0) {
+				long			myNumPixels = (myCount > kNativeAnimationMaxLiteral) ? kNativeAnimationMaxLiteral : myCount;
+
+				*myData++ = (unsigned char)myNumPixels;
+				memcpy(myData, thePixels + myX, (size_t)myNumPixels * 4);
+				myData += myNumPixels * 4;
+				myX += myNumPixels;
+				myCount -= myNumPixels;
+			}
+		}
+	}
+
+	return((long)(myData - theData));
+}
+
+
+//////////
+//
+// QTNative_EncodeAnimationSkip
+// Encode skip codes for the specified number of pixels, in the middle of a line; return the number of bytes written.
+//
+//////////
+
+static long QTNative_EncodeAnimationSkip (long theCount, unsigned char *theData)
+{
+	unsigned char				*myData = theData;
+	long						myNumPixels;
+
+	while (theCount > 0) {
+		myNumPixels = (theCount > kNativeAnimationMaxSkip) ? kNativeAnimationMaxSkip : theCount;
+
+		*myData++ = kNativeAnimationSkipCode;
+		*myData++ = (unsigned char)(myNumPixels + 1);
+		theCount -= myNumPixels;
+	}
+
+	return((long)(myData - theData));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Run search functions.
+//
+// Use these functions to find runs of equal pixels in a line, and spans of pixels that changed since the last frame.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_CountRunScalar
+// Return the number of pixels at the start of thePixels (at least 1, and at most theCount) that are equal to the
+// first one.
+//
+//////////
+
+static long QTNative_CountRunScalar (const unsigned int *thePixels, long theCount)
+{
+	long				myX;
+
+	for (myX = 1; myX < theCount; myX++)
+		if (thePixels[myX] != thePixels[0])
+			break;
+
+	return(myX);
+}
+
+
+//////////
+//
+// QTNative_FindPairScalar
+// Return the index of the first pixel of thePixels that's equal to the pixel after it, or theCount if there's
+// no such pixel.
+//
+//////////
+
+static long QTNative_FindPairScalar (const unsigned int *thePixels, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX + 1 < theCount; myX++)
+		if (thePixels[myX] == thePixels[myX + 1])
+			return(myX);
+
+	return(theCount);
+}
+
+
+//////////
+//
+// QTNative_CountSameScalar
+// Return the number of pixels at the start of thePixels (at most theCount) that are the same as in theLastPixels.
+//
+//////////
+
+static long QTNative_CountSameScalar (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++)
+		if (thePixels[myX] != theLastPixels[myX])
+			break;
+
+	return(myX);
+}
+
+
+//////////
+//
+// QTNative_CountChangedScalar
+// Return the number of pixels at the start of thePixels (at most theCount) that aren't the same as in theLastPixels.
+//
+//////////
+
+static long QTNative_CountChangedScalar (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++)
+		if (thePixels[myX] == theLastPixels[myX])
+			break;
+
+	return(myX);
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_LowestBit
+// Return the index of the lowest bit that's set in a mask that isn't 0.
+//
+//////////
+
+NATIVE_INLINE long QTNative_LowestBit (unsigned int theMask)
+{
+#if defined(_MSC_VER)
+	unsigned long		myIndex;
+
+	_BitScanForward(&myIndex, theMask);
+	return((long)myIndex);
+#else
+	return((long)__builtin_ctz(theMask));
+#endif
+}
+
+
+//////////
+//
+// QTNative_CountRunAVX2
+// Do what QTNative_CountRunScalar does, comparing 8 pixels at a time with the first one.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static long QTNative_CountRunAVX2 (const unsigned int *thePixels, long theCount)
+{
+	__m256i				myFirst = _mm256_set1_epi32((int)thePixels[0]);
+	unsigned int		myMask;
+	long				myX = 1;
+
+	for (; myX + 8 <= theCount; myX += 8) {
+		myMask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(thePixels + myX)), myFirst)));
+		if (myMask != 0xFF)
+			return(myX + QTNative_LowestBit(~myMask));
+	}
+
+	for (; myX < theCount; myX++)
+		if (thePixels[myX] != thePixels[0])
+			break;
+
+	return(myX);
+}
+
+
+//////////
+//
+// QTNative_FindPairAVX2
+// Do what QTNative_FindPairScalar does, comparing 8 pixels at a time with the pixels after them.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static long QTNative_FindPairAVX2 (const unsigned int *thePixels, long theCount)
+{
+	unsigned int		myMask;
+	long				myX = 0;
+
+	for (; myX + 9 <= theCount; myX += 8) {
+		myMask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(thePixels + myX)),
+																						   _mm256_loadu_si256((const __m256i *)(thePixels + myX + 1)))));
+		if (myMask != 0)
+			return(myX + QTNative_LowestBit(myMask));
+	}
+
+	for (; myX + 1 < theCount; myX++)
+		if (thePixels[myX] == thePixels[myX + 1])
+			return(myX);
+
+	return(theCount);
+}
+
+
+//////////
+//
+// QTNative_CountSameAVX2
+// Do what QTNative_CountSameScalar does, comparing 8 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static long QTNative_CountSameAVX2 (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount)
+{
+	unsigned int		myMask;
+	long				myX = 0;
+
+	for (; myX + 8 <= theCount; myX += 8) {
+		myMask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(thePixels + myX)),
+																						   _mm256_loadu_si256((const __m256i *)(theLastPixels + myX)))));
+		if (myMask != 0xFF)
+			return(myX + QTNative_LowestBit(~myMask));
+	}
+
+	for (; myX < theCount; myX++)
+		if (thePixels[myX] != theLastPixels[myX])
+			break;
+
+	return(myX);
+}
+
+
+//////////
+//
+// QTNative_CountChangedAVX2
+// Do what QTNative_CountChangedScalar does, comparing 8 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static long QTNative_CountChangedAVX2 (const unsigned int *thePixels, const unsigned int *theLastPixels, long theCount)
+{
+	unsigned int		myMask;
+	long				myX = 0;
+
+	for (; myX + 8 <= theCount; myX += 8) {
+		myMask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(thePixels + myX)),
+																						   _mm256_loadu_si256((const __m256i *)(theLastPixels + myX)))));
+		if (myMask != 0)
+			return(myX + QTNative_LowestBit(myMask));
+	}
+
+	for (; myX < theCount; myX++)
+		if (thePixels[myX] == theLastPixels[myX])
+			break;
+
+	return(myX);
+}
+#endif	// NATIVE_HAS_AVX2
@@ -0,0 +1,81 @@
+//////////
+//
+//	File:		QTNativeAnimation.h
+//
+//	Contains:	A native encoder for QuickTime's Animation codec (run-length encoded 32-bit pixels), which encodes
+//				the bands of a frame in parallel into buffers that are kept from one frame to the next.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		added delta frames and QTNative_SetAnimationKeyFrameInterval
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeAnimation__
+#define __QTNativeAnimation__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the codec type, depth, and compressor name of the frames we encode (the same values as QuickTime's
+// kAnimationCodecType and its 32-bit "Millions of Colors+" depth)
+#define kNativeAnimationCodecType			FOUR_CHAR_CODE('rle ')
+#define kNativeAnimationDepth				32
+#define kNativeAnimationCompressorName		"Animation"
+
+// limits of the codes in an encoded line
+#define kNativeAnimationMaxRun				128			// the most pixels in one run
+#define kNativeAnimationMaxLiteral			127			// the most pixels copied by one code
+#define kNativeAnimationMaxLines			0xFFFF		// the most lines in a frame
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// an encoder of frames of one size
+typedef struct {
+	long					fWidth;
+	long					fHeight;
+	long					fMaxLineSize;				// the most bytes that one encoded line can take
+	long					fKeyFrameInterval;			// the frames from one key frame to the next, or 0 for only the first
+	long					fNumFrames;					// the frames encoded since the last change of interval
+	unsigned char *			fData;						// the encoded frame, at most QTNative_GetMaxAnimationFrameSize bytes
+	long *					fBandSizes;					// the bytes of encoded lines in each band of the current frame
+	long *					fChangedLines;				// the first and last lines of each band that changed, in a delta frame
+	unsigned char *			fLastFrame;					// the last frame, as packed 32-bit ARGB rows (NULL if every frame is a key frame)
+} NativeAnimationEncoder;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_NewAnimationEncoder (long theWidth, long theHeight, NativeAnimationEncoder *theEncoder);
+void						QTNative_DisposeAnimationEncoder (NativeAnimationEncoder *theEncoder);
+OSErr						QTNative_SetAnimationKeyFrameInterval (NativeAnimationEncoder *theEncoder, long theInterval);
+long						QTNative_GetMaxAnimationFrameSize (long theWidth, long theHeight);
+OSErr						QTNative_EncodeAnimationFrame (NativeAnimationEncoder *theEncoder, const NativePixelBuffer *theFrame, const unsigned char **theData, long *theSize, Boolean *isKeyFrame);
+
+#endif	// __QTNativeAnimation__
@@ -0,0 +1,448 @@
+//////////
+//
+//	File:		QTNativeBench.c
+//
+//	Contains:	A command-line benchmark for the native cross fade kernels.
+//
+//	Change History (most recent first):
+//
+//	   <6>	 	10/17/26	rtm		also time a graph of two branches (a blur and an emboss) cross faded and sharpened, rendered
+//									node by node and by QTNative_RenderGraph
+//	   <5>	 	10/17/26	rtm		start each compound run with an empty frame pool
+//	   <4>	 	10/17/26	rtm		keep freed frames and scratch rows in the frame pool, as the application does
+//	   <3>	 	10/17/26	rtm		also time a cross fade with film noise and sharpening layered over it, rendered stage by
+//									stage and as a fused pipeline
+//	   <2>	 	10/17/26	rtm		also time whole frames rendered by QTNative_RenderEffect, on one thread and in bands
+//									on all the worker threads
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This program blends two 4K (3840 x 2160) 32-bit frames with every cross fade kernel that runs on this
+//	processor, checks that each kernel produces the same pixels as the scalar kernel, and reports the
+//	throughput of each kernel in frames per second and in gigabytes per second of memory traffic (two
+//	frames read plus one frame written per blend). A plain memcpy of one frame is timed as well, as a rough
+//	measure of the memory bandwidth available.
+//
+//	Finally, the program times whole cross fade steps rendered by QTNative_RenderEffect, first on the calling
+//	thread alone and then split into bands on a pool of worker threads (one per processor, unless a number of
+//	threads is given), and checks that both produce the same pixels.
+//
+//	Last, it times a compound effect (a cross fade, with the film noise and sharpen filters layered over it),
+//	first rendered one stage at a time into whole intermediate frames and then as a fused pipeline (see
+//	QTNativePipeline.c), and checks that both produce the same pixels.
+//
+//	Then it times an effect graph of two branches (source A blurred, source B embossed) that are cross faded
+//	and then sharpened, first rendered one node at a time with QTNative_RenderEffect and then scheduled by
+//	QTNative_RenderGraph (see QTNativeGraph.c); it checks that both produce the same pixels, and reports how
+//	many intermediate frames the graph allocates.
+//
+//	Usage:	QTNativeBench [width height [iterations [threads [band height]]]]
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <stdio.h>
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeGraph.h"
+#include "QTNativePipeline.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kBenchDefaultWidth				3840
+#define kBenchDefaultHeight				2160
+#define kBenchDefaultIterations			50
+#define kBenchGraphNodes				4
+
+
+//////////
+//
+// QTBench_FillFrame
+// Fill a frame with an arbitrary (but repeatable) pattern.
+//
+//////////
+
+static void QTBench_FillFrame (NativePixelBuffer *theBuffer, unsigned long theSeed)
+{
+	unsigned long		myState = theSeed;
+	long				myY, myX;
+
+	for (myY = 0; myY < theBuffer->fHeight; myY++) {
+		unsigned char	*myRow = theBuffer->fBaseAddr + (myY * theBuffer->fRowBytes);
+
+		for (myX = 0; myX < theBuffer->fWidth * 4; myX++) {
+			myState = (myState * 1103515245UL) + 12345UL;
+			myRow[myX] = (unsigned char)(myState >> 16);
+		}
+	}
+}
+
+
+//////////
+//
+// QTBench_BlendFrame
+// Blend two whole frames with the current kernel.
+//
+//////////
+
+static void QTBench_BlendFrame (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theAmount)
+{
+	long				myY;
+
+	for (myY = 0; myY < theDest->fHeight; myY++)
+		QTNative_CrossFadeRow32(theSrcA->fBaseAddr + (myY * theSrcA->fRowBytes),
+								theSrcB->fBaseAddr + (myY * theSrcB->fRowBytes),
+								theDest->fBaseAddr + (myY * theDest->fRowBytes),
+								theDest->fWidth,
+								theAmount);
+}
+
+
+//////////
+//
+// QTBench_RenderFrames
+// Render a number of cross fade steps with QTNative_RenderEffect, and return the elapsed time.
+//
+//////////
+
+static double QTBench_RenderFrames (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theIterations)
+{
+	NativeEffectParams			myParams;
+	const NativePixelBuffer		*mySources[2];
+	double						myStart;
+	long						myIndex;
+
+	mySources[0] = theSrcA;
+	mySources[1] = theSrcB;
+
+	QTNative_InitEffectParams(&myParams, kNativeCrossFadeType);
+	myParams.fNumberOfSteps = theIterations;
+
+	myStart = QTNative_GetSeconds();
+	for (myIndex = 0; myIndex < theIterations; myIndex++) {
+		myParams.fStep = myIndex;
+		QTNative_RenderEffect(&myParams, mySources, 2, theDest);
+	}
+
+	return(QTNative_GetSeconds() - myStart);
+}
+
+
+//////////
+//
+// QTBench_RenderCompoundFrames
+// Render a number of steps of a compound effect (a cross fade, film noise, and sharpening), either one stage
+// at a time or as a fused pipeline, and return the elapsed time.
+//
+//////////
+
+static double QTBench_RenderCompoundFrames (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theIterations, Boolean theFused)
+{
+	static const OSType			myTypes[] = {kNativeCrossFadeType, kNativeFilmNoiseType, kNativeSharpenType};
+	NativePipeline				myPipeline;
+	NativeEffectParams			myParams;
+	NativePixelBuffer			myStages[2];
+	const NativePixelBuffer		*mySources[2];
+	double						myStart, myElapsed = 0.0;
+	long						myIndex;
+	short						myStage;
+
+	memset(myStages, 0, sizeof(myStages));
+
+	QTNative_InitPipeline(&myPipeline);
+	for (myStage = 0; myStage < 3; myStage++) {
+		QTNative_InitEffectParams(&myParams, myTypes[myStage]);
+		QTNative_AddPipelineStage(&myPipeline, &myParams);
+	}
+
+	if ((QTNative_NewPixelBuffer(&myStages[0], theDest->fWidth, theDest->fHeight, QTNative_GetHostPixelFormat()) != noErr) ||
+		(QTNative_NewPixelBuffer(&myStages[1], theDest->fWidth, theDest->fHeight, QTNative_GetHostPixelFormat()) != noErr))
+		goto bail;
+
+	myStart = QTNative_GetSeconds();
+	for (myIndex = 0; myIndex < theIterations; myIndex++) {
+		mySources[0] = theSrcA;
+		mySources[1] = theSrcB;
+
+		if (theFused) {
+			QTNative_RenderPipeline(&myPipeline, myIndex, theIterations, mySources, 2, theDest);
+			continue;
+		}
+
+		// render each stage into a whole frame, which the next stage reads
+		for (myStage = 0; myStage < myPipeline.fNumStages; myStage++) {
+			myParams = myPipeline.fStages[myStage];
+			myParams.fStep = myIndex;
+			myParams.fNumberOfSteps = theIterations;
+
+			QTNative_RenderEffect(&myParams, mySources, 2, (myStage == myPipeline.fNumStages - 1) ? theDest : &myStages[myStage & 1]);
+
+			mySources[0] = &myStages[myStage & 1];
+		}
+	}
+	myElapsed = QTNative_GetSeconds() - myStart;
+
+bail:
+	QTNative_DisposePixelBuffer(&myStages[0]);
+	QTNative_DisposePixelBuffer(&myStages[1]);
+
+	return(myElapsed);
+}
+
+
+//////////
+//
+// QTBench_RenderGraphFrames
+// Render a number of steps of an effect graph (source A blurred and source B embossed, cross faded, and then
+// sharpened), either one node at a time into whole frames or with QTNative_RenderGraph, and return the elapsed
+// time; theNumBuffers gets the number of intermediate frames that QTNative_RenderGraph allocates.
+//
+//////////
+
+static double QTBench_RenderGraphFrames (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theIterations, Boolean theScheduled, long *theNumBuffers)
+{
+	NativeEffectGraph			myGraph;
+	NativeEffectParams			myParams;
+	NativePixelBuffer			myNodes[kBenchGraphNodes - 1];
+	const NativePixelBuffer		*mySources[2];
+	double						myStart, myElapsed = 0.0;
+	long						myIndex;
+	short						myNode;
+
+	memset(myNodes, 0, sizeof(myNodes));
+
+	// node 0 blurs source A, node 1 embosses source B, node 2 cross fades from node 0 to node 1, and node 3
+	// sharpens node 2
+	QTNative_InitGraph(&myGraph, 2);
+
+	QTNative_InitEffectParams(&myParams, kNativeBlurType);
+	QTNative_AddGraphNode(&myGraph, &myParams, &myNode);
+	QTNative_ConnectGraphNode(&myGraph, myNode, FOUR_CHAR_CODE('srcA'), kNativeGraphSource(0));
+
+	QTNative_InitEffectParams(&myParams, kNativeEmbossType);
+	QTNative_AddGraphNode(&myGraph, &myParams, &myNode);
+	QTNative_ConnectGraphNode(&myGraph, myNode, FOUR_CHAR_CODE('srcA'), kNativeGraphSource(1));
+
+	QTNative_InitEffectParams(&myParams, kNativeCrossFadeType);
+	QTNative_AddGraphNode(&myGraph, &myParams, &myNode);
+	QTNative_ConnectGraphNode(&myGraph, myNode, FOUR_CHAR_CODE('srcA'), 0);
+	QTNative_ConnectGraphNode(&myGraph, myNode, FOUR_CHAR_CODE('srcB'), 1);
+
+	QTNative_InitEffectParams(&myParams, kNativeSharpenType);
+	QTNative_AddGraphNode(&myGraph, &myParams, &myNode);
+	QTNative_ConnectGraphNode(&myGraph, myNode, FOUR_CHAR_CODE('srcA'), 2);
+	QTNative_SetGraphOutput(&myGraph, myNode);
+
+	if (theNumBuffers != NULL)
+		*theNumBuffers = QTNative_GetGraphBufferCount(&myGraph);
+
+	for (myNode = 0; myNode < kBenchGraphNodes - 1; myNode++)
+		if (QTNative_NewPixelBuffer(&myNodes[myNode], theDest->fWidth, theDest->fHeight, QTNative_GetHostPixelFormat()) != noErr)
+			goto bail;
+
+	mySources[0] = theSrcA;
+	mySources[1] = theSrcB;
+
+	myStart = QTNative_GetSeconds();
+	for (myIndex = 0; myIndex < theIterations; myIndex++) {
+		if (theScheduled) {
+			QTNative_RenderGraph(&myGraph, myIndex, theIterations, mySources, theDest);
+			continue;
+		}
+
+		// render each node into a whole frame of its own, in the order in which they were added
+		for (myNode = 0; myNode < kBenchGraphNodes; myNode++) {
+			const NativeGraphNode		*myGraphNode = &myGraph.fNodes[myNode];
+			const NativePixelBuffer		*myInputs[kNativeMaxSources];
+			short						myInput;
+
+			for (myInput = 0; myInput < myGraphNode->fNumInputs; myInput++) {
+				short		myFrom = myGraphNode->fInputs[myInput];
+
+				myInputs[myInput] = (myFrom < 0) ? mySources[-1 - myFrom] : &myNodes[myFrom];
+			}
+
+			myParams = myGraphNode->fParams;
+			myParams.fStep = myIndex;
+			myParams.fNumberOfSteps = theIterations;
+
+			QTNative_RenderEffect(&myParams, myInputs, myGraphNode->fNumInputs, (myNode == kBenchGraphNodes - 1) ? theDest : &myNodes[myNode]);
+		}
+	}
+	myElapsed = QTNative_GetSeconds() - myStart;
+
+bail:
+	for (myNode = 0; myNode < kBenchGraphNodes - 1; myNode++)
+		QTNative_DisposePixelBuffer(&myNodes[myNode]);
+
+	return(myElapsed);
+}
+
+
+//////////
+//
+// main
+//
+//////////
+
+int main (int argc, char *argv[])
+{
+	NativePixelBuffer	mySrcA, mySrcB, myDest, myReference;
+	long				myWidth = kBenchDefaultWidth;
+	long				myHeight = kBenchDefaultHeight;
+	long				myIterations = kBenchDefaultIterations;
+	long				myThreads = 0;
+	long				myNumBuffers = 0;
+	double				myFrameBytes;
+	double				myStart, myElapsed;
+	long				myIndex;
+	short				myKernel;
+	int					myResult = 0;
+
+	if (argc >= 3) {
+		myWidth = atol(argv[1]);
+		myHeight = atol(argv[2]);
+	}
+	if (argc >= 4)
+		myIterations = atol(argv[3]);
+	if (argc >= 5)
+		myThreads = atol(argv[4]);
+	if (argc >= 6)
+		QTNative_SetBandHeight(atol(argv[5]));
+
+	if ((myWidth <= 0) || (myHeight <= 0) || (myIterations <= 0)) {
+		fprintf(stderr, "usage: %s [width height [iterations [threads [band height]]]]\n", argv[0]);
+		return(1);
+	}
+
+	QTNative_StartFramePool();
+
+	if ((QTNative_NewPixelBuffer(&mySrcA, myWidth, myHeight, kNativePixelFormat_32ARGB) != noErr) ||
+		(QTNative_NewPixelBuffer(&mySrcB, myWidth, myHeight, kNativePixelFormat_32ARGB) != noErr) ||
+		(QTNative_NewPixelBuffer(&myDest, myWidth, myHeight, kNativePixelFormat_32ARGB) != noErr) ||
+		(QTNative_NewPixelBuffer(&myReference, myWidth, myHeight, kNativePixelFormat_32ARGB) != noErr)) {
+		fprintf(stderr, "%s: not enough memory for %ld x %ld frames\n", argv[0], myWidth, myHeight);
+		return(1);
+	}
+
+	QTBench_FillFrame(&mySrcA, 1);
+	QTBench_FillFrame(&mySrcB, 2);
+
+	myFrameBytes = (double)myDest.fRowBytes * (double)myHeight;
+
+	printf("cross fade, %ld x %ld, %ld iterations\n", myWidth, myHeight, myIterations);
+
+	// time a plain copy of one frame, as a reference for the memory bandwidth
+	memcpy(myDest.fBaseAddr, mySrcA.fBaseAddr, (size_t)myFrameBytes);
+	myStart = QTNative_GetSeconds();
+	for (myIndex = 0; myIndex < myIterations; myIndex++)
+		memcpy(myDest.fBaseAddr, (myIndex & 1) ? mySrcA.fBaseAddr : mySrcB.fBaseAddr, (size_t)myFrameBytes);
+	myElapsed = QTNative_GetSeconds() - myStart;
+	printf("  %-8s %8.1f frames/s %8.2f GB/s\n", "memcpy", myIterations / myElapsed, (2.0 * myFrameBytes * myIterations) / (myElapsed * 1.0e9));
+
+	// compute the reference result with the scalar kernel
+	QTNative_SelectBlendKernel(kNativeKernelScalar);
+	QTBench_BlendFrame(&mySrcA, &mySrcB, &myReference, 100);
+
+	for (myKernel = kNativeKernelScalar; myKernel < kNativeNumKernels; myKernel++) {
+		if (!QTNative_IsBlendKernelAvailable(myKernel))
+			continue;
+
+		QTNative_SelectBlendKernel(myKernel);
+
+		// check the kernel against the reference result
+		QTBench_BlendFrame(&mySrcA, &mySrcB, &myDest, 100);
+		if (memcmp(myDest.fBaseAddr, myReference.fBaseAddr, (size_t)myFrameBytes) != 0) {
+			printf("  %-8s MISMATCH with the scalar kernel\n", QTNative_GetBlendKernelName(myKernel));
+			myResult = 1;
+			continue;
+		}
+
+		myStart = QTNative_GetSeconds();
+		for (myIndex = 0; myIndex < myIterations; myIndex++)
+			QTBench_BlendFrame(&mySrcA, &mySrcB, &myDest, (myIndex * kNativeBlendMax) / myIterations);
+		myElapsed = QTNative_GetSeconds() - myStart;
+
+		printf("  %-8s %8.1f frames/s %8.2f GB/s\n", QTNative_GetBlendKernelName(myKernel), myIterations / myElapsed, (3.0 * myFrameBytes * myIterations) / (myElapsed * 1.0e9));
+	}
+
+	QTNative_InitBlendKernels();
+	printf("selected kernel: %s\n", QTNative_GetBlendKernelName(QTNative_GetBlendKernel()));
+
+	// time whole steps on this thread only, and then in bands on all the threads
+	myElapsed = QTBench_RenderFrames(&mySrcA, &mySrcB, &myReference, myIterations);
+	printf("  %-8s %8.1f frames/s %8.2f ms/frame\n", "1 thread", myIterations / myElapsed, (myElapsed * 1000.0) / myIterations);
+
+	QTNative_StartThreads(myThreads);
+	myElapsed = QTBench_RenderFrames(&mySrcA, &mySrcB, &myDest, myIterations);
+	printf("  %ld threads, %ld-row bands: %.1f frames/s %.2f ms/frame\n", QTNative_GetNumberOfThreads(), QTNative_GetBandHeight(&myDest), myIterations / myElapsed, (myElapsed * 1000.0) / myIterations);
+	QTNative_StopThreads();
+
+	if (memcmp(myDest.fBaseAddr, myReference.fBaseAddr, (size_t)myFrameBytes) != 0) {
+		printf("  MISMATCH between the banded and the single-threaded steps\n");
+		myResult = 1;
+	}
+
+	// time a compound effect, rendered stage by stage and then fused
+	printf("cross fade + film noise + sharpen\n");
+	QTNative_StartThreads(myThreads);
+
+	// empty the frame pool before each run, so that the frames freed by one run don't crowd out the blocks of the other
+	QTNative_StopFramePool();
+	QTNative_StartFramePool();
+	myElapsed = QTBench_RenderCompoundFrames(&mySrcA, &mySrcB, &myReference, myIterations, false);
+	printf("  %-8s %8.1f frames/s %8.2f ms/frame\n", "staged", myIterations / myElapsed, (myElapsed * 1000.0) / myIterations);
+
+	QTNative_StopFramePool();
+	QTNative_StartFramePool();
+	myElapsed = QTBench_RenderCompoundFrames(&mySrcA, &mySrcB, &myDest, myIterations, true);
+	printf("  %-8s %8.1f frames/s %8.2f ms/frame\n", "fused", myIterations / myElapsed, (myElapsed * 1000.0) / myIterations);
+
+	QTNative_StopThreads();
+
+	if (memcmp(myDest.fBaseAddr, myReference.fBaseAddr, (size_t)myFrameBytes) != 0) {
+		printf("  MISMATCH between the fused and the staged steps\n");
+		myResult = 1;
+	}
+
+	// time an effect graph, rendered node by node and then scheduled by QTNative_RenderGraph
+	printf("blur A + emboss B, cross faded and sharpened\n");
+	QTNative_StartThreads(myThreads);
+
+	QTNative_StopFramePool();
+	QTNative_StartFramePool();
+	myElapsed = QTBench_RenderGraphFrames(&mySrcA, &mySrcB, &myReference, myIterations, false, NULL);
+	printf("  %-8s %8.1f frames/s %8.2f ms/frame\n", "by node", myIterations / myElapsed, (myElapsed * 1000.0) / myIterations);
+
+	QTNative_StopFramePool();
+	QTNative_StartFramePool();
+	myElapsed = QTBench_RenderGraphFrames(&mySrcA, &mySrcB, &myDest, myIterations, true, &myNumBuffers);
+	printf("  %-8s %8.1f frames/s %8.2f ms/frame, %ld intermediate frames\n", "graph", myIterations / myElapsed, (myElapsed * 1000.0) / myIterations, myNumBuffers);
+
+	QTNative_StopThreads();
+
+	if (memcmp(myDest.fBaseAddr, myReference.fBaseAddr, (size_t)myFrameBytes) != 0) {
+		printf("  MISMATCH between the graph and the node-by-node steps\n");
+		myResult = 1;
+	}
+
+	QTNative_DisposePixelBuffer(&mySrcA);
+	QTNative_DisposePixelBuffer(&mySrcB);
+	QTNative_DisposePixelBuffer(&myDest);
+	QTNative_DisposePixelBuffer(&myReference);
+	QTNative_StopFramePool();
+
+	return(myResult);
+}
@@ -0,0 +1,425 @@
+//////////
+//
+//	File:		QTNativeBlend.c
+//
+//	Contains:	Vectorized blending kernels for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		added QTNative_UseAVX2Kernels
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The cross fade is by far the most common effect we render, and it's a pure streaming operation: two loads,
+//	a little arithmetic, and one store per pixel. So its inner loop is written several times over, once for
+//	each vector extension we know about (SSE2, AVX2, AVX-512BW, and NEON), plus a portable scalar version that
+//	blends two channels at a time in a 32-bit register. QTNative_InitBlendKernels picks the widest version that
+//	the processor supports; QTNative_SelectBlendKernel lets a benchmark force a particular one.
+//
+//	All versions compute exactly the same result, (a * (256 - amount) + b * amount) >> 8 for each byte, so the
+//	choice of kernel never changes the rendered pixels. The kernels treat a pixel as four independent bytes,
+//	so they work for any 32-bit pixel format, as long as both sources and the destination share that format.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+
+#if NATIVE_HAS_SSE2 || NATIVE_HAS_AVX2 || NATIVE_HAS_AVX512
+#include <immintrin.h>
+#endif
+
+#if NATIVE_CPU_NEON
+#include <arm_neon.h>
+#endif
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static void							QTNative_CrossFadeRowScalar (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+#if NATIVE_HAS_SSE2
+static void							QTNative_CrossFadeRowSSE2 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+#endif
+#if NATIVE_HAS_AVX2
+static void							QTNative_CrossFadeRowAVX2 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+#endif
+#if NATIVE_HAS_AVX512
+static void							QTNative_CrossFadeRowAVX512 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+#endif
+#if NATIVE_CPU_NEON
+static void							QTNative_CrossFadeRowNEON (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+// the cross fade kernels, indexed by kernel; NULL means the kernel wasn't compiled
+static const NativeBlendRowProcPtr	gNativeCrossFadeProcs[kNativeNumKernels] = {
+	QTNative_CrossFadeRowScalar,
+#if NATIVE_HAS_SSE2
+	QTNative_CrossFadeRowSSE2,
+#else
+	NULL,
+#endif
+#if NATIVE_HAS_AVX2
+	QTNative_CrossFadeRowAVX2,
+#else
+	NULL,
+#endif
+#if NATIVE_HAS_AVX512
+	QTNative_CrossFadeRowAVX512,
+#else
+	NULL,
+#endif
+#if NATIVE_CPU_NEON
+	QTNative_CrossFadeRowNEON
+#else
+	NULL
+#endif
+};
+
+// the CPU feature that each kernel requires
+static const long					gNativeKernelFeatures[kNativeNumKernels] = {
+	0,
+	kNativeCPUHasSSE2,
+	kNativeCPUHasAVX2,
+	kNativeCPUHasAVX512BW,
+	kNativeCPUHasNEON
+};
+
+static const char *					gNativeKernelNames[kNativeNumKernels] = {
+	"scalar",
+	"SSE2",
+	"AVX2",
+	"AVX-512",
+	"NEON"
+};
+
+static NativeBlendRowProcPtr		gNativeCrossFadeRowProc = NULL;		// the current cross fade kernel
+static short						gNativeBlendKernel = kNativeKernelScalar;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Kernel selection functions.
+//
+// Use these functions to choose which version of the blending kernels is used.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_InitBlendKernels
+// Select the fastest blending kernels that this processor supports.
+//
+// It's safe to call this function more than once; the blending functions call it themselves if necessary.
+//
+//////////
+
+void QTNative_InitBlendKernels (void)
+{
+	short		myKernel;
+
+	for (myKernel = kNativeNumKernels - 1; myKernel > kNativeKernelScalar; myKernel--)
+		if (QTNative_IsBlendKernelAvailable(myKernel))
+			break;
+
+	QTNative_SelectBlendKernel(myKernel);
+}
+
+
+//////////
+//
+// QTNative_IsBlendKernelAvailable
+// Can the specified kernel run on this processor?
+//
+//////////
+
+Boolean QTNative_IsBlendKernelAvailable (short theKernel)
+{
+	if ((theKernel < 0) || (theKernel >= kNativeNumKernels))
+		return(false);
+
+	if (gNativeCrossFadeProcs[theKernel] == NULL)
+		return(false);
+
+	return((QTNative_GetCPUFeatures() & gNativeKernelFeatures[theKernel]) == gNativeKernelFeatures[theKernel]);
+}
+
+
+//////////
+//
+// QTNative_SelectBlendKernel
+// Use the specified kernel from now on.
+//
+//////////
+
+OSErr QTNative_SelectBlendKernel (short theKernel)
+{
+	if (!QTNative_IsBlendKernelAvailable(theKernel))
+		return(paramErr);
+
+	gNativeBlendKernel = theKernel;
+	gNativeCrossFadeRowProc = gNativeCrossFadeProcs[theKernel];
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetBlendKernel
+// Return the kernel currently in use.
+//
+//////////
+
+short QTNative_GetBlendKernel (void)
+{
+	if (gNativeCrossFadeRowProc == NULL)
+		QTNative_InitBlendKernels();
+
+	return(gNativeBlendKernel);
+}
+
+
+//////////
+//
+// QTNative_GetBlendKernelName
+// Return a printable name for the specified kernel.
+//
+//////////
+
+const char *QTNative_GetBlendKernelName (short theKernel)
+{
+	if ((theKernel < 0) || (theKernel >= kNativeNumKernels))
+		return("unknown");
+
+	return(gNativeKernelNames[theKernel]);
+}
+
+
+//////////
+//
+// QTNative_UseAVX2Kernels
+// Should the kernels that come only in scalar and AVX2 versions (such as the grain and convolution kernels)
+// use their AVX2 versions? We follow the choice of blending kernel, so that a benchmark that forces the scalar
+// blending kernel gets the other scalar kernels too.
+//
+//////////
+
+Boolean QTNative_UseAVX2Kernels (void)
+{
+#if NATIVE_HAS_AVX2
+	short		myKernel = QTNative_GetBlendKernel();
+
+	if ((myKernel == kNativeKernelAVX2) || (myKernel == kNativeKernelAVX512))
+		return((QTNative_GetCPUFeatures() & kNativeCPUHasAVX2) != 0);
+#endif
+
+	return(false);
+}
+
+
+//////////
+//
+// QTNative_CrossFadeRow32
+// Blend a row of 32-bit pixels, using the current kernel.
+//
+//////////
+
+void QTNative_CrossFadeRow32 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	if (gNativeCrossFadeRowProc == NULL)
+		QTNative_InitBlendKernels();
+
+	gNativeCrossFadeRowProc(theSrcA, theSrcB, theDest, theNumPixels, theAmount);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Cross fade kernels.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_CrossFadeRowScalar
+// Blend a row of 32-bit pixels, two channels at a time: each channel gets 16 bits of a 32-bit register,
+// which is enough to hold a * (256 - amount) + b * amount without carrying into the next channel.
+//
+//////////
+
+static void QTNative_CrossFadeRowScalar (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	unsigned int		myAmount = (unsigned int)theAmount;
+	unsigned int		myInverse = kNativeBlendMax - myAmount;
+	long				myIndex;
+
+	for (myIndex = 0; myIndex < theNumPixels; myIndex++) {
+		unsigned int		myA, myB, myRB, myAG;
+
+		memcpy(&myA, theSrcA + (myIndex * 4), 4);
+		memcpy(&myB, theSrcB + (myIndex * 4), 4);
+
+		myRB = ((((myA & 0x00FF00FF) * myInverse) + ((myB & 0x00FF00FF) * myAmount)) >> 8) & 0x00FF00FF;
+		myAG = ((((myA >> 8) & 0x00FF00FF) * myInverse) + (((myB >> 8) & 0x00FF00FF) * myAmount)) & 0xFF00FF00;
+		myA = myRB | myAG;
+
+		memcpy(theDest + (myIndex * 4), &myA, 4);
+	}
+}
+
+
+#if NATIVE_HAS_SSE2
+//////////
+//
+// QTNative_CrossFadeRowSSE2
+// Blend a row of 32-bit pixels, 4 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("sse2")
+static void QTNative_CrossFadeRowSSE2 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	__m128i				myZero = _mm_setzero_si128();
+	__m128i				myAmount = _mm_set1_epi16((short)theAmount);
+	__m128i				myInverse = _mm_set1_epi16((short)(kNativeBlendMax - theAmount));
+	long				myIndex;
+
+	for (myIndex = 0; myIndex + 4 <= theNumPixels; myIndex += 4) {
+		__m128i		myA = _mm_loadu_si128((const __m128i *)(theSrcA + (myIndex * 4)));
+		__m128i		myB = _mm_loadu_si128((const __m128i *)(theSrcB + (myIndex * 4)));
+		__m128i		myLo, myHi;
+
+		myLo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(myA, myZero), myInverse), _mm_mullo_epi16(_mm_unpacklo_epi8(myB, myZero), myAmount));
+		myHi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(myA, myZero), myInverse), _mm_mullo_epi16(_mm_unpackhi_epi8(myB, myZero), myAmount));
+
+		_mm_storeu_si128((__m128i *)(theDest + (myIndex * 4)), _mm_packus_epi16(_mm_srli_epi16(myLo, 8), _mm_srli_epi16(myHi, 8)));
+	}
+
+	if (myIndex < theNumPixels)
+		QTNative_CrossFadeRowScalar(theSrcA + (myIndex * 4), theSrcB + (myIndex * 4), theDest + (myIndex * 4), theNumPixels - myIndex, theAmount);
+}
+#endif	// NATIVE_HAS_SSE2
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_CrossFadeRowAVX2
+// Blend a row of 32-bit pixels, 8 pixels at a time. The unpack and pack instructions work within each 128-bit
+// lane, so the pixels come out of the pack in the same order they went into the unpack.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_CrossFadeRowAVX2 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	__m256i				myZero = _mm256_setzero_si256();
+	__m256i				myAmount = _mm256_set1_epi16((short)theAmount);
+	__m256i				myInverse = _mm256_set1_epi16((short)(kNativeBlendMax - theAmount));
+	long				myIndex;
+
+	for (myIndex = 0; myIndex + 8 <= theNumPixels; myIndex += 8) {
+		__m256i		myA = _mm256_loadu_si256((const __m256i *)(theSrcA + (myIndex * 4)));
+		__m256i		myB = _mm256_loadu_si256((const __m256i *)(theSrcB + (myIndex * 4)));
+		__m256i		myLo, myHi;
+
+		myLo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(myA, myZero), myInverse), _mm256_mullo_epi16(_mm256_unpacklo_epi8(myB, myZero), myAmount));
+		myHi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(myA, myZero), myInverse), _mm256_mullo_epi16(_mm256_unpackhi_epi8(myB, myZero), myAmount));
+
+		_mm256_storeu_si256((__m256i *)(theDest + (myIndex * 4)), _mm256_packus_epi16(_mm256_srli_epi16(myLo, 8), _mm256_srli_epi16(myHi, 8)));
+	}
+
+	if (myIndex < theNumPixels)
+		QTNative_CrossFadeRowScalar(theSrcA + (myIndex * 4), theSrcB + (myIndex * 4), theDest + (myIndex * 4), theNumPixels - myIndex, theAmount);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+#if NATIVE_HAS_AVX512
+//////////
+//
+// QTNative_CrossFadeRowAVX512
+// Blend a row of 32-bit pixels, 16 pixels at a time (this needs the byte and word instructions of AVX-512BW).
+//
+//////////
+
+NATIVE_TARGET("avx512f,avx512bw")
+static void QTNative_CrossFadeRowAVX512 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	__m512i				myZero = _mm512_setzero_si512();
+	__m512i				myAmount = _mm512_set1_epi16((short)theAmount);
+	__m512i				myInverse = _mm512_set1_epi16((short)(kNativeBlendMax - theAmount));
+	long				myIndex;
+
+	for (myIndex = 0; myIndex + 16 <= theNumPixels; myIndex += 16) {
+		__m512i		myA = _mm512_loadu_si512((const void *)(theSrcA + (myIndex * 4)));
+		__m512i		myB = _mm512_loadu_si512((const void *)(theSrcB + (myIndex * 4)));
+		__m512i		myLo, myHi;
+
+		myLo = _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpacklo_epi8(myA, myZero), myInverse), _mm512_mullo_epi16(_mm512_unpacklo_epi8(myB, myZero), myAmount));
+		myHi = _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpackhi_epi8(myA, myZero), myInverse), _mm512_mullo_epi16(_mm512_unpackhi_epi8(myB, myZero), myAmount));
+
+		_mm512_storeu_si512((void *)(theDest + (myIndex * 4)), _mm512_packus_epi16(_mm512_srli_epi16(myLo, 8), _mm512_srli_epi16(myHi, 8)));
+	}
+
+	if (myIndex < theNumPixels)
+		QTNative_CrossFadeRowScalar(theSrcA + (myIndex * 4), theSrcB + (myIndex * 4), theDest + (myIndex * 4), theNumPixels - myIndex, theAmount);
+}
+#endif	// NATIVE_HAS_AVX512
+
+
+#if NATIVE_CPU_NEON
+//////////
+//
+// QTNative_CrossFadeRowNEON
+// Blend a row of 32-bit pixels, 4 pixels at a time. NEON multiplies 8-bit lanes, so amounts of 0 and 256
+// (whose complements don't fit in a byte) are handled as plain copies.
+//
+//////////
+
+static void QTNative_CrossFadeRowNEON (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount)
+{
+	uint8x8_t			myAmount;
+	uint8x8_t			myInverse;
+	long				myIndex;
+
+	if ((theAmount <= 0) || (theAmount >= kNativeBlendMax)) {
+		memmove(theDest, (theAmount <= 0) ? theSrcA : theSrcB, theNumPixels * 4);
+		return;
+	}
+
+	myAmount = vdup_n_u8((unsigned char)theAmount);
+	myInverse = vdup_n_u8((unsigned char)(kNativeBlendMax - theAmount));
+
+	for (myIndex = 0; myIndex + 4 <= theNumPixels; myIndex += 4) {
+		uint8x16_t		myA = vld1q_u8(theSrcA + (myIndex * 4));
+		uint8x16_t		myB = vld1q_u8(theSrcB + (myIndex * 4));
+		uint16x8_t		myLo, myHi;
+
+		myLo = vmlal_u8(vmull_u8(vget_low_u8(myA), myInverse), vget_low_u8(myB), myAmount);
+		myHi = vmlal_u8(vmull_u8(vget_high_u8(myA), myInverse), vget_high_u8(myB), myAmount);
+
+		vst1q_u8(theDest + (myIndex * 4), vcombine_u8(vshrn_n_u16(myLo, 8), vshrn_n_u16(myHi, 8)));
+	}
+
+	if (myIndex < theNumPixels)
+		QTNative_CrossFadeRowScalar(theSrcA + (myIndex * 4), theSrcB + (myIndex * 4), theDest + (myIndex * 4), theNumPixels - myIndex, theAmount);
+}
+#endif	// NATIVE_CPU_NEON
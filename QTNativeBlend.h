@@ -0,0 +1,74 @@
+//////////
+//
+//	File:		QTNativeBlend.h
+//
+//	Contains:	Vectorized blending kernels for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeBlend__
+#define __QTNativeBlend__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the available implementations of the blending kernels
+enum {
+	kNativeKernelScalar				= 0,
+	kNativeKernelSSE2				= 1,
+	kNativeKernelAVX2				= 2,
+	kNativeKernelAVX512				= 3,
+	kNativeKernelNEON				= 4,
+	kNativeNumKernels				= 5
+};
+
+// the blend amount that selects the second source entirely
+#define kNativeBlendMax				256
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// blend theNumPixels 32-bit pixels of theSrcA and theSrcB into theDest: dest = (a * (256 - amount) + b * amount) / 256
+typedef void (*NativeBlendRowProcPtr) (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void						QTNative_InitBlendKernels (void);
+Boolean						QTNative_IsBlendKernelAvailable (short theKernel);
+OSErr						QTNative_SelectBlendKernel (short theKernel);
+short						QTNative_GetBlendKernel (void);
+const char *				QTNative_GetBlendKernelName (short theKernel);
+Boolean						QTNative_UseAVX2Kernels (void);
+
+void						QTNative_CrossFadeRow32 (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theNumPixels, long theAmount);
+
+#endif	// __QTNativeBlend__
@@ -0,0 +1,215 @@
+//////////
+//
+//	File:		QTNativeCPU.c
+//
+//	Contains:	Processor feature detection and timing for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The native renderer picks its inner loops at run time, according to the vector extensions that the
+//	processor (and the operating system) actually support. This file finds out what those are; it also
+//	provides a high-resolution wall clock for benchmarking and frame-rate reporting.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeCPU.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#if defined(_MSC_VER) && (_MSC_VER >= 1600)
+#include <intrin.h>
+#endif
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if NATIVE_CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#endif
+
+
+//////////
+//
+// compiler macros
+//
+//////////
+
+// can we execute CPUID and XGETBV?
+#if NATIVE_CPU_X86 && (defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && (_MSC_VER >= 1600)))
+#define NATIVE_HAS_CPUID			1
+#else
+#define NATIVE_HAS_CPUID			0
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static long					gNativeCPUFeatures = -1;		// the processor features, once we've found them
+
+
+#if NATIVE_HAS_CPUID
+//////////
+//
+// QTNative_CPUID
+// Execute the CPUID instruction for the specified leaf and subleaf.
+//
+//////////
+
+static void QTNative_CPUID (unsigned int theLeaf, unsigned int theSubLeaf, unsigned int theRegs[4])
+{
+#if defined(_MSC_VER)
+	int					myRegs[4];
+
+	__cpuidex(myRegs, (int)theLeaf, (int)theSubLeaf);
+	theRegs[0] = (unsigned int)myRegs[0];
+	theRegs[1] = (unsigned int)myRegs[1];
+	theRegs[2] = (unsigned int)myRegs[2];
+	theRegs[3] = (unsigned int)myRegs[3];
+#else
+	if (__get_cpuid_max(0, NULL) < theLeaf) {
+		theRegs[0] = theRegs[1] = theRegs[2] = theRegs[3] = 0;
+		return;
+	}
+
+	__cpuid_count(theLeaf, theSubLeaf, theRegs[0], theRegs[1], theRegs[2], theRegs[3]);
+#endif
+}
+
+
+//////////
+//
+// QTNative_GetEnabledRegisterState
+// Return the low word of XCR0, which tells us which register sets the operating system saves and restores.
+//
+//////////
+
+static unsigned int QTNative_GetEnabledRegisterState (void)
+{
+#if defined(_MSC_VER)
+	return((unsigned int)_xgetbv(0));
+#else
+	unsigned int		myLow, myHigh;
+
+	__asm__ __volatile__ ("xgetbv" : "=a" (myLow), "=d" (myHigh) : "c" (0));
+	return(myLow);
+#endif
+}
+#endif	// NATIVE_HAS_CPUID
+
+
+//////////
+//
+// QTNative_GetCPUFeatures
+// Return a set of kNativeCPUHas... flags that describe the vector extensions we can use.
+//
+// An extension counts only if both the processor and the operating system support it; for instance, AVX2
+// needs the OS to save the upper halves of the YMM registers, which we check with XGETBV.
+//
+//////////
+
+long QTNative_GetCPUFeatures (void)
+{
+	long				myFeatures = 0;
+
+	if (gNativeCPUFeatures >= 0)
+		return(gNativeCPUFeatures);
+
+#if NATIVE_HAS_CPUID
+	{
+		unsigned int		myRegs[4];
+		unsigned int		myXCR0 = 0;
+		Boolean				hasOSXSAVE;
+
+		QTNative_CPUID(1, 0, myRegs);
+		if (myRegs[3] & (1U << 26))
+			myFeatures |= kNativeCPUHasSSE2;
+
+		hasOSXSAVE = (myRegs[2] & (1U << 27)) != 0;
+		if (hasOSXSAVE)
+			myXCR0 = QTNative_GetEnabledRegisterState();
+
+		QTNative_CPUID(7, 0, myRegs);
+
+		// AVX2 needs XMM and YMM state (XCR0 bits 1 and 2)
+		if (hasOSXSAVE && ((myXCR0 & 0x06) == 0x06) && (myRegs[1] & (1U << 5)))
+			myFeatures |= kNativeCPUHasAVX2;
+
+		// AVX-512BW also needs the opmask and ZMM state (XCR0 bits 5, 6, and 7)
+		if (hasOSXSAVE && ((myXCR0 & 0xE6) == 0xE6) && (myRegs[1] & (1U << 16)) && (myRegs[1] & (1U << 30)))
+			myFeatures |= kNativeCPUHasAVX512BW;
+	}
+#endif
+
+#if NATIVE_CPU_NEON
+	// NEON is a required part of the architecture on the processors we build NEON code for
+	myFeatures |= kNativeCPUHasNEON;
+#endif
+
+	gNativeCPUFeatures = myFeatures;
+	return(myFeatures);
+}
+
+
+//////////
+//
+// QTNative_GetNumberOfCPUs
+// Return the number of processors available to this process.
+//
+//////////
+
+long QTNative_GetNumberOfCPUs (void)
+{
+	long				myCount = 1;
+
+#if defined(_WIN32)
+	SYSTEM_INFO			myInfo;
+
+	GetSystemInfo(&myInfo);
+	myCount = (long)myInfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	myCount = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	return((myCount < 1) ? 1 : myCount);
+}
+
+
+//////////
+//
+// QTNative_GetSeconds
+// Return the value of a monotonic wall clock, in seconds.
+//
+//////////
+
+double QTNative_GetSeconds (void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER		myFrequency;
+	LARGE_INTEGER		myCounter;
+
+	QueryPerformanceFrequency(&myFrequency);
+	QueryPerformanceCounter(&myCounter);
+
+	return((double)myCounter.QuadPart / (double)myFrequency.QuadPart);
+#else
+	struct timespec		myTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &myTime);
+
+	return((double)myTime.tv_sec + ((double)myTime.tv_nsec * 1.0e-9));
+#endif
+}
@@ -0,0 +1,98 @@
+//////////
+//
+//	File:		QTNativeCPU.h
+//
+//	Contains:	Processor feature detection and timing for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeCPU__
+#define __QTNativeCPU__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// compiler macros
+//
+//////////
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define NATIVE_CPU_X86				1
+#else
+#define NATIVE_CPU_X86				0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define NATIVE_CPU_NEON				1
+#else
+#define NATIVE_CPU_NEON				0
+#endif
+
+// can this compiler generate code for the various x86 vector extensions? (older compilers can't)
+#if NATIVE_CPU_X86 && (defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && (_MSC_VER >= 1300)))
+#define NATIVE_HAS_SSE2				1
+#else
+#define NATIVE_HAS_SSE2				0
+#endif
+
+#if NATIVE_CPU_X86 && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 5)) || (defined(_MSC_VER) && (_MSC_VER >= 1700)))
+#define NATIVE_HAS_AVX2				1
+#else
+#define NATIVE_HAS_AVX2				0
+#endif
+
+#if NATIVE_CPU_X86 && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 6)) || (defined(_MSC_VER) && (_MSC_VER >= 1911)))
+#define NATIVE_HAS_AVX512			1
+#else
+#define NATIVE_HAS_AVX512			0
+#endif
+
+// functions that use an instruction set extension are compiled for that extension only, so that the rest
+// of the file still runs on any processor; MSVC doesn't need (or allow) this
+#if defined(__GNUC__) || defined(__clang__)
+#define NATIVE_TARGET(x)			__attribute__((target(x)))
+#else
+#define NATIVE_TARGET(x)
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// processor features
+#define kNativeCPUHasSSE2			(1L << 0)
+#define kNativeCPUHasAVX2			(1L << 1)
+#define kNativeCPUHasAVX512BW		(1L << 2)
+#define kNativeCPUHasNEON			(1L << 3)
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+long						QTNative_GetCPUFeatures (void);
+long						QTNative_GetNumberOfCPUs (void);
+double						QTNative_GetSeconds (void);
+
+#endif	// __QTNativeCPU__
@@ -0,0 +1,704 @@
+//////////
+//
+//	File:		QTNativeConvert.c
+//
+//	Contains:	Conversion of whole pixel buffers between pixel formats, including Y'CbCr, optionally combined
+//				with scaling.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <2>	 	10/17/26	rtm		Y'CbCr buffers and the rows of each band come from the frame pool
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	Pixel buffers in the RGB formats (8-bit indexed, 16-bit, 24-bit, and 32-bit) are converted a row at a time
+//	by the span kernels in QTNativeFormats.c, which have AVX2 versions. The Y'CbCr formats don't fit in spans,
+//	since a chroma sample covers two pixels (4:2:2) or two pixels in each of two rows (4:2:0); so they're
+//	converted through rows of 0xAARRGGBB pixels in the host's 32-bit format, with QTNative_ReadHostRow and
+//	QTNative_WriteHostRows, which work on pairs of rows.
+//
+//	The conversions between 0xAARRGGBB and Y'CbCr use the integer approximations of BT.601 that are usual for
+//	8-bit video; each chroma sample is computed from the average of the pixels it covers, and is repeated for
+//	those pixels on the way back. The AVX2 versions of the row kernels (for the planar format) produce exactly
+//	the same bytes as the scalar versions.
+//
+//	QTNative_ConvertAndScalePixelBuffer converts and scales in one pass when the sizes differ: the resampler
+//	reads its source rows and writes its destination rows with QTNative_ReadHostRow and QTNative_WriteHostRows,
+//	so there's never an intermediate buffer at either end just for the change of format.
+//
+//	Both whole-buffer conversions split the buffer into bands of rows, which are converted in parallel on the
+//	worker threads.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeConvert.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeResample.h"
+#include "QTNativeThreads.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// compiler macros
+//
+//////////
+
+// the BT.601 conversions; the chroma of four pixels is computed from the sums of their channels
+#define NATIVE_RGB_TO_Y(r, g, b)			((((66 * (r)) + (129 * (g)) + (25 * (b)) + 128) >> 8) + 16)
+#define NATIVE_RGB4_TO_CB(r, g, b)			(((-38 * (r)) - (74 * (g)) + (112 * (b)) + (128 << 10) + 512) >> 10)
+#define NATIVE_RGB4_TO_CR(r, g, b)			(((112 * (r)) - (94 * (g)) - (18 * (b)) + (128 << 10) + 512) >> 10)
+
+// two 16-bit weights in one 32-bit lane, for vpmaddwd
+#define NATIVE_WEIGHT_PAIR(theLow, theHigh)	((int)((((unsigned int)(theHigh) & 0xFFFF) << 16) | ((unsigned int)(theLow) & 0xFFFF)))
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// convert a row of 0xAARRGGBB pixels to Y' samples theStep bytes apart
+typedef void (*NativeLumaRowProcPtr) (const unsigned int *theRow, unsigned char *theY, long theStep, long theCount);
+
+// convert two rows of 0xAARRGGBB pixels (which may be the same row) to Cb and Cr samples theStep bytes apart,
+// one for every two pixels
+typedef void (*NativeChromaRowProcPtr) (const unsigned int *theRow0, const unsigned int *theRow1, unsigned char *theCb, unsigned char *theCr, long theStep, long theCount);
+
+// convert a row of Y'CbCr samples to 0xAARRGGBB pixels
+typedef void (*NativeYCbCrRowProcPtr) (const unsigned char *theY, long theYStep, const unsigned char *theCb, const unsigned char *theCr, long theChromaStep, unsigned int *theRow, long theCount);
+
+// the row kernels to use
+typedef struct {
+	NativeLumaRowProcPtr		fToLuma;
+	NativeChromaRowProcPtr		fToChroma;
+	NativeYCbCrRowProcPtr		fFromYCbCr;
+} NativeYCbCrKernels;
+
+// a pixel buffer being converted on the worker threads
+typedef struct {
+	const NativePixelBuffer *	fSrc;
+	NativePixelBuffer *			fDest;
+	long						fBandHeight;				// always even, so that no band splits a pair of 4:2:0 rows
+} NativeConvertInfo;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static OSErr						QTNative_ConvertBand (void *theRefCon, long theIndex);
+static void							QTNative_ToLumaScalar (const unsigned int *theRow, unsigned char *theY, long theStep, long theCount);
+static void							QTNative_ToChromaScalar (const unsigned int *theRow0, const unsigned int *theRow1, unsigned char *theCb, unsigned char *theCr, long theStep, long theCount);
+static void							QTNative_FromYCbCrScalar (const unsigned char *theY, long theYStep, const unsigned char *theCb, const unsigned char *theCr, long theChromaStep, unsigned int *theRow, long theCount);
+#if NATIVE_HAS_AVX2
+static void							QTNative_ToLumaAVX2 (const unsigned int *theRow, unsigned char *theY, long theStep, long theCount);
+static void							QTNative_ToChromaAVX2 (const unsigned int *theRow0, const unsigned int *theRow1, unsigned char *theCb, unsigned char *theCr, long theStep, long theCount);
+static void							QTNative_FromYCbCrAVX2 (const unsigned char *theY, long theYStep, const unsigned char *theCb, const unsigned char *theCr, long theChromaStep, unsigned int *theRow, long theCount);
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static const NativeYCbCrKernels		gNativeYCbCrScalar = {
+	QTNative_ToLumaScalar,
+	QTNative_ToChromaScalar,
+	QTNative_FromYCbCrScalar
+};
+
+#if NATIVE_HAS_AVX2
+static const NativeYCbCrKernels		gNativeYCbCrAVX2 = {
+	QTNative_ToLumaAVX2,
+	QTNative_ToChromaAVX2,
+	QTNative_FromYCbCrAVX2
+};
+#endif
+
+
+//////////
+//
+// QTNative_GetYCbCrKernels
+// Return the row kernels to use.
+//
+//////////
+
+static const NativeYCbCrKernels *QTNative_GetYCbCrKernels (void)
+{
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		return(&gNativeYCbCrAVX2);
+#endif
+
+	return(&gNativeYCbCrScalar);
+}
+
+
+//////////
+//
+// QTNative_IsYUVPixelFormat
+// Is the specified pixel format one of the Y'CbCr formats?
+//
+//////////
+
+Boolean QTNative_IsYUVPixelFormat (OSType thePixelFormat)
+{
+	return((thePixelFormat == kNativePixelFormat_2vuy) || (thePixelFormat == kNativePixelFormat_YUV420));
+}
+
+
+//////////
+//
+// QTNative_CanConvertPixelFormat
+// Can pixel buffers in the specified pixel format be converted (and scaled) by the functions in this file?
+//
+//////////
+
+Boolean QTNative_CanConvertPixelFormat (OSType thePixelFormat)
+{
+	return((QTNative_GetBytesPerPixel(thePixelFormat) != 0) || QTNative_IsYUVPixelFormat(thePixelFormat));
+}
+
+
+//////////
+//
+// QTNative_NewYUVPixelBuffer
+// Allocate the pixels for a new pixel buffer of the specified size, in one of the Y'CbCr formats, and make
+// them all black.
+//
+// The caller is responsible for disposing of the pixels, by calling QTNative_DisposePixelBuffer.
+//
+//////////
+
+OSErr QTNative_NewYUVPixelBuffer (NativePixelBuffer *theBuffer, long theWidth, long theHeight, OSType thePixelFormat)
+{
+	long				myBytesPerPixel = (thePixelFormat == kNativePixelFormat_2vuy) ? 2 : 1;
+	long				myChromaSize = 0;
+	long				myIndex;
+
+	memset(theBuffer, 0, sizeof(NativePixelBuffer));
+
+	if (!QTNative_IsYUVPixelFormat(thePixelFormat) || (theWidth <= 0) || (theHeight <= 0))
+		return(paramErr);
+
+	theBuffer->fRowBytes = ((theWidth * myBytesPerPixel) + kNativeYUVRowAlignment - 1) & ~(kNativeYUVRowAlignment - 1);
+	if (thePixelFormat == kNativePixelFormat_YUV420)
+		myChromaSize = (theBuffer->fRowBytes / 2) * ((theHeight + 1) / 2);
+
+	theBuffer->fBaseAddr = (unsigned char *)QTNative_NewPoolBlock((theBuffer->fRowBytes * theHeight) + (2 * myChromaSize));
+	if (theBuffer->fBaseAddr == NULL)
+		return(memFullErr);
+
+	theBuffer->fWidth = theWidth;
+	theBuffer->fHeight = theHeight;
+	theBuffer->fPixelFormat = thePixelFormat;
+
+	// black is Y' 16, with no color (Cb and Cr 128)
+	if (thePixelFormat == kNativePixelFormat_YUV420) {
+		memset(theBuffer->fBaseAddr, 16, (size_t)(theBuffer->fRowBytes * theHeight));
+		memset(theBuffer->fBaseAddr + (theBuffer->fRowBytes * theHeight), 128, (size_t)(2 * myChromaSize));
+	} else {
+		for (myIndex = 0; myIndex < theBuffer->fRowBytes * theHeight; myIndex += 2) {
+			theBuffer->fBaseAddr[myIndex] = 128;
+			theBuffer->fBaseAddr[myIndex + 1] = 16;
+		}
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetChromaPlanes
+// Return the addresses of the Cb and Cr planes of a pixel buffer in kNativePixelFormat_YUV420, and the number of
+// bytes in each of their rows.
+//
+//////////
+
+void QTNative_GetChromaPlanes (const NativePixelBuffer *theBuffer, unsigned char **theCb, unsigned char **theCr, long *theRowBytes)
+{
+	*theRowBytes = theBuffer->fRowBytes / 2;
+	*theCb = theBuffer->fBaseAddr + (theBuffer->fRowBytes * theBuffer->fHeight);
+	*theCr = *theCb + (*theRowBytes * ((theBuffer->fHeight + 1) / 2));
+}
+
+
+//////////
+//
+// QTNative_ReadHostRow
+// Convert the specified row of a pixel buffer, in any format we can convert, to 0xAARRGGBB pixels in the host's
+// 32-bit format; theDest must have room for theSrc->fWidth pixels.
+//
+//////////
+
+OSErr QTNative_ReadHostRow (const NativePixelBuffer *theSrc, long theRow, unsigned int *theDest)
+{
+	const unsigned char		*myRow = QTNative_GetRowAddress(theSrc, theRow);
+	NativeSpanKernels		myToRow;
+
+	if ((theRow < 0) || (theRow >= theSrc->fHeight))
+		return(paramErr);
+
+	switch (theSrc->fPixelFormat) {
+		case kNativePixelFormat_YUV420: {
+			unsigned char		*myCb;
+			unsigned char		*myCr;
+			long				myChromaRowBytes;
+
+			QTNative_GetChromaPlanes(theSrc, &myCb, &myCr, &myChromaRowBytes);
+			QTNative_GetYCbCrKernels()->fFromYCbCr(myRow, 1, myCb + ((theRow >> 1) * myChromaRowBytes), myCr + ((theRow >> 1) * myChromaRowBytes), 1,
+													theDest, theSrc->fWidth);
+			break;
+		}
+
+		case kNativePixelFormat_2vuy:
+			QTNative_GetYCbCrKernels()->fFromYCbCr(myRow + 1, 2, myRow, myRow + 2, 4, theDest, theSrc->fWidth);
+			break;
+
+		default:
+			if (!QTNative_GetSpanKernels(theSrc->fPixelFormat, QTNative_GetHostPixelFormat(), &myToRow))
+				return(paramErr);
+
+			myToRow.fConvert(myRow, (unsigned char *)theDest, theSrc->fWidth, theSrc->fColorTable);
+			break;
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_WriteHostRows
+// Convert one or two rows of 0xAARRGGBB pixels in the host's 32-bit format to the specified row of a pixel
+// buffer and (if theRow1 isn't NULL) the row below it.
+//
+// The rows of a 4:2:0 buffer share their chroma in pairs, so they must be written in pairs, starting with an
+// even row; only the last row of a buffer with an odd number of rows is written by itself.
+//
+//////////
+
+OSErr QTNative_WriteHostRows (NativePixelBuffer *theDest, long theRow, const unsigned int *theRow0, const unsigned int *theRow1)
+{
+	const NativeYCbCrKernels	*myKernels = QTNative_GetYCbCrKernels();
+	unsigned char				*myRow = QTNative_GetRowAddress(theDest, theRow);
+	NativeSpanKernels			myFromRow;
+
+	if ((theRow < 0) || (theRow >= theDest->fHeight) || ((theRow1 != NULL) && (theRow + 1 >= theDest->fHeight)))
+		return(paramErr);
+
+	switch (theDest->fPixelFormat) {
+		case kNativePixelFormat_YUV420: {
+			unsigned char		*myCb;
+			unsigned char		*myCr;
+			long				myChromaRowBytes;
+
+			if (((theRow & 1) != 0) || ((theRow1 == NULL) && (theRow + 1 < theDest->fHeight)))
+				return(paramErr);
+
+			QTNative_GetChromaPlanes(theDest, &myCb, &myCr, &myChromaRowBytes);
+			myCb += (theRow >> 1) * myChromaRowBytes;
+			myCr += (theRow >> 1) * myChromaRowBytes;
+
+			myKernels->fToLuma(theRow0, myRow, 1, theDest->fWidth);
+			if (theRow1 != NULL)
+				myKernels->fToLuma(theRow1, myRow + theDest->fRowBytes, 1, theDest->fWidth);
+
+			myKernels->fToChroma(theRow0, (theRow1 != NULL) ? theRow1 : theRow0, myCb, myCr, 1, theDest->fWidth);
+			break;
+		}
+
+		case kNativePixelFormat_2vuy:
+			myKernels->fToLuma(theRow0, myRow + 1, 2, theDest->fWidth);
+			myKernels->fToChroma(theRow0, theRow0, myRow, myRow + 2, 4, theDest->fWidth);
+
+			if (theRow1 != NULL) {
+				myRow += theDest->fRowBytes;
+				myKernels->fToLuma(theRow1, myRow + 1, 2, theDest->fWidth);
+				myKernels->fToChroma(theRow1, theRow1, myRow, myRow + 2, 4, theDest->fWidth);
+			}
+			break;
+
+		default:
+			if (!QTNative_GetSpanKernels(QTNative_GetHostPixelFormat(), theDest->fPixelFormat, &myFromRow))
+				return(paramErr);
+
+			myFromRow.fConvert((const unsigned char *)theRow0, myRow, theDest->fWidth, NULL);
+			if (theRow1 != NULL)
+				myFromRow.fConvert((const unsigned char *)theRow1, myRow + theDest->fRowBytes, theDest->fWidth, NULL);
+			break;
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ConvertPixelBuffer
+// Copy the pixels of one pixel buffer into another pixel buffer of the same size, converting them to the pixel
+// format of the destination (which can be any format we can convert, except 8-bit indexed).
+//
+//////////
+
+OSErr QTNative_ConvertPixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest)
+{
+	NativeConvertInfo			myInfo;
+
+	if ((theSrc == NULL) || (theSrc->fBaseAddr == NULL) || (theDest == NULL) || (theDest->fBaseAddr == NULL))
+		return(paramErr);
+
+	if ((theSrc->fWidth != theDest->fWidth) || (theSrc->fHeight != theDest->fHeight) || (theDest->fWidth <= 0) || (theDest->fHeight <= 0))
+		return(paramErr);
+
+	if (!QTNative_CanConvertPixelFormat(theSrc->fPixelFormat) || !QTNative_CanConvertPixelFormat(theDest->fPixelFormat))
+		return(paramErr);
+
+	if (theDest->fPixelFormat == kNativePixelFormat_8Indexed)
+		return(paramErr);
+
+	myInfo.fSrc = theSrc;
+	myInfo.fDest = theDest;
+	myInfo.fBandHeight = (QTNative_GetBandHeight(theDest) + 1) & ~1L;
+
+	return(QTNative_ParallelFor((theDest->fHeight + myInfo.fBandHeight - 1) / myInfo.fBandHeight, QTNative_ConvertBand, &myInfo));
+}
+
+
+//////////
+//
+// QTNative_ConvertAndScalePixelBuffer
+// Convert the pixels of one pixel buffer to the pixel format of another, and scale them to fill it, using the
+// specified resampling filter; if the buffers are the same size, just convert the pixels.
+//
+//////////
+
+OSErr QTNative_ConvertAndScalePixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest, short theFilter)
+{
+	if ((theSrc == NULL) || (theDest == NULL))
+		return(paramErr);
+
+	if ((theSrc->fWidth == theDest->fWidth) && (theSrc->fHeight == theDest->fHeight))
+		return(QTNative_ConvertPixelBuffer(theSrc, theDest));
+
+	return(QTNative_ResamplePixelBuffer(theSrc, theDest, theFilter));
+}
+
+
+//////////
+//
+// QTNative_ConvertBand
+// Convert one band of rows; this is called on a worker thread by QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_ConvertBand (void *theRefCon, long theIndex)
+{
+	const NativeConvertInfo		*myInfo = (const NativeConvertInfo *)theRefCon;
+	const NativePixelBuffer		*mySrc = myInfo->fSrc;
+	NativePixelBuffer			*myDest = myInfo->fDest;
+	NativeSpanKernels			myKernels;
+	unsigned int				*myRows = NULL;
+	long						myFirstRow = theIndex * myInfo->fBandHeight;
+	long						myLastRow = myFirstRow + myInfo->fBandHeight;
+	long						myY;
+	OSErr						myErr = noErr;
+
+	if (myLastRow > myDest->fHeight)
+		myLastRow = myDest->fHeight;
+
+	// between RGB formats, convert straight from one to the other
+	if (!QTNative_IsYUVPixelFormat(mySrc->fPixelFormat) && !QTNative_IsYUVPixelFormat(myDest->fPixelFormat)) {
+		if (!QTNative_GetSpanKernels(mySrc->fPixelFormat, myDest->fPixelFormat, &myKernels))
+			return(paramErr);
+
+		for (myY = myFirstRow; myY < myLastRow; myY++)
+			myKernels.fConvert(QTNative_GetRowAddress(mySrc, myY), QTNative_GetRowAddress(myDest, myY), myDest->fWidth, mySrc->fColorTable);
+
+		return(noErr);
+	}
+
+	// otherwise, go through pairs of rows in the host's format
+	myRows = (unsigned int *)QTNative_NewPoolBlock(myDest->fWidth * 2 * sizeof(unsigned int));
+	if (myRows == NULL)
+		return(memFullErr);
+
+	for (myY = myFirstRow; (myY < myLastRow) && (myErr == noErr); myY += 2) {
+		Boolean					myHasPair = (myY + 1 < myLastRow);
+
+		myErr = QTNative_ReadHostRow(mySrc, myY, myRows);
+		if ((myErr == noErr) && myHasPair)
+			myErr = QTNative_ReadHostRow(mySrc, myY + 1, myRows + myDest->fWidth);
+		if (myErr == noErr)
+			myErr = QTNative_WriteHostRows(myDest, myY, myRows, myHasPair ? myRows + myDest->fWidth : NULL);
+	}
+
+	QTNative_DisposePoolBlock(myRows);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_ToLumaScalar
+// Convert a row of 0xAARRGGBB pixels to Y' samples.
+//
+//////////
+
+static void QTNative_ToLumaScalar (const unsigned int *theRow, unsigned char *theY, long theStep, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++) {
+		unsigned int	myPixel = theRow[myX];
+
+		theY[myX * theStep] = (unsigned char)NATIVE_RGB_TO_Y((int)((myPixel >> 16) & 0xFF), (int)((myPixel >> 8) & 0xFF), (int)(myPixel & 0xFF));
+	}
+}
+
+
+//////////
+//
+// QTNative_ToChromaScalar
+// Convert two rows of 0xAARRGGBB pixels to one row of Cb and Cr samples, each of which covers two pixels in
+// each row; the last sample of a row with an odd number of pixels covers the last pixel twice.
+//
+//////////
+
+static void QTNative_ToChromaScalar (const unsigned int *theRow0, const unsigned int *theRow1, unsigned char *theCb, unsigned char *theCr, long theStep, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX += 2) {
+		long			myNext = (myX + 1 < theCount) ? myX + 1 : myX;
+		unsigned int	myPixels[4];
+		int				myRed = 0;
+		int				myGreen = 0;
+		int				myBlue = 0;
+		short			myIndex;
+
+		myPixels[0] = theRow0[myX];
+		myPixels[1] = theRow0[myNext];
+		myPixels[2] = theRow1[myX];
+		myPixels[3] = theRow1[myNext];
+
+		for (myIndex = 0; myIndex < 4; myIndex++) {
+			myRed += (int)((myPixels[myIndex] >> 16) & 0xFF);
+			myGreen += (int)((myPixels[myIndex] >> 8) & 0xFF);
+			myBlue += (int)(myPixels[myIndex] & 0xFF);
+		}
+
+		theCb[(myX >> 1) * theStep] = (unsigned char)NATIVE_RGB4_TO_CB(myRed, myGreen, myBlue);
+		theCr[(myX >> 1) * theStep] = (unsigned char)NATIVE_RGB4_TO_CR(myRed, myGreen, myBlue);
+	}
+}
+
+
+//////////
+//
+// QTNative_FromYCbCrScalar
+// Convert a row of Y'CbCr samples to 0xAARRGGBB pixels; each Cb and Cr sample is used for two pixels.
+//
+//////////
+
+static void QTNative_FromYCbCrScalar (const unsigned char *theY, long theYStep, const unsigned char *theCb, const unsigned char *theCr, long theChromaStep, unsigned int *theRow, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++) {
+		int				myLuma = 298 * ((int)theY[myX * theYStep] - 16);
+		int				myCb = (int)theCb[(myX >> 1) * theChromaStep] - 128;
+		int				myCr = (int)theCr[(myX >> 1) * theChromaStep] - 128;
+		int				myRed = (myLuma + (409 * myCr) + 128) >> 8;
+		int				myGreen = (myLuma - (100 * myCb) - (208 * myCr) + 128) >> 8;
+		int				myBlue = (myLuma + (516 * myCb) + 128) >> 8;
+
+		myRed = (myRed < 0) ? 0 : ((myRed > 255) ? 255 : myRed);
+		myGreen = (myGreen < 0) ? 0 : ((myGreen > 255) ? 255 : myGreen);
+		myBlue = (myBlue < 0) ? 0 : ((myBlue > 255) ? 255 : myBlue);
+
+		theRow[myX] = (unsigned int)kNativeOpaqueBlackPixel | ((unsigned int)myRed << 16) | ((unsigned int)myGreen << 8) | (unsigned int)myBlue;
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_VectorLuma
+// Return the Y' samples of 8 0xAARRGGBB pixels, in the lanes of a vector. Each pixel is split into its blue and red
+// bytes and its green and alpha bytes, as 16-bit values, so that vpmaddwd can weigh two channels at once.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorLuma (__m256i thePixels)
+{
+	__m256i				myMask = _mm256_set1_epi32(0x00FF00FF);
+	__m256i				myBlueRed = _mm256_and_si256(thePixels, myMask);
+	__m256i				myGreenAlpha = _mm256_and_si256(_mm256_srli_epi32(thePixels, 8), myMask);
+	__m256i				mySum = _mm256_add_epi32(_mm256_madd_epi16(myBlueRed, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(25, 66))),
+												 _mm256_madd_epi16(myGreenAlpha, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(129, 0))));
+
+	return(_mm256_add_epi32(_mm256_srli_epi32(_mm256_add_epi32(mySum, _mm256_set1_epi32(128)), 8), _mm256_set1_epi32(16)));
+}
+
+
+//////////
+//
+// QTNative_ToLumaAVX2
+// Do what QTNative_ToLumaScalar does, for 16 pixels at a time, when the samples are next to each other.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ToLumaAVX2 (const unsigned int *theRow, unsigned char *theY, long theStep, long theCount)
+{
+	long				myX = 0;
+
+	if (theStep == 1) {
+		for (; myX + 16 <= theCount; myX += 16) {
+			__m256i		myLuma0 = QTNative_VectorLuma(_mm256_loadu_si256((const __m256i *)(theRow + myX)));
+			__m256i		myLuma1 = QTNative_VectorLuma(_mm256_loadu_si256((const __m256i *)(theRow + myX + 8)));
+			__m256i		myWords = _mm256_permute4x64_epi64(_mm256_packus_epi32(myLuma0, myLuma1), _MM_SHUFFLE(3, 1, 2, 0));
+			__m256i		myBytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(myWords, myWords), _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm_storeu_si128((__m128i *)(theY + myX), _mm256_castsi256_si128(myBytes));
+		}
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theCount)
+		QTNative_ToLumaScalar(theRow + myX, theY + (myX * theStep), theStep, theCount - myX);
+}
+
+
+//////////
+//
+// QTNative_ToChromaAVX2
+// Do what QTNative_ToChromaScalar does, for 16 pixels (8 chroma samples) at a time, when the samples are next to
+// each other. The two rows are added channel by channel, and then neighboring pixels are added with vphaddd
+// (which works on whole lanes, but the 16-bit channel sums are too small to carry into each other).
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ToChromaAVX2 (const unsigned int *theRow0, const unsigned int *theRow1, unsigned char *theCb, unsigned char *theCr, long theStep, long theCount)
+{
+	__m256i				myMask = _mm256_set1_epi32(0x00FF00FF);
+	__m256i				myOrder = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+	__m256i				myRound = _mm256_set1_epi32((128 << 10) + 512);
+	long				myX = 0;
+
+	if (theStep == 1) {
+		for (; myX + 16 <= theCount; myX += 16) {
+			__m256i		myA0 = _mm256_loadu_si256((const __m256i *)(theRow0 + myX));
+			__m256i		myA1 = _mm256_loadu_si256((const __m256i *)(theRow0 + myX + 8));
+			__m256i		myB0 = _mm256_loadu_si256((const __m256i *)(theRow1 + myX));
+			__m256i		myB1 = _mm256_loadu_si256((const __m256i *)(theRow1 + myX + 8));
+			__m256i		myBlueRed0 = _mm256_add_epi16(_mm256_and_si256(myA0, myMask), _mm256_and_si256(myB0, myMask));
+			__m256i		myBlueRed1 = _mm256_add_epi16(_mm256_and_si256(myA1, myMask), _mm256_and_si256(myB1, myMask));
+			__m256i		myGreen0 = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi32(myA0, 8), myMask), _mm256_and_si256(_mm256_srli_epi32(myB0, 8), myMask));
+			__m256i		myGreen1 = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi32(myA1, 8), myMask), _mm256_and_si256(_mm256_srli_epi32(myB1, 8), myMask));
+			__m256i		myBlueRed = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(myBlueRed0, myBlueRed1), myOrder);
+			__m256i		myGreen = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(myGreen0, myGreen1), myOrder);
+			__m256i		myCb = _mm256_add_epi32(_mm256_madd_epi16(myBlueRed, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(112, -38))),
+												_mm256_madd_epi16(myGreen, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(-74, 0))));
+			__m256i		myCr = _mm256_add_epi32(_mm256_madd_epi16(myBlueRed, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(-18, 112))),
+												_mm256_madd_epi16(myGreen, _mm256_set1_epi32(NATIVE_WEIGHT_PAIR(-94, 0))));
+			__m256i		myWords;
+			__m256i		myBytes;
+
+			myCb = _mm256_srli_epi32(_mm256_add_epi32(myCb, myRound), 10);
+			myCr = _mm256_srli_epi32(_mm256_add_epi32(myCr, myRound), 10);
+
+			// pack the samples into bytes: Cb 0-7, then Cr 0-7
+			myWords = _mm256_packus_epi32(myCb, myCr);
+			myBytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(myWords, myWords), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+			_mm_storel_epi64((__m128i *)(theCb + (myX >> 1)), _mm256_castsi256_si128(myBytes));
+			_mm_storel_epi64((__m128i *)(theCr + (myX >> 1)), _mm_srli_si128(_mm256_castsi256_si128(myBytes), 8));
+		}
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theCount)
+		QTNative_ToChromaScalar(theRow0 + myX, theRow1 + myX, theCb + ((myX >> 1) * theStep), theCr + ((myX >> 1) * theStep), theStep, theCount - myX);
+}
+
+
+//////////
+//
+// QTNative_FromYCbCrAVX2
+// Do what QTNative_FromYCbCrScalar does, for 8 pixels at a time, when the samples are next to each other.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_FromYCbCrAVX2 (const unsigned char *theY, long theYStep, const unsigned char *theCb, const unsigned char *theCr, long theChromaStep, unsigned int *theRow, long theCount)
+{
+	__m256i				myDouble = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	__m256i				myZero = _mm256_setzero_si256();
+	__m256i				myMax = _mm256_set1_epi32(255);
+	__m256i				myRound = _mm256_set1_epi32(128);
+	long				myX = 0;
+
+	if ((theYStep == 1) && (theChromaStep == 1)) {
+		for (; myX + 8 <= theCount; myX += 8) {
+			int			myCbBytes;
+			int			myCrBytes;
+			__m256i		myLuma;
+			__m256i		myCb;
+			__m256i		myCr;
+			__m256i		myRed;
+			__m256i		myGreen;
+			__m256i		myBlue;
+
+			memcpy(&myCbBytes, theCb + (myX >> 1), 4);
+			memcpy(&myCrBytes, theCr + (myX >> 1), 4);
+
+			myLuma = _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(theY + myX))), _mm256_set1_epi32(16)), _mm256_set1_epi32(298));
+			myCb = _mm256_sub_epi32(_mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(_mm_cvtsi32_si128(myCbBytes)), myDouble), myRound);
+			myCr = _mm256_sub_epi32(_mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(_mm_cvtsi32_si128(myCrBytes)), myDouble), myRound);
+
+			myRed = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(myLuma, _mm256_mullo_epi32(myCr, _mm256_set1_epi32(409))), myRound), 8);
+			myGreen = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(_mm256_sub_epi32(myLuma, _mm256_mullo_epi32(myCb, _mm256_set1_epi32(100))),
+																		  _mm256_mullo_epi32(myCr, _mm256_set1_epi32(208))), myRound), 8);
+			myBlue = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(myLuma, _mm256_mullo_epi32(myCb, _mm256_set1_epi32(516))), myRound), 8);
+
+			myRed = _mm256_min_epi32(_mm256_max_epi32(myRed, myZero), myMax);
+			myGreen = _mm256_min_epi32(_mm256_max_epi32(myGreen, myZero), myMax);
+			myBlue = _mm256_min_epi32(_mm256_max_epi32(myBlue, myZero), myMax);
+
+			_mm256_storeu_si256((__m256i *)(theRow + myX), _mm256_or_si256(_mm256_or_si256(myBlue, _mm256_slli_epi32(myGreen, 8)),
+																		   _mm256_or_si256(_mm256_slli_epi32(myRed, 16), _mm256_set1_epi32((int)kNativeOpaqueBlackPixel))));
+		}
+	}
+
+	// finish the row with the scalar kernel (myX is even, so the chroma samples line up)
+	if (myX < theCount)
+		QTNative_FromYCbCrScalar(theY + (myX * theYStep), theYStep, theCb + ((myX >> 1) * theChromaStep), theCr + ((myX >> 1) * theChromaStep), theChromaStep,
+								 theRow + myX, theCount - myX);
+}
+#endif	// NATIVE_HAS_AVX2
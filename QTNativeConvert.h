@@ -0,0 +1,64 @@
+//////////
+//
+//	File:		QTNativeConvert.h
+//
+//	Contains:	Conversion of whole pixel buffers between pixel formats, including Y'CbCr, optionally combined
+//				with scaling.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A pixel buffer in kNativePixelFormat_YUV420 holds three planes, one after another, starting at fBaseAddr:
+//	the Y' plane (fWidth x fHeight bytes, with fRowBytes bytes per row), then the Cb plane, then the Cr plane
+//	(each half the width and half the height of the Y' plane, rounded up, with fRowBytes / 2 bytes per row).
+//	A buffer in kNativePixelFormat_2vuy has one plane, with 2 bytes per pixel. Both use the video range of
+//	ITU-R BT.601 (Y' from 16 to 235), as QuickTime does.
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeConvert__
+#define __QTNativeConvert__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the alignment of the rows of the Y' plane of a buffer allocated by QTNative_NewYUVPixelBuffer (so that the rows
+// of the chroma planes are aligned to half that)
+#define kNativeYUVRowAlignment				32
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+Boolean						QTNative_IsYUVPixelFormat (OSType thePixelFormat);
+Boolean						QTNative_CanConvertPixelFormat (OSType thePixelFormat);
+OSErr						QTNative_NewYUVPixelBuffer (NativePixelBuffer *theBuffer, long theWidth, long theHeight, OSType thePixelFormat);
+void						QTNative_GetChromaPlanes (const NativePixelBuffer *theBuffer, unsigned char **theCb, unsigned char **theCr, long *theRowBytes);
+
+OSErr						QTNative_ReadHostRow (const NativePixelBuffer *theSrc, long theRow, unsigned int *theDest);
+OSErr						QTNative_WriteHostRows (NativePixelBuffer *theDest, long theRow, const unsigned int *theRow0, const unsigned int *theRow1);
+
+OSErr						QTNative_ConvertPixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest);
+OSErr						QTNative_ConvertAndScalePixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest, short theFilter);
+
+#endif	// __QTNativeConvert__
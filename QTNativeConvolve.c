@@ -0,0 +1,1133 @@
+//////////
+//
+//	File:		QTNativeConvolve.c
+//
+//	Contains:	A separable convolution engine, and the native blur, sharpen, emboss, edge detection, and
+//				general convolution filters built on it.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <3>	 	10/17/26	rtm		QTNative_GetConvolveHalo clamps the blur radius and number of passes as the filters do (see
+//									QTNative_GetBlurSettings), so a band is always given all the rows it reads
+//	   <2>	 	10/17/26	rtm		the scratch rows of each band come from the frame pool
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A 2D convolution with an n x n kernel costs n * n multiplications per channel, so doubling the radius of a
+//	blur makes it four times slower. This file avoids that in two ways:
+//
+//	- A kernel that can be written as a column of taps times a row of taps (a separable kernel) is applied as
+//	  a pass along each row followed by a pass down each column, which costs 2n instead of n * n. Kernels that
+//	  aren't separable are written as the sum of a few separable terms; any 3x3 kernel is the sum of 3.
+//
+//	- A blur is done with box filters, using running sums: each output pixel is the previous one, plus the pixel
+//	  entering the box, minus the pixel leaving it, so the cost per pixel doesn't depend on the radius at all.
+//	  Three box blurs in a row look almost exactly like a Gaussian blur.
+//
+//	The column passes work on whole rows at once, so they vectorize naturally; there are AVX2 versions of all
+//	the passes, which produce exactly the same pixels as the scalar versions (all the arithmetic is integer).
+//
+//	Like the other native effects, these filters render a band of rows at a time. A band needs some rows
+//	above and below it (its "halo"), which are read from the source, so the bands are still independent of
+//	each other; QTNative_GetConvolveHalo tells QTNative_RenderEffect how many, so that it can make the bands
+//	tall enough that the halo doesn't dominate. Pixels beyond the edges of the frame are taken to be copies
+//	of the nearest edge pixel.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeConvolve.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// box filter sums are scaled by 2^kNativeBoxShift / (2 * radius + 1); with this shift, the product of a sum and
+// its scale always fits in 32 bits
+#define kNativeBoxShift					23
+
+// the largest magnitude a kernel's sums can reach without overflowing an int
+#define kNativeMaxKernelSum				2147483647.0
+
+#define kNativeEmbossBias				128
+#define kNativeEdgeShift				1
+
+
+//////////
+//
+// data types
+//
+//////////
+
+typedef void (*NativeBoxRowPassProcPtr) (const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theRadius);
+typedef void (*NativeBoxColumnPassProcPtr) (const unsigned char *theSrc, unsigned char *theDest, long theNumRows, long theRowBytes, long theCount, long theRadius, unsigned int *theSums);
+typedef void (*NativeKernelRowPassProcPtr) (const unsigned int *theSrc, int *theDest, long theWidth, const int *theTaps, long theRadius);
+typedef void (*NativeKernelColumnPassProcPtr) (const int *theSrc, long theStride, int *theDest, long theCount, const int *theTaps, long theRadius, Boolean theAbsolute);
+typedef void (*NativeKernelFinishProcPtr) (const int *theSums, const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theShift, long theBias);
+
+// the pass kernels to use
+typedef struct {
+	NativeBoxRowPassProcPtr			fBoxRowPass;
+	NativeBoxColumnPassProcPtr		fBoxColumnPass;
+	NativeKernelRowPassProcPtr		fKernelRowPass;
+	NativeKernelColumnPassProcPtr	fKernelColumnPass;
+	NativeKernelFinishProcPtr		fKernelFinish;
+} NativeConvolveKernels;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static void							QTNative_BoxRowPassScalar (const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theRadius);
+static void							QTNative_BoxColumnPassScalar (const unsigned char *theSrc, unsigned char *theDest, long theNumRows, long theRowBytes, long theCount, long theRadius, unsigned int *theSums);
+static void							QTNative_KernelRowPassScalar (const unsigned int *theSrc, int *theDest, long theWidth, const int *theTaps, long theRadius);
+static void							QTNative_KernelColumnPassScalar (const int *theSrc, long theStride, int *theDest, long theCount, const int *theTaps, long theRadius, Boolean theAbsolute);
+static void							QTNative_KernelFinishScalar (const int *theSums, const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theShift, long theBias);
+#if NATIVE_HAS_AVX2
+static void							QTNative_BoxRowPassAVX2 (const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theRadius);
+static void							QTNative_BoxColumnPassAVX2 (const unsigned char *theSrc, unsigned char *theDest, long theNumRows, long theRowBytes, long theCount, long theRadius, unsigned int *theSums);
+static void							QTNative_KernelRowPassAVX2 (const unsigned int *theSrc, int *theDest, long theWidth, const int *theTaps, long theRadius);
+static void							QTNative_KernelColumnPassAVX2 (const int *theSrc, long theStride, int *theDest, long theCount, const int *theTaps, long theRadius, Boolean theAbsolute);
+static void							QTNative_KernelFinishAVX2 (const int *theSums, const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theShift, long theBias);
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static const NativeConvolveKernels	gNativeConvolveScalar = {
+	QTNative_BoxRowPassScalar,
+	QTNative_BoxColumnPassScalar,
+	QTNative_KernelRowPassScalar,
+	QTNative_KernelColumnPassScalar,
+	QTNative_KernelFinishScalar
+};
+
+#if NATIVE_HAS_AVX2
+static const NativeConvolveKernels	gNativeConvolveAVX2 = {
+	QTNative_BoxRowPassAVX2,
+	QTNative_BoxColumnPassAVX2,
+	QTNative_KernelRowPassAVX2,
+	QTNative_KernelColumnPassAVX2,
+	QTNative_KernelFinishAVX2
+};
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetConvolveKernels
+// Return the pass kernels to use.
+//
+//////////
+
+static const NativeConvolveKernels *QTNative_GetConvolveKernels (void)
+{
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		return(&gNativeConvolveAVX2);
+#endif
+
+	return(&gNativeConvolveScalar);
+}
+
+
+//////////
+//
+// QTNative_GetBoxScale
+// Return the number that a box filter's sums are multiplied by (before shifting them right by kNativeBoxShift)
+// to divide them by the width of the box.
+//
+//////////
+
+static unsigned int QTNative_GetBoxScale (long theRadius)
+{
+	unsigned long		myWidth = (2 * theRadius) + 1;
+
+	return((unsigned int)(((1UL << kNativeBoxShift) + (myWidth / 2)) / myWidth));
+}
+
+
+//////////
+//
+// QTNative_LoadPaddedRow
+// Read a row of the source as 0xAARRGGBB values into theRow, with thePad copies of the first and last pixels
+// on either side. Rows above and below the frame are replaced by the nearest row in the frame.
+//
+//////////
+
+static void QTNative_LoadPaddedRow (const NativePixelBuffer *theSrc, NativeConvertSpanProcPtr theConvert, long theWidth, long theHeight, long theRow, long thePad, unsigned int *theDest)
+{
+	long			myIndex;
+
+	if (theRow < 0)
+		theRow = 0;
+	if (theRow > theHeight - 1)
+		theRow = theHeight - 1;
+
+	theConvert(QTNative_GetRowAddress(theSrc, theRow), (unsigned char *)(theDest + thePad), theWidth, theSrc->fColorTable);
+
+	for (myIndex = 0; myIndex < thePad; myIndex++) {
+		theDest[myIndex] = theDest[thePad];
+		theDest[thePad + theWidth + myIndex] = theDest[thePad + theWidth - 1];
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Scalar pass kernels.
+//
+// The box kernels treat a pixel as four independent bytes; the other kernels work on rows of ints that hold
+// one channel each, in the order of the bytes of the pixels in memory.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_BoxRowPassScalar
+// Box filter a row of pixels horizontally; theSrc holds theRadius extra pixels on either side.
+//
+//////////
+
+static void QTNative_BoxRowPassScalar (const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theRadius)
+{
+	const unsigned char		*mySrc = (const unsigned char *)theSrc;
+	unsigned char			*myDest = (unsigned char *)theDest;
+	unsigned int			myScale = QTNative_GetBoxScale(theRadius);
+	unsigned int			mySums[4] = {0, 0, 0, 0};
+	long					myBoxBytes = ((2 * theRadius) + 1) * 4;
+	long					myX;
+	short					myChannel;
+
+	for (myX = 0; myX < myBoxBytes; myX++)
+		mySums[myX & 3] += mySrc[myX];
+
+	for (myX = 0; myX < theWidth; myX++) {
+		for (myChannel = 0; myChannel < 4; myChannel++) {
+			myDest[(myX * 4) + myChannel] = (unsigned char)(((mySums[myChannel] * myScale) + (1U << (kNativeBoxShift - 1))) >> kNativeBoxShift);
+
+			if (myX + 1 < theWidth)
+				mySums[myChannel] += mySrc[(myX * 4) + myBoxBytes + myChannel] - mySrc[(myX * 4) + myChannel];
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_BoxColumnPassScalar
+// Box filter theNumRows rows of pixels vertically; theSrc holds theRadius extra rows above and below them.
+// The rows are theRowBytes apart, and theCount channels of each are filtered; theSums must have room for
+// theCount sums.
+//
+//////////
+
+static void QTNative_BoxColumnPassScalar (const unsigned char *theSrc, unsigned char *theDest, long theNumRows, long theRowBytes, long theCount, long theRadius, unsigned int *theSums)
+{
+	unsigned int			myScale = QTNative_GetBoxScale(theRadius);
+	long					myBoxRows = (2 * theRadius) + 1;
+	long					myIndex, myRow;
+
+	memset(theSums, 0, theCount * sizeof(unsigned int));
+	for (myRow = 0; myRow < myBoxRows; myRow++)
+		for (myIndex = 0; myIndex < theCount; myIndex++)
+			theSums[myIndex] += theSrc[(myRow * theRowBytes) + myIndex];
+
+	for (myRow = 0; myRow < theNumRows; myRow++) {
+		const unsigned char	*myLeaving = theSrc + (myRow * theRowBytes);
+		const unsigned char	*myEntering = myLeaving + (myBoxRows * theRowBytes);
+		unsigned char		*myDest = theDest + (myRow * theRowBytes);
+
+		for (myIndex = 0; myIndex < theCount; myIndex++)
+			myDest[myIndex] = (unsigned char)(((theSums[myIndex] * myScale) + (1U << (kNativeBoxShift - 1))) >> kNativeBoxShift);
+
+		if (myRow + 1 < theNumRows)
+			for (myIndex = 0; myIndex < theCount; myIndex++)
+				theSums[myIndex] += myEntering[myIndex] - myLeaving[myIndex];
+	}
+}
+
+
+//////////
+//
+// QTNative_KernelRowPassScalar
+// Convolve a row of pixels with a row of taps; theSrc holds theRadius extra pixels on either side, and theDest
+// receives 4 channels for each pixel.
+//
+//////////
+
+static void QTNative_KernelRowPassScalar (const unsigned int *theSrc, int *theDest, long theWidth, const int *theTaps, long theRadius)
+{
+	const unsigned char		*mySrc = (const unsigned char *)theSrc;
+	long					myIndex, myTap;
+
+	memset(theDest, 0, theWidth * 4 * sizeof(int));
+
+	for (myTap = 0; myTap <= 2 * theRadius; myTap++) {
+		if (theTaps[myTap] == 0)
+			continue;
+
+		for (myIndex = 0; myIndex < theWidth * 4; myIndex++)
+			theDest[myIndex] += theTaps[myTap] * mySrc[(myTap * 4) + myIndex];
+	}
+}
+
+
+//////////
+//
+// QTNative_KernelColumnPassScalar
+// Convolve theCount channels of a column of rows with a column of taps, and add the result (or its absolute value)
+// to theDest; theSrc points to the first of the 2 * theRadius + 1 rows, which are theStride ints apart.
+//
+//////////
+
+static void QTNative_KernelColumnPassScalar (const int *theSrc, long theStride, int *theDest, long theCount, const int *theTaps, long theRadius, Boolean theAbsolute)
+{
+	long					myIndex, myTap;
+
+	for (myIndex = 0; myIndex < theCount; myIndex++) {
+		int					mySum = 0;
+
+		for (myTap = 0; myTap <= 2 * theRadius; myTap++)
+			if (theTaps[myTap] != 0)
+				mySum += theTaps[myTap] * theSrc[(myTap * theStride) + myIndex];
+
+		if (theAbsolute && (mySum < 0))
+			mySum = -mySum;
+
+		theDest[myIndex] += mySum;
+	}
+}
+
+
+//////////
+//
+// QTNative_KernelFinishScalar
+// Turn a row of sums into pixels: shift each sum right (rounding), add the bias, and pin the result to 0..255.
+// The pixels keep the alpha channel of the corresponding source pixels.
+//
+//////////
+
+static void QTNative_KernelFinishScalar (const int *theSums, const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theShift, long theBias)
+{
+	unsigned char			*myDest = (unsigned char *)theDest;
+	int						myRound = (theShift > 0) ? (1 << (theShift - 1)) : 0;
+	long					myIndex;
+
+	for (myIndex = 0; myIndex < theWidth * 4; myIndex++) {
+		long				myValue = (long)((theSums[myIndex] + myRound) >> theShift) + theBias;
+
+		myDest[myIndex] = (unsigned char)((myValue < 0) ? 0 : (myValue > 255) ? 255 : myValue);
+	}
+
+	for (myIndex = 0; myIndex < theWidth; myIndex++)
+		theDest[myIndex] = (theDest[myIndex] & 0x00FFFFFFU) | (theSrc[myIndex] & 0xFF000000U);
+}
+
+
+#if NATIVE_HAS_AVX2
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AVX2 pass kernels.
+//
+// These do exactly what the scalar kernels do, 8 or 16 channels at a time, and finish each row with the
+// scalar kernels.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_PackBytesAVX2
+// Pack 16 32-bit values into 16 bytes, in order, pinning them to 0..255.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static __m128i QTNative_PackBytesAVX2 (__m256i theLow, __m256i theHigh)
+{
+	__m256i			myWords = _mm256_packs_epi32(theLow, theHigh);
+
+	myWords = _mm256_permute4x64_epi64(myWords, _MM_SHUFFLE(3, 1, 2, 0));
+	myWords = _mm256_packus_epi16(myWords, myWords);
+	myWords = _mm256_permute4x64_epi64(myWords, _MM_SHUFFLE(3, 1, 2, 0));
+
+	return(_mm256_castsi256_si128(myWords));
+}
+
+
+//////////
+//
+// QTNative_BoxRowPassAVX2
+// Box filter a row of pixels horizontally, keeping the 4 channel sums of a pixel in one vector.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_BoxRowPassAVX2 (const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theRadius)
+{
+	const __m128i			myScale = _mm_set1_epi32((int)QTNative_GetBoxScale(theRadius));
+	const __m128i			myRound = _mm_set1_epi32(1 << (kNativeBoxShift - 1));
+	__m128i					mySums = _mm_setzero_si128();
+	long					myBoxWidth = (2 * theRadius) + 1;
+	long					myX;
+
+	for (myX = 0; myX < myBoxWidth; myX++)
+		mySums = _mm_add_epi32(mySums, _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)theSrc[myX])));
+
+	for (myX = 0; myX < theWidth; myX++) {
+		__m128i				myPixel = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(mySums, myScale), myRound), kNativeBoxShift);
+
+		myPixel = _mm_packus_epi32(myPixel, myPixel);
+		theDest[myX] = (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(myPixel, myPixel));
+
+		if (myX + 1 < theWidth) {
+			mySums = _mm_add_epi32(mySums, _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)theSrc[myX + myBoxWidth])));
+			mySums = _mm_sub_epi32(mySums, _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)theSrc[myX])));
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_BoxColumnPassAVX2
+// Box filter theNumRows rows of pixels vertically, 16 channels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_BoxColumnPassAVX2 (const unsigned char *theSrc, unsigned char *theDest, long theNumRows, long theRowBytes, long theCount, long theRadius, unsigned int *theSums)
+{
+	const __m256i			myScale = _mm256_set1_epi32((int)QTNative_GetBoxScale(theRadius));
+	const __m256i			myRound = _mm256_set1_epi32(1 << (kNativeBoxShift - 1));
+	long					myBoxRows = (2 * theRadius) + 1;
+	long					myVectorCount = theCount & ~15L;
+	long					myIndex, myRow;
+
+	for (myIndex = 0; myIndex < myVectorCount; myIndex += 16) {
+		__m256i				myLow = _mm256_setzero_si256();
+		__m256i				myHigh = _mm256_setzero_si256();
+
+		for (myRow = 0; myRow < myBoxRows; myRow++) {
+			const unsigned char	*mySrc = theSrc + (myRow * theRowBytes) + myIndex;
+
+			myLow = _mm256_add_epi32(myLow, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)mySrc)));
+			myHigh = _mm256_add_epi32(myHigh, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(mySrc + 8))));
+		}
+
+		_mm256_storeu_si256((__m256i *)(theSums + myIndex), myLow);
+		_mm256_storeu_si256((__m256i *)(theSums + myIndex + 8), myHigh);
+	}
+
+	for (myRow = 0; myRow < theNumRows; myRow++) {
+		const unsigned char	*myLeaving = theSrc + (myRow * theRowBytes);
+		const unsigned char	*myEntering = myLeaving + (myBoxRows * theRowBytes);
+		unsigned char		*myDest = theDest + (myRow * theRowBytes);
+
+		for (myIndex = 0; myIndex < myVectorCount; myIndex += 16) {
+			__m256i			myLow = _mm256_loadu_si256((const __m256i *)(theSums + myIndex));
+			__m256i			myHigh = _mm256_loadu_si256((const __m256i *)(theSums + myIndex + 8));
+			__m256i			myOutLow = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myLow, myScale), myRound), kNativeBoxShift);
+			__m256i			myOutHigh = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myHigh, myScale), myRound), kNativeBoxShift);
+
+			_mm_storeu_si128((__m128i *)(myDest + myIndex), QTNative_PackBytesAVX2(myOutLow, myOutHigh));
+
+			if (myRow + 1 == theNumRows)
+				continue;
+
+			myLow = _mm256_add_epi32(myLow, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(myEntering + myIndex))));
+			myLow = _mm256_sub_epi32(myLow, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(myLeaving + myIndex))));
+			myHigh = _mm256_add_epi32(myHigh, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(myEntering + myIndex + 8))));
+			myHigh = _mm256_sub_epi32(myHigh, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(myLeaving + myIndex + 8))));
+
+			_mm256_storeu_si256((__m256i *)(theSums + myIndex), myLow);
+			_mm256_storeu_si256((__m256i *)(theSums + myIndex + 8), myHigh);
+		}
+	}
+
+	if (myVectorCount < theCount)
+		QTNative_BoxColumnPassScalar(theSrc + myVectorCount, theDest + myVectorCount, theNumRows, theRowBytes, theCount - myVectorCount, theRadius, theSums + myVectorCount);
+}
+
+
+//////////
+//
+// QTNative_KernelRowPassAVX2
+// Convolve a row of pixels with a row of taps, 2 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_KernelRowPassAVX2 (const unsigned int *theSrc, int *theDest, long theWidth, const int *theTaps, long theRadius)
+{
+	long					myVectorWidth = theWidth & ~1L;
+	long					myX, myTap;
+
+	for (myX = 0; myX < myVectorWidth; myX += 2) {
+		__m256i				mySum = _mm256_setzero_si256();
+
+		for (myTap = 0; myTap <= 2 * theRadius; myTap++) {
+			__m256i			myPixels;
+
+			if (theTaps[myTap] == 0)
+				continue;
+
+			myPixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(theSrc + myX + myTap)));
+			mySum = _mm256_add_epi32(mySum, _mm256_mullo_epi32(myPixels, _mm256_set1_epi32(theTaps[myTap])));
+		}
+
+		_mm256_storeu_si256((__m256i *)(theDest + (myX * 4)), mySum);
+	}
+
+	if (myVectorWidth < theWidth)
+		QTNative_KernelRowPassScalar(theSrc + myVectorWidth, theDest + (myVectorWidth * 4), theWidth - myVectorWidth, theTaps, theRadius);
+}
+
+
+//////////
+//
+// QTNative_KernelColumnPassAVX2
+// Convolve a column of rows with a column of taps, 8 channels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_KernelColumnPassAVX2 (const int *theSrc, long theStride, int *theDest, long theCount, const int *theTaps, long theRadius, Boolean theAbsolute)
+{
+	long					myVectorCount = theCount & ~7L;
+	long					myIndex, myTap;
+
+	for (myIndex = 0; myIndex < myVectorCount; myIndex += 8) {
+		__m256i				mySum = _mm256_setzero_si256();
+
+		for (myTap = 0; myTap <= 2 * theRadius; myTap++) {
+			__m256i			myValues;
+
+			if (theTaps[myTap] == 0)
+				continue;
+
+			myValues = _mm256_loadu_si256((const __m256i *)(theSrc + (myTap * theStride) + myIndex));
+			mySum = _mm256_add_epi32(mySum, _mm256_mullo_epi32(myValues, _mm256_set1_epi32(theTaps[myTap])));
+		}
+
+		if (theAbsolute)
+			mySum = _mm256_abs_epi32(mySum);
+
+		mySum = _mm256_add_epi32(mySum, _mm256_loadu_si256((const __m256i *)(theDest + myIndex)));
+		_mm256_storeu_si256((__m256i *)(theDest + myIndex), mySum);
+	}
+
+	if (myVectorCount < theCount)
+		QTNative_KernelColumnPassScalar(theSrc + myVectorCount, theStride, theDest + myVectorCount, theCount - myVectorCount, theTaps, theRadius, theAbsolute);
+}
+
+
+//////////
+//
+// QTNative_KernelFinishAVX2
+// Turn a row of sums into pixels, 4 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_KernelFinishAVX2 (const int *theSums, const unsigned int *theSrc, unsigned int *theDest, long theWidth, long theShift, long theBias)
+{
+	const __m256i			myRound = _mm256_set1_epi32((theShift > 0) ? (1 << (theShift - 1)) : 0);
+	const __m256i			myBias = _mm256_set1_epi32((int)theBias);
+	const __m128i			myShift = _mm_cvtsi32_si128((int)theShift);
+	const __m128i			myAlphaMask = _mm_set1_epi32((int)0xFF000000U);
+	long					myVectorWidth = theWidth & ~3L;
+	long					myX;
+
+	for (myX = 0; myX < myVectorWidth; myX += 4) {
+		__m256i				myLow = _mm256_loadu_si256((const __m256i *)(theSums + (myX * 4)));
+		__m256i				myHigh = _mm256_loadu_si256((const __m256i *)(theSums + (myX * 4) + 8));
+		__m128i				myPixels, mySrc;
+
+		myLow = _mm256_add_epi32(_mm256_sra_epi32(_mm256_add_epi32(myLow, myRound), myShift), myBias);
+		myHigh = _mm256_add_epi32(_mm256_sra_epi32(_mm256_add_epi32(myHigh, myRound), myShift), myBias);
+		myPixels = QTNative_PackBytesAVX2(myLow, myHigh);
+
+		mySrc = _mm_loadu_si128((const __m128i *)(theSrc + myX));
+		myPixels = _mm_or_si128(_mm_andnot_si128(myAlphaMask, myPixels), _mm_and_si128(myAlphaMask, mySrc));
+		_mm_storeu_si128((__m128i *)(theDest + myX), myPixels);
+	}
+
+	if (myVectorWidth < theWidth)
+		QTNative_KernelFinishScalar(theSums + (myVectorWidth * 4), theSrc + myVectorWidth, theDest + myVectorWidth, theWidth - myVectorWidth, theShift, theBias);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Convolution engine.
+//
+// Use these functions to filter a band of rows of a source into a buffer of 0xAARRGGBB values (one row after
+// another, theWidth pixels each). theWidth and theHeight give the part of the source that's filtered, which
+// is also the part whose edge pixels are repeated beyond the edges.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_BoxBlurBand
+// Blur the specified rows of the source by applying a box filter of the specified radius theNumPasses times,
+// both horizontally and vertically. This takes the same time per pixel whatever the radius.
+//
+//////////
+
+OSErr QTNative_BoxBlurBand (const NativePixelBuffer *theSrc, long theWidth, long theHeight, long theFirstRow, long theLastRow, long theRadius, short theNumPasses, unsigned int *theDest)
+{
+	const NativeConvolveKernels	*myKernels = QTNative_GetConvolveKernels();
+	NativeSpanKernels			myToRow;
+	unsigned int				*myRows = NULL;					// two sets of rows, for the vertical passes
+	unsigned int				*myPaddedRow = NULL;
+	unsigned int				*mySums = NULL;
+	unsigned int				*myIn, *myOut;
+	long						myHalo, myNumRows, myNumBandRows = theLastRow - theFirstRow;
+	long						myFirst, myCount;
+	long						myRow;
+	short						myPass;
+	OSErr						myErr = noErr;
+
+	if ((theRadius < 0) || (theRadius > kNativeMaxBlurRadius) || (theNumPasses < 1) || (theNumPasses > kNativeMaxBlurPasses))
+		return(paramErr);
+
+	if (!QTNative_GetSpanKernels(theSrc->fPixelFormat, QTNative_GetHostPixelFormat(), &myToRow))
+		return(paramErr);
+
+	if (myNumBandRows <= 0)
+		return(noErr);
+
+	// with no radius, there's nothing to blur
+	if (theRadius == 0) {
+		for (myRow = theFirstRow; myRow < theLastRow; myRow++)
+			QTNative_LoadPaddedRow(theSrc, myToRow.fConvert, theWidth, theHeight, myRow, 0, theDest + ((myRow - theFirstRow) * theWidth));
+		return(noErr);
+	}
+
+	myHalo = theRadius * theNumPasses;
+	myNumRows = myNumBandRows + (2 * myHalo);
+
+	myRows = (unsigned int *)QTNative_NewPoolBlock(myNumRows * theWidth * 2 * sizeof(unsigned int));
+	myPaddedRow = (unsigned int *)QTNative_NewPoolBlock((theWidth + (2 * theRadius)) * sizeof(unsigned int));
+	mySums = (unsigned int *)QTNative_NewPoolBlock(theWidth * 4 * sizeof(unsigned int));
+	if ((myRows == NULL) || (myPaddedRow == NULL) || (mySums == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	// filter the band and its halo horizontally; each pass but the last puts its result back into the padded row
+	for (myRow = 0; myRow < myNumRows; myRow++) {
+		unsigned int			*myDest = myRows + (myRow * theWidth);
+
+		QTNative_LoadPaddedRow(theSrc, myToRow.fConvert, theWidth, theHeight, theFirstRow - myHalo + myRow, theRadius, myPaddedRow);
+
+		for (myPass = 0; myPass < theNumPasses; myPass++) {
+			myKernels->fBoxRowPass(myPaddedRow, myDest, theWidth, theRadius);
+
+			if (myPass + 1 < theNumPasses) {
+				long			myIndex;
+
+				memcpy(myPaddedRow + theRadius, myDest, theWidth * sizeof(unsigned int));
+				for (myIndex = 0; myIndex < theRadius; myIndex++) {
+					myPaddedRow[myIndex] = myDest[0];
+					myPaddedRow[theRadius + theWidth + myIndex] = myDest[theWidth - 1];
+				}
+			}
+		}
+	}
+
+	// then vertically; each pass loses theRadius rows at the top and bottom (a row stays at the same index in
+	// both sets of rows), and the last pass leaves just the band, which goes straight to theDest
+	myIn = myRows;
+	myOut = myRows + (myNumRows * theWidth);
+	myFirst = 0;
+	myCount = myNumRows;
+
+	for (myPass = 0; myPass < theNumPasses; myPass++) {
+		unsigned int			*myPassDest = myOut + ((myFirst + theRadius) * theWidth);
+		unsigned int			*myTemp;
+
+		if (myPass + 1 == theNumPasses)
+			myPassDest = theDest;
+
+		myKernels->fBoxColumnPass((const unsigned char *)(myIn + (myFirst * theWidth)), (unsigned char *)myPassDest, myCount - (2 * theRadius), theWidth * 4, theWidth * 4, theRadius, mySums);
+
+		myFirst += theRadius;
+		myCount -= 2 * theRadius;
+
+		myTemp = myIn;
+		myIn = myOut;
+		myOut = myTemp;
+	}
+
+bail:
+	QTNative_DisposePoolBlock(myRows);
+	QTNative_DisposePoolBlock(myPaddedRow);
+	QTNative_DisposePoolBlock(mySums);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_ConvolveBand
+// Convolve the specified rows of the source with the specified kernel.
+//
+//////////
+
+OSErr QTNative_ConvolveBand (const NativePixelBuffer *theSrc, long theWidth, long theHeight, long theFirstRow, long theLastRow, const NativeKernel *theKernel, unsigned int *theDest)
+{
+	const NativeConvolveKernels	*myKernels = QTNative_GetConvolveKernels();
+	NativeSpanKernels			myToRow;
+	unsigned int				*myRows = NULL;					// the padded source rows
+	int							*myFiltered = NULL;				// the source rows, filtered horizontally
+	int							*mySums = NULL;
+	int							myRowTaps[kNativeMaxKernelTaps];
+	int							myColumnTaps[kNativeMaxKernelTaps];
+	double						myMaxSum = 0.0;
+	long						myHalo = 0;
+	long						myNumRows, myNumBandRows = theLastRow - theFirstRow;
+	long						myPaddedWidth;
+	long						myRow;
+	short						myTerm, myTap;
+	OSErr						myErr = noErr;
+
+	if ((theKernel == NULL) || (theKernel->fNumTerms < 1) || (theKernel->fNumTerms > kNativeMaxKernelTerms) || (theKernel->fShift < 0) || (theKernel->fShift > 30))
+		return(paramErr);
+
+	// make sure that no sum can overflow
+	for (myTerm = 0; myTerm < theKernel->fNumTerms; myTerm++) {
+		const NativeKernelTerm	*myKernelTerm = &theKernel->fTerms[myTerm];
+		double					myRowSum = 0.0, myColumnSum = 0.0;
+
+		if ((myKernelTerm->fRadius < 0) || (myKernelTerm->fRadius > kNativeMaxKernelRadius))
+			return(paramErr);
+
+		for (myTap = 0; myTap <= 2 * myKernelTerm->fRadius; myTap++) {
+			myRowSum += (myKernelTerm->fRowTaps[myTap] < 0) ? -(double)myKernelTerm->fRowTaps[myTap] : (double)myKernelTerm->fRowTaps[myTap];
+			myColumnSum += (myKernelTerm->fColumnTaps[myTap] < 0) ? -(double)myKernelTerm->fColumnTaps[myTap] : (double)myKernelTerm->fColumnTaps[myTap];
+		}
+
+		myMaxSum += 255.0 * myRowSum * myColumnSum;
+		if (myKernelTerm->fRadius > myHalo)
+			myHalo = myKernelTerm->fRadius;
+	}
+
+	if (myMaxSum + (double)(1L << theKernel->fShift) > kNativeMaxKernelSum)
+		return(paramErr);
+
+	if (!QTNative_GetSpanKernels(theSrc->fPixelFormat, QTNative_GetHostPixelFormat(), &myToRow))
+		return(paramErr);
+
+	if (myNumBandRows <= 0)
+		return(noErr);
+
+	myNumRows = myNumBandRows + (2 * myHalo);
+	myPaddedWidth = theWidth + (2 * myHalo);
+
+	myRows = (unsigned int *)QTNative_NewPoolBlock(myNumRows * myPaddedWidth * sizeof(unsigned int));
+	myFiltered = (int *)QTNative_NewPoolBlock(myNumRows * theWidth * 4 * sizeof(int));
+	mySums = (int *)QTNative_NewPoolBlock(myNumBandRows * theWidth * 4 * sizeof(int));
+	if ((myRows == NULL) || (myFiltered == NULL) || (mySums == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	memset(mySums, 0, (size_t)myNumBandRows * theWidth * 4 * sizeof(int));
+
+	for (myRow = 0; myRow < myNumRows; myRow++)
+		QTNative_LoadPaddedRow(theSrc, myToRow.fConvert, theWidth, theHeight, theFirstRow - myHalo + myRow, myHalo, myRows + (myRow * myPaddedWidth));
+
+	// add up the terms
+	for (myTerm = 0; myTerm < theKernel->fNumTerms; myTerm++) {
+		const NativeKernelTerm	*myKernelTerm = &theKernel->fTerms[myTerm];
+		long					myRadius = myKernelTerm->fRadius;
+		long					mySkip = myHalo - myRadius;		// the rows and columns of the halo that this term doesn't need
+
+		for (myTap = 0; myTap <= 2 * myRadius; myTap++) {
+			myRowTaps[myTap] = (int)myKernelTerm->fRowTaps[myTap];
+			myColumnTaps[myTap] = (int)myKernelTerm->fColumnTaps[myTap];
+		}
+
+		for (myRow = mySkip; myRow < myNumRows - mySkip; myRow++)
+			myKernels->fKernelRowPass(myRows + (myRow * myPaddedWidth) + mySkip, myFiltered + (myRow * theWidth * 4), theWidth, myRowTaps, myRadius);
+
+		for (myRow = 0; myRow < myNumBandRows; myRow++)
+			myKernels->fKernelColumnPass(myFiltered + ((myRow + mySkip) * theWidth * 4), theWidth * 4, mySums + (myRow * theWidth * 4), theWidth * 4,
+											myColumnTaps, myRadius, theKernel->fAbsolute);
+	}
+
+	for (myRow = 0; myRow < myNumBandRows; myRow++)
+		myKernels->fKernelFinish(mySums + (myRow * theWidth * 4), myRows + ((myRow + myHalo) * myPaddedWidth) + myHalo, theDest + (myRow * theWidth),
+									theWidth, theKernel->fShift, theKernel->fBias);
+
+bail:
+	QTNative_DisposePoolBlock(myRows);
+	QTNative_DisposePoolBlock(myFiltered);
+	QTNative_DisposePoolBlock(mySums);
+
+	return(myErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Effect procedures.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetBlurSettings
+// Get the radius and the number of passes of the box filter that the specified blur or sharpen filter applies,
+// clamped to the values QTNative_BoxBlurBand accepts.
+//
+// The effect procedures and QTNative_GetConvolveHalo must agree on these values, or a band won't be given
+// the rows it reads; so they all get them here.
+//
+//////////
+
+static void QTNative_GetBlurSettings (const NativeEffectParams *theParams, long *theRadius, long *theNumPasses)
+{
+	if (theParams->fEffectType == kNativeSharpenType) {
+		*theRadius = QTNative_GetEffectParam(theParams, kNativeParamRadius, kNativeDefaultSharpenRadius);
+		*theNumPasses = kNativeDefaultBlurPasses;
+	} else {
+		*theRadius = QTNative_GetEffectParam(theParams, kNativeParamRadius, kNativeDefaultBlurRadius);
+		*theNumPasses = QTNative_GetEffectParam(theParams, kNativeParamPasses, kNativeDefaultBlurPasses);
+	}
+
+	*theRadius = (*theRadius < 0) ? 0 : (*theRadius > kNativeMaxBlurRadius) ? kNativeMaxBlurRadius : *theRadius;
+	*theNumPasses = (*theNumPasses < 1) ? 1 : (*theNumPasses > kNativeMaxBlurPasses) ? kNativeMaxBlurPasses : *theNumPasses;
+}
+
+
+//////////
+//
+// QTNative_GetConvolveHalo
+// Return the number of rows above and below a band that the specified filter reads.
+//
+//////////
+
+long QTNative_GetConvolveHalo (const NativeEffectParams *theParams)
+{
+	long				myRadius;
+	long				myNumPasses;
+
+	switch (theParams->fEffectType) {
+		case kNativeBlurType:
+		case kNativeSharpenType:
+			QTNative_GetBlurSettings(theParams, &myRadius, &myNumPasses);
+			return(myRadius * myNumPasses);
+
+		default:
+			return(1);
+	}
+}
+
+
+//////////
+//
+// QTNative_FinishFilterBand
+// Write a band of filtered rows to the destination.
+//
+//////////
+
+static OSErr QTNative_FinishFilterBand (const NativeRenderJob *theJob, const unsigned int *theRows)
+{
+	NativePixelBuffer			*myDest = theJob->fDest;
+	NativeSpanKernels			myFromRow;
+	long						myRow;
+
+	if (!QTNative_GetSpanKernels(QTNative_GetHostPixelFormat(), myDest->fPixelFormat, &myFromRow))
+		return(paramErr);
+
+	for (myRow = theJob->fFirstRow; myRow < theJob->fLastRow; myRow++)
+		myFromRow.fConvert((const unsigned char *)(theRows + ((myRow - theJob->fFirstRow) * myDest->fWidth)), QTNative_GetRowAddress(myDest, myRow), myDest->fWidth, NULL);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ConvolveFilterBand
+// Convolve the band of rows described by the specified job with the specified kernel, and write it to the destination.
+// If theGray is true, each pixel is replaced by its brightness.
+//
+//////////
+
+static OSErr QTNative_ConvolveFilterBand (const NativeRenderJob *theJob, const NativeKernel *theKernel, Boolean theGray)
+{
+	NativePixelBuffer			*myDest = theJob->fDest;
+	unsigned int				*myRows = NULL;
+	long						myNumPixels = (theJob->fLastRow - theJob->fFirstRow) * myDest->fWidth;
+	long						myIndex;
+	OSErr						myErr = noErr;
+
+	myRows = (unsigned int *)QTNative_NewPoolBlock(myNumPixels * sizeof(unsigned int));
+	if (myRows == NULL)
+		return(memFullErr);
+
+	myErr = QTNative_ConvolveBand(theJob->fSources[0], myDest->fWidth, myDest->fHeight, theJob->fFirstRow, theJob->fLastRow, theKernel, myRows);
+	if (myErr != noErr)
+		goto bail;
+
+	if (theGray) {
+		for (myIndex = 0; myIndex < myNumPixels; myIndex++) {
+			unsigned int		myPixel = myRows[myIndex];
+			unsigned int		myLuma = ((((myPixel >> 16) & 0xFF) * 77) + (((myPixel >> 8) & 0xFF) * 150) + ((myPixel & 0xFF) * 29)) >> 8;
+
+			myRows[myIndex] = (myPixel & 0xFF000000U) | (myLuma * 0x010101U);
+		}
+	}
+
+	myErr = QTNative_FinishFilterBand(theJob, myRows);
+
+bail:
+	QTNative_DisposePoolBlock(myRows);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_SetKernelTerm
+// Set one term of a kernel to a 3x3 kernel (or, if theRowTaps and theColumnTaps are longer, a larger one).
+//
+//////////
+
+static void QTNative_SetKernelTerm (NativeKernelTerm *theTerm, short theRadius, const long *theRowTaps, const long *theColumnTaps)
+{
+	short						myTap;
+
+	memset(theTerm, 0, sizeof(NativeKernelTerm));
+	theTerm->fRadius = theRadius;
+	for (myTap = 0; myTap <= 2 * theRadius; myTap++) {
+		theTerm->fRowTaps[myTap] = theRowTaps[myTap];
+		theTerm->fColumnTaps[myTap] = theColumnTaps[myTap];
+	}
+}
+
+
+//////////
+//
+// QTNative_BlurProc
+// Blur the first source with a box filter applied several times (by default, a close approximation of a
+// Gaussian blur).
+//
+//////////
+
+OSErr QTNative_BlurProc (const NativeRenderJob *theJob)
+{
+	NativePixelBuffer			*myDest = theJob->fDest;
+	long						myRadius;
+	long						myNumPasses;
+	unsigned int				*myRows = NULL;
+	OSErr						myErr = noErr;
+
+	QTNative_GetBlurSettings(theJob->fParams, &myRadius, &myNumPasses);
+
+	myRows = (unsigned int *)QTNative_NewPoolBlock((theJob->fLastRow - theJob->fFirstRow) * myDest->fWidth * sizeof(unsigned int));
+	if (myRows == NULL)
+		return(memFullErr);
+
+	myErr = QTNative_BoxBlurBand(theJob->fSources[0], myDest->fWidth, myDest->fHeight, theJob->fFirstRow, theJob->fLastRow, myRadius, (short)myNumPasses, myRows);
+	if (myErr == noErr)
+		myErr = QTNative_FinishFilterBand(theJob, myRows);
+
+	QTNative_DisposePoolBlock(myRows);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_SharpenProc
+// Sharpen the first source with an unsharp mask: add back (some of) the difference between each pixel and the
+// blurred picture.
+//
+//////////
+
+OSErr QTNative_SharpenProc (const NativeRenderJob *theJob)
+{
+	const NativePixelBuffer		*mySrc = theJob->fSources[0];
+	NativePixelBuffer			*myDest = theJob->fDest;
+	long						myRadius;
+	long						myNumPasses;
+	long						myAmount = QTNative_GetEffectParam(theJob->fParams, kNativeParamAmount, kNativeDefaultSharpenAmount);
+	NativeSpanKernels			myToRow;
+	unsigned int				*myRows = NULL;
+	unsigned int				*mySrcRow = NULL;
+	long						myRow, myX;
+	OSErr						myErr = noErr;
+
+	QTNative_GetBlurSettings(theJob->fParams, &myRadius, &myNumPasses);
+	myAmount = (myAmount < 0) ? 0 : (myAmount > 4096) ? 4096 : myAmount;
+
+	if (!QTNative_GetSpanKernels(mySrc->fPixelFormat, QTNative_GetHostPixelFormat(), &myToRow))
+		return(paramErr);
+
+	myRows = (unsigned int *)QTNative_NewPoolBlock((theJob->fLastRow - theJob->fFirstRow) * myDest->fWidth * sizeof(unsigned int));
+	mySrcRow = (unsigned int *)QTNative_NewPoolBlock(myDest->fWidth * sizeof(unsigned int));
+	if ((myRows == NULL) || (mySrcRow == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myErr = QTNative_BoxBlurBand(mySrc, myDest->fWidth, myDest->fHeight, theJob->fFirstRow, theJob->fLastRow, myRadius, (short)myNumPasses, myRows);
+	if (myErr != noErr)
+		goto bail;
+
+	for (myRow = theJob->fFirstRow; myRow < theJob->fLastRow; myRow++) {
+		unsigned int			*myBlurred = myRows + ((myRow - theJob->fFirstRow) * myDest->fWidth);
+
+		myToRow.fConvert(QTNative_GetRowAddress(mySrc, myRow), (unsigned char *)mySrcRow, myDest->fWidth, mySrc->fColorTable);
+
+		for (myX = 0; myX < myDest->fWidth; myX++) {
+			unsigned int		myPixel = mySrcRow[myX];
+			unsigned int		myResult = myPixel & 0xFF000000U;
+			short				myShift;
+
+			for (myShift = 0; myShift < 24; myShift += 8) {
+				long			myValue = (myPixel >> myShift) & 0xFF;
+				long			myDetail = (myValue - (long)((myBlurred[myX] >> myShift) & 0xFF)) * myAmount;
+
+				// divide the detail by 256, rounding toward zero whatever its sign
+				myValue += (myDetail < 0) ? -((-myDetail) >> 8) : (myDetail >> 8);
+				myResult |= (unsigned int)((myValue < 0) ? 0 : (myValue > 255) ? 255 : myValue) << myShift;
+			}
+
+			myBlurred[myX] = myResult;
+		}
+	}
+
+	myErr = QTNative_FinishFilterBand(theJob, myRows);
+
+bail:
+	QTNative_DisposePoolBlock(myRows);
+	QTNative_DisposePoolBlock(mySrcRow);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_EmbossProc
+// Emboss the first source: light the picture from the top left, as though its brightness were height.
+// The kernel is the sum of the horizontal and vertical Prewitt kernels, both of which are separable.
+//
+//////////
+
+OSErr QTNative_EmbossProc (const NativeRenderJob *theJob)
+{
+	static const long			myOnes[3] = {1, 1, 1};
+	static const long			myDiff[3] = {-1, 0, 1};
+	NativeKernel				myKernel;
+
+	memset(&myKernel, 0, sizeof(myKernel));
+	myKernel.fNumTerms = 2;
+	myKernel.fBias = kNativeEmbossBias;
+	QTNative_SetKernelTerm(&myKernel.fTerms[0], 1, myDiff, myOnes);
+	QTNative_SetKernelTerm(&myKernel.fTerms[1], 1, myOnes, myDiff);
+
+	return(QTNative_ConvolveFilterBand(theJob, &myKernel, true));
+}
+
+
+//////////
+//
+// QTNative_EdgeDetectProc
+// Find the edges in the first source: each channel is the sum of the magnitudes of the horizontal and vertical
+// Sobel gradients, both of which are separable.
+//
+//////////
+
+OSErr QTNative_EdgeDetectProc (const NativeRenderJob *theJob)
+{
+	static const long			mySmooth[3] = {1, 2, 1};
+	static const long			myDiff[3] = {-1, 0, 1};
+	NativeKernel				myKernel;
+
+	memset(&myKernel, 0, sizeof(myKernel));
+	myKernel.fNumTerms = 2;
+	myKernel.fAbsolute = true;
+	myKernel.fShift = kNativeEdgeShift;
+	QTNative_SetKernelTerm(&myKernel.fTerms[0], 1, myDiff, mySmooth);
+	QTNative_SetKernelTerm(&myKernel.fTerms[1], 1, mySmooth, myDiff);
+
+	return(QTNative_ConvolveFilterBand(theJob, &myKernel, false));
+}
+
+
+//////////
+//
+// QTNative_ConvolveProc
+// Convolve the first source with a 3x3 kernel given by the parameters. Each row of the kernel becomes one
+// separable term: the row of taps, times a column that picks out that row.
+//
+//////////
+
+OSErr QTNative_ConvolveProc (const NativeRenderJob *theJob)
+{
+	static const OSType			myNames[3][3] = {
+		{kNativeParamKernel11, kNativeParamKernel12, kNativeParamKernel13},
+		{kNativeParamKernel21, kNativeParamKernel22, kNativeParamKernel23},
+		{kNativeParamKernel31, kNativeParamKernel32, kNativeParamKernel33}
+	};
+	NativeKernel				myKernel;
+	short						myRow, myColumn;
+
+	memset(&myKernel, 0, sizeof(myKernel));
+	myKernel.fNumTerms = 3;
+	myKernel.fShift = QTNative_GetEffectParam(theJob->fParams, kNativeParamShift, kNativeDefaultKernelShift);
+	myKernel.fBias = QTNative_GetEffectParam(theJob->fParams, kNativeParamBias, kNativeDefaultKernelBias);
+
+	for (myRow = 0; myRow < 3; myRow++) {
+		NativeKernelTerm		*myTerm = &myKernel.fTerms[myRow];
+
+		myTerm->fRadius = 1;
+		myTerm->fColumnTaps[myRow] = 1;
+		for (myColumn = 0; myColumn < 3; myColumn++)
+			myTerm->fRowTaps[myColumn] = QTNative_GetEffectParam(theJob->fParams, myNames[myRow][myColumn], ((myRow == 1) && (myColumn == 1)) ? 1 : 0);
+	}
+
+	return(QTNative_ConvolveFilterBand(theJob, &myKernel, false));
+}
@@ -0,0 +1,94 @@
+//////////
+//
+//	File:		QTNativeConvolve.h
+//
+//	Contains:	A separable convolution engine, and the native blur, sharpen, emboss, edge detection, and
+//				general convolution filters built on it.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeConvolve__
+#define __QTNativeConvolve__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// limits
+#define kNativeMaxBlurRadius				256
+#define kNativeMaxBlurPasses				3
+#define kNativeMaxKernelRadius				7			// so a kernel has at most 15 taps in each direction
+#define kNativeMaxKernelTaps				((2 * kNativeMaxKernelRadius) + 1)
+#define kNativeMaxKernelTerms				3
+
+// default values of the convolution parameters
+#define kNativeDefaultBlurRadius			2
+#define kNativeDefaultBlurPasses			3			// three box blurs in a row are very close to a Gaussian blur
+#define kNativeDefaultSharpenRadius			1
+#define kNativeDefaultSharpenAmount			256			// how much of the detail to add back, out of 256
+#define kNativeDefaultKernelShift			0
+#define kNativeDefaultKernelBias			0
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// one separable term of a kernel: the 2D kernel (fColumnTaps x fRowTaps), where each list of taps has
+// 2 * fRadius + 1 entries, centered on the pixel being computed
+typedef struct {
+	short					fRadius;
+	long					fRowTaps[kNativeMaxKernelTaps];
+	long					fColumnTaps[kNativeMaxKernelTaps];
+} NativeKernelTerm;
+
+// a kernel that's the sum of up to kNativeMaxKernelTerms separable terms; each channel of the result is
+// ((sum of the terms) >> fShift) + fBias, where each term is replaced by its absolute value if fAbsolute is true;
+// any 3x3 kernel can be written as the sum of 3 terms (one per row)
+typedef struct {
+	short					fNumTerms;
+	Boolean					fAbsolute;
+	long					fShift;
+	long					fBias;
+	NativeKernelTerm		fTerms[kNativeMaxKernelTerms];
+} NativeKernel;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_BoxBlurBand (const NativePixelBuffer *theSrc, long theWidth, long theHeight, long theFirstRow, long theLastRow, long theRadius, short theNumPasses, unsigned int *theDest);
+OSErr						QTNative_ConvolveBand (const NativePixelBuffer *theSrc, long theWidth, long theHeight, long theFirstRow, long theLastRow, const NativeKernel *theKernel, unsigned int *theDest);
+
+long						QTNative_GetConvolveHalo (const NativeEffectParams *theParams);
+OSErr						QTNative_BlurProc (const NativeRenderJob *theJob);
+OSErr						QTNative_SharpenProc (const NativeRenderJob *theJob);
+OSErr						QTNative_EmbossProc (const NativeRenderJob *theJob);
+OSErr						QTNative_EdgeDetectProc (const NativeRenderJob *theJob);
+OSErr						QTNative_ConvolveProc (const NativeRenderJob *theJob);
+
+#endif	// __QTNativeConvolve__
@@ -0,0 +1,1097 @@
+//////////
+//
+//	File:		QTNativeEffects.c
+//
+//	Contains:	A portable software renderer for some of the QuickTime video effects.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <15>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <14>	 	10/17/26	rtm		QTNative_PrepareEffect returns the effect's state, which stays put until QTNative_ReleaseEffect, and
+//									the bands get it in their job; added QTNative_RenderPreparedEffect, so that nodes rendered on the
+//									worker threads never prepare (and so never change) a state themselves
+//	   <13>	 	10/17/26	rtm		QTNative_CanRenderEffect now looks at the effect parameters, so that the SMPTE wipes we
+//									don't implement are left to the effect component
+//	   <12>	 	10/17/26	rtm		the pixels of a pixel buffer now come from the frame pool (see QTNativeFramePool.c), with
+//									rows aligned and padded to kNativePoolAlignment bytes
+//	   <11>	 	10/17/26	rtm		added 32-bit RGBA pixels
+//	   <10>	 	10/17/26	rtm		added the fire, clouds, and water ripple generators (see QTNativeGenerators.c); an effect
+//									with state gets a chance to update it (with QTNative_PrepareEffect) before its bands are rendered
+//	   <9>	 	10/17/26	rtm		added QTNative_GetHaloBandHeight and QTNative_GetEffectHalo, for the fused effect pipelines
+//									in QTNativePipeline.c
+//	   <8>	 	10/17/26	rtm		added the chroma key (see QTNativeKey.c)
+//	   <7>	 	10/17/26	rtm		added the blur, sharpen, emboss, edge detection, and general convolution filters
+//									(see QTNativeConvolve.c); effects that read rows around a band get taller bands
+//	   <6>	 	10/17/26	rtm		added the film noise filter (see QTNativeNoise.c)
+//	   <5>	 	10/17/26	rtm		the effect procedures now work on spans of pixels with kernels specialized for each pair
+//									of pixel formats (see QTNativeFormats.c), instead of calling QTNative_GetPixel and
+//									QTNative_SetPixel for each pixel
+//	   <4>	 	10/17/26	rtm		QTNative_RenderEffect now splits large frames into bands of rows and renders the bands
+//									on the worker threads (see QTNativeThreads.c); added QTNative_SetBandHeight
+//	   <3>	 	10/17/26	rtm		added QTNative_CopyPixelBuffer
+//	   <2>	 	10/17/26	rtm		QTNative_CrossFadeProc uses the vectorized kernels in QTNativeBlend.c for 32-bit buffers
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This file defines functions that render single steps of some QuickTime video effects directly from the
+//	pixels of the effect sources, without going through the effect components. QTShowEffect uses these
+//	functions (instead of DecompressSequenceFrameWhen) for any effect listed in the table gNativeEffects;
+//	since nothing here depends on QuickTime, the same code can be used on hosts that have no QuickTime.
+//
+//	Each native effect is a function that renders a band of rows of the destination buffer; the caller
+//	fills in a NativeRenderJob that describes the sources, the destination, the effect parameters, and
+//	the rows to render. An effect's time is given as a step number and a number of steps, just like the
+//	time value and time scale passed to DecompressSequenceFrameWhen by QTEffects_RunEffect.
+//
+//	A large frame is split into bands of rows small enough to stay in the processor's cache while they're
+//	rendered, and the bands are rendered in parallel on the worker threads; so even a single step of an effect
+//	(when stepping forward or backward, for instance) is rendered by all the processors.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeEffects.h"
+#include "QTNativeBlend.h"
+#include "QTNativeConvolve.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeGenerators.h"
+#include "QTNativeKey.h"
+#include "QTNativeNoise.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeOpaqueBlack				0xFF000000UL
+#define kNativeDefaultBandBytes			(128L * 1024L)		// the size of a band of destination rows, if not set explicitly
+
+
+//////////
+//
+// function prototypes for the effect procedures
+//
+//////////
+
+static OSErr						QTNative_CrossFadeProc (const NativeRenderJob *theJob);
+static OSErr						QTNative_WipeProc (const NativeRenderJob *theJob);
+static OSErr						QTNative_PushProc (const NativeRenderJob *theJob);
+static OSErr						QTNative_SlideProc (const NativeRenderJob *theJob);
+
+static OSErr						QTNative_RenderBand (void *theRefCon, long theIndex);
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+// the table of effects that have a native implementation
+static const NativeEffectEntry		gNativeEffects[] = {
+	{kNativeCrossFadeType,	2,	kNativeEffectFlagTimeIndependent,	QTNative_CrossFadeProc,		NULL,						NULL,						NULL},
+	{kNativeWipeType,		2,	kNativeEffectFlagTimeIndependent,	QTNative_WipeProc,			NULL,						NULL,						NULL},
+	{kNativePushType,		2,	kNativeEffectFlagTimeIndependent,	QTNative_PushProc,			NULL,						NULL,						NULL},
+	{kNativeSlideType,		2,	kNativeEffectFlagTimeIndependent,	QTNative_SlideProc,			NULL,						NULL,						NULL},
+	{kNativeChromaKeyType,	2,	kNativeEffectFlagTimeIndependent,	QTNative_ChromaKeyProc,		NULL,						NULL,						NULL},
+	{kNativeFilmNoiseType,	1,	kNativeEffectFlagTimeIndependent,	QTNative_FilmNoiseProc,		NULL,						NULL,						NULL},
+	{kNativeBlurType,		1,	kNativeEffectFlagTimeIndependent,	QTNative_BlurProc,			QTNative_GetConvolveHalo,	NULL,						NULL},
+	{kNativeSharpenType,	1,	kNativeEffectFlagTimeIndependent,	QTNative_SharpenProc,		QTNative_GetConvolveHalo,	NULL,						NULL},
+	{kNativeEmbossType,		1,	kNativeEffectFlagTimeIndependent,	QTNative_EmbossProc,		QTNative_GetConvolveHalo,	NULL,						NULL},
+	{kNativeEdgeDetectType,	1,	kNativeEffectFlagTimeIndependent,	QTNative_EdgeDetectProc,	QTNative_GetConvolveHalo,	NULL,						NULL},
+	{kNativeConvolveType,	1,	kNativeEffectFlagTimeIndependent,	QTNative_ConvolveProc,		QTNative_GetConvolveHalo,	NULL,						NULL},
+	{kNativeFireType,		0,	0,									QTNative_FireProc,			NULL,						QTNative_PrepareGenerator,	QTNative_ReleaseGenerator},
+	{kNativeCloudsType,		0,	kNativeEffectFlagTimeIndependent,	QTNative_CloudsProc,		NULL,						NULL,						NULL},
+	{kNativeRippleType,		0,	0,									QTNative_RippleProc,		NULL,						QTNative_PrepareGenerator,	QTNative_ReleaseGenerator}
+};
+
+#define kNumNativeEffects				(sizeof(gNativeEffects) / sizeof(gNativeEffects[0]))
+
+static long							gNativeBandHeight = 0;				// the number of rows in a band; 0 means pick one automatically
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Effect dispatch functions.
+//
+// Use these functions to find out whether an effect can be rendered natively and to render it.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_FindEffect
+// Return the table entry for the specified effect type, or NULL if there is no native implementation.
+//
+//////////
+
+const NativeEffectEntry *QTNative_FindEffect (OSType theEffectType)
+{
+	unsigned long		myIndex;
+
+	for (myIndex = 0; myIndex < kNumNativeEffects; myIndex++)
+		if (gNativeEffects[myIndex].fEffectType == theEffectType)
+			return(&gNativeEffects[myIndex]);
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTNative_CanRenderEffect
+// Is there a native implementation of the specified effect, with the specified parameters?
+//
+// Some effect types are implemented for only some values of their parameters (we render only two of the
+// SMPTE wipes, for instance); the caller should let the effect component render any others.
+//
+//////////
+
+Boolean QTNative_CanRenderEffect (const NativeEffectParams *theParams)
+{
+	long				myWipeID;
+
+	if ((theParams == NULL) || (QTNative_FindEffect(theParams->fEffectType) == NULL))
+		return(false);
+
+	switch (theParams->fEffectType) {
+		case kNativeWipeType:
+			myWipeID = QTNative_GetEffectParam(theParams, kNativeParamWipeID, kNativeWipeLeftToRight);
+			return((myWipeID == kNativeWipeLeftToRight) || (myWipeID == kNativeWipeTopToBottom));
+
+		default:
+			return(true);
+	}
+}
+
+
+//////////
+//
+// QTNative_RenderEffect
+// Render one step of an effect into the specified destination buffer.
+//
+// The sources must be at least as large as the destination; the destination must be a direct-color buffer.
+// Only the part of each source that lies under the destination is used.
+//
+//////////
+
+OSErr QTNative_RenderEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest)
+{
+	void						*myState = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theParams == NULL) || (theDest == NULL))
+		return(paramErr);
+
+	// bring the effect's state (if it has any) up to this step, before any band is rendered
+	myErr = QTNative_PrepareEffect(theParams, theDest, &myState);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTNative_RenderPreparedEffect(theParams, theSources, theNumSources, theDest, myState);
+
+	QTNative_ReleaseEffect(theParams, myState);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_RenderPreparedEffect
+// Render one step of an effect into the specified destination buffer, as QTNative_RenderEffect does, with the
+// state that QTNative_PrepareEffect returned for that step (NULL if the effect has no state).
+//
+// This never prepares a state itself, so the nodes of a graph can call it in parallel on the worker threads.
+//
+//////////
+
+OSErr QTNative_RenderPreparedEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest, void *theState)
+{
+	const NativeEffectEntry		*myEntry = NULL;
+	NativeRenderJob				myJob;
+	NativeBandInfo				myBands;
+	long						myBandHeight;
+	long						myNumBands;
+	short						myIndex;
+
+	if ((theParams == NULL) || (theDest == NULL) || (theDest->fBaseAddr == NULL))
+		return(paramErr);
+
+	if (theDest->fPixelFormat == kNativePixelFormat_8Indexed)
+		return(paramErr);
+
+	if (theParams->fNumberOfSteps <= 0)
+		return(paramErr);
+
+	if (!QTNative_CanRenderEffect(theParams))
+		return(paramErr);
+
+	myEntry = QTNative_FindEffect(theParams->fEffectType);
+	if ((theNumSources < myEntry->fNumSources) || (theNumSources > kNativeMaxSources))
+		return(paramErr);
+
+	memset(&myJob, 0, sizeof(myJob));
+	for (myIndex = 0; myIndex < myEntry->fNumSources; myIndex++) {
+		const NativePixelBuffer		*mySource = theSources[myIndex];
+
+		if ((mySource == NULL) || (mySource->fBaseAddr == NULL))
+			return(paramErr);
+		if (QTNative_GetBytesPerPixel(mySource->fPixelFormat) == 0)
+			return(paramErr);
+		if ((mySource->fWidth < theDest->fWidth) || (mySource->fHeight < theDest->fHeight))
+			return(paramErr);
+
+		myJob.fSources[myIndex] = mySource;
+	}
+
+	myJob.fParams = theParams;
+	myJob.fDest = theDest;
+	myJob.fFirstRow = 0;
+	myJob.fLastRow = theDest->fHeight;
+	myJob.fState = theState;
+
+	if ((myEntry->fPrepareProc != NULL) && (theState == NULL))
+		return(paramErr);
+
+	// split the frame into bands, and render them on the worker threads
+	myBandHeight = QTNative_GetHaloBandHeight(theDest, QTNative_GetEffectHalo(theParams));
+
+	myNumBands = (theDest->fHeight + myBandHeight - 1) / myBandHeight;
+
+	if ((myNumBands <= 1) || (QTNative_GetNumberOfThreads() < 2))
+		return(myEntry->fProc(&myJob));
+
+	myBands.fJob = myJob;
+	myBands.fProc = myEntry->fProc;
+	myBands.fBandHeight = myBandHeight;
+
+	return(QTNative_ParallelFor(myNumBands, QTNative_RenderBand, &myBands));
+}
+
+
+//////////
+//
+// QTNative_RenderBand
+// Render one band of rows of an effect step; this is called on a worker thread by QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_RenderBand (void *theRefCon, long theIndex)
+{
+	const NativeBandInfo		*myBands = (const NativeBandInfo *)theRefCon;
+	NativeRenderJob				myJob = myBands->fJob;
+
+	myJob.fFirstRow = theIndex * myBands->fBandHeight;
+	myJob.fLastRow = myJob.fFirstRow + myBands->fBandHeight;
+	if (myJob.fLastRow > myJob.fDest->fHeight)
+		myJob.fLastRow = myJob.fDest->fHeight;
+
+	return(myBands->fProc(&myJob));
+}
+
+
+//////////
+//
+// QTNative_SetBandHeight
+// Set the number of rows in each of the bands that a frame is split into for rendering; pass 0 to have the
+// band height picked automatically, so that a band of the destination takes up about 128K.
+//
+//////////
+
+void QTNative_SetBandHeight (long theNumRows)
+{
+	gNativeBandHeight = (theNumRows < 0) ? 0 : theNumRows;
+}
+
+
+//////////
+//
+// QTNative_GetBandHeight
+// Return the number of rows in each of the bands that the specified destination is split into for rendering.
+//
+//////////
+
+long QTNative_GetBandHeight (const NativePixelBuffer *theDest)
+{
+	long			myNumRows = gNativeBandHeight;
+
+	if ((myNumRows == 0) && (theDest->fRowBytes > 0))
+		myNumRows = kNativeDefaultBandBytes / theDest->fRowBytes;
+
+	return((myNumRows < 1) ? 1 : myNumRows);
+}
+
+
+//////////
+//
+// QTNative_GetHaloBandHeight
+// Return the number of rows in each of the bands that the specified destination is split into, when the effect
+// reads the specified number of rows above and below each band.
+//
+// An effect that reads rows around each band does that extra work for every band, so (unless the band height
+// was set explicitly) we make its bands at least twice as tall as that halo of rows, as long as there are still
+// enough bands to keep all the threads busy.
+//
+//////////
+
+long QTNative_GetHaloBandHeight (const NativePixelBuffer *theDest, long theHaloRows)
+{
+	long			myNumRows = QTNative_GetBandHeight(theDest);
+	long			myHaloHeight = 2 * theHaloRows;
+	long			myMaxHeight;
+
+	if (gNativeBandHeight != 0)
+		return(myNumRows);
+
+	myMaxHeight = (theDest->fHeight + QTNative_GetNumberOfThreads() - 1) / QTNative_GetNumberOfThreads();
+	if (myHaloHeight > myMaxHeight)
+		myHaloHeight = myMaxHeight;
+
+	return((myHaloHeight > myNumRows) ? myHaloHeight : myNumRows);
+}
+
+
+//////////
+//
+// QTNative_GetEffectHalo
+// Return the number of rows above and below a band that the specified effect reads from its sources.
+//
+//////////
+
+long QTNative_GetEffectHalo (const NativeEffectParams *theParams)
+{
+	const NativeEffectEntry		*myEntry = QTNative_FindEffect(theParams->fEffectType);
+
+	if ((myEntry == NULL) || (myEntry->fHaloProc == NULL))
+		return(0);
+
+	return(myEntry->fHaloProc(theParams));
+}
+
+
+//////////
+//
+// QTNative_PrepareEffect
+// Bring the state of the specified effect up to the step in theParams, for rendering into the specified destination,
+// and return it in theState (NULL if the effect has no state). Anything that renders the bands of an effect itself
+// (instead of calling QTNative_RenderEffect) must call this first, put the state in each band's job, and call
+// QTNative_ReleaseEffect once all the bands are done.
+//
+// This must be called only on the thread that starts the rendering, never from a band or a task on the worker threads:
+// preparing one state can discard another one that isn't in use. At most kNativeMaxPreparedEffects states can be
+// prepared at once; beyond that, this returns paramErr.
+//
+//////////
+
+OSErr QTNative_PrepareEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theDest, void **theState)
+{
+	const NativeEffectEntry		*myEntry = QTNative_FindEffect(theParams->fEffectType);
+
+	*theState = NULL;
+
+	if ((myEntry == NULL) || (myEntry->fPrepareProc == NULL))
+		return(noErr);
+
+	return(myEntry->fPrepareProc(theParams, theDest->fWidth, theDest->fHeight, theState));
+}
+
+
+//////////
+//
+// QTNative_ReleaseEffect
+// Release a state returned by QTNative_PrepareEffect, once all the bands that read it have been rendered.
+//
+//////////
+
+void QTNative_ReleaseEffect (const NativeEffectParams *theParams, void *theState)
+{
+	const NativeEffectEntry		*myEntry = QTNative_FindEffect(theParams->fEffectType);
+
+	if ((theState == NULL) || (myEntry == NULL) || (myEntry->fReleaseProc == NULL))
+		return;
+
+	myEntry->fReleaseProc(theState);
+}
+
+
+//////////
+//
+// QTNative_EffectHasState
+// Does the specified effect have a state that must be prepared before its bands are rendered?
+//
+//////////
+
+Boolean QTNative_EffectHasState (const NativeEffectParams *theParams)
+{
+	const NativeEffectEntry		*myEntry = QTNative_FindEffect(theParams->fEffectType);
+
+	return((myEntry != NULL) && (myEntry->fPrepareProc != NULL));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Effect parameter functions.
+//
+// Use these functions to build and read the list of parameters passed to a native effect.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_InitEffectParams
+// Initialize an effect parameter block for the specified effect, with no parameters.
+//
+//////////
+
+void QTNative_InitEffectParams (NativeEffectParams *theParams, OSType theEffectType)
+{
+	memset(theParams, 0, sizeof(NativeEffectParams));
+	theParams->fEffectType = theEffectType;
+	theParams->fNumberOfSteps = 1;
+}
+
+
+//////////
+//
+// QTNative_SetEffectParam
+// Set the value of the specified parameter, adding it to the parameter block if necessary.
+//
+//////////
+
+OSErr QTNative_SetEffectParam (NativeEffectParams *theParams, OSType theName, long theValue)
+{
+	short		myIndex;
+
+	for (myIndex = 0; myIndex < theParams->fNumParams; myIndex++) {
+		if (theParams->fParams[myIndex].fName == theName) {
+			theParams->fParams[myIndex].fValue = theValue;
+			return(noErr);
+		}
+	}
+
+	if (theParams->fNumParams >= kNativeMaxParams)
+		return(paramErr);
+
+	theParams->fParams[theParams->fNumParams].fName = theName;
+	theParams->fParams[theParams->fNumParams].fValue = theValue;
+	theParams->fNumParams++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetEffectParam
+// Return the value of the specified parameter, or theDefault if the parameter block does not contain it.
+//
+//////////
+
+long QTNative_GetEffectParam (const NativeEffectParams *theParams, OSType theName, long theDefault)
+{
+	short		myIndex;
+
+	for (myIndex = 0; myIndex < theParams->fNumParams; myIndex++)
+		if (theParams->fParams[myIndex].fName == theName)
+			return(theParams->fParams[myIndex].fValue);
+
+	return(theDefault);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Pixel buffer functions.
+//
+// Use these functions to allocate pixel buffers and to read and write their pixels.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_NewPixelBuffer
+// Allocate the pixels for a new pixel buffer of the specified size and format, cleared to 0.
+//
+// The pixels come from the frame pool, so the rows are aligned to kNativePoolAlignment bytes. The caller is
+// responsible for disposing of the pixels, by calling QTNative_DisposePixelBuffer.
+//
+//////////
+
+OSErr QTNative_NewPixelBuffer (NativePixelBuffer *theBuffer, long theWidth, long theHeight, OSType thePixelFormat)
+{
+	long		myBytesPerPixel = QTNative_GetBytesPerPixel(thePixelFormat);
+
+	memset(theBuffer, 0, sizeof(NativePixelBuffer));
+
+	if ((myBytesPerPixel == 0) || (theWidth <= 0) || (theHeight <= 0))
+		return(paramErr);
+
+	theBuffer->fRowBytes = QTNative_GetPoolRowBytes(theWidth, myBytesPerPixel);
+	theBuffer->fBaseAddr = (unsigned char *)QTNative_NewPoolBlock(theBuffer->fRowBytes * theHeight);
+	if (theBuffer->fBaseAddr == NULL)
+		return(memFullErr);
+
+	memset(theBuffer->fBaseAddr, 0, (size_t)(theBuffer->fRowBytes * theHeight));
+
+	theBuffer->fWidth = theWidth;
+	theBuffer->fHeight = theHeight;
+	theBuffer->fPixelFormat = thePixelFormat;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_DisposePixelBuffer
+// Dispose of the pixels of a pixel buffer allocated by QTNative_NewPixelBuffer (or QTNative_NewYUVPixelBuffer),
+// giving them back to the frame pool.
+//
+//////////
+
+void QTNative_DisposePixelBuffer (NativePixelBuffer *theBuffer)
+{
+	if (theBuffer->fBaseAddr != NULL)
+		QTNative_DisposePoolBlock(theBuffer->fBaseAddr);
+
+	memset(theBuffer, 0, sizeof(NativePixelBuffer));
+}
+
+
+//////////
+//
+// QTNative_CopyPixelBuffer
+// Copy the pixels of one pixel buffer into another pixel buffer of the same size and format.
+//
+//////////
+
+OSErr QTNative_CopyPixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest)
+{
+	long		myRowLength = theSrc->fWidth * QTNative_GetBytesPerPixel(theSrc->fPixelFormat);
+	long		myRow;
+
+	if ((theSrc->fWidth != theDest->fWidth) || (theSrc->fHeight != theDest->fHeight) || (theSrc->fPixelFormat != theDest->fPixelFormat))
+		return(paramErr);
+
+	if ((theSrc->fRowBytes == theDest->fRowBytes) && (theSrc->fRowBytes == myRowLength)) {
+		memcpy(theDest->fBaseAddr, theSrc->fBaseAddr, (size_t)(myRowLength * theSrc->fHeight));
+		return(noErr);
+	}
+
+	for (myRow = 0; myRow < theSrc->fHeight; myRow++)
+		memcpy(QTNative_GetRowAddress(theDest, myRow), QTNative_GetRowAddress(theSrc, myRow), (size_t)myRowLength);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetBytesPerPixel
+// Return the number of bytes occupied by one pixel of the specified format, or 0 if the format is unknown.
+//
+//////////
+
+long QTNative_GetBytesPerPixel (OSType thePixelFormat)
+{
+	switch (thePixelFormat) {
+		case kNativePixelFormat_8Indexed:
+			return(1);
+		case kNativePixelFormat_16BE555:
+		case kNativePixelFormat_16LE555:
+		case kNativePixelFormat_16LE565:
+			return(2);
+		case kNativePixelFormat_24RGB:
+			return(3);
+		case kNativePixelFormat_32ARGB:
+		case kNativePixelFormat_32BGRA:
+		case kNativePixelFormat_32RGBA:
+			return(4);
+		default:
+			return(0);
+	}
+}
+
+
+//////////
+//
+// QTNative_GetPixel
+// Return the pixel at the specified location, as 0xAARRGGBB.
+//
+//////////
+
+unsigned long QTNative_GetPixel (const NativePixelBuffer *theBuffer, long theX, long theY)
+{
+	const unsigned char		*myPtr;
+	unsigned long			myPixel;
+
+	if ((theX < 0) || (theY < 0) || (theX >= theBuffer->fWidth) || (theY >= theBuffer->fHeight))
+		return(kNativeOpaqueBlack);
+
+	myPtr = QTNative_GetRowAddress(theBuffer, theY);
+
+	switch (theBuffer->fPixelFormat) {
+		case kNativePixelFormat_8Indexed:
+			myPixel = myPtr[theX];
+			if (theBuffer->fColorTable != NULL)
+				return(theBuffer->fColorTable[myPixel]);
+			return(kNativeOpaqueBlack | (myPixel << 16) | (myPixel << 8) | myPixel);
+
+		case kNativePixelFormat_16BE555:
+		case kNativePixelFormat_16LE555:
+			myPtr += theX * 2;
+			if (theBuffer->fPixelFormat == kNativePixelFormat_16BE555)
+				myPixel = ((unsigned long)myPtr[0] << 8) | myPtr[1];
+			else
+				myPixel = ((unsigned long)myPtr[1] << 8) | myPtr[0];
+			return(kNativeOpaqueBlack |
+					((((myPixel >> 7) & 0xF8) | ((myPixel >> 12) & 0x07)) << 16) |
+					((((myPixel >> 2) & 0xF8) | ((myPixel >> 7) & 0x07)) << 8) |
+					(((myPixel << 3) & 0xF8) | ((myPixel >> 2) & 0x07)));
+
+		case kNativePixelFormat_16LE565:
+			myPtr += theX * 2;
+			myPixel = ((unsigned long)myPtr[1] << 8) | myPtr[0];
+			return(kNativeOpaqueBlack |
+					((((myPixel >> 8) & 0xF8) | ((myPixel >> 13) & 0x07)) << 16) |
+					((((myPixel >> 3) & 0xFC) | ((myPixel >> 9) & 0x03)) << 8) |
+					(((myPixel << 3) & 0xF8) | ((myPixel >> 2) & 0x07)));
+
+		case kNativePixelFormat_24RGB:
+			myPtr += theX * 3;
+			return(kNativeOpaqueBlack | ((unsigned long)myPtr[0] << 16) | ((unsigned long)myPtr[1] << 8) | myPtr[2]);
+
+		case kNativePixelFormat_32ARGB:
+			myPtr += theX * 4;
+			return(((unsigned long)myPtr[0] << 24) | ((unsigned long)myPtr[1] << 16) | ((unsigned long)myPtr[2] << 8) | myPtr[3]);
+
+		case kNativePixelFormat_32BGRA:
+			myPtr += theX * 4;
+			return(((unsigned long)myPtr[3] << 24) | ((unsigned long)myPtr[2] << 16) | ((unsigned long)myPtr[1] << 8) | myPtr[0]);
+
+		case kNativePixelFormat_32RGBA:
+			myPtr += theX * 4;
+			return(((unsigned long)myPtr[3] << 24) | ((unsigned long)myPtr[0] << 16) | ((unsigned long)myPtr[1] << 8) | myPtr[2]);
+
+		default:
+			return(kNativeOpaqueBlack);
+	}
+}
+
+
+//////////
+//
+// QTNative_SetPixel
+// Set the pixel at the specified location from a 0xAARRGGBB value.
+//
+// Indexed destinations are not supported (we'd need an inverse color table); such pixels are left unchanged.
+//
+//////////
+
+void QTNative_SetPixel (NativePixelBuffer *theBuffer, long theX, long theY, unsigned long theARGB)
+{
+	unsigned char		*myPtr;
+	unsigned long		myPixel;
+
+	if ((theX < 0) || (theY < 0) || (theX >= theBuffer->fWidth) || (theY >= theBuffer->fHeight))
+		return;
+
+	myPtr = QTNative_GetRowAddress(theBuffer, theY);
+
+	switch (theBuffer->fPixelFormat) {
+		case kNativePixelFormat_16BE555:
+		case kNativePixelFormat_16LE555:
+			myPtr += theX * 2;
+			myPixel = ((theARGB >> 9) & 0x7C00) | ((theARGB >> 6) & 0x03E0) | ((theARGB >> 3) & 0x001F);
+			if (theBuffer->fPixelFormat == kNativePixelFormat_16BE555) {
+				myPtr[0] = (unsigned char)(myPixel >> 8);
+				myPtr[1] = (unsigned char)myPixel;
+			} else {
+				myPtr[0] = (unsigned char)myPixel;
+				myPtr[1] = (unsigned char)(myPixel >> 8);
+			}
+			break;
+
+		case kNativePixelFormat_16LE565:
+			myPtr += theX * 2;
+			myPixel = ((theARGB >> 8) & 0xF800) | ((theARGB >> 5) & 0x07E0) | ((theARGB >> 3) & 0x001F);
+			myPtr[0] = (unsigned char)myPixel;
+			myPtr[1] = (unsigned char)(myPixel >> 8);
+			break;
+
+		case kNativePixelFormat_24RGB:
+			myPtr += theX * 3;
+			myPtr[0] = (unsigned char)(theARGB >> 16);
+			myPtr[1] = (unsigned char)(theARGB >> 8);
+			myPtr[2] = (unsigned char)theARGB;
+			break;
+
+		case kNativePixelFormat_32ARGB:
+			myPtr += theX * 4;
+			myPtr[0] = (unsigned char)(theARGB >> 24);
+			myPtr[1] = (unsigned char)(theARGB >> 16);
+			myPtr[2] = (unsigned char)(theARGB >> 8);
+			myPtr[3] = (unsigned char)theARGB;
+			break;
+
+		case kNativePixelFormat_32BGRA:
+			myPtr += theX * 4;
+			myPtr[0] = (unsigned char)theARGB;
+			myPtr[1] = (unsigned char)(theARGB >> 8);
+			myPtr[2] = (unsigned char)(theARGB >> 16);
+			myPtr[3] = (unsigned char)(theARGB >> 24);
+			break;
+
+		case kNativePixelFormat_32RGBA:
+			myPtr += theX * 4;
+			myPtr[0] = (unsigned char)(theARGB >> 16);
+			myPtr[1] = (unsigned char)(theARGB >> 8);
+			myPtr[2] = (unsigned char)theARGB;
+			myPtr[3] = (unsigned char)(theARGB >> 24);
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Effect procedures.
+//
+// Each of these functions renders the band of rows described by a NativeRenderJob. The progress of an
+// effect is expressed as a fraction of 256, computed from the step and the number of steps.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetProgress
+// Return the progress of the effect described by the specified parameters, from 0 (start) to 256 (end).
+//
+//////////
+
+static long QTNative_GetProgress (const NativeEffectParams *theParams)
+{
+	long		myStep = theParams->fStep;
+
+	if (myStep < 0)
+		myStep = 0;
+	if (myStep > theParams->fNumberOfSteps)
+		myStep = theParams->fNumberOfSteps;
+
+	return((myStep * 256) / theParams->fNumberOfSteps);
+}
+
+
+//////////
+//
+// QTNative_CrossFadeProc
+// Dissolve from the first source to the second source.
+//
+// When the sources and the destination are all 32-bit buffers of the same format, we blend whole rows with
+// the vectorized kernel selected by QTNativeBlend.c; when the two sources have the same format, we use the
+// blend kernel for that format and the destination format; otherwise we fall back to blending pixel by pixel.
+//
+//////////
+
+static OSErr QTNative_CrossFadeProc (const NativeRenderJob *theJob)
+{
+	const NativePixelBuffer		*mySrcA = theJob->fSources[0];
+	const NativePixelBuffer		*mySrcB = theJob->fSources[1];
+	NativePixelBuffer			*myDest = theJob->fDest;
+	long						myAmount = QTNative_GetProgress(theJob->fParams);
+	NativeSpanKernels			myKernels;
+	long						myX, myY;
+
+	if ((QTNative_GetBytesPerPixel(myDest->fPixelFormat) == 4) && (mySrcA->fPixelFormat == myDest->fPixelFormat) && (mySrcB->fPixelFormat == myDest->fPixelFormat)) {
+		for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++)
+			QTNative_CrossFadeRow32(QTNative_GetRowAddress(mySrcA, myY),
+									QTNative_GetRowAddress(mySrcB, myY),
+									QTNative_GetRowAddress(myDest, myY),
+									myDest->fWidth,
+									myAmount);
+		return(noErr);
+	}
+
+	if ((mySrcA->fPixelFormat == mySrcB->fPixelFormat) && QTNative_GetSpanKernels(mySrcA->fPixelFormat, myDest->fPixelFormat, &myKernels)) {
+		for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++)
+			myKernels.fBlend(QTNative_GetRowAddress(mySrcA, myY),
+							QTNative_GetRowAddress(mySrcB, myY),
+							QTNative_GetRowAddress(myDest, myY),
+							myDest->fWidth,
+							myAmount,
+							mySrcA->fColorTable,
+							mySrcB->fColorTable);
+		return(noErr);
+	}
+
+	for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+		for (myX = 0; myX < theJob->fDest->fWidth; myX++) {
+			unsigned long		myPixelA = QTNative_GetPixel(theJob->fSources[0], myX, myY);
+			unsigned long		myPixelB = QTNative_GetPixel(theJob->fSources[1], myX, myY);
+			unsigned long		myPixel = 0;
+			short				myShift;
+
+			// blend each of the four 8-bit channels, exactly as the row kernels do
+			for (myShift = 0; myShift < 32; myShift += 8) {
+				unsigned long	myA = (myPixelA >> myShift) & 0xFF;
+				unsigned long	myB = (myPixelB >> myShift) & 0xFF;
+
+				myPixel |= (((myA * (kNativeBlendMax - myAmount)) + (myB * myAmount)) >> 8) << myShift;
+			}
+
+			QTNative_SetPixel(theJob->fDest, myX, myY, myPixel);
+		}
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_CopySourceSpan
+// Copy theCount pixels of a source, starting at (theSrcX, theSrcY), into a row of the destination, starting at
+// theDestX. Pixels that lie outside the frame (the size of the destination) are set to opaque black.
+//
+//////////
+
+static void QTNative_CopySourceSpan (const NativeRenderJob *theJob, short theSource, const NativeSpanKernels *theKernels, NativeFillSpanProcPtr theFill, long theSrcX, long theSrcY, long theDestY, long theDestX, long theCount)
+{
+	const NativePixelBuffer		*mySrc = theJob->fSources[theSource];
+	unsigned char				*myDestPtr;
+	long						myWidth = theJob->fDest->fWidth;
+	long						myCount;
+
+	if (theCount <= 0)
+		return;
+
+	myDestPtr = QTNative_GetRowAddress(theJob->fDest, theDestY) + (theDestX * theKernels->fDestBytesPerPixel);
+
+	// a row above or below the frame
+	if ((theSrcY < 0) || (theSrcY >= theJob->fDest->fHeight)) {
+		theFill(myDestPtr, theCount, kNativeOpaqueBlack);
+		return;
+	}
+
+	// pixels to the left of the frame
+	if (theSrcX < 0) {
+		myCount = (-theSrcX < theCount) ? -theSrcX : theCount;
+		theFill(myDestPtr, myCount, kNativeOpaqueBlack);
+		myDestPtr += myCount * theKernels->fDestBytesPerPixel;
+		theSrcX += myCount;
+		theCount -= myCount;
+	}
+
+	// pixels inside the frame
+	myCount = myWidth - theSrcX;
+	if (myCount > theCount)
+		myCount = theCount;
+	if (myCount > 0) {
+		theKernels->fConvert(QTNative_GetRowAddress(mySrc, theSrcY) + (theSrcX * theKernels->fSrcBytesPerPixel), myDestPtr, myCount, mySrc->fColorTable);
+		myDestPtr += myCount * theKernels->fDestBytesPerPixel;
+		theCount -= myCount;
+	}
+
+	// pixels to the right of the frame
+	if (theCount > 0)
+		theFill(myDestPtr, theCount, kNativeOpaqueBlack);
+}
+
+
+//////////
+//
+// QTNative_GetJobKernels
+// Look up the span kernels that copy each of the two sources of the specified job into its destination.
+//
+//////////
+
+static OSErr QTNative_GetJobKernels (const NativeRenderJob *theJob, NativeSpanKernels theKernels[2], NativeFillSpanProcPtr *theFill)
+{
+	if (!QTNative_GetSpanKernels(theJob->fSources[0]->fPixelFormat, theJob->fDest->fPixelFormat, &theKernels[0]))
+		return(paramErr);
+
+	if (!QTNative_GetSpanKernels(theJob->fSources[1]->fPixelFormat, theJob->fDest->fPixelFormat, &theKernels[1]))
+		return(paramErr);
+
+	*theFill = QTNative_GetFillKernel(theJob->fDest->fPixelFormat);
+	if (*theFill == NULL)
+		return(paramErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_WipeProc
+// Wipe from the first source to the second source, with a hard edge.
+//
+//////////
+
+static OSErr QTNative_WipeProc (const NativeRenderJob *theJob)
+{
+	NativeSpanKernels		myKernels[2];
+	NativeFillSpanProcPtr	myFill;
+	long					myAmount = QTNative_GetProgress(theJob->fParams);
+	long					myWipeID = QTNative_GetEffectParam(theJob->fParams, kNativeParamWipeID, kNativeWipeLeftToRight);
+	long					myWidth = theJob->fDest->fWidth;
+	long					myEdge;
+	long					myY;
+	OSErr					myErr = noErr;
+
+	myErr = QTNative_GetJobKernels(theJob, myKernels, &myFill);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (myWipeID == kNativeWipeTopToBottom)
+		myEdge = (theJob->fDest->fHeight * myAmount) >> 8;
+	else
+		myEdge = (myWidth * myAmount) >> 8;
+
+	for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+		if (myWipeID == kNativeWipeTopToBottom) {
+			short			mySource = (myY < myEdge) ? 1 : 0;
+
+			QTNative_CopySourceSpan(theJob, mySource, &myKernels[mySource], myFill, 0, myY, myY, 0, myWidth);
+		} else {
+			QTNative_CopySourceSpan(theJob, 1, &myKernels[1], myFill, 0, myY, myY, 0, myEdge);
+			QTNative_CopySourceSpan(theJob, 0, &myKernels[0], myFill, myEdge, myY, myY, myEdge, myWidth - myEdge);
+		}
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetMotionOffset
+// Compute the offset of the incoming source for a push or slide effect; the incoming source
+// starts entirely off the edge named by the kNativeParamFrom parameter and ends at (0, 0).
+//
+//////////
+
+static void QTNative_GetMotionOffset (const NativeRenderJob *theJob, long *theDeltaX, long *theDeltaY)
+{
+	long			myRemaining = 256 - QTNative_GetProgress(theJob->fParams);
+	long			myWidth = theJob->fDest->fWidth;
+	long			myHeight = theJob->fDest->fHeight;
+
+	*theDeltaX = 0;
+	*theDeltaY = 0;
+
+	switch (QTNative_GetEffectParam(theJob->fParams, kNativeParamFrom, kNativeFromLeft)) {
+		case kNativeFromTop:
+			*theDeltaY = -((myHeight * myRemaining) >> 8);
+			break;
+		case kNativeFromRight:
+			*theDeltaX = (myWidth * myRemaining) >> 8;
+			break;
+		case kNativeFromBottom:
+			*theDeltaY = (myHeight * myRemaining) >> 8;
+			break;
+		case kNativeFromLeft:
+		default:
+			*theDeltaX = -((myWidth * myRemaining) >> 8);
+			break;
+	}
+}
+
+
+//////////
+//
+// QTNative_RenderMotionRows
+// Render the rows of a push or slide: the incoming (second) source is offset by (theInX, theInY) and the
+// outgoing (first) source by (theOutX, theOutY); the incoming source is on top.
+//
+//////////
+
+static OSErr QTNative_RenderMotionRows (const NativeRenderJob *theJob, long theInX, long theInY, long theOutX, long theOutY)
+{
+	NativeSpanKernels		myKernels[2];
+	NativeFillSpanProcPtr	myFill;
+	long					myWidth = theJob->fDest->fWidth;
+	long					myHeight = theJob->fDest->fHeight;
+	long					myLeft, myRight;
+	long					myY;
+	OSErr					myErr = noErr;
+
+	myErr = QTNative_GetJobKernels(theJob, myKernels, &myFill);
+	if (myErr != noErr)
+		return(myErr);
+
+	// the columns covered by the incoming source
+	myLeft = (theInX > 0) ? theInX : 0;
+	myRight = (theInX < 0) ? (myWidth + theInX) : myWidth;
+	if (myRight < myLeft)
+		myRight = myLeft;
+
+	for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+		long			myInY = myY - theInY;
+		long			myOutY = myY - theOutY;
+
+		if ((myInY < 0) || (myInY >= myHeight)) {
+			QTNative_CopySourceSpan(theJob, 0, &myKernels[0], myFill, -theOutX, myOutY, myY, 0, myWidth);
+			continue;
+		}
+
+		QTNative_CopySourceSpan(theJob, 0, &myKernels[0], myFill, -theOutX, myOutY, myY, 0, myLeft);
+		QTNative_CopySourceSpan(theJob, 1, &myKernels[1], myFill, myLeft - theInX, myInY, myY, myLeft, myRight - myLeft);
+		QTNative_CopySourceSpan(theJob, 0, &myKernels[0], myFill, myRight - theOutX, myOutY, myY, myRight, myWidth - myRight);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_PushProc
+// Push the first source off the window with the second source.
+//
+//////////
+
+static OSErr QTNative_PushProc (const NativeRenderJob *theJob)
+{
+	long			myDeltaX, myDeltaY;
+	long			myOutX, myOutY;
+
+	QTNative_GetMotionOffset(theJob, &myDeltaX, &myDeltaY);
+
+	// the outgoing source moves along with the incoming source, one full frame behind it
+	myOutX = myDeltaX - ((myDeltaX < 0) ? -theJob->fDest->fWidth : (myDeltaX > 0) ? theJob->fDest->fWidth : 0);
+	myOutY = myDeltaY - ((myDeltaY < 0) ? -theJob->fDest->fHeight : (myDeltaY > 0) ? theJob->fDest->fHeight : 0);
+
+	return(QTNative_RenderMotionRows(theJob, myDeltaX, myDeltaY, myOutX, myOutY));
+}
+
+
+//////////
+//
+// QTNative_SlideProc
+// Slide the second source over the first source, which stays where it is.
+//
+//////////
+
+static OSErr QTNative_SlideProc (const NativeRenderJob *theJob)
+{
+	long			myDeltaX, myDeltaY;
+
+	QTNative_GetMotionOffset(theJob, &myDeltaX, &myDeltaY);
+
+	return(QTNative_RenderMotionRows(theJob, myDeltaX, myDeltaY, 0, 0));
+}
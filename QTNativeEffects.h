@@ -0,0 +1,267 @@
+//////////
+//
+//	File:		QTNativeEffects.h
+//
+//	Contains:	A portable software renderer for some of the QuickTime video effects.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		a pixel buffer can hold only some of the rows of a frame, starting at fFirstRow
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This file does not depend on QuickTime or on any window system, so that the same effects code can
+//	run on hosts where QuickTime is not available. When it is compiled as part of QTShowEffect, the
+//	basic types (OSErr, OSType, Boolean) come from the Mac OS headers; otherwise we define them here.
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeEffects__
+#define __QTNativeEffects__
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////
+//
+// basic types
+//
+//////////
+
+#ifndef __MACTYPES__
+typedef short						OSErr;
+typedef unsigned long				OSType;
+typedef unsigned char				Boolean;
+
+enum {
+	noErr							= 0,
+	paramErr						= -50,
+	memFullErr						= -108
+};
+
+#ifndef __cplusplus
+enum {
+	false							= 0,
+	true							= 1
+};
+#endif
+
+#ifndef FOUR_CHAR_CODE
+#define FOUR_CHAR_CODE(x)			(x)
+#endif
+#endif	// __MACTYPES__
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// pixel formats; the numeric values match the QuickTime pixel format constants, so that the pixelFormat
+// field of a PixMap can be used directly
+#define kNativePixelFormat_8Indexed			8
+#define kNativePixelFormat_16BE555			16
+#define kNativePixelFormat_24RGB			24
+#define kNativePixelFormat_32ARGB			32
+#define kNativePixelFormat_16LE555			FOUR_CHAR_CODE('L555')
+#define kNativePixelFormat_16LE565			FOUR_CHAR_CODE('L565')
+#define kNativePixelFormat_32BGRA			FOUR_CHAR_CODE('BGRA')
+#define kNativePixelFormat_32RGBA			FOUR_CHAR_CODE('RGBA')
+
+// Y'CbCr pixel formats, which only the conversion functions in QTNativeConvert.c read and write (the effects never see them)
+#define kNativePixelFormat_2vuy				FOUR_CHAR_CODE('2vuy')		// 4:2:2, packed as Cb Y0 Cr Y1
+#define kNativePixelFormat_YUV420			FOUR_CHAR_CODE('y420')		// 4:2:0, in three planes (see QTNativeConvert.h)
+
+// effect types that have a native implementation (same values as the QuickTime effect types)
+#define kNativeCrossFadeType				FOUR_CHAR_CODE('dslv')
+#define kNativeWipeType						FOUR_CHAR_CODE('smpt')
+#define kNativePushType						FOUR_CHAR_CODE('push')
+#define kNativeSlideType					FOUR_CHAR_CODE('slid')
+#define kNativeFilmNoiseType				FOUR_CHAR_CODE('fmns')
+#define kNativeBlurType						FOUR_CHAR_CODE('blur')
+#define kNativeSharpenType					FOUR_CHAR_CODE('shrp')
+#define kNativeEmbossType					FOUR_CHAR_CODE('embs')
+#define kNativeEdgeDetectType				FOUR_CHAR_CODE('edge')
+#define kNativeConvolveType					FOUR_CHAR_CODE('genk')
+#define kNativeChromaKeyType				FOUR_CHAR_CODE('ckey')
+#define kNativeFireType						FOUR_CHAR_CODE('fire')
+#define kNativeCloudsType					FOUR_CHAR_CODE('clou')
+#define kNativeRippleType					FOUR_CHAR_CODE('ripl')
+
+// effect parameters understood by the native effects (same names as the effect description atoms)
+#define kNativeParamWipeID					FOUR_CHAR_CODE('wpID')
+#define kNativeParamFrom					FOUR_CHAR_CODE('from')
+
+// film noise parameters (see QTNativeNoise.h for their meanings and default values)
+#define kNativeParamDust					FOUR_CHAR_CODE('dust')
+#define kNativeParamHair					FOUR_CHAR_CODE('hair')
+#define kNativeParamScratches				FOUR_CHAR_CODE('scrt')
+#define kNativeParamFade					FOUR_CHAR_CODE('fade')
+#define kNativeParamGrain					FOUR_CHAR_CODE('grai')
+#define kNativeParamSeed					FOUR_CHAR_CODE('seed')
+
+// convolution parameters (see QTNativeConvolve.h for their meanings and default values)
+#define kNativeParamRadius					FOUR_CHAR_CODE('radi')
+#define kNativeParamPasses					FOUR_CHAR_CODE('pass')
+#define kNativeParamAmount					FOUR_CHAR_CODE('amnt')
+#define kNativeParamKernel11				FOUR_CHAR_CODE('kr11')		// the general convolution kernel, by row and column
+#define kNativeParamKernel12				FOUR_CHAR_CODE('kr12')
+#define kNativeParamKernel13				FOUR_CHAR_CODE('kr13')
+#define kNativeParamKernel21				FOUR_CHAR_CODE('kr21')
+#define kNativeParamKernel22				FOUR_CHAR_CODE('kr22')
+#define kNativeParamKernel23				FOUR_CHAR_CODE('kr23')
+#define kNativeParamKernel31				FOUR_CHAR_CODE('kr31')
+#define kNativeParamKernel32				FOUR_CHAR_CODE('kr32')
+#define kNativeParamKernel33				FOUR_CHAR_CODE('kr33')
+#define kNativeParamShift					FOUR_CHAR_CODE('shft')
+#define kNativeParamBias					FOUR_CHAR_CODE('bias')
+
+// chroma key parameters (see QTNativeKey.h for their meanings and default values)
+#define kNativeParamKeyColor				FOUR_CHAR_CODE('kcol')		// 0x00RRGGBB
+#define kNativeParamKeyTolerance			FOUR_CHAR_CODE('ktol')
+#define kNativeParamKeySoftness				FOUR_CHAR_CODE('ksft')
+#define kNativeParamKeySpill				FOUR_CHAR_CODE('kspl')
+
+// generator parameters (see QTNativeGenerators.h for their meanings and default values)
+#define kNativeParamFlameHeight				FOUR_CHAR_CODE('fhgt')
+#define kNativeParamSputter					FOUR_CHAR_CODE('sput')
+#define kNativeParamCloudSize				FOUR_CHAR_CODE('csiz')
+#define kNativeParamCloudSpeed				FOUR_CHAR_CODE('cspd')
+#define kNativeParamCloudCover				FOUR_CHAR_CODE('ccov')
+#define kNativeParamDrops					FOUR_CHAR_CODE('drop')
+#define kNativeParamDamping					FOUR_CHAR_CODE('damp')
+
+// values for kNativeParamWipeID
+#define kNativeWipeLeftToRight				1
+#define kNativeWipeTopToBottom				2
+
+// values for kNativeParamFrom
+#define kNativeFromTop						0
+#define kNativeFromRight					1
+#define kNativeFromBottom					2
+#define kNativeFromLeft						3
+
+// effect flags
+#define kNativeEffectFlagTimeIndependent	(1L << 0)	// any step can be rendered without rendering the earlier steps
+
+// limits
+#define kNativeMaxSources					3			// srcA, srcB, srcC
+#define kNativeMaxParams					16
+#define kNativeMaxPreparedEffects			4			// the most effects with state that can be prepared at once
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a description of a block of pixels in memory; the pixels are not owned by the descriptor
+typedef struct {
+	unsigned char *			fBaseAddr;
+	long					fRowBytes;
+	long					fWidth;
+	long					fHeight;
+	long					fFirstRow;						// the row of the frame at fBaseAddr; 0 unless the buffer holds only some rows
+	OSType					fPixelFormat;
+	const unsigned long *	fColorTable;					// 256 entries of 0xAARRGGBB, for indexed formats only
+} NativePixelBuffer;
+
+// a single effect parameter, as found in an effect description
+typedef struct {
+	OSType					fName;
+	long					fValue;
+} NativeEffectParam;
+
+// the parameters for rendering one step of an effect
+typedef struct {
+	OSType					fEffectType;
+	long					fStep;							// the step to render, from 0 to fNumberOfSteps
+	long					fNumberOfSteps;
+	short					fNumParams;
+	NativeEffectParam		fParams[kNativeMaxParams];
+} NativeEffectParams;
+
+// a request to render some rows of one step of an effect
+typedef struct {
+	const NativeEffectParams *	fParams;
+	const NativePixelBuffer *	fSources[kNativeMaxSources];
+	NativePixelBuffer *			fDest;
+	long						fFirstRow;					// the first row to render
+	long						fLastRow;					// one past the last row to render
+	void *						fState;						// the state that QTNative_PrepareEffect returned, or NULL
+} NativeRenderJob;
+
+typedef OSErr (*NativeEffectProcPtr) (const NativeRenderJob *theJob);
+
+// return the number of rows above and below a band that an effect reads from its sources
+typedef long (*NativeHaloProcPtr) (const NativeEffectParams *theParams);
+
+// bring the state of an effect whose steps depend on the earlier steps up to the step in theParams, before
+// the bands of that step are rendered, and return it; the state stays put until it's released
+typedef OSErr (*NativePrepareProcPtr) (const NativeEffectParams *theParams, long theWidth, long theHeight, void **theState);
+
+// release a state returned by an effect's prepare procedure, once the bands of the step have been rendered
+typedef void (*NativeReleaseProcPtr) (void *theState);
+
+// a frame being rendered in bands of rows on the worker threads
+typedef struct {
+	NativeRenderJob				fJob;						// the job for the whole frame
+	NativeEffectProcPtr			fProc;
+	long						fBandHeight;
+} NativeBandInfo;
+
+// an entry in the table of native effects
+typedef struct {
+	OSType					fEffectType;
+	short					fNumSources;
+	long					fFlags;
+	NativeEffectProcPtr		fProc;
+	NativeHaloProcPtr		fHaloProc;						// NULL if the effect reads only the rows it renders
+	NativePrepareProcPtr	fPrepareProc;					// NULL if the effect has no state
+	NativeReleaseProcPtr	fReleaseProc;
+} NativeEffectEntry;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+const NativeEffectEntry *	QTNative_FindEffect (OSType theEffectType);
+Boolean						QTNative_CanRenderEffect (const NativeEffectParams *theParams);
+OSErr						QTNative_RenderEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest);
+OSErr						QTNative_RenderPreparedEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest, void *theState);
+void						QTNative_SetBandHeight (long theNumRows);
+long						QTNative_GetBandHeight (const NativePixelBuffer *theDest);
+long						QTNative_GetHaloBandHeight (const NativePixelBuffer *theDest, long theHaloRows);
+long						QTNative_GetEffectHalo (const NativeEffectParams *theParams);
+OSErr						QTNative_PrepareEffect (const NativeEffectParams *theParams, const NativePixelBuffer *theDest, void **theState);
+void						QTNative_ReleaseEffect (const NativeEffectParams *theParams, void *theState);
+Boolean						QTNative_EffectHasState (const NativeEffectParams *theParams);
+
+void						QTNative_InitEffectParams (NativeEffectParams *theParams, OSType theEffectType);
+OSErr						QTNative_SetEffectParam (NativeEffectParams *theParams, OSType theName, long theValue);
+long						QTNative_GetEffectParam (const NativeEffectParams *theParams, OSType theName, long theDefault);
+
+OSErr						QTNative_NewPixelBuffer (NativePixelBuffer *theBuffer, long theWidth, long theHeight, OSType thePixelFormat);
+void						QTNative_DisposePixelBuffer (NativePixelBuffer *theBuffer);
+OSErr						QTNative_CopyPixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest);
+long						QTNative_GetBytesPerPixel (OSType thePixelFormat);
+unsigned long				QTNative_GetPixel (const NativePixelBuffer *theBuffer, long theX, long theY);
+void						QTNative_SetPixel (NativePixelBuffer *theBuffer, long theX, long theY, unsigned long theARGB);
+
+#endif	// __QTNativeEffects__
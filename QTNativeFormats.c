@@ -0,0 +1,401 @@
+//////////
+//
+//	File:		QTNativeFormats.c
+//
+//	Contains:	Pixel format templates and specialized span kernels for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	10/17/26	rtm		added AVX2 versions of the conversion kernels, which QTNative_GetSpanKernels returns
+//									when the AVX2 kernels are in use
+//	   <3>	 	10/17/26	rtm		added 32-bit RGBA (the byte order of PAM files and most raw frame dumps)
+//	   <2>	 	10/17/26	rtm		added QTNative_GetHostPixelFormat
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This file instantiates the span kernels for every pair of source and destination pixel formats listed in
+//	QTNativeFormats.h, and collects them in tables indexed by format. Each kernel has the pixel formats built
+//	in, so its inner loop has no tests or function calls that depend on the format.
+//
+//	The conversion kernels also come in AVX2 versions, built from the same list of formats: each one loads 8
+//	pixels, turns them into 0xAARRGGBB values in the lanes of a vector (NATIVE_VECTOR_LOAD_F), and writes those
+//	in the destination format (NATIVE_VECTOR_STORE_F), with the byte shuffles and shifts that the scalar
+//	templates do one pixel at a time; the pixels left over at the end of a span are done by the scalar
+//	templates. The two versions produce exactly the same bytes.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeFormats.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// kernel templates
+//
+//////////
+
+#define NATIVE_DEFINE_SPAN_KERNELS(theSrc, theDest)																	\
+static void QTNative_ConvertSpan_##theSrc##_##theDest (const unsigned char *theSrcPtr, unsigned char *theDestPtr,	\
+														long theCount, const unsigned long *theColorTable)			\
+{																													\
+	long				myX;																						\
+																													\
+	(void)theColorTable;																							\
+	for (myX = 0; myX < theCount; myX++) {																			\
+		unsigned long	myPixel = NATIVE_LOAD_##theSrc(theSrcPtr, theColorTable);									\
+																													\
+		NATIVE_STORE_##theDest(theDestPtr, myPixel);																\
+		theSrcPtr += NATIVE_BPP_##theSrc;																			\
+		theDestPtr += NATIVE_BPP_##theDest;																			\
+	}																												\
+}																													\
+																													\
+static void QTNative_BlendSpan_##theSrc##_##theDest (const unsigned char *theSrcPtrA, const unsigned char *theSrcPtrB,	\
+														unsigned char *theDestPtr, long theCount, long theAmount,	\
+														const unsigned long *theColorTableA,						\
+														const unsigned long *theColorTableB)						\
+{																													\
+	long				myX;																						\
+																													\
+	(void)theColorTableA;																							\
+	(void)theColorTableB;																							\
+	for (myX = 0; myX < theCount; myX++) {																			\
+		unsigned long	myPixelA = NATIVE_LOAD_##theSrc(theSrcPtrA, theColorTableA);								\
+		unsigned long	myPixelB = NATIVE_LOAD_##theSrc(theSrcPtrB, theColorTableB);								\
+		unsigned long	myPixel = NATIVE_BLEND_PIXELS(myPixelA, myPixelB, theAmount);								\
+																													\
+		NATIVE_STORE_##theDest(theDestPtr, myPixel);																\
+		theSrcPtrA += NATIVE_BPP_##theSrc;																			\
+		theSrcPtrB += NATIVE_BPP_##theSrc;																			\
+		theDestPtr += NATIVE_BPP_##theDest;																			\
+	}																												\
+}
+
+#define NATIVE_DEFINE_FILL_KERNEL(theDest)																			\
+static void QTNative_FillSpan_##theDest (unsigned char *theDestPtr, long theCount, unsigned long thePixel)			\
+{																													\
+	long				myX;																						\
+																													\
+	for (myX = 0; myX < theCount; myX++) {																			\
+		NATIVE_STORE_##theDest(theDestPtr, thePixel);																\
+		theDestPtr += NATIVE_BPP_##theDest;																			\
+	}																												\
+}
+
+#define NATIVE_DEFINE_KERNELS_FOR_DEST(theDest)		NATIVE_SOURCE_FORMATS(NATIVE_DEFINE_SPAN_KERNELS, theDest) NATIVE_DEFINE_FILL_KERNEL(theDest)
+
+#define NATIVE_KERNEL_ENTRY(theSrc, theDest)		{QTNative_ConvertSpan_##theSrc##_##theDest, QTNative_BlendSpan_##theSrc##_##theDest, NATIVE_BPP_##theSrc, NATIVE_BPP_##theDest},
+#define NATIVE_KERNEL_ROW(theDest)					{NATIVE_SOURCE_FORMATS(NATIVE_KERNEL_ENTRY, theDest)},
+#define NATIVE_FILL_ENTRY(theDest)					QTNative_FillSpan_##theDest,
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// vector kernel templates
+//
+// Each NATIVE_VECTOR_LOAD_F reads 8 pixels at thePtr into a vector of 0xAARRGGBB values; a few read a little
+// past the 8 pixels, so a kernel stops its vector loop NATIVE_VECTOR_SLACK_F pixels short of the end of the span.
+// Each NATIVE_VECTOR_STORE_F writes a vector of 8 0xAARRGGBB values at thePtr. (AVX2 processors are all
+// little-endian, so a 0xAARRGGBB value in memory is B, G, R, A.)
+//
+//////////
+
+#define NATIVE_VECTOR_SLACK_8Indexed		0
+#define NATIVE_VECTOR_SLACK_16BE555			0
+#define NATIVE_VECTOR_SLACK_16LE555			0
+#define NATIVE_VECTOR_SLACK_16LE565			0
+#define NATIVE_VECTOR_SLACK_24RGB			2				// the upper 4 pixels are loaded with 16 bytes starting at byte 12
+#define NATIVE_VECTOR_SLACK_32ARGB			0
+#define NATIVE_VECTOR_SLACK_32BGRA			0
+#define NATIVE_VECTOR_SLACK_32RGBA			0
+
+#define NATIVE_VECTOR_LOAD_8Indexed(thePtr, theColorTable)		QTNative_VectorLoad8Indexed((thePtr), (theColorTable))
+#define NATIVE_VECTOR_LOAD_16BE555(thePtr, theColorTable)		QTNative_VectorExpand555(_mm256_cvtepu16_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(thePtr)), \
+																	_mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14))))
+#define NATIVE_VECTOR_LOAD_16LE555(thePtr, theColorTable)		QTNative_VectorExpand555(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(thePtr))))
+#define NATIVE_VECTOR_LOAD_16LE565(thePtr, theColorTable)		QTNative_VectorExpand565(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(thePtr))))
+#define NATIVE_VECTOR_LOAD_24RGB(thePtr, theColorTable)			QTNative_VectorLoad24RGB(thePtr)
+#define NATIVE_VECTOR_LOAD_32ARGB(thePtr, theColorTable)		_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(thePtr)), NATIVE_SWAP_ARGB)
+#define NATIVE_VECTOR_LOAD_32BGRA(thePtr, theColorTable)		_mm256_loadu_si256((const __m256i *)(thePtr))
+#define NATIVE_VECTOR_LOAD_32RGBA(thePtr, theColorTable)		_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(thePtr)), NATIVE_SWAP_RGBA)
+
+#define NATIVE_VECTOR_STORE_16BE555(thePtr, thePixels)			_mm_storeu_si128((__m128i *)(thePtr), _mm_shuffle_epi8(QTNative_VectorPack16(QTNative_VectorPack555(thePixels)), \
+																	_mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)))
+#define NATIVE_VECTOR_STORE_16LE555(thePtr, thePixels)			_mm_storeu_si128((__m128i *)(thePtr), QTNative_VectorPack16(QTNative_VectorPack555(thePixels)))
+#define NATIVE_VECTOR_STORE_16LE565(thePtr, thePixels)			_mm_storeu_si128((__m128i *)(thePtr), QTNative_VectorPack16(QTNative_VectorPack565(thePixels)))
+#define NATIVE_VECTOR_STORE_24RGB(thePtr, thePixels)			QTNative_VectorStore24RGB((thePtr), (thePixels))
+#define NATIVE_VECTOR_STORE_32ARGB(thePtr, thePixels)			_mm256_storeu_si256((__m256i *)(thePtr), _mm256_shuffle_epi8((thePixels), NATIVE_SWAP_ARGB))
+#define NATIVE_VECTOR_STORE_32BGRA(thePtr, thePixels)			_mm256_storeu_si256((__m256i *)(thePtr), (thePixels))
+#define NATIVE_VECTOR_STORE_32RGBA(thePtr, thePixels)			_mm256_storeu_si256((__m256i *)(thePtr), _mm256_shuffle_epi8((thePixels), NATIVE_SWAP_RGBA))
+
+// the byte shuffles between 0xAARRGGBB values and the 32-bit ARGB and RGBA formats (each is its own inverse)
+#define NATIVE_SWAP_ARGB					_mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, \
+																3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+#define NATIVE_SWAP_RGBA					_mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, \
+																2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)
+
+#define NATIVE_DEFINE_VECTOR_SPAN_KERNEL(theSrc, theDest)															\
+NATIVE_TARGET("avx2")																								\
+static void QTNative_ConvertSpanAVX2_##theSrc##_##theDest (const unsigned char *theSrcPtr, unsigned char *theDestPtr,	\
+														long theCount, const unsigned long *theColorTable)			\
+{																													\
+	long				myX;																						\
+																													\
+	(void)theColorTable;																							\
+	for (myX = 0; myX + 8 + NATIVE_VECTOR_SLACK_##theSrc <= theCount; myX += 8) {									\
+		__m256i			myPixels = NATIVE_VECTOR_LOAD_##theSrc(theSrcPtr, theColorTable);							\
+																													\
+		NATIVE_VECTOR_STORE_##theDest(theDestPtr, myPixels);														\
+		theSrcPtr += 8 * NATIVE_BPP_##theSrc;																		\
+		theDestPtr += 8 * NATIVE_BPP_##theDest;																		\
+	}																												\
+																													\
+	for (; myX < theCount; myX++) {																					\
+		unsigned long	myPixel = NATIVE_LOAD_##theSrc(theSrcPtr, theColorTable);									\
+																													\
+		NATIVE_STORE_##theDest(theDestPtr, myPixel);																\
+		theSrcPtr += NATIVE_BPP_##theSrc;																			\
+		theDestPtr += NATIVE_BPP_##theDest;																			\
+	}																												\
+}
+
+#define NATIVE_DEFINE_VECTOR_KERNELS_FOR_DEST(theDest)	NATIVE_SOURCE_FORMATS(NATIVE_DEFINE_VECTOR_SPAN_KERNEL, theDest)
+
+#define NATIVE_VECTOR_KERNEL_ENTRY(theSrc, theDest)	QTNative_ConvertSpanAVX2_##theSrc##_##theDest,
+#define NATIVE_VECTOR_KERNEL_ROW(theDest)			{NATIVE_SOURCE_FORMATS(NATIVE_VECTOR_KERNEL_ENTRY, theDest)},
+
+
+//////////
+//
+// vector helpers
+//
+//////////
+
+// read 8 indexed pixels; without a color table they're gray levels
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorLoad8Indexed (const unsigned char *thePtr, const unsigned long *theColorTable)
+{
+	__m256i				myIndexes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)thePtr));
+
+	if (theColorTable == NULL)
+		return(_mm256_or_si256(_mm256_mullo_epi32(myIndexes, _mm256_set1_epi32(0x010101)), _mm256_set1_epi32((int)kNativeOpaqueBlackPixel)));
+
+	// the low 32 bits of each entry (which come first, on a little-endian processor) hold the whole color
+	return(_mm256_i32gather_epi32((const int *)theColorTable, myIndexes, sizeof(unsigned long)));
+}
+
+// expand 16-bit pixels (zero-extended to 32 bits) exactly as QTNative_Expand555 and QTNative_Expand565 do
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorExpand555 (__m256i thePixels)
+{
+	__m256i				myRed = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 9), _mm256_set1_epi32(0xF80000)),
+												_mm256_and_si256(_mm256_slli_epi32(thePixels, 4), _mm256_set1_epi32(0x070000)));
+	__m256i				myGreen = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 6), _mm256_set1_epi32(0xF800)),
+												  _mm256_and_si256(_mm256_slli_epi32(thePixels, 1), _mm256_set1_epi32(0x0700)));
+	__m256i				myBlue = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 3), _mm256_set1_epi32(0xF8)),
+												 _mm256_and_si256(_mm256_srli_epi32(thePixels, 2), _mm256_set1_epi32(0x07)));
+
+	return(_mm256_or_si256(_mm256_or_si256(myRed, myGreen), _mm256_or_si256(myBlue, _mm256_set1_epi32((int)kNativeOpaqueBlackPixel))));
+}
+
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorExpand565 (__m256i thePixels)
+{
+	__m256i				myRed = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 8), _mm256_set1_epi32(0xF80000)),
+												_mm256_and_si256(_mm256_slli_epi32(thePixels, 3), _mm256_set1_epi32(0x070000)));
+	__m256i				myGreen = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 5), _mm256_set1_epi32(0xFC00)),
+												  _mm256_and_si256(_mm256_srli_epi32(thePixels, 1), _mm256_set1_epi32(0x0300)));
+	__m256i				myBlue = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(thePixels, 3), _mm256_set1_epi32(0xF8)),
+												 _mm256_and_si256(_mm256_srli_epi32(thePixels, 2), _mm256_set1_epi32(0x07)));
+
+	return(_mm256_or_si256(_mm256_or_si256(myRed, myGreen), _mm256_or_si256(myBlue, _mm256_set1_epi32((int)kNativeOpaqueBlackPixel))));
+}
+
+// read 8 24-bit pixels (and 4 bytes beyond them): the lower half of the vector gets bytes 0-15, the upper half
+// bytes 12-27, and each half then picks out its 4 pixels
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorLoad24RGB (const unsigned char *thePtr)
+{
+	__m256i				myBytes = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)thePtr)),
+														  _mm_loadu_si128((const __m128i *)(thePtr + 12)), 1);
+	__m256i				myShuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+													 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+
+	return(_mm256_or_si256(_mm256_shuffle_epi8(myBytes, myShuffle), _mm256_set1_epi32((int)kNativeOpaqueBlackPixel)));
+}
+
+// write 8 pixels as 24-bit pixels: each half of the vector packs its 4 pixels into 12 bytes, and the halves are
+// then moved together
+NATIVE_TARGET("avx2")
+NATIVE_INLINE void QTNative_VectorStore24RGB (unsigned char *thePtr, __m256i thePixels)
+{
+	__m256i				myShuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+													 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	__m256i				myPacked = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(thePixels, myShuffle), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+	_mm_storeu_si128((__m128i *)thePtr, _mm256_castsi256_si128(myPacked));
+	_mm_storel_epi64((__m128i *)(thePtr + 16), _mm256_extracti128_si256(myPacked, 1));
+}
+
+// pack 0xAARRGGBB values into 16-bit pixels (in the low 16 bits of each lane) exactly as the scalar templates do
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorPack555 (__m256i thePixels)
+{
+	return(_mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(thePixels, 9), _mm256_set1_epi32(0x7C00)),
+										   _mm256_and_si256(_mm256_srli_epi32(thePixels, 6), _mm256_set1_epi32(0x03E0))),
+						   _mm256_and_si256(_mm256_srli_epi32(thePixels, 3), _mm256_set1_epi32(0x001F))));
+}
+
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m256i QTNative_VectorPack565 (__m256i thePixels)
+{
+	return(_mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(thePixels, 8), _mm256_set1_epi32(0xF800)),
+										   _mm256_and_si256(_mm256_srli_epi32(thePixels, 5), _mm256_set1_epi32(0x07E0))),
+						   _mm256_and_si256(_mm256_srli_epi32(thePixels, 3), _mm256_set1_epi32(0x001F))));
+}
+
+// narrow 8 lanes of 16-bit values to 8 consecutive 16-bit values
+NATIVE_TARGET("avx2")
+NATIVE_INLINE __m128i QTNative_VectorPack16 (__m256i theValues)
+{
+	__m256i				myPacked = _mm256_packus_epi32(theValues, theValues);
+
+	return(_mm256_castsi256_si128(_mm256_permute4x64_epi64(myPacked, _MM_SHUFFLE(3, 1, 2, 0))));
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// kernels
+//
+//////////
+
+NATIVE_DEST_FORMATS(NATIVE_DEFINE_KERNELS_FOR_DEST)
+
+#if NATIVE_HAS_AVX2
+NATIVE_DEST_FORMATS(NATIVE_DEFINE_VECTOR_KERNELS_FOR_DEST)
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+// the span kernels, indexed by destination format and then by source format
+static const NativeSpanKernels		gNativeSpanKernels[kNativeNumDestFormats][kNativeNumSourceFormats] = {
+	NATIVE_DEST_FORMATS(NATIVE_KERNEL_ROW)
+};
+
+// the fill kernels, indexed by destination format
+static const NativeFillSpanProcPtr	gNativeFillKernels[kNativeNumDestFormats] = {
+	NATIVE_DEST_FORMATS(NATIVE_FILL_ENTRY)
+};
+
+#if NATIVE_HAS_AVX2
+// the AVX2 conversion kernels, indexed the same way
+static const NativeConvertSpanProcPtr	gNativeVectorSpanKernels[kNativeNumDestFormats][kNativeNumSourceFormats] = {
+	NATIVE_DEST_FORMATS(NATIVE_VECTOR_KERNEL_ROW)
+};
+#endif
+
+
+//////////
+//
+// QTNative_GetSourceFormatIndex
+// Return the position of the specified pixel format in NATIVE_SOURCE_FORMATS, or -1 if it's not there.
+// The position of a format in NATIVE_DEST_FORMATS is one less (since 8-bit indexed comes first).
+//
+//////////
+
+static short QTNative_GetSourceFormatIndex (OSType thePixelFormat)
+{
+	switch (thePixelFormat) {
+		case kNativePixelFormat_8Indexed:		return(0);
+		case kNativePixelFormat_16BE555:		return(1);
+		case kNativePixelFormat_16LE555:		return(2);
+		case kNativePixelFormat_16LE565:		return(3);
+		case kNativePixelFormat_24RGB:			return(4);
+		case kNativePixelFormat_32ARGB:			return(5);
+		case kNativePixelFormat_32BGRA:			return(6);
+		case kNativePixelFormat_32RGBA:			return(7);
+		default:								return(-1);
+	}
+}
+
+
+//////////
+//
+// QTNative_GetSpanKernels
+// Get the span kernels for the specified source and destination formats. Return false if there are none
+// (for instance, because the destination is an indexed format).
+//
+//////////
+
+Boolean QTNative_GetSpanKernels (OSType theSrcFormat, OSType theDestFormat, NativeSpanKernels *theKernels)
+{
+	short			mySrcIndex = QTNative_GetSourceFormatIndex(theSrcFormat);
+	short			myDestIndex = QTNative_GetSourceFormatIndex(theDestFormat) - 1;
+
+	if ((mySrcIndex < 0) || (myDestIndex < 0))
+		return(false);
+
+	*theKernels = gNativeSpanKernels[myDestIndex][mySrcIndex];
+
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		theKernels->fConvert = gNativeVectorSpanKernels[myDestIndex][mySrcIndex];
+#endif
+
+	return(true);
+}
+
+
+//////////
+//
+// QTNative_GetFillKernel
+// Return the fill kernel for the specified destination format, or NULL if there is none.
+//
+//////////
+
+NativeFillSpanProcPtr QTNative_GetFillKernel (OSType theDestFormat)
+{
+	short			myDestIndex = QTNative_GetSourceFormatIndex(theDestFormat) - 1;
+
+	if (myDestIndex < 0)
+		return(NULL);
+
+	return(gNativeFillKernels[myDestIndex]);
+}
+
+
+//////////
+//
+// QTNative_GetHostPixelFormat
+// Return the 32-bit pixel format whose pixels, read as unsigned ints, are 0xAARRGGBB values: 32-bit BGRA on
+// little-endian processors and 32-bit ARGB on big-endian ones. Effects that work on rows of unsigned ints
+// convert the source rows to this format and back.
+//
+//////////
+
+OSType QTNative_GetHostPixelFormat (void)
+{
+	unsigned int	myEndianTest = 0x01020304U;
+
+	return((*(unsigned char *)&myEndianTest == 0x04) ? kNativePixelFormat_32BGRA : kNativePixelFormat_32ARGB);
+}
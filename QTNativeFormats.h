@@ -0,0 +1,179 @@
+//////////
+//
+//	File:		QTNativeFormats.h
+//
+//	Contains:	Pixel format templates and specialized span kernels for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		added QTNative_GetRowAddress
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The source GWorlds have the depth of the screen, so the native effects can be asked to read 8-bit indexed,
+//	16-bit, 24-bit, or 32-bit pixels. Rather than switching on the pixel format for every pixel (as
+//	QTNative_GetPixel and QTNative_SetPixel do), the effects work on spans of pixels with kernels that are
+//	specialized for one source format and one destination format at compile time.
+//
+//	The macros in this file are the "templates": for each pixel format F there's NATIVE_BPP_F (the number of
+//	bytes per pixel), NATIVE_LOAD_F (read one pixel as 0xAARRGGBB), and, for the direct formats, NATIVE_STORE_F
+//	(write one pixel). NATIVE_SOURCE_FORMATS and NATIVE_DEST_FORMATS list the formats, so that QTNativeFormats.c
+//	can instantiate a kernel for every pair of formats. The effects look up the kernels they need once per band
+//	of rows, with QTNative_GetSpanKernels.
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeFormats__
+#define __QTNativeFormats__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// compiler macros
+//
+//////////
+
+#if defined(_MSC_VER)
+#define NATIVE_INLINE						static __inline
+#else
+#define NATIVE_INLINE						static __inline__
+#endif
+
+// the pixel formats we can read, and the pixel formats we can write; M is called as M(format, theArg)
+// (or M(format)), where format is the suffix of a kNativePixelFormat_ constant
+#define NATIVE_SOURCE_FORMATS(M, theArg)	M(8Indexed, theArg) M(16BE555, theArg) M(16LE555, theArg) M(16LE565, theArg) \
+											M(24RGB, theArg) M(32ARGB, theArg) M(32BGRA, theArg) M(32RGBA, theArg)
+#define NATIVE_DEST_FORMATS(M)				M(16BE555) M(16LE555) M(16LE565) M(24RGB) M(32ARGB) M(32BGRA) M(32RGBA)
+
+#define kNativeNumSourceFormats				8
+#define kNativeNumDestFormats				7
+
+#define kNativeOpaqueBlackPixel				0xFF000000UL
+
+
+//////////
+//
+// pixel format templates
+//
+//////////
+
+// expand 5- and 6-bit channels to 8 bits by replicating their high bits
+NATIVE_INLINE unsigned long QTNative_Expand555 (unsigned long thePixel)
+{
+	return(kNativeOpaqueBlackPixel |
+			((((thePixel >> 7) & 0xF8) | ((thePixel >> 12) & 0x07)) << 16) |
+			((((thePixel >> 2) & 0xF8) | ((thePixel >> 7) & 0x07)) << 8) |
+			(((thePixel << 3) & 0xF8) | ((thePixel >> 2) & 0x07)));
+}
+
+NATIVE_INLINE unsigned long QTNative_Expand565 (unsigned long thePixel)
+{
+	return(kNativeOpaqueBlackPixel |
+			((((thePixel >> 8) & 0xF8) | ((thePixel >> 13) & 0x07)) << 16) |
+			((((thePixel >> 3) & 0xFC) | ((thePixel >> 9) & 0x03)) << 8) |
+			(((thePixel << 3) & 0xF8) | ((thePixel >> 2) & 0x07)));
+}
+
+NATIVE_INLINE unsigned long QTNative_Expand8Indexed (unsigned char theIndex, const unsigned long *theColorTable)
+{
+	if (theColorTable != NULL)
+		return(theColorTable[theIndex]);
+
+	return(kNativeOpaqueBlackPixel | ((unsigned long)theIndex * 0x010101UL));
+}
+
+// return the address of a row of a buffer, given its row number in the whole frame; a buffer that holds only
+// some of the rows of a frame (such as a scratch buffer of a pipeline) starts with row fFirstRow
+NATIVE_INLINE unsigned char *QTNative_GetRowAddress (const NativePixelBuffer *theBuffer, long theRow)
+{
+	return(theBuffer->fBaseAddr + ((theRow - theBuffer->fFirstRow) * theBuffer->fRowBytes));
+}
+
+#define NATIVE_BPP_8Indexed					1
+#define NATIVE_BPP_16BE555					2
+#define NATIVE_BPP_16LE555					2
+#define NATIVE_BPP_16LE565					2
+#define NATIVE_BPP_24RGB					3
+#define NATIVE_BPP_32ARGB					4
+#define NATIVE_BPP_32BGRA					4
+#define NATIVE_BPP_32RGBA					4
+
+// read the pixel at thePtr, as 0xAARRGGBB
+#define NATIVE_LOAD_8Indexed(thePtr, theColorTable)		QTNative_Expand8Indexed((thePtr)[0], (theColorTable))
+#define NATIVE_LOAD_16BE555(thePtr, theColorTable)		QTNative_Expand555(((unsigned long)(thePtr)[0] << 8) | (thePtr)[1])
+#define NATIVE_LOAD_16LE555(thePtr, theColorTable)		QTNative_Expand555(((unsigned long)(thePtr)[1] << 8) | (thePtr)[0])
+#define NATIVE_LOAD_16LE565(thePtr, theColorTable)		QTNative_Expand565(((unsigned long)(thePtr)[1] << 8) | (thePtr)[0])
+#define NATIVE_LOAD_24RGB(thePtr, theColorTable)		(kNativeOpaqueBlackPixel | ((unsigned long)(thePtr)[0] << 16) | ((unsigned long)(thePtr)[1] << 8) | (thePtr)[2])
+#define NATIVE_LOAD_32ARGB(thePtr, theColorTable)		(((unsigned long)(thePtr)[0] << 24) | ((unsigned long)(thePtr)[1] << 16) | ((unsigned long)(thePtr)[2] << 8) | (thePtr)[3])
+#define NATIVE_LOAD_32BGRA(thePtr, theColorTable)		(((unsigned long)(thePtr)[3] << 24) | ((unsigned long)(thePtr)[2] << 16) | ((unsigned long)(thePtr)[1] << 8) | (thePtr)[0])
+#define NATIVE_LOAD_32RGBA(thePtr, theColorTable)		(((unsigned long)(thePtr)[3] << 24) | ((unsigned long)(thePtr)[0] << 16) | ((unsigned long)(thePtr)[1] << 8) | (thePtr)[2])
+
+// write thePixel (0xAARRGGBB) at thePtr
+#define NATIVE_STORE_16BE555(thePtr, thePixel)			do { unsigned long myPacked = (((thePixel) >> 9) & 0x7C00) | (((thePixel) >> 6) & 0x03E0) | (((thePixel) >> 3) & 0x001F); \
+															(thePtr)[0] = (unsigned char)(myPacked >> 8); (thePtr)[1] = (unsigned char)myPacked; } while (0)
+#define NATIVE_STORE_16LE555(thePtr, thePixel)			do { unsigned long myPacked = (((thePixel) >> 9) & 0x7C00) | (((thePixel) >> 6) & 0x03E0) | (((thePixel) >> 3) & 0x001F); \
+															(thePtr)[0] = (unsigned char)myPacked; (thePtr)[1] = (unsigned char)(myPacked >> 8); } while (0)
+#define NATIVE_STORE_16LE565(thePtr, thePixel)			do { unsigned long myPacked = (((thePixel) >> 8) & 0xF800) | (((thePixel) >> 5) & 0x07E0) | (((thePixel) >> 3) & 0x001F); \
+															(thePtr)[0] = (unsigned char)myPacked; (thePtr)[1] = (unsigned char)(myPacked >> 8); } while (0)
+#define NATIVE_STORE_24RGB(thePtr, thePixel)			do { (thePtr)[0] = (unsigned char)((thePixel) >> 16); (thePtr)[1] = (unsigned char)((thePixel) >> 8); \
+															(thePtr)[2] = (unsigned char)(thePixel); } while (0)
+#define NATIVE_STORE_32ARGB(thePtr, thePixel)			do { (thePtr)[0] = (unsigned char)((thePixel) >> 24); (thePtr)[1] = (unsigned char)((thePixel) >> 16); \
+															(thePtr)[2] = (unsigned char)((thePixel) >> 8); (thePtr)[3] = (unsigned char)(thePixel); } while (0)
+#define NATIVE_STORE_32BGRA(thePtr, thePixel)			do { (thePtr)[0] = (unsigned char)(thePixel); (thePtr)[1] = (unsigned char)((thePixel) >> 8); \
+															(thePtr)[2] = (unsigned char)((thePixel) >> 16); (thePtr)[3] = (unsigned char)((thePixel) >> 24); } while (0)
+#define NATIVE_STORE_32RGBA(thePtr, thePixel)			do { (thePtr)[0] = (unsigned char)((thePixel) >> 16); (thePtr)[1] = (unsigned char)((thePixel) >> 8); \
+															(thePtr)[2] = (unsigned char)(thePixel); (thePtr)[3] = (unsigned char)((thePixel) >> 24); } while (0)
+
+// blend two 0xAARRGGBB pixels, theAmount / 256 of the way from thePixelA to thePixelB; each channel is computed
+// as (a * (256 - theAmount) + b * theAmount) >> 8, exactly as the cross fade row kernels do
+#define NATIVE_BLEND_PIXELS(thePixelA, thePixelB, theAmount) \
+			((((((thePixelA) & 0x00FF00FFUL) * (256 - (theAmount))) + (((thePixelB) & 0x00FF00FFUL) * (theAmount))) >> 8) & 0x00FF00FFUL) | \
+			((((((thePixelA) >> 8) & 0x00FF00FFUL) * (256 - (theAmount))) + ((((thePixelB) >> 8) & 0x00FF00FFUL) * (theAmount))) & 0xFF00FF00UL)
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// copy theCount pixels from theSrc to theDest, converting them from one pixel format to another
+typedef void (*NativeConvertSpanProcPtr) (const unsigned char *theSrc, unsigned char *theDest, long theCount, const unsigned long *theColorTable);
+
+// blend theCount pixels of theSrcA and theSrcB (which have the same pixel format) into theDest
+typedef void (*NativeBlendSpanProcPtr) (const unsigned char *theSrcA, const unsigned char *theSrcB, unsigned char *theDest, long theCount, long theAmount, const unsigned long *theColorTableA, const unsigned long *theColorTableB);
+
+// set theCount pixels of theDest to thePixel (0xAARRGGBB)
+typedef void (*NativeFillSpanProcPtr) (unsigned char *theDest, long theCount, unsigned long thePixel);
+
+// the kernels for one pair of source and destination formats
+typedef struct {
+	NativeConvertSpanProcPtr	fConvert;
+	NativeBlendSpanProcPtr		fBlend;
+	long						fSrcBytesPerPixel;
+	long						fDestBytesPerPixel;
+} NativeSpanKernels;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+Boolean						QTNative_GetSpanKernels (OSType theSrcFormat, OSType theDestFormat, NativeSpanKernels *theKernels);
+NativeFillSpanProcPtr		QTNative_GetFillKernel (OSType theDestFormat);
+OSType						QTNative_GetHostPixelFormat (void);
+
+#endif	// __QTNativeFormats__
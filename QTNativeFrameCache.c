@@ -0,0 +1,392 @@
+//////////
+//
+//	File:		QTNativeFrameCache.c
+//
+//	Contains:	A memory-limited cache of rendered effect steps.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		keys are compared in full (the effect description byte for byte, and the sources by identity
+//									and generation), so a hash collision can no longer show a stale step
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	When an effect is played in a loop, the same steps are rendered over and over again. This file keeps
+//	copies of rendered steps so that they can be shown again without being rendered again.
+//
+//	A cached step is found by a NativeFrameKey, which holds everything that determines its pixels: the effect
+//	and its parameters, the contents of the sources, the step number and number of steps, and the size and
+//	format of the frame. The effect is identified by the bytes of its effect description, which the cache copies
+//	and compares in full (a hash value from QTNative_GetEffectParamsKey just tells most keys apart quickly); a source
+//	is identified by the caller's object for it and a generation number that the caller changes whenever it puts
+//	new pixels in the source. So when the user changes the parameters or picks a new picture, the keys change and
+//	the old steps are simply never found again; they are discarded as room is needed.
+//
+//	The cache holds at most a fixed number of bytes of pixels; when adding a step would go over that limit,
+//	we discard the least recently used steps first. The cache is not thread-safe; it should be used only
+//	from the main thread.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeFrameCache.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the parameters of the FNV-1a hash function
+#define kNativeHashOffsetBasis			2166136261UL
+#define kNativeHashPrime				16777619UL
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a cached step
+typedef struct NativeCachedFrame {
+	NativeFrameKey					fKey;
+	NativePixelBuffer				fFrame;
+	struct NativeCachedFrame *		fPrev;					// the next more recently used step
+	struct NativeCachedFrame *		fNext;					// the next less recently used step
+} NativeCachedFrame;
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeCachedFrame *			gNativeCacheHead = NULL;				// the most recently used step
+static NativeCachedFrame *			gNativeCacheTail = NULL;				// the least recently used step
+static long							gNativeCacheBytes = 0;					// the number of bytes of pixels in the cache
+static long							gNativeCacheLimit = kNativeDefaultFrameCacheSize;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Cache list functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_UnlinkCachedFrame
+// Remove the specified step from the list of cached steps.
+//
+//////////
+
+static void QTNative_UnlinkCachedFrame (NativeCachedFrame *theEntry)
+{
+	if (theEntry->fPrev != NULL)
+		theEntry->fPrev->fNext = theEntry->fNext;
+	else
+		gNativeCacheHead = theEntry->fNext;
+
+	if (theEntry->fNext != NULL)
+		theEntry->fNext->fPrev = theEntry->fPrev;
+	else
+		gNativeCacheTail = theEntry->fPrev;
+
+	theEntry->fPrev = NULL;
+	theEntry->fNext = NULL;
+}
+
+
+//////////
+//
+// QTNative_LinkCachedFrame
+// Add the specified step to the front (the most recently used end) of the list of cached steps.
+//
+//////////
+
+static void QTNative_LinkCachedFrame (NativeCachedFrame *theEntry)
+{
+	theEntry->fPrev = NULL;
+	theEntry->fNext = gNativeCacheHead;
+
+	if (gNativeCacheHead != NULL)
+		gNativeCacheHead->fPrev = theEntry;
+	else
+		gNativeCacheTail = theEntry;
+
+	gNativeCacheHead = theEntry;
+}
+
+
+//////////
+//
+// QTNative_DisposeCachedFrame
+// Remove the specified step from the cache and dispose of it.
+//
+//////////
+
+static void QTNative_DisposeCachedFrame (NativeCachedFrame *theEntry)
+{
+	QTNative_UnlinkCachedFrame(theEntry);
+
+	gNativeCacheBytes -= theEntry->fFrame.fRowBytes * theEntry->fFrame.fHeight;
+
+	QTNative_DisposePixelBuffer(&theEntry->fFrame);
+	free((void *)theEntry->fKey.fEffectDesc);
+	free(theEntry);
+}
+
+
+//////////
+//
+// QTNative_TrimFrameCache
+// Discard the least recently used steps until the cache holds no more than the specified number of bytes.
+//
+//////////
+
+static void QTNative_TrimFrameCache (long theNumBytes)
+{
+	while ((gNativeCacheTail != NULL) && (gNativeCacheBytes > theNumBytes))
+		QTNative_DisposeCachedFrame(gNativeCacheTail);
+}
+
+
+//////////
+//
+// QTNative_EqualFrameKeys
+// Are the specified keys the same?
+//
+//////////
+
+static Boolean QTNative_EqualFrameKeys (const NativeFrameKey *theKey1, const NativeFrameKey *theKey2)
+{
+	short		myIndex;
+
+	if ((theKey1->fEffectKey != theKey2->fEffectKey) ||
+		(theKey1->fEffectDescSize != theKey2->fEffectDescSize) ||
+		(theKey1->fStep != theKey2->fStep) ||
+		(theKey1->fNumberOfSteps != theKey2->fNumberOfSteps) ||
+		(theKey1->fWidth != theKey2->fWidth) ||
+		(theKey1->fHeight != theKey2->fHeight) ||
+		(theKey1->fPixelFormat != theKey2->fPixelFormat))
+		return(false);
+
+	for (myIndex = 0; myIndex < kNativeMaxSources; myIndex++)
+		if ((theKey1->fSourceIDs[myIndex] != theKey2->fSourceIDs[myIndex]) || (theKey1->fSourceGenerations[myIndex] != theKey2->fSourceGenerations[myIndex]))
+			return(false);
+
+	// a hash value can collide, so compare the effect descriptions themselves
+	if (theKey1->fEffectDescSize > 0)
+		if (memcmp(theKey1->fEffectDesc, theKey2->fEffectDesc, theKey1->fEffectDescSize) != 0)
+			return(false);
+
+	return(true);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Frame cache functions.
+//
+// Use these functions to add rendered steps to the cache and to find them again.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_SetFrameCacheLimit
+// Set the maximum number of bytes of pixels that the cache may hold; 0 turns the cache off.
+//
+//////////
+
+void QTNative_SetFrameCacheLimit (long theNumBytes)
+{
+	gNativeCacheLimit = (theNumBytes < 0) ? 0 : theNumBytes;
+	QTNative_TrimFrameCache(gNativeCacheLimit);
+}
+
+
+//////////
+//
+// QTNative_GetFrameCacheLimit
+// Return the maximum number of bytes of pixels that the cache may hold.
+//
+//////////
+
+long QTNative_GetFrameCacheLimit (void)
+{
+	return(gNativeCacheLimit);
+}
+
+
+//////////
+//
+// QTNative_FlushFrameCache
+// Discard all the cached steps.
+//
+//////////
+
+void QTNative_FlushFrameCache (void)
+{
+	QTNative_TrimFrameCache(0);
+}
+
+
+//////////
+//
+// QTNative_FindCachedFrame
+// Return the cached step with the specified key, or NULL if there is none.
+//
+// The returned buffer belongs to the cache; it remains valid until the next call to QTNative_AddCachedFrame,
+// QTNative_SetFrameCacheLimit, or QTNative_FlushFrameCache.
+//
+//////////
+
+const NativePixelBuffer *QTNative_FindCachedFrame (const NativeFrameKey *theKey)
+{
+	NativeCachedFrame		*myEntry;
+
+	for (myEntry = gNativeCacheHead; myEntry != NULL; myEntry = myEntry->fNext) {
+		if (QTNative_EqualFrameKeys(&myEntry->fKey, theKey)) {
+			// move the step to the front of the list, since it's now the most recently used
+			if (myEntry != gNativeCacheHead) {
+				QTNative_UnlinkCachedFrame(myEntry);
+				QTNative_LinkCachedFrame(myEntry);
+			}
+
+			return(&myEntry->fFrame);
+		}
+	}
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTNative_AddCachedFrame
+// Add a copy of the specified rendered step to the cache, discarding older steps if necessary.
+//
+// It's not an error for a step not to be cached (for instance, because it's larger than the limit).
+//
+//////////
+
+OSErr QTNative_AddCachedFrame (const NativeFrameKey *theKey, const NativePixelBuffer *theFrame)
+{
+	NativeCachedFrame		*myEntry = NULL;
+	long					myNumBytes;
+	OSErr					myErr = noErr;
+
+	if ((theKey->fWidth != theFrame->fWidth) || (theKey->fHeight != theFrame->fHeight) || (theKey->fPixelFormat != theFrame->fPixelFormat))
+		return(paramErr);
+
+	if ((theKey->fEffectDescSize < 0) || ((theKey->fEffectDescSize > 0) && (theKey->fEffectDesc == NULL)))
+		return(paramErr);
+
+	// if we already have this step, there's nothing to add
+	if (QTNative_FindCachedFrame(theKey) != NULL)
+		return(noErr);
+
+	myEntry = (NativeCachedFrame *)calloc(1, sizeof(NativeCachedFrame));
+	if (myEntry == NULL)
+		return(memFullErr);
+
+	myErr = QTNative_NewPixelBuffer(&myEntry->fFrame, theFrame->fWidth, theFrame->fHeight, theFrame->fPixelFormat);
+	if (myErr != noErr)
+		goto bail;
+
+	myNumBytes = myEntry->fFrame.fRowBytes * myEntry->fFrame.fHeight;
+	if (myNumBytes > gNativeCacheLimit)
+		goto bail;
+
+	// the caller's effect description may change or go away, so keep our own copy of it
+	myEntry->fKey = *theKey;
+	myEntry->fKey.fEffectDesc = NULL;
+	if (theKey->fEffectDescSize > 0) {
+		myEntry->fKey.fEffectDesc = malloc(theKey->fEffectDescSize);
+		if (myEntry->fKey.fEffectDesc == NULL) {
+			myErr = memFullErr;
+			goto bail;
+		}
+
+		memcpy((void *)myEntry->fKey.fEffectDesc, theKey->fEffectDesc, theKey->fEffectDescSize);
+	}
+
+	// make room for the new step
+	QTNative_TrimFrameCache(gNativeCacheLimit - myNumBytes);
+
+	myEntry->fFrame.fColorTable = theFrame->fColorTable;
+	QTNative_CopyPixelBuffer(theFrame, &myEntry->fFrame);
+
+	QTNative_LinkCachedFrame(myEntry);
+	gNativeCacheBytes += myNumBytes;
+
+	return(noErr);
+
+bail:
+	QTNative_DisposePixelBuffer(&myEntry->fFrame);
+	free((void *)myEntry->fKey.fEffectDesc);
+	free(myEntry);
+
+	return(myErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Key functions.
+//
+// Use these functions to compute the parts of a NativeFrameKey.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_HashBytes
+// Add the specified bytes to a hash value. Pass 0 as theHash to start a new hash value.
+//
+//////////
+
+unsigned long QTNative_HashBytes (const void *theData, long theLength, unsigned long theHash)
+{
+	const unsigned char		*myPtr = (const unsigned char *)theData;
+	long					myIndex;
+
+	if (theHash == 0)
+		theHash = kNativeHashOffsetBasis;
+
+	for (myIndex = 0; myIndex < theLength; myIndex++)
+		theHash = ((theHash ^ myPtr[myIndex]) * kNativeHashPrime) & 0xFFFFFFFFUL;
+
+	return(theHash);
+}
+
+
+//////////
+//
+// QTNative_GetEffectParamsKey
+// Return a hash value that identifies the specified effect and its parameters (but not the step).
+//
+//////////
+
+unsigned long QTNative_GetEffectParamsKey (const NativeEffectParams *theParams)
+{
+	unsigned long			myHash = 0;
+	short					myIndex;
+
+	myHash = QTNative_HashBytes(&theParams->fEffectType, sizeof(theParams->fEffectType), myHash);
+	for (myIndex = 0; myIndex < theParams->fNumParams; myIndex++) {
+		myHash = QTNative_HashBytes(&theParams->fParams[myIndex].fName, sizeof(theParams->fParams[myIndex].fName), myHash);
+		myHash = QTNative_HashBytes(&theParams->fParams[myIndex].fValue, sizeof(theParams->fParams[myIndex].fValue), myHash);
+	}
+
+	return(myHash);
+}
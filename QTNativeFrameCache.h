@@ -0,0 +1,76 @@
+//////////
+//
+//	File:		QTNativeFrameCache.h
+//
+//	Contains:	A memory-limited cache of rendered effect steps.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		a key holds the bytes of the effect description, and identifies each source by the caller's
+//									object and a generation number, instead of by hash values alone
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeFrameCache__
+#define __QTNativeFrameCache__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeDefaultFrameCacheSize		(32L * 1024L * 1024L)		// the default limit on the memory used by cached frames
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// everything that determines the pixels of a rendered step
+typedef struct {
+	const void *			fEffectDesc;					// the bytes of the effect description (the cache keeps a copy)
+	long					fEffectDescSize;
+	unsigned long			fEffectKey;						// a hash value of the effect and its parameters, to tell most keys apart quickly
+	const void *			fSourceIDs[kNativeMaxSources];	// identify the sources (by the caller's objects, such as GWorlds)
+	unsigned long			fSourceGenerations[kNativeMaxSources];	// change whenever the pixels of a source change
+	long					fStep;
+	long					fNumberOfSteps;
+	long					fWidth;
+	long					fHeight;
+	OSType					fPixelFormat;
+} NativeFrameKey;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void						QTNative_SetFrameCacheLimit (long theNumBytes);
+long						QTNative_GetFrameCacheLimit (void);
+void						QTNative_FlushFrameCache (void);
+const NativePixelBuffer *	QTNative_FindCachedFrame (const NativeFrameKey *theKey);
+OSErr						QTNative_AddCachedFrame (const NativeFrameKey *theKey, const NativePixelBuffer *theFrame);
+
+unsigned long				QTNative_HashBytes (const void *theData, long theLength, unsigned long theHash);
+unsigned long				QTNative_GetEffectParamsKey (const NativeEffectParams *theParams);
+
+#endif	// __QTNativeFrameCache__
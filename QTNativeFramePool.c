@@ -0,0 +1,368 @@
+//////////
+//
+//	File:		QTNativeFramePool.c
+//
+//	Contains:	A pool of aligned memory blocks for frames and scratch rows, so that rendering doesn't allocate
+//				from the heap for every frame.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	Rendering a step allocates the same buffers over and over: the steps of a batch, the intermediate frames
+//	of an effect graph, the scratch rows of each band. Large blocks come straight from the system (and go back
+//	to it when they're freed), so each one costs a round of page faults as well as the allocation itself. This
+//	file keeps the blocks that are freed and hands them out again, so that once playback or an export has warmed
+//	up, it doesn't allocate any memory at all.
+//
+//	Blocks are grouped into size classes, four to each power of 2 (256, 320, 384, 448, 512, 640 bytes, and so on),
+//	so a request is rounded up by at most a quarter; a freed block goes onto the free list for its class, and a
+//	request takes the most recently freed block of its class (whose pages are most likely to be in the cache).
+//	The free blocks hold at most a fixed number of bytes; a block that would go over that limit is given back
+//	to the system. Blocks larger than the largest class aren't kept at all.
+//
+//	Every block starts on a kNativePoolAlignment (64-byte) boundary, which is the size of a cache line and
+//	more than any vector kernel needs. A few bytes just before each block record its size class and where it was
+//	really allocated. QTNative_GetPoolRowBytes pads the rows of a frame to a multiple of kNativePoolAlignment too,
+//	and steers clear of row lengths that are multiples of 4096 bytes: with those, a column of pixels falls into
+//	a single set of the processor's cache, so passes that walk down columns (like the vertical pass of the
+//	resampler) keep evicting their own rows.
+//
+//	The free lists are protected by a lock, so blocks may be allocated and freed on any thread. Before
+//	QTNative_StartFramePool (and after QTNative_StopFramePool), blocks are still aligned, but freed blocks go
+//	straight back to the system.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeFramePool.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeMinClassShift			8				// the smallest size class is 2^8 bytes
+#define kNativeMaxClassShift			28				// and the largest is 2^28 bytes
+#define kNativeNumSizeClasses			(((kNativeMaxClassShift - kNativeMinClassShift) * 4) + 1)
+#define kNativeUnpooledClass			-1				// the class of a block too large to keep
+#define kNativeCacheSetStride			4096			// row lengths to avoid (see above)
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the bookkeeping for a block, which sits in the kNativePoolAlignment bytes just before the block
+typedef struct NativePoolHeader {
+	void *						fAllocation;				// the address returned by malloc
+	long						fClass;						// the size class, or kNativeUnpooledClass
+	long						fSize;						// the usable size of the block
+	struct NativePoolHeader *	fNext;						// the next free block of the same class
+} NativePoolHeader;
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeLock					gNativeFramePoolLock;				// protects everything below
+static NativePoolHeader *			gNativeFreeBlocks[kNativeNumSizeClasses];
+static long							gNativeFreeBytes = 0;				// the number of bytes in free blocks
+static long							gNativeFramePoolLimit = kNativeDefaultFramePoolSize;
+static Boolean						gNativeFramePoolStarted = false;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Size class functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetSizeClass
+// Return the size class for a block of the specified number of bytes, and the size of the blocks of that
+// class through theClassSize; return kNativeUnpooledClass (and theNumBytes) if the block is too large to keep.
+//
+//////////
+
+static long QTNative_GetSizeClass (long theNumBytes, long *theClassSize)
+{
+	long						myShift = kNativeMinClassShift;
+	long						myQuarter;
+	long						myStep;
+
+	if (theNumBytes <= (1L << kNativeMinClassShift)) {
+		*theClassSize = 1L << kNativeMinClassShift;
+		return(0);
+	}
+
+	// find the power of 2 just below the size: 2^myShift < theNumBytes <= 2^(myShift + 1)
+	while ((myShift < kNativeMaxClassShift) && ((1L << (myShift + 1)) < theNumBytes))
+		myShift++;
+
+	if (myShift >= kNativeMaxClassShift) {
+		*theClassSize = theNumBytes;
+		return(kNativeUnpooledClass);
+	}
+
+	// and then the quarter of the way to the next power of 2
+	myQuarter = 1L << (myShift - 2);
+	myStep = (theNumBytes - (1L << myShift) + myQuarter - 1) / myQuarter;
+
+	*theClassSize = (1L << myShift) + (myStep * myQuarter);
+	return(((myShift - kNativeMinClassShift) * 4) + myStep);
+}
+
+
+//////////
+//
+// QTNative_TrimFramePool
+// Give free blocks back to the system, largest first, until the free blocks hold no more than the specified
+// number of bytes.
+//
+//////////
+
+static void QTNative_TrimFramePool (long theNumBytes)
+{
+	NativePoolHeader			*myDoomed = NULL;
+	NativePoolHeader			*myHeader = NULL;
+	long						myClass;
+
+	if (!gNativeFramePoolStarted)
+		return;
+
+	QTNative_Lock(&gNativeFramePoolLock);
+
+	for (myClass = kNativeNumSizeClasses - 1; (myClass >= 0) && (gNativeFreeBytes > theNumBytes); myClass--) {
+		while ((gNativeFreeBlocks[myClass] != NULL) && (gNativeFreeBytes > theNumBytes)) {
+			myHeader = gNativeFreeBlocks[myClass];
+			gNativeFreeBlocks[myClass] = myHeader->fNext;
+			gNativeFreeBytes -= myHeader->fSize;
+
+			myHeader->fNext = myDoomed;
+			myDoomed = myHeader;
+		}
+	}
+
+	QTNative_Unlock(&gNativeFramePoolLock);
+
+	// free the blocks without holding the lock
+	while (myDoomed != NULL) {
+		myHeader = myDoomed;
+		myDoomed = myHeader->fNext;
+		free(myHeader->fAllocation);
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Frame pool functions.
+//
+// Use these functions to allocate and free blocks, and to set up the pool.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_StartFramePool
+// Start keeping freed blocks for reuse. This must be called before any other threads use the pool.
+//
+//////////
+
+void QTNative_StartFramePool (void)
+{
+	if (gNativeFramePoolStarted)
+		return;
+
+	QTNative_InitLock(&gNativeFramePoolLock);
+	memset(gNativeFreeBlocks, 0, sizeof(gNativeFreeBlocks));
+	gNativeFreeBytes = 0;
+
+	gNativeFramePoolStarted = true;
+}
+
+
+//////////
+//
+// QTNative_StopFramePool
+// Give all the free blocks back to the system, and stop keeping freed blocks. No other threads may be using the
+// pool; blocks that are still in use may be freed later.
+//
+//////////
+
+void QTNative_StopFramePool (void)
+{
+	if (!gNativeFramePoolStarted)
+		return;
+
+	QTNative_TrimFramePool(0);
+
+	gNativeFramePoolStarted = false;
+	QTNative_DisposeLock(&gNativeFramePoolLock);
+}
+
+
+//////////
+//
+// QTNative_SetFramePoolLimit
+// Set the maximum number of bytes that the free blocks may hold; 0 turns the pool off.
+//
+//////////
+
+void QTNative_SetFramePoolLimit (long theNumBytes)
+{
+	gNativeFramePoolLimit = (theNumBytes < 0) ? 0 : theNumBytes;
+	QTNative_TrimFramePool(gNativeFramePoolLimit);
+}
+
+
+//////////
+//
+// QTNative_GetFramePoolLimit
+// Return the maximum number of bytes that the free blocks may hold.
+//
+//////////
+
+long QTNative_GetFramePoolLimit (void)
+{
+	return(gNativeFramePoolLimit);
+}
+
+
+//////////
+//
+// QTNative_FlushFramePool
+// Give all the free blocks back to the system.
+//
+//////////
+
+void QTNative_FlushFramePool (void)
+{
+	QTNative_TrimFramePool(0);
+}
+
+
+//////////
+//
+// QTNative_NewPoolBlock
+// Return a block of at least the specified number of bytes, aligned to kNativePoolAlignment, or NULL if there's
+// not enough memory. The contents of the block are undefined. Free the block with QTNative_DisposePoolBlock.
+//
+//////////
+
+void *QTNative_NewPoolBlock (long theNumBytes)
+{
+	NativePoolHeader			*myHeader = NULL;
+	unsigned char				*myAllocation = NULL;
+	unsigned char				*myBlock = NULL;
+	long						myClassSize;
+	long						myClass;
+
+	if (theNumBytes < 0)
+		return(NULL);
+
+	myClass = QTNative_GetSizeClass(theNumBytes, &myClassSize);
+
+	// reuse a free block of the same class, if there is one
+	if (gNativeFramePoolStarted && (myClass != kNativeUnpooledClass)) {
+		QTNative_Lock(&gNativeFramePoolLock);
+
+		myHeader = gNativeFreeBlocks[myClass];
+		if (myHeader != NULL) {
+			gNativeFreeBlocks[myClass] = myHeader->fNext;
+			gNativeFreeBytes -= myHeader->fSize;
+		}
+
+		QTNative_Unlock(&gNativeFramePoolLock);
+
+		if (myHeader != NULL) {
+			myHeader->fNext = NULL;
+			return((unsigned char *)myHeader + kNativePoolAlignment);
+		}
+	}
+
+	// otherwise, allocate a new one, with room for the header and for aligning the block
+	myAllocation = (unsigned char *)malloc((size_t)myClassSize + (2 * kNativePoolAlignment));
+	if (myAllocation == NULL)
+		return(NULL);
+
+	myBlock = myAllocation + kNativePoolAlignment + ((kNativePoolAlignment - ((unsigned long)myAllocation & (kNativePoolAlignment - 1))) & (kNativePoolAlignment - 1));
+
+	myHeader = (NativePoolHeader *)(myBlock - kNativePoolAlignment);
+	myHeader->fAllocation = myAllocation;
+	myHeader->fClass = myClass;
+	myHeader->fSize = myClassSize;
+	myHeader->fNext = NULL;
+
+	return(myBlock);
+}
+
+
+//////////
+//
+// QTNative_DisposePoolBlock
+// Free a block allocated by QTNative_NewPoolBlock, keeping it for reuse if there's room. It's OK to pass NULL.
+//
+//////////
+
+void QTNative_DisposePoolBlock (void *theBlock)
+{
+	NativePoolHeader			*myHeader = NULL;
+	Boolean						isKept = false;
+
+	if (theBlock == NULL)
+		return;
+
+	myHeader = (NativePoolHeader *)((unsigned char *)theBlock - kNativePoolAlignment);
+
+	if (gNativeFramePoolStarted && (myHeader->fClass != kNativeUnpooledClass)) {
+		QTNative_Lock(&gNativeFramePoolLock);
+
+		if (gNativeFreeBytes + myHeader->fSize <= gNativeFramePoolLimit) {
+			myHeader->fNext = gNativeFreeBlocks[myHeader->fClass];
+			gNativeFreeBlocks[myHeader->fClass] = myHeader;
+			gNativeFreeBytes += myHeader->fSize;
+			isKept = true;
+		}
+
+		QTNative_Unlock(&gNativeFramePoolLock);
+	}
+
+	if (!isKept)
+		free(myHeader->fAllocation);
+}
+
+
+//////////
+//
+// QTNative_GetPoolRowBytes
+// Return the number of bytes per row for a frame of the specified width: the length of a row, padded to a multiple
+// of kNativePoolAlignment, and then by one more kNativePoolAlignment if it's a multiple of kNativeCacheSetStride.
+//
+//////////
+
+long QTNative_GetPoolRowBytes (long theWidth, long theBytesPerPixel)
+{
+	long						myRowBytes = ((theWidth * theBytesPerPixel) + kNativePoolAlignment - 1) & ~(kNativePoolAlignment - 1);
+
+	if ((myRowBytes % kNativeCacheSetStride) == 0)
+		myRowBytes += kNativePoolAlignment;
+
+	return(myRowBytes);
+}
@@ -0,0 +1,56 @@
+//////////
+//
+//	File:		QTNativeFramePool.h
+//
+//	Contains:	A pool of aligned memory blocks for frames and scratch rows, so that rendering doesn't allocate
+//				from the heap for every frame.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeFramePool__
+#define __QTNativeFramePool__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativePoolAlignment				64							// the alignment of every block, and of the rows of a pooled frame
+#define kNativeDefaultFramePoolSize			(64L * 1024L * 1024L)		// the default limit on the memory held by free blocks
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void						QTNative_StartFramePool (void);
+void						QTNative_StopFramePool (void);
+void						QTNative_SetFramePoolLimit (long theNumBytes);
+long						QTNative_GetFramePoolLimit (void);
+void						QTNative_FlushFramePool (void);
+
+void *						QTNative_NewPoolBlock (long theNumBytes);
+void						QTNative_DisposePoolBlock (void *theBlock);
+long						QTNative_GetPoolRowBytes (long theWidth, long theBytesPerPixel);
+
+#endif	// __QTNativeFramePool__
@@ -0,0 +1,1256 @@
+//////////
+//
+//	File:		QTNativeGenerators.c
+//
+//	Contains:	Native fire, clouds, and water ripple generators (effects with no sources).
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <4>	 	10/17/26	rtm		a simulation is pinned from QTNative_PrepareGenerator until QTNative_ReleaseGenerator, and the bands
+//									read it from their job, so no simulation can be discarded while a step is being rendered from it
+//	   <3>	 	10/17/26	rtm		the scratch rows of each band, and the weights of the clouds, come from the frame pool
+//	   <2>	 	10/17/26	rtm		the fire and water simulations now keep checkpoints, so that seeking costs a bounded
+//									number of steps
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The generators draw a picture from nothing: flames rising from the bottom of the frame, clouds drifting
+//	across a blue sky, or raindrops rippling the surface of a pool.
+//
+//	Each generator works on a grid with half the resolution of the frame in each direction (so a 1080p frame
+//	has a grid of 962 x 542 cells), which is then scaled up to the frame, two pixels for each cell, with a
+//	color table. Fire and clouds keep one byte per cell and water keeps two 16-bit heights, so even for a
+//	large frame the grids stay small, and each step of a simulation sweeps through them row by row.
+//
+//	Clouds are a sum of layers of smoothly interpolated random values (each layer twice as fine and half as
+//	strong as the one before), drifting at different speeds; any step can be computed directly. But fire and
+//	water are simulations, where each step is computed from the one before: each fire cell takes the average
+//	heat of the cells below it, less some cooling, and the fuel at the bottom flickers at random; and each water
+//	cell moves toward the average height of its neighbors, with new drops falling now and then. So these two
+//	keep their grids from one step to the next, in a small table of simulations (one for each effect, set of
+//	parameters, and frame size in use). QTNative_PrepareGenerator is called (on the thread that starts the
+//	rendering, never on a worker thread) before the bands of a step are rendered; it advances the simulation to
+//	that step (starting over if it has to go back) and returns it, and the bands then just read the grids of the
+//	simulation in their job. A prepared simulation is pinned until QTNative_ReleaseGenerator is called, so that
+//	preparing another one (for another node of a graph, say) can't discard it or change its step while its
+//	bands are being rendered; when all kNativeMaxGeneratorStates simulations are pinned, there's no room for
+//	another one, and QTNative_PrepareGenerator fails. Every random number depends only on the seed and the step (see QTNativeNoise.c), so a
+//	step always looks the same no matter how we got to it. Each simulation is run for a while before step 0,
+//	so that the fire is already burning and the water is already rippling when the effect starts.
+//
+//	Going back to an earlier step (when a movie loops, plays as a palindrome, or is scrubbed) would mean running
+//	the simulation all the way from the start again, and going far forward would mean running all the steps in
+//	between. So each simulation also keeps checkpoints: copies of its grids at every few steps (every 16, by
+//	default; see QTNative_SetCheckpointInterval). To reach a step, we start from the latest checkpoint at or before
+//	it, if that's closer than where the simulation is now; so once a stretch of steps has been rendered, any step
+//	in it costs at most one checkpoint interval of simulation. A simulation keeps at most kNativeMaxCheckpoints
+//	checkpoints; when it needs more than that, it drops every other one and doubles its interval, so that the
+//	memory used stays bounded, and the cost of a seek grows only with the length of the effect.
+//
+//	Because of that state, the steps of the fire and water generators must be rendered one at a time; nothing
+//	marks them as time-independent, so QTShowEffect doesn't render them in parallel batches.
+//
+//	The simulation steps and the scaling of the grid have AVX2 versions, which produce exactly the same pixels
+//	as the scalar versions.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeGenerators.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeNoise.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeGridShift				1			// each grid cell covers 2 x 2 pixels
+#define kNativeFuelRows					2			// the rows of burning fuel below the visible fire grid
+#define kNativeRippleSubsteps			4			// the number of times the water moves in one step
+#define kNativeRippleWarmUp				32			// the number of steps of water run before step 0
+#define kNativeMaxDropsPerStep			2
+#define kNativeDropHeight				2048		// the depth of the dent that a drop makes in the water
+#define kNativeCloudOctaves				4
+#define kNativeMaxCheckpoints			16			// the most checkpoints that a simulation keeps
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a fire or water simulation
+typedef struct {
+	NativeEffectParams			fParams;					// the effect and parameters, with fStep and fNumberOfSteps set to 0
+	long						fWidth;						// the size of the frames
+	long						fHeight;
+	long						fStep;						// the step that the grids hold
+	long						fGridWidth;
+	long						fGridHeight;
+	unsigned long				fLastUse;
+	long						fNumPins;					// the steps being rendered from the grids, which mustn't change
+	unsigned char *				fHeat;						// fire: fGridHeight + kNativeFuelRows rows of heat
+	unsigned char *				fCooling;					// fire: fGridHeight rows of cooling
+	short *						fWater[2];					// water: the current and the previous heights
+	long						fCheckpointInterval;		// checkpoint i holds the grids of step i * fCheckpointInterval
+	void *						fCheckpoints[kNativeMaxCheckpoints];
+} NativeGeneratorState;
+
+// the settings of the clouds for one step
+typedef struct {
+	unsigned int				fKeys[kNativeCloudOctaves];
+	long						fSpacing[kNativeCloudOctaves];	// the distance between random values, in cells
+	long						fOffsetX[kNativeCloudOctaves];	// how far each layer has drifted, in cells
+	long						fOffsetY[kNativeCloudOctaves];
+	long						fAmplitude[kNativeCloudOctaves];
+	unsigned short *			fWeights[kNativeCloudOctaves];	// the interpolation weights for each layer, out of 256
+	long						fGridWidth;
+	long *						fColumn;						// scratch space for one row of a layer
+} NativeCloudInfo;
+
+typedef void (*NativeGridRowProcPtr) (const void *theRefCon, long theGridRow, unsigned char *theRow);
+typedef void (*NativeExpandRowProcPtr) (const unsigned char *theCells, const unsigned int *thePalette, unsigned int *theRow, long theCount);
+typedef void (*NativeFireRowProcPtr) (unsigned char *theDest, const unsigned char *theBelow, const unsigned char *theBelow2, const unsigned char *theCooling, long theWidth);
+typedef void (*NativeWaterRowProcPtr) (short *theNew, const short *theUp, const short *theMiddle, const short *theDown, long theWidth, long theDamping);
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeGeneratorState			gNativeGeneratorStates[kNativeMaxGeneratorStates];
+static unsigned long				gNativeGeneratorUses = 0;
+static long							gNativeCheckpointInterval = kNativeDefaultCheckpointInterval;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Grid scaling functions.
+//
+// Each generator produces one byte per grid cell; these functions scale the grid up to the frame, and use
+// the byte as an index into a color table.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_ExpandRowScalar
+// Scale a row of cells up to twice its width, and look up the color of each pixel; the pixels between two cells
+// get the average of the two.
+//
+//////////
+
+static void QTNative_ExpandRowScalar (const unsigned char *theCells, const unsigned int *thePalette, unsigned int *theRow, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++) {
+		long			myCell = myX >> 1;
+
+		if (myX & 1)
+			theRow[myX] = thePalette[(theCells[myCell] + theCells[myCell + 1] + 1) >> 1];
+		else
+			theRow[myX] = thePalette[theCells[myCell]];
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_ExpandRowAVX2
+// Do what QTNative_ExpandRowScalar does, for 16 pixels at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ExpandRowAVX2 (const unsigned char *theCells, const unsigned int *thePalette, unsigned int *theRow, long theCount)
+{
+	long				myX;
+
+	for (myX = 0; myX + 16 <= theCount; myX += 16) {
+		__m128i			myCells = _mm_loadl_epi64((const __m128i *)(theCells + (myX >> 1)));
+		__m128i			myNext = _mm_loadl_epi64((const __m128i *)(theCells + (myX >> 1) + 1));
+		__m128i			myValues = _mm_unpacklo_epi8(myCells, _mm_avg_epu8(myCells, myNext));
+
+		_mm256_storeu_si256((__m256i *)(theRow + myX), _mm256_i32gather_epi32((const int *)thePalette, _mm256_cvtepu8_epi32(myValues), 4));
+		_mm256_storeu_si256((__m256i *)(theRow + myX + 8), _mm256_i32gather_epi32((const int *)thePalette, _mm256_cvtepu8_epi32(_mm_srli_si128(myValues, 8)), 4));
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theCount)
+		QTNative_ExpandRowScalar(theCells + (myX >> 1), thePalette, theRow + myX, theCount - myX);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// QTNative_RenderGridBand
+// Render the band of rows described by the specified job from a grid of cells, which theRowProc supplies one
+// row at a time.
+//
+//////////
+
+static OSErr QTNative_RenderGridBand (const NativeRenderJob *theJob, long theGridWidth, long theGridHeight, NativeGridRowProcPtr theRowProc, const void *theRefCon, const unsigned int thePalette[256])
+{
+	NativePixelBuffer			*myDest = theJob->fDest;
+	OSType						myRowFormat = QTNative_GetHostPixelFormat();
+	NativeSpanKernels			myFromRow;
+	NativeExpandRowProcPtr		myExpandProc = QTNative_ExpandRowScalar;
+	unsigned char				*myCells = NULL;
+	unsigned char				*myRows[2];
+	unsigned char				*myMixed;
+	unsigned int				*myRow = NULL;
+	long						myLoaded = -2;					// the grid row in myRows[0]
+	long						myY, myX;
+
+	if (!QTNative_GetSpanKernels(myRowFormat, myDest->fPixelFormat, &myFromRow))
+		return(paramErr);
+
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		myExpandProc = QTNative_ExpandRowAVX2;
+#endif
+
+	myCells = (unsigned char *)QTNative_NewPoolBlock(theGridWidth * 3);
+	myRow = (unsigned int *)QTNative_NewPoolBlock(myDest->fWidth * sizeof(unsigned int));
+	if ((myCells == NULL) || (myRow == NULL)) {
+		QTNative_DisposePoolBlock(myCells);
+		QTNative_DisposePoolBlock(myRow);
+		return(memFullErr);
+	}
+
+	myRows[0] = myCells;
+	myRows[1] = myCells + theGridWidth;
+	myMixed = myCells + (2 * theGridWidth);
+
+	for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+		long					myGridRow = myY >> kNativeGridShift;
+
+		// get the two grid rows around this row of pixels
+		if (myGridRow != myLoaded) {
+			if (myGridRow == myLoaded + 1) {
+				unsigned char	*mySwap = myRows[0];
+
+				myRows[0] = myRows[1];
+				myRows[1] = mySwap;
+			} else {
+				theRowProc(theRefCon, myGridRow, myRows[0]);
+			}
+
+			theRowProc(theRefCon, (myGridRow + 1 < theGridHeight) ? myGridRow + 1 : myGridRow, myRows[1]);
+			myLoaded = myGridRow;
+		}
+
+		// a row of pixels between two grid rows gets their average
+		if (myY & 1) {
+			for (myX = 0; myX < theGridWidth; myX++)
+				myMixed[myX] = (unsigned char)((myRows[0][myX] + myRows[1][myX] + 1) >> 1);
+
+			myExpandProc(myMixed, thePalette, myRow, myDest->fWidth);
+		} else {
+			myExpandProc(myRows[0], thePalette, myRow, myDest->fWidth);
+		}
+
+		myFromRow.fConvert((const unsigned char *)myRow, QTNative_GetRowAddress(myDest, myY), myDest->fWidth, NULL);
+	}
+
+	QTNative_DisposePoolBlock(myCells);
+	QTNative_DisposePoolBlock(myRow);
+
+	return(noErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Simulation state functions.
+//
+// Use these functions to keep the grids of the fire and water simulations from one step to the next.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_IsSameGenerator
+// Do the specified simulation and the specified effect parameters and frame size go together?
+//
+//////////
+
+static Boolean QTNative_IsSameGenerator (const NativeGeneratorState *theState, const NativeEffectParams *theParams, long theWidth, long theHeight)
+{
+	short				myIndex;
+
+	if ((theState->fParams.fEffectType != theParams->fEffectType) || (theState->fWidth != theWidth) || (theState->fHeight != theHeight))
+		return(false);
+
+	if (theState->fParams.fNumParams != theParams->fNumParams)
+		return(false);
+
+	for (myIndex = 0; myIndex < theParams->fNumParams; myIndex++)
+		if ((theState->fParams.fParams[myIndex].fName != theParams->fParams[myIndex].fName) ||
+			(theState->fParams.fParams[myIndex].fValue != theParams->fParams[myIndex].fValue))
+			return(false);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTNative_FindGenerator
+// Return the simulation for the specified effect parameters and frame size, or NULL if there isn't one.
+//
+//////////
+
+static NativeGeneratorState *QTNative_FindGenerator (const NativeEffectParams *theParams, long theWidth, long theHeight)
+{
+	short				myIndex;
+
+	for (myIndex = 0; myIndex < kNativeMaxGeneratorStates; myIndex++)
+		if (QTNative_IsSameGenerator(&gNativeGeneratorStates[myIndex], theParams, theWidth, theHeight))
+			return(&gNativeGeneratorStates[myIndex]);
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTNative_DisposeGenerator
+// Free the grids of a simulation, and forget what it was for.
+//
+//////////
+
+static void QTNative_DisposeGenerator (NativeGeneratorState *theState)
+{
+	short				myIndex;
+
+	for (myIndex = 0; myIndex < kNativeMaxCheckpoints; myIndex++)
+		free(theState->fCheckpoints[myIndex]);
+
+	free(theState->fHeat);
+	free(theState->fCooling);
+	free(theState->fWater[0]);
+	free(theState->fWater[1]);
+
+	memset(theState, 0, sizeof(NativeGeneratorState));
+}
+
+
+//////////
+//
+// QTNative_FlushGenerators
+// Free the grids of all the simulations.
+//
+//////////
+
+void QTNative_FlushGenerators (void)
+{
+	short				myIndex;
+
+	for (myIndex = 0; myIndex < kNativeMaxGeneratorStates; myIndex++)
+		QTNative_DisposeGenerator(&gNativeGeneratorStates[myIndex]);
+}
+
+
+//////////
+//
+// QTNative_SetCheckpointInterval
+// Set the number of steps between the checkpoints of a simulation; 0 turns checkpoints off. The existing checkpoints
+// are thrown away.
+//
+//////////
+
+void QTNative_SetCheckpointInterval (long theNumSteps)
+{
+	short				myIndex;
+	short				myCheckpoint;
+
+	gNativeCheckpointInterval = (theNumSteps < 0) ? 0 : theNumSteps;
+
+	for (myIndex = 0; myIndex < kNativeMaxGeneratorStates; myIndex++) {
+		NativeGeneratorState	*myState = &gNativeGeneratorStates[myIndex];
+
+		for (myCheckpoint = 0; myCheckpoint < kNativeMaxCheckpoints; myCheckpoint++) {
+			free(myState->fCheckpoints[myCheckpoint]);
+			myState->fCheckpoints[myCheckpoint] = NULL;
+		}
+
+		myState->fCheckpointInterval = gNativeCheckpointInterval;
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Checkpoint functions.
+//
+// Use these functions to save and restore copies of the grids of a simulation.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetCheckpointSize
+// Return the number of bytes in a checkpoint of the specified simulation: the fire's heat (including the fuel),
+// or both of the water's heights. (The fire's cooling never changes, so it isn't saved.)
+//
+//////////
+
+static size_t QTNative_GetCheckpointSize (const NativeGeneratorState *theState)
+{
+	if (theState->fParams.fEffectType == kNativeFireType)
+		return((size_t)theState->fGridWidth * (theState->fGridHeight + kNativeFuelRows));
+	else
+		return((size_t)theState->fGridWidth * theState->fGridHeight * sizeof(short));
+}
+
+
+//////////
+//
+// QTNative_ThinCheckpoints
+// Drop every other checkpoint of a simulation, and double its checkpoint interval.
+//
+//////////
+
+static void QTNative_ThinCheckpoints (NativeGeneratorState *theState)
+{
+	short				myIndex;
+
+	for (myIndex = 0; myIndex < kNativeMaxCheckpoints; myIndex++) {
+		if (myIndex & 1) {
+			free(theState->fCheckpoints[myIndex]);
+		} else {
+			theState->fCheckpoints[myIndex / 2] = theState->fCheckpoints[myIndex];
+		}
+	}
+
+	for (myIndex = kNativeMaxCheckpoints / 2; myIndex < kNativeMaxCheckpoints; myIndex++)
+		theState->fCheckpoints[myIndex] = NULL;
+
+	theState->fCheckpointInterval *= 2;
+}
+
+
+//////////
+//
+// QTNative_SaveCheckpoint
+// Save a copy of the grids of a simulation, if its current step is one that gets a checkpoint and it doesn't have one
+// yet. If the memory for the copy can't be allocated, we just go without it.
+//
+//////////
+
+static void QTNative_SaveCheckpoint (NativeGeneratorState *theState)
+{
+	size_t				mySize = QTNative_GetCheckpointSize(theState);
+	unsigned char		*myCheckpoint = NULL;
+	long				myIndex;
+
+	if ((theState->fCheckpointInterval <= 0) || (theState->fStep < 0) || ((theState->fStep % theState->fCheckpointInterval) != 0))
+		return;
+
+	while (theState->fStep / theState->fCheckpointInterval >= kNativeMaxCheckpoints)
+		QTNative_ThinCheckpoints(theState);
+
+	if ((theState->fStep % theState->fCheckpointInterval) != 0)
+		return;
+
+	myIndex = theState->fStep / theState->fCheckpointInterval;
+	if (theState->fCheckpoints[myIndex] != NULL)
+		return;
+
+	myCheckpoint = (unsigned char *)malloc(theState->fParams.fEffectType == kNativeFireType ? mySize : 2 * mySize);
+	if (myCheckpoint == NULL)
+		return;
+
+	if (theState->fParams.fEffectType == kNativeFireType) {
+		memcpy(myCheckpoint, theState->fHeat, mySize);
+	} else {
+		memcpy(myCheckpoint, theState->fWater[0], mySize);
+		memcpy(myCheckpoint + mySize, theState->fWater[1], mySize);
+	}
+
+	theState->fCheckpoints[myIndex] = myCheckpoint;
+}
+
+
+//////////
+//
+// QTNative_RestoreCheckpoint
+// Restore the grids of a simulation from the latest checkpoint at or before the specified step, if that's closer to the
+// step than the simulation is now (or if the simulation is already past the step). Return true if we did.
+//
+//////////
+
+static Boolean QTNative_RestoreCheckpoint (NativeGeneratorState *theState, long theStep)
+{
+	size_t				mySize = QTNative_GetCheckpointSize(theState);
+	const unsigned char	*myCheckpoint = NULL;
+	long				myIndex;
+
+	if ((theState->fCheckpointInterval <= 0) || (theStep < 0))
+		return(false);
+
+	myIndex = theStep / theState->fCheckpointInterval;
+	if (myIndex >= kNativeMaxCheckpoints)
+		myIndex = kNativeMaxCheckpoints - 1;
+
+	for (; myIndex >= 0; myIndex--)
+		if (theState->fCheckpoints[myIndex] != NULL)
+			break;
+
+	if (myIndex < 0)
+		return(false);
+
+	// the checkpoint is no help if the simulation is already between it and the step
+	if ((theState->fStep <= theStep) && (theState->fStep >= myIndex * theState->fCheckpointInterval))
+		return(false);
+
+	myCheckpoint = (const unsigned char *)theState->fCheckpoints[myIndex];
+
+	if (theState->fParams.fEffectType == kNativeFireType) {
+		memcpy(theState->fHeat, myCheckpoint, mySize);
+	} else {
+		memcpy(theState->fWater[0], myCheckpoint, mySize);
+		memcpy(theState->fWater[1], myCheckpoint + mySize, mySize);
+	}
+
+	theState->fStep = myIndex * theState->fCheckpointInterval;
+
+	return(true);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Fire functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_FireRowScalar
+// Compute a row of the fire from the two rows below it: each cell takes the average of the three cells below it
+// and the one below that, less the cooling.
+//
+//////////
+
+static void QTNative_FireRowScalar (unsigned char *theDest, const unsigned char *theBelow, const unsigned char *theBelow2, const unsigned char *theCooling, long theWidth)
+{
+	long				myX;
+
+	for (myX = 0; myX < theWidth; myX++) {
+		long			myLeft = (myX > 0) ? myX - 1 : 0;
+		long			myRight = (myX < theWidth - 1) ? myX + 1 : myX;
+		long			myHeat = (theBelow[myLeft] + theBelow[myX] + theBelow[myRight] + theBelow2[myX]) >> 2;
+
+		theDest[myX] = (unsigned char)((myHeat > theCooling[myX]) ? myHeat - theCooling[myX] : 0);
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_FireRowAVX2
+// Do what QTNative_FireRowScalar does, for 16 cells at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_FireRowAVX2 (unsigned char *theDest, const unsigned char *theBelow, const unsigned char *theBelow2, const unsigned char *theCooling, long theWidth)
+{
+	long				myX;
+
+	// the first cell (whose left neighbor is itself) and the last few are done by the scalar kernel
+	QTNative_FireRowScalar(theDest, theBelow, theBelow2, theCooling, (theWidth < 2) ? theWidth : 2);
+	if (theWidth < 2)
+		return;
+
+	for (myX = 1; myX + 16 < theWidth; myX += 16) {
+		__m256i			myLeft = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(theBelow + myX - 1)));
+		__m256i			myCenter = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(theBelow + myX)));
+		__m256i			myRight = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(theBelow + myX + 1)));
+		__m256i			myBelow2 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(theBelow2 + myX)));
+		__m256i			myCooling = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(theCooling + myX)));
+		__m256i			myHeat;
+
+		myHeat = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(myLeft, myCenter), _mm256_add_epi16(myRight, myBelow2)), 2);
+		myHeat = _mm256_subs_epu16(myHeat, myCooling);
+
+		_mm_storeu_si128((__m128i *)(theDest + myX), _mm_packus_epi16(_mm256_castsi256_si128(myHeat), _mm256_extracti128_si256(myHeat, 1)));
+	}
+
+	// the last cells need their right neighbors clamped, which the scalar kernel does
+	for (; myX < theWidth; myX++) {
+		long			myRight = (myX < theWidth - 1) ? myX + 1 : myX;
+		long			myHeat = (theBelow[myX - 1] + theBelow[myX] + theBelow[myRight] + theBelow2[myX]) >> 2;
+
+		theDest[myX] = (unsigned char)((myHeat > theCooling[myX]) ? myHeat - theCooling[myX] : 0);
+	}
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// QTNative_ResetFire
+// Set a fire simulation to its state before it starts burning.
+//
+//////////
+
+static void QTNative_ResetFire (NativeGeneratorState *theState)
+{
+	const NativeEffectParams	*myParams = &theState->fParams;
+	unsigned long				mySeed = (unsigned long)QTNative_GetEffectParam(myParams, kNativeParamSeed, kNativeDefaultSeed);
+	long						myFlameHeight = QTNative_GetEffectParam(myParams, kNativeParamFlameHeight, kNativeDefaultFlameHeight);
+	unsigned int				myKey = QTNative_GetRandomKey(mySeed, 0, kNativeGeneratorStreamCooling);
+	long						myNumCells = theState->fGridWidth * theState->fGridHeight;
+	long						myMeanCooling;
+	long						myIndex;
+
+	myFlameHeight = (myFlameHeight < 1) ? 1 : (myFlameHeight > 1000) ? 1000 : myFlameHeight;
+
+	// the average cooling per row (in 1/256ths of a level) that makes the flames die out at the right height
+	myMeanCooling = (255L * 256L * 100L) / (theState->fGridHeight * myFlameHeight);
+
+	memset(theState->fHeat, 0, (size_t)theState->fGridWidth * (theState->fGridHeight + kNativeFuelRows));
+
+	// each cell's cooling is random, from 0 to twice the average
+	for (myIndex = 0; myIndex < myNumCells; myIndex++) {
+		long					myCooling = (myMeanCooling * (long)(QTNative_Random(myKey, (unsigned long)myIndex) & 0x1FF)) >> 16;
+
+		theState->fCooling[myIndex] = (unsigned char)((myCooling > 255) ? 255 : myCooling);
+	}
+
+	// let the fire burn up to the top of the frame before step 0
+	theState->fStep = -theState->fGridHeight - 1;
+}
+
+
+//////////
+//
+// QTNative_StepFire
+// Advance a fire simulation by one step.
+//
+//////////
+
+static void QTNative_StepFire (NativeGeneratorState *theState, NativeFireRowProcPtr theRowProc)
+{
+	const NativeEffectParams	*myParams = &theState->fParams;
+	unsigned long				mySeed = (unsigned long)QTNative_GetEffectParam(myParams, kNativeParamSeed, kNativeDefaultSeed);
+	long						mySputter = QTNative_GetEffectParam(myParams, kNativeParamSputter, kNativeDefaultSputter);
+	long						myStep = theState->fStep + 1;
+	unsigned int				myKey = QTNative_GetRandomKey(mySeed, myStep, kNativeGeneratorStreamFuel);
+	long						myWidth = theState->fGridWidth;
+	long						myHeight = theState->fGridHeight;
+	unsigned char				*myFuel = theState->fHeat + (myWidth * myHeight);
+	long						myCoolingRow;
+	long						myIndex;
+	long						myY;
+
+	// the fuel flickers at random
+	for (myIndex = 0; myIndex < myWidth * kNativeFuelRows; myIndex++)
+		myFuel[myIndex] = (unsigned char)(((long)(QTNative_Random(myKey, (unsigned long)myIndex) & 0xFF) < mySputter) ? 0 : 255);
+
+	// the heat rises; we work from the top down, so the rows below each row still hold the previous step;
+	// the cooling rows move up with the flames, which draws them out into tongues
+	myCoolingRow = myStep % myHeight;
+	if (myCoolingRow < 0)
+		myCoolingRow += myHeight;
+
+	for (myY = 0; myY < myHeight; myY++) {
+		unsigned char			*myRow = theState->fHeat + (myY * myWidth);
+
+		theRowProc(myRow, myRow + myWidth, myRow + (2 * myWidth), theState->fCooling + (myCoolingRow * myWidth), myWidth);
+
+		if (++myCoolingRow == myHeight)
+			myCoolingRow = 0;
+	}
+
+	theState->fStep = myStep;
+}
+
+
+//////////
+//
+// QTNative_GetFireGridRow
+// Supply a row of the fire's grid to QTNative_RenderGridBand.
+//
+//////////
+
+static void QTNative_GetFireGridRow (const void *theRefCon, long theGridRow, unsigned char *theRow)
+{
+	const NativeGeneratorState	*myState = (const NativeGeneratorState *)theRefCon;
+
+	memcpy(theRow, myState->fHeat + (theGridRow * myState->fGridWidth), (size_t)myState->fGridWidth);
+}
+
+
+//////////
+//
+// QTNative_FireProc
+// Render a step of the fire, which QTNative_PrepareGenerator has already simulated (and put in the job).
+//
+//////////
+
+OSErr QTNative_FireProc (const NativeRenderJob *theJob)
+{
+	const NativeGeneratorState	*myState = (const NativeGeneratorState *)theJob->fState;
+	unsigned int				myPalette[256];
+	long						myIndex;
+
+	if ((myState == NULL) || (myState->fStep != theJob->fParams->fStep))
+		return(paramErr);
+
+	// black, through red, orange, and yellow, to white
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		long					myRed = myIndex * 3;
+		long					myGreen = (myIndex - 85) * 3;
+		long					myBlue = (myIndex - 170) * 3;
+
+		myRed = (myRed > 255) ? 255 : myRed;
+		myGreen = (myGreen < 0) ? 0 : (myGreen > 255) ? 255 : myGreen;
+		myBlue = (myBlue < 0) ? 0 : (myBlue > 255) ? 255 : myBlue;
+
+		myPalette[myIndex] = 0xFF000000U | ((unsigned int)myRed << 16) | ((unsigned int)myGreen << 8) | (unsigned int)myBlue;
+	}
+
+	return(QTNative_RenderGridBand(theJob, myState->fGridWidth, myState->fGridHeight, QTNative_GetFireGridRow, myState, myPalette));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Water ripple functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_WaterRowScalar
+// Move a row of the water: each cell moves toward the average height of its four neighbors, overshooting by as
+// much as it moved last time, and loses a little of its height. The new heights replace the previous ones.
+//
+// The arithmetic is done on 16-bit values (wrapping around), just as in the AVX2 version.
+//
+//////////
+
+static void QTNative_WaterRowScalar (short *theNew, const short *theUp, const short *theMiddle, const short *theDown, long theWidth, long theDamping)
+{
+	long				myX;
+
+	for (myX = 1; myX < theWidth - 1; myX++) {
+		short			mySum = (short)(theUp[myX] + theDown[myX] + theMiddle[myX - 1] + theMiddle[myX + 1]);
+		short			myHeight = (short)((mySum >> 1) - theNew[myX]);
+
+		theNew[myX] = (short)(myHeight - (myHeight >> theDamping));
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_WaterRowAVX2
+// Do what QTNative_WaterRowScalar does, for 16 cells at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_WaterRowAVX2 (short *theNew, const short *theUp, const short *theMiddle, const short *theDown, long theWidth, long theDamping)
+{
+	__m128i				myDamping = _mm_cvtsi32_si128((int)theDamping);
+	long				myX;
+
+	for (myX = 1; myX + 16 < theWidth; myX += 16) {
+		__m256i			mySum, myHeight;
+
+		mySum = _mm256_add_epi16(_mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(theUp + myX)), _mm256_loadu_si256((const __m256i *)(theDown + myX))),
+								_mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(theMiddle + myX - 1)), _mm256_loadu_si256((const __m256i *)(theMiddle + myX + 1))));
+		myHeight = _mm256_sub_epi16(_mm256_srai_epi16(mySum, 1), _mm256_loadu_si256((const __m256i *)(theNew + myX)));
+		myHeight = _mm256_sub_epi16(myHeight, _mm256_sra_epi16(myHeight, myDamping));
+
+		_mm256_storeu_si256((__m256i *)(theNew + myX), myHeight);
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theWidth - 1)
+		QTNative_WaterRowScalar(theNew + myX - 1, theUp + myX - 1, theMiddle + myX - 1, theDown + myX - 1, theWidth - myX + 1, theDamping);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// QTNative_ResetRipple
+// Set a water simulation to a calm pool.
+//
+//////////
+
+static void QTNative_ResetRipple (NativeGeneratorState *theState)
+{
+	size_t						mySize = (size_t)theState->fGridWidth * theState->fGridHeight * sizeof(short);
+
+	memset(theState->fWater[0], 0, mySize);
+	memset(theState->fWater[1], 0, mySize);
+
+	// let the drops fall for a while before step 0
+	theState->fStep = -kNativeRippleWarmUp - 1;
+}
+
+
+//////////
+//
+// QTNative_DropInWater
+// Make a round dent in the water where a drop falls.
+//
+//////////
+
+static void QTNative_DropInWater (NativeGeneratorState *theState, long theX, long theY, long theRadius)
+{
+	short						*myWater = theState->fWater[0];
+	long						myRadius2 = theRadius * theRadius;
+	long						myX, myY;
+
+	for (myY = theY - theRadius; myY <= theY + theRadius; myY++) {
+		if ((myY < 1) || (myY >= theState->fGridHeight - 1))
+			continue;
+
+		for (myX = theX - theRadius; myX <= theX + theRadius; myX++) {
+			long				myDistance2 = ((myX - theX) * (myX - theX)) + ((myY - theY) * (myY - theY));
+			short				*myCell = myWater + (myY * theState->fGridWidth) + myX;
+
+			if ((myX < 1) || (myX >= theState->fGridWidth - 1) || (myDistance2 >= myRadius2))
+				continue;
+
+			*myCell = (short)(*myCell - ((kNativeDropHeight * (myRadius2 - myDistance2)) / myRadius2));
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_StepRipple
+// Advance a water simulation by one step.
+//
+//////////
+
+static void QTNative_StepRipple (NativeGeneratorState *theState, NativeWaterRowProcPtr theRowProc)
+{
+	const NativeEffectParams	*myParams = &theState->fParams;
+	unsigned long				mySeed = (unsigned long)QTNative_GetEffectParam(myParams, kNativeParamSeed, kNativeDefaultSeed);
+	long						myDrops = QTNative_GetEffectParam(myParams, kNativeParamDrops, kNativeDefaultDrops);
+	long						myDamping = QTNative_GetEffectParam(myParams, kNativeParamDamping, kNativeDefaultDamping);
+	long						myRadius = QTNative_GetEffectParam(myParams, kNativeParamRadius, kNativeDefaultDropRadius) >> kNativeGridShift;
+	long						myStep = theState->fStep + 1;
+	unsigned int				myKey = QTNative_GetRandomKey(mySeed, myStep, kNativeGeneratorStreamDrops);
+	long						myWidth = theState->fGridWidth;
+	long						myHeight = theState->fGridHeight;
+	short						*mySwap;
+	long						myIndex;
+	long						myY;
+
+	myDrops = (myDrops < 0) ? 0 : (myDrops > 32 * kNativeMaxDropsPerStep) ? 32 * kNativeMaxDropsPerStep : myDrops;
+	myDamping = (myDamping < 1) ? 1 : (myDamping > 15) ? 15 : myDamping;
+	myRadius = (myRadius < 1) ? 1 : (myRadius > 64) ? 64 : myRadius;
+
+	// drops fall at random; each of the possible drops falls with a chance of myDrops in 16 * kNativeMaxDropsPerStep
+	for (myIndex = 0; myIndex < kNativeMaxDropsPerStep; myIndex++) {
+		unsigned int			myChance = QTNative_Random(myKey, (unsigned long)(3 * myIndex)) & 0xFFFF;
+
+		if ((long)myChance < (myDrops * 0x10000L) / (16 * kNativeMaxDropsPerStep))
+			QTNative_DropInWater(theState,
+								1 + (long)(QTNative_Random(myKey, (unsigned long)((3 * myIndex) + 1)) % (unsigned int)(myWidth - 2)),
+								1 + (long)(QTNative_Random(myKey, (unsigned long)((3 * myIndex) + 2)) % (unsigned int)(myHeight - 2)),
+								myRadius);
+	}
+
+	// the water moves; the new heights replace the previous heights, which then become the current ones
+	for (myIndex = 0; myIndex < kNativeRippleSubsteps; myIndex++) {
+		short					*myCurrent = theState->fWater[0];
+		short					*myNew = theState->fWater[1];
+
+		for (myY = 1; myY < myHeight - 1; myY++)
+			theRowProc(myNew + (myY * myWidth), myCurrent + ((myY - 1) * myWidth), myCurrent + (myY * myWidth), myCurrent + ((myY + 1) * myWidth), myWidth, myDamping);
+
+		mySwap = theState->fWater[0];
+		theState->fWater[0] = theState->fWater[1];
+		theState->fWater[1] = mySwap;
+	}
+
+	theState->fStep = myStep;
+}
+
+
+//////////
+//
+// QTNative_GetRippleGridRow
+// Supply a row of the water's grid to QTNative_RenderGridBand: the water is lit from the upper left, so each cell
+// gets brighter or darker with the slope of the water.
+//
+//////////
+
+static void QTNative_GetRippleGridRow (const void *theRefCon, long theGridRow, unsigned char *theRow)
+{
+	const NativeGeneratorState	*myState = (const NativeGeneratorState *)theRefCon;
+	long						myWidth = myState->fGridWidth;
+	const short					*myMiddle = myState->fWater[0] + (theGridRow * myWidth);
+	const short					*myUp = (theGridRow > 0) ? myMiddle - myWidth : myMiddle;
+	const short					*myDown = (theGridRow < myState->fGridHeight - 1) ? myMiddle + myWidth : myMiddle;
+	long						myX;
+
+	for (myX = 0; myX < myWidth; myX++) {
+		long					myLeft = (myX > 0) ? myX - 1 : 0;
+		long					myRight = (myX < myWidth - 1) ? myX + 1 : myX;
+		long					myShade = 128 + (((myMiddle[myLeft] - myMiddle[myRight]) + (myUp[myX] - myDown[myX])) >> 3);
+
+		theRow[myX] = (unsigned char)((myShade < 0) ? 0 : (myShade > 255) ? 255 : myShade);
+	}
+}
+
+
+//////////
+//
+// QTNative_RippleProc
+// Render a step of the water ripple, which QTNative_PrepareGenerator has already simulated (and put in the job).
+//
+//////////
+
+OSErr QTNative_RippleProc (const NativeRenderJob *theJob)
+{
+	const NativeGeneratorState	*myState = (const NativeGeneratorState *)theJob->fState;
+	unsigned int				myPalette[256];
+	long						myIndex;
+
+	if ((myState == NULL) || (myState->fStep != theJob->fParams->fStep))
+		return(paramErr);
+
+	// deep blue in the shadows, through the color of the pool, to white highlights
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		long					myRed = (myIndex * myIndex) >> 9;
+		long					myGreen = 48 + ((myIndex * 3) >> 2);
+		long					myBlue = 96 + ((myIndex * 5) >> 3);
+
+		if (myIndex > 192) {
+			myRed += (myIndex - 192) * 2;
+			myGreen += myIndex - 192;
+		}
+
+		myRed = (myRed > 255) ? 255 : myRed;
+		myGreen = (myGreen > 255) ? 255 : myGreen;
+		myBlue = (myBlue > 255) ? 255 : myBlue;
+
+		myPalette[myIndex] = 0xFF000000U | ((unsigned int)myRed << 16) | ((unsigned int)myGreen << 8) | (unsigned int)myBlue;
+	}
+
+	return(QTNative_RenderGridBand(theJob, myState->fGridWidth, myState->fGridHeight, QTNative_GetRippleGridRow, myState, myPalette));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Simulation preparation functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_PrepareGenerator
+// Advance the fire or water simulation for the specified effect parameters and frame size to the step in theParams,
+// setting one up if there isn't one yet, and return it pinned in theState. This is the prepare procedure of those
+// effects (see QTNative_PrepareEffect).
+//
+//////////
+
+OSErr QTNative_PrepareGenerator (const NativeEffectParams *theParams, long theWidth, long theHeight, void **theState)
+{
+	NativeGeneratorState		*myState = NULL;
+	NativeFireRowProcPtr		myFireProc = QTNative_FireRowScalar;
+	NativeWaterRowProcPtr		myWaterProc = QTNative_WaterRowScalar;
+	long						myGridWidth = (theWidth >> kNativeGridShift) + 2;
+	long						myGridHeight = (theHeight >> kNativeGridShift) + 2;
+	short						myIndex;
+
+	*theState = NULL;
+
+	if ((theParams->fEffectType != kNativeFireType) && (theParams->fEffectType != kNativeRippleType))
+		return(paramErr);
+
+	if ((theWidth <= 0) || (theHeight <= 0))
+		return(paramErr);
+
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels()) {
+		myFireProc = QTNative_FireRowAVX2;
+		myWaterProc = QTNative_WaterRowAVX2;
+	}
+#endif
+
+	myState = QTNative_FindGenerator(theParams, theWidth, theHeight);
+
+	// if the simulation is already at this step, there's nothing to do (and nothing is changed, since the bands of
+	// the step may already be reading the grids)
+	if ((myState != NULL) && (myState->fStep == theParams->fStep)) {
+		myState->fLastUse = ++gNativeGeneratorUses;
+		myState->fNumPins++;
+		*theState = myState;
+		return(noErr);
+	}
+
+	// a pinned simulation is being rendered at another step, and can't be moved
+	if ((myState != NULL) && (myState->fNumPins > 0))
+		return(paramErr);
+
+	if (myState == NULL) {
+		// reuse the simulation that was used least recently, among those that aren't pinned
+		for (myIndex = 0; myIndex < kNativeMaxGeneratorStates; myIndex++)
+			if ((gNativeGeneratorStates[myIndex].fNumPins == 0) && ((myState == NULL) || (gNativeGeneratorStates[myIndex].fLastUse < myState->fLastUse)))
+				myState = &gNativeGeneratorStates[myIndex];
+
+		if (myState == NULL)
+			return(paramErr);
+
+		QTNative_DisposeGenerator(myState);
+
+		if (theParams->fEffectType == kNativeFireType) {
+			myState->fHeat = (unsigned char *)malloc((size_t)myGridWidth * (myGridHeight + kNativeFuelRows));
+			myState->fCooling = (unsigned char *)malloc((size_t)myGridWidth * myGridHeight);
+			if ((myState->fHeat == NULL) || (myState->fCooling == NULL)) {
+				QTNative_DisposeGenerator(myState);
+				return(memFullErr);
+			}
+		} else {
+			myState->fWater[0] = (short *)malloc((size_t)myGridWidth * myGridHeight * sizeof(short));
+			myState->fWater[1] = (short *)malloc((size_t)myGridWidth * myGridHeight * sizeof(short));
+			if ((myState->fWater[0] == NULL) || (myState->fWater[1] == NULL)) {
+				QTNative_DisposeGenerator(myState);
+				return(memFullErr);
+			}
+		}
+
+		myState->fParams = *theParams;
+		myState->fParams.fStep = 0;
+		myState->fParams.fNumberOfSteps = 0;
+		myState->fWidth = theWidth;
+		myState->fHeight = theHeight;
+		myState->fGridWidth = myGridWidth;
+		myState->fGridHeight = myGridHeight;
+		myState->fCheckpointInterval = gNativeCheckpointInterval;
+		myState->fStep = theParams->fStep + 1;					// so that it's reset below
+	}
+
+	myState->fLastUse = ++gNativeGeneratorUses;
+
+	// a simulation can only go forward; to go back, start again from a checkpoint, or from the beginning
+	if (!QTNative_RestoreCheckpoint(myState, theParams->fStep) && (myState->fStep > theParams->fStep)) {
+		if (myState->fParams.fEffectType == kNativeFireType)
+			QTNative_ResetFire(myState);
+		else
+			QTNative_ResetRipple(myState);
+	}
+
+	while (myState->fStep < theParams->fStep) {
+		if (myState->fParams.fEffectType == kNativeFireType)
+			QTNative_StepFire(myState, myFireProc);
+		else
+			QTNative_StepRipple(myState, myWaterProc);
+
+		QTNative_SaveCheckpoint(myState);
+	}
+
+	myState->fNumPins++;
+	*theState = myState;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ReleaseGenerator
+// Unpin a simulation returned by QTNative_PrepareGenerator, once the bands of its step have been rendered. This is
+// the release procedure of the fire and water effects (see QTNative_ReleaseEffect).
+//
+//////////
+
+void QTNative_ReleaseGenerator (void *theState)
+{
+	NativeGeneratorState		*myState = (NativeGeneratorState *)theState;
+
+	if ((myState != NULL) && (myState->fNumPins > 0))
+		myState->fNumPins--;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Cloud functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetCloudGridRow
+// Supply a row of the clouds' grid to QTNative_RenderGridBand: the sum of the layers of interpolated random values.
+//
+//////////
+
+static void QTNative_GetCloudGridRow (const void *theRefCon, long theGridRow, unsigned char *theRow)
+{
+	const NativeCloudInfo		*myInfo = (const NativeCloudInfo *)theRefCon;
+	long						*myColumn = myInfo->fColumn;
+	long						mySum;
+	long						myX;
+	short						myOctave;
+
+	for (myX = 0; myX < myInfo->fGridWidth; myX++)
+		theRow[myX] = 0;
+
+	for (myOctave = 0; myOctave < kNativeCloudOctaves; myOctave++) {
+		long					mySpacing = myInfo->fSpacing[myOctave];
+		long					myY = theGridRow + myInfo->fOffsetY[myOctave];
+		long					myLatticeY = myY / mySpacing;
+		long					myWeightY = myInfo->fWeights[myOctave][myY % mySpacing];
+		long					myFirstX = myInfo->fOffsetX[myOctave] / mySpacing;
+		long					myNumX = ((myInfo->fOffsetX[myOctave] + myInfo->fGridWidth - 1) / mySpacing) - myFirstX + 2;
+		long					myCell, myFraction;
+		unsigned int			myKey = myInfo->fKeys[myOctave];
+		const unsigned short	*myWeights = myInfo->fWeights[myOctave];
+
+		// interpolate between two rows of random values, at each column of random values that this row crosses
+		for (myCell = 0; myCell < myNumX; myCell++) {
+			unsigned long		myCounter = ((unsigned long)myLatticeY * 0x10001UL) + (unsigned long)(myFirstX + myCell);
+			long				myAbove = QTNative_Random(myKey, myCounter) & 0xFF;
+			long				myBelow = QTNative_Random(myKey, myCounter + 0x10001UL) & 0xFF;
+
+			myColumn[myCell] = (myAbove << 8) + ((myBelow - myAbove) * myWeightY);
+		}
+
+		// then interpolate along the row between those columns
+		myCell = 0;
+		myFraction = myInfo->fOffsetX[myOctave] % mySpacing;
+		for (myX = 0; myX < myInfo->fGridWidth; myX++) {
+			long				myValue = (myColumn[myCell] << 8) + ((myColumn[myCell + 1] - myColumn[myCell]) * myWeights[myFraction]);
+
+			mySum = theRow[myX] + ((myValue * myInfo->fAmplitude[myOctave]) >> 24);
+			theRow[myX] = (unsigned char)((mySum > 255) ? 255 : mySum);
+
+			if (++myFraction == mySpacing) {
+				myFraction = 0;
+				myCell++;
+			}
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_CloudsProc
+// Render a step of the clouds.
+//
+//////////
+
+OSErr QTNative_CloudsProc (const NativeRenderJob *theJob)
+{
+	const NativeEffectParams	*myParams = theJob->fParams;
+	unsigned long				mySeed = (unsigned long)QTNative_GetEffectParam(myParams, kNativeParamSeed, kNativeDefaultSeed);
+	long						mySize = QTNative_GetEffectParam(myParams, kNativeParamCloudSize, kNativeDefaultCloudSize);
+	long						mySpeed = QTNative_GetEffectParam(myParams, kNativeParamCloudSpeed, kNativeDefaultCloudSpeed);
+	long						myCover = QTNative_GetEffectParam(myParams, kNativeParamCloudCover, kNativeDefaultCloudCover);
+	long						myStep = myParams->fStep;
+	NativeCloudInfo				myInfo;
+	unsigned int				myPalette[256];
+	long						myThreshold;
+	long						myIndex;
+	short						myOctave;
+	OSErr						myErr = noErr;
+
+	mySize = (mySize < 16) ? 16 : (mySize > kNativeMaxCloudSize) ? kNativeMaxCloudSize : mySize;
+	mySpeed = (mySpeed < 0) ? 0 : (mySpeed > 256) ? 256 : mySpeed;
+	myCover = (myCover < 0) ? 0 : (myCover > 256) ? 256 : myCover;
+	myStep = (myStep < 0) ? 0 : myStep;
+
+	memset(&myInfo, 0, sizeof(myInfo));
+	myInfo.fGridWidth = (theJob->fDest->fWidth >> kNativeGridShift) + 2;
+
+	// each layer is twice as fine and half as strong as the one before, and drifts a bit faster
+	for (myOctave = 0; myOctave < kNativeCloudOctaves; myOctave++) {
+		long					mySpacing = (mySize >> kNativeGridShift) >> myOctave;
+
+		mySpacing = (mySpacing < 2) ? 2 : mySpacing;
+
+		myInfo.fKeys[myOctave] = QTNative_GetRandomKey(mySeed, myOctave, kNativeGeneratorStreamClouds);
+		myInfo.fSpacing[myOctave] = mySpacing;
+		myInfo.fOffsetX[myOctave] = (myStep * mySpeed * (myOctave + 2)) >> (kNativeGridShift + 1);
+		myInfo.fOffsetY[myOctave] = (myStep * mySpeed * myOctave) >> (kNativeGridShift + 2);
+		myInfo.fAmplitude[myOctave] = 128 >> myOctave;
+
+		// smoothstep weights, so that the layers have no visible creases
+		myInfo.fWeights[myOctave] = (unsigned short *)QTNative_NewPoolBlock(mySpacing * sizeof(unsigned short));
+		if (myInfo.fWeights[myOctave] == NULL) {
+			myErr = memFullErr;
+			goto bail;
+		}
+
+		for (myIndex = 0; myIndex < mySpacing; myIndex++) {
+			long				myT = (myIndex * 256) / mySpacing;
+
+			myInfo.fWeights[myOctave][myIndex] = (unsigned short)((myT * myT * ((3 * 256) - (2 * myT))) >> 16);
+		}
+	}
+
+	myInfo.fColumn = (long *)QTNative_NewPoolBlock(((myInfo.fGridWidth / 2) + 4) * sizeof(long));
+	if (myInfo.fColumn == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	// the sum of the layers is at most 240; the cover sets how much of that range is clear sky
+	myThreshold = 240 - ((myCover * 240) >> 8);
+
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		long					myDensity = (myIndex - myThreshold) * 4;
+		long					myRed, myGreen, myBlue;
+
+		myDensity = (myDensity < 0) ? 0 : (myDensity > 256) ? 256 : myDensity;
+
+		myRed = ((0x48 * (256 - myDensity)) + (0xF4 * myDensity)) >> 8;
+		myGreen = ((0x80 * (256 - myDensity)) + (0xF4 * myDensity)) >> 8;
+		myBlue = ((0xD0 * (256 - myDensity)) + (0xF8 * myDensity)) >> 8;
+
+		myPalette[myIndex] = 0xFF000000U | ((unsigned int)myRed << 16) | ((unsigned int)myGreen << 8) | (unsigned int)myBlue;
+	}
+
+	myErr = QTNative_RenderGridBand(theJob, myInfo.fGridWidth, (theJob->fDest->fHeight >> kNativeGridShift) + 2, QTNative_GetCloudGridRow, &myInfo, myPalette);
+
+bail:
+	for (myOctave = 0; myOctave < kNativeCloudOctaves; myOctave++)
+		QTNative_DisposePoolBlock(myInfo.fWeights[myOctave]);
+	QTNative_DisposePoolBlock(myInfo.fColumn);
+
+	return(myErr);
+}
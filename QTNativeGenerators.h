@@ -0,0 +1,73 @@
+//////////
+//
+//	File:		QTNativeGenerators.h
+//
+//	Contains:	Native fire, clouds, and water ripple generators (effects with no sources).
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		added QTNative_ReleaseGenerator; QTNative_PrepareGenerator returns the simulation it prepared
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeGenerators__
+#define __QTNativeGenerators__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the random number streams used by the generators (see QTNativeNoise.h)
+#define kNativeGeneratorStreamFuel			16
+#define kNativeGeneratorStreamCooling		17
+#define kNativeGeneratorStreamDrops			18
+#define kNativeGeneratorStreamClouds		19
+
+// default values of the generator parameters
+#define kNativeDefaultFlameHeight			50			// how far up the frame the flames reach, in percent
+#define kNativeDefaultSputter				96			// the chance that a spot of the fuel is out, out of 256
+#define kNativeDefaultCloudSize				256			// the size of the largest clouds, in pixels
+#define kNativeDefaultCloudSpeed			4			// how far the clouds drift in a step, in pixels
+#define kNativeDefaultCloudCover			128			// how much of the sky the clouds cover, out of 256
+#define kNativeDefaultDrops					4			// the number of drops that fall in 16 steps
+#define kNativeDefaultDamping				6			// the ripples lose 1/2^damping of their height as they move
+#define kNativeDefaultDropRadius			6			// the radius of a drop (kNativeParamRadius), in pixels
+#define kNativeDefaultCheckpointInterval	16			// the number of steps between checkpoints of a simulation
+
+// limits
+#define kNativeMaxGeneratorStates			kNativeMaxPreparedEffects	// the number of fire and ripple simulations kept at once
+#define kNativeMaxCloudSize					1024
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_PrepareGenerator (const NativeEffectParams *theParams, long theWidth, long theHeight, void **theState);
+void						QTNative_ReleaseGenerator (void *theState);
+void						QTNative_FlushGenerators (void);
+void						QTNative_SetCheckpointInterval (long theNumSteps);
+
+OSErr						QTNative_FireProc (const NativeRenderJob *theJob);
+OSErr						QTNative_CloudsProc (const NativeRenderJob *theJob);
+OSErr						QTNative_RippleProc (const NativeRenderJob *theJob);
+
+#endif	// __QTNativeGenerators__
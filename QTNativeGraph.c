@@ -0,0 +1,566 @@
+//////////
+//
+//	File:		QTNativeGraph.c
+//
+//	Contains:	Graphs of native effects, scheduled on the worker threads with recycled intermediate buffers.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	10/17/26	rtm		a level is rendered in rounds of at most kNativeMaxPreparedEffects stateful nodes, whose states stay
+//									pinned until the round is done; the nodes no longer prepare anything on the worker threads
+//	   <2>	 	10/17/26	rtm		the stateful effects of a level are prepared one at a time before the level is rendered
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	In a QuickTime movie, the sources of an effect track are named in its effect description ('srcA', 'srcB',
+//	and so on), and the track's input map connects each name to another track (see the function
+//	QTEffects_AddTrackReferenceToInputMap in QTShowEffect.c); since a source can itself be an effect track, the
+//	effects of a movie form a graph. The functions in this file render such a graph natively: each node is a
+//	native effect, and each of its named sources is connected either to another node or to one of the pictures
+//	passed to QTNative_RenderGraph.
+//
+//	Rendering a graph happens in two steps. First we schedule it: starting from the output node, we give each
+//	node a level one higher than the highest level of the nodes it reads (which also finds any cycles), and we
+//	sort the nodes by level. The nodes of one level don't depend on each other, so they are rendered in
+//	parallel on the worker threads (and each of them is split into bands, as usual, by QTNative_RenderEffect).
+//	The state of a stateful effect (a fire, say) is prepared before its level is rendered, and stays pinned
+//	until the nodes are done; since only kNativeMaxPreparedEffects states can be pinned at once, a level with
+//	more stateful nodes than that is rendered in several rounds.
+//
+//	Then we assign an intermediate buffer to the output of each node, other than the output node (which
+//	renders straight into the destination). A buffer is returned to the free list as soon as the last node that
+//	reads it has been rendered, and the next level takes its buffers from that list before allocating new
+//	ones; so the number of whole frames allocated depends on how wide the graph is, not on how many nodes it has.
+//	A chain of filters, however long, needs only two buffers.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeGraph.h"
+#include "QTNativeFormats.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the order in which the nodes of a graph are rendered, and the buffers that receive their outputs
+typedef struct {
+	short						fNumNodes;							// the number of nodes that the output depends on
+	short						fOrder[kNativeMaxGraphNodes];		// those nodes, sorted by level
+	short						fNumLevels;
+	short						fLevelStarts[kNativeMaxGraphNodes + 1];	// the index in fOrder of the first node of each level
+	short						fBuffers[kNativeMaxGraphNodes];		// the buffer of each node, or -1 for the output node
+	short						fNumBuffers;
+} NativeGraphSchedule;
+
+// a level of a graph being rendered on the worker threads
+typedef struct {
+	const NativeEffectGraph *	fGraph;
+	const NativeGraphSchedule *	fSchedule;
+	const NativePixelBuffer **	fSources;
+	NativePixelBuffer *			fBuffers;
+	NativePixelBuffer *			fDest;
+	long						fStep;
+	long						fNumberOfSteps;
+	short						fFirstNode;							// the index in fOrder of the first node of the round
+	void *						fStates[kNativeMaxGraphNodes];		// the state of each node of the round, by its index in fOrder
+} NativeGraphInfo;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static short						QTNative_GetNodeLevel (const NativeEffectGraph *theGraph, short theNode, short theLevels[], Boolean theVisiting[]);
+static OSErr						QTNative_ScheduleGraph (const NativeEffectGraph *theGraph, NativeGraphSchedule *theSchedule);
+static OSErr						QTNative_RenderGraphNode (void *theRefCon, long theIndex);
+static void							QTNative_ReleaseGraphStates (NativeGraphInfo *theInfo, short theLastNode);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Graph building functions.
+//
+// Use these functions to build an effect graph.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_InitGraph
+// Initialize an effect graph that reads the specified number of pictures, with no nodes.
+//
+//////////
+
+OSErr QTNative_InitGraph (NativeEffectGraph *theGraph, short theNumSources)
+{
+	if ((theGraph == NULL) || (theNumSources < 0) || (theNumSources > kNativeMaxGraphSources))
+		return(paramErr);
+
+	memset(theGraph, 0, sizeof(NativeEffectGraph));
+	theGraph->fNumSources = theNumSources;
+	theGraph->fOutput = -1;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_AddGraphNode
+// Add a node for the specified effect to a graph, and return its index; the last node added is the graph's output,
+// unless QTNative_SetGraphOutput says otherwise.
+//
+//////////
+
+OSErr QTNative_AddGraphNode (NativeEffectGraph *theGraph, const NativeEffectParams *theParams, short *theNode)
+{
+	NativeGraphNode			*myNode = NULL;
+	short					myIndex;
+
+	if ((theGraph == NULL) || (theParams == NULL) || (theNode == NULL))
+		return(paramErr);
+
+	if (theGraph->fNumNodes >= kNativeMaxGraphNodes)
+		return(paramErr);
+
+	if (!QTNative_CanRenderEffect(theParams))
+		return(paramErr);
+
+	myNode = &theGraph->fNodes[theGraph->fNumNodes];
+	myNode->fParams = *theParams;
+	myNode->fNumInputs = 0;
+	for (myIndex = 0; myIndex < kNativeMaxSources; myIndex++) {
+		myNode->fSourceNames[myIndex] = 0;
+		myNode->fInputs[myIndex] = kNativeGraphNoInput;
+	}
+
+	*theNode = theGraph->fNumNodes;
+	theGraph->fOutput = theGraph->fNumNodes;
+	theGraph->fNumNodes++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ConnectGraphNode
+// Connect the named source of a node to another node, or (with kNativeGraphSource) to one of the graph's pictures.
+// Connecting a name a second time replaces its earlier connection.
+//
+//////////
+
+OSErr QTNative_ConnectGraphNode (NativeEffectGraph *theGraph, short theNode, OSType theSourceName, short theInput)
+{
+	NativeGraphNode			*myNode = NULL;
+	short					myIndex;
+
+	if ((theGraph == NULL) || (theNode < 0) || (theNode >= theGraph->fNumNodes))
+		return(paramErr);
+
+	if (theInput < 0) {
+		if (-1 - theInput >= theGraph->fNumSources)
+			return(paramErr);
+	} else {
+		if ((theInput >= theGraph->fNumNodes) || (theInput == theNode))
+			return(paramErr);
+	}
+
+	myNode = &theGraph->fNodes[theNode];
+
+	for (myIndex = 0; myIndex < myNode->fNumInputs; myIndex++)
+		if (myNode->fSourceNames[myIndex] == theSourceName)
+			break;
+
+	if (myIndex == myNode->fNumInputs) {
+		if (myNode->fNumInputs >= kNativeMaxSources)
+			return(paramErr);
+
+		myNode->fSourceNames[myIndex] = theSourceName;
+		myNode->fNumInputs++;
+	}
+
+	myNode->fInputs[myIndex] = theInput;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_SetGraphOutput
+// Make the specified node the graph's output; only that node and the nodes it depends on are rendered.
+//
+//////////
+
+OSErr QTNative_SetGraphOutput (NativeEffectGraph *theGraph, short theNode)
+{
+	if ((theGraph == NULL) || (theNode < 0) || (theNode >= theGraph->fNumNodes))
+		return(paramErr);
+
+	theGraph->fOutput = theNode;
+
+	return(noErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Graph scheduling functions.
+//
+// Use these functions to order the nodes of a graph and to assign buffers to their outputs.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetNodeLevel
+// Return the level of the specified node (0 if it reads only the graph's pictures, and otherwise one more than the
+// highest level of the nodes it reads), filling in the levels of the nodes it depends on as well; return -1 if
+// the node depends on itself or has a source that isn't connected.
+//
+//////////
+
+static short QTNative_GetNodeLevel (const NativeEffectGraph *theGraph, short theNode, short theLevels[], Boolean theVisiting[])
+{
+	const NativeGraphNode		*myNode = &theGraph->fNodes[theNode];
+	const NativeEffectEntry		*myEntry = NULL;
+	short						myLevel = 0;
+	short						myInputLevel;
+	short						myIndex;
+
+	if (theLevels[theNode] >= 0)
+		return(theLevels[theNode]);
+
+	// a node we're still working on is part of a cycle
+	if (theVisiting[theNode])
+		return(-1);
+
+	myEntry = QTNative_FindEffect(myNode->fParams.fEffectType);
+	if ((myEntry == NULL) || (myNode->fNumInputs < myEntry->fNumSources))
+		return(-1);
+
+	theVisiting[theNode] = true;
+
+	for (myIndex = 0; myIndex < myEntry->fNumSources; myIndex++) {
+		short					myInput = myNode->fInputs[myIndex];
+
+		if (myInput == kNativeGraphNoInput) {
+			myLevel = -1;
+			break;
+		}
+
+		if (myInput < 0)
+			continue;
+
+		myInputLevel = QTNative_GetNodeLevel(theGraph, myInput, theLevels, theVisiting);
+		if (myInputLevel < 0) {
+			myLevel = -1;
+			break;
+		}
+
+		if (myInputLevel + 1 > myLevel)
+			myLevel = myInputLevel + 1;
+	}
+
+	theVisiting[theNode] = false;
+	theLevels[theNode] = myLevel;
+
+	return(myLevel);
+}
+
+
+//////////
+//
+// QTNative_ScheduleGraph
+// Sort the nodes that the graph's output depends on by level, and assign a buffer to the output of each of them.
+//
+//////////
+
+static OSErr QTNative_ScheduleGraph (const NativeEffectGraph *theGraph, NativeGraphSchedule *theSchedule)
+{
+	short						myLevels[kNativeMaxGraphNodes];
+	Boolean						myVisiting[kNativeMaxGraphNodes];
+	short						myReaders[kNativeMaxGraphNodes];	// the number of sources still to be rendered that read each node
+	short						myFreeBuffers[kNativeMaxGraphNodes];
+	short						myNumFree = 0;
+	short						myNode, myLevel, myIndex, myInput;
+	short						myFirst, myLast;
+
+	if ((theGraph == NULL) || (theGraph->fOutput < 0) || (theGraph->fOutput >= theGraph->fNumNodes))
+		return(paramErr);
+
+	memset(theSchedule, 0, sizeof(NativeGraphSchedule));
+	for (myNode = 0; myNode < theGraph->fNumNodes; myNode++) {
+		myLevels[myNode] = -1;
+		myVisiting[myNode] = false;
+		myReaders[myNode] = 0;
+		theSchedule->fBuffers[myNode] = -1;
+	}
+
+	myLevel = QTNative_GetNodeLevel(theGraph, theGraph->fOutput, myLevels, myVisiting);
+	if (myLevel < 0)
+		return(paramErr);
+
+	// the output node reads (directly or not) every other node we render, so it's alone on the highest level
+	theSchedule->fNumLevels = myLevel + 1;
+
+	// sort the nodes by level; the nodes the output doesn't depend on still have a level of -1
+	for (myLevel = 0; myLevel < theSchedule->fNumLevels; myLevel++) {
+		theSchedule->fLevelStarts[myLevel] = theSchedule->fNumNodes;
+
+		for (myNode = 0; myNode < theGraph->fNumNodes; myNode++)
+			if (myLevels[myNode] == myLevel)
+				theSchedule->fOrder[theSchedule->fNumNodes++] = myNode;
+	}
+	theSchedule->fLevelStarts[theSchedule->fNumLevels] = theSchedule->fNumNodes;
+
+	// count the readers of each node
+	for (myIndex = 0; myIndex < theSchedule->fNumNodes; myIndex++) {
+		const NativeGraphNode	*myGraphNode = &theGraph->fNodes[theSchedule->fOrder[myIndex]];
+		short					myNumSources = QTNative_FindEffect(myGraphNode->fParams.fEffectType)->fNumSources;
+		short					mySource;
+
+		for (mySource = 0; mySource < myNumSources; mySource++)
+			if (myGraphNode->fInputs[mySource] >= 0)
+				myReaders[myGraphNode->fInputs[mySource]]++;
+	}
+
+	// assign the buffers, level by level; a buffer becomes free once all the nodes that read it have been rendered
+	for (myLevel = 0; myLevel < theSchedule->fNumLevels; myLevel++) {
+		myFirst = theSchedule->fLevelStarts[myLevel];
+		myLast = theSchedule->fLevelStarts[myLevel + 1];
+
+		for (myIndex = myFirst; myIndex < myLast; myIndex++) {
+			myNode = theSchedule->fOrder[myIndex];
+			if (myNode == theGraph->fOutput)
+				continue;
+
+			if (myNumFree > 0)
+				theSchedule->fBuffers[myNode] = myFreeBuffers[--myNumFree];
+			else
+				theSchedule->fBuffers[myNode] = theSchedule->fNumBuffers++;
+		}
+
+		for (myIndex = myFirst; myIndex < myLast; myIndex++) {
+			const NativeGraphNode	*myGraphNode = &theGraph->fNodes[theSchedule->fOrder[myIndex]];
+			short					myNumSources = QTNative_FindEffect(myGraphNode->fParams.fEffectType)->fNumSources;
+			short					mySource;
+
+			for (mySource = 0; mySource < myNumSources; mySource++) {
+				myInput = myGraphNode->fInputs[mySource];
+				if ((myInput >= 0) && (--myReaders[myInput] == 0))
+					myFreeBuffers[myNumFree++] = theSchedule->fBuffers[myInput];
+			}
+		}
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_GetGraphBufferCount
+// Return the number of intermediate buffers (each the size of a whole frame) needed to render a graph, or -1 if the
+// graph can't be rendered.
+//
+//////////
+
+long QTNative_GetGraphBufferCount (const NativeEffectGraph *theGraph)
+{
+	NativeGraphSchedule			mySchedule;
+
+	if (QTNative_ScheduleGraph(theGraph, &mySchedule) != noErr)
+		return(-1);
+
+	return(mySchedule.fNumBuffers);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Graph rendering functions.
+//
+// Use these functions to render one step of an effect graph.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_RenderGraph
+// Render one step of an effect graph into the specified destination buffer.
+//
+// The graph's pictures must be at least as large as the destination, and all the nodes render the same step.
+//
+//////////
+
+OSErr QTNative_RenderGraph (const NativeEffectGraph *theGraph, long theStep, long theNumberOfSteps, const NativePixelBuffer *theSources[], NativePixelBuffer *theDest)
+{
+	NativeGraphSchedule			mySchedule;
+	NativeGraphInfo				myInfo;
+	NativePixelBuffer			*myBuffers = NULL;
+	short						myLevel;
+	short						myIndex;
+	short						myLastNode = 0;
+	short						myNumStates;
+	OSErr						myErr = noErr;
+
+	if ((theDest == NULL) || (theDest->fBaseAddr == NULL) || (theNumberOfSteps <= 0))
+		return(paramErr);
+
+	if ((theGraph != NULL) && (theGraph->fNumSources > 0) && (theSources == NULL))
+		return(paramErr);
+
+	memset(&myInfo, 0, sizeof(myInfo));
+
+	myErr = QTNative_ScheduleGraph(theGraph, &mySchedule);
+	if (myErr != noErr)
+		goto bail;
+
+	// allocate the intermediate buffers, in the host's 32-bit format
+	if (mySchedule.fNumBuffers > 0) {
+		myBuffers = (NativePixelBuffer *)calloc((size_t)mySchedule.fNumBuffers, sizeof(NativePixelBuffer));
+		if (myBuffers == NULL) {
+			myErr = memFullErr;
+			goto bail;
+		}
+
+		for (myIndex = 0; myIndex < mySchedule.fNumBuffers; myIndex++) {
+			myErr = QTNative_NewPixelBuffer(&myBuffers[myIndex], theDest->fWidth, theDest->fHeight, QTNative_GetHostPixelFormat());
+			if (myErr != noErr)
+				goto bail;
+		}
+	}
+
+	myInfo.fGraph = theGraph;
+	myInfo.fSchedule = &mySchedule;
+	myInfo.fSources = theSources;
+	myInfo.fBuffers = myBuffers;
+	myInfo.fDest = theDest;
+	myInfo.fStep = theStep;
+	myInfo.fNumberOfSteps = theNumberOfSteps;
+
+	// render the levels in order, and the nodes of each level in parallel
+	for (myLevel = 0; myLevel < mySchedule.fNumLevels; myLevel++) {
+		myInfo.fFirstNode = mySchedule.fLevelStarts[myLevel];
+
+		while (myInfo.fFirstNode < mySchedule.fLevelStarts[myLevel + 1]) {
+			// bring the state of the stateful effects in this round up to this step, one node at a time, so that
+			// the nodes rendered in parallel only read their states; the round ends when no more states fit
+			myLastNode = myInfo.fFirstNode;
+			myNumStates = 0;
+			while (myLastNode < mySchedule.fLevelStarts[myLevel + 1]) {
+				NativeEffectParams	myParams = theGraph->fNodes[mySchedule.fOrder[myLastNode]].fParams;
+
+				myParams.fStep = theStep;
+				myParams.fNumberOfSteps = theNumberOfSteps;
+
+				if (QTNative_EffectHasState(&myParams)) {
+					if (myNumStates == kNativeMaxPreparedEffects)
+						break;
+					myNumStates++;
+				}
+
+				myErr = QTNative_PrepareEffect(&myParams, theDest, &myInfo.fStates[myLastNode]);
+				myLastNode++;
+				if (myErr != noErr)
+					goto bail;
+			}
+
+			myErr = QTNative_ParallelFor(myLastNode - myInfo.fFirstNode, QTNative_RenderGraphNode, &myInfo);
+			if (myErr != noErr)
+				goto bail;
+
+			QTNative_ReleaseGraphStates(&myInfo, myLastNode);
+			myInfo.fFirstNode = myLastNode;
+		}
+	}
+
+bail:
+	// release the states of a round that was cut short
+	QTNative_ReleaseGraphStates(&myInfo, myLastNode);
+
+	if (myBuffers != NULL) {
+		for (myIndex = 0; myIndex < mySchedule.fNumBuffers; myIndex++)
+			QTNative_DisposePixelBuffer(&myBuffers[myIndex]);
+		free(myBuffers);
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_RenderGraphNode
+// Render one node of a round of a graph, with the state that QTNative_RenderGraph prepared for it; this is called on
+// a worker thread by QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_RenderGraphNode (void *theRefCon, long theIndex)
+{
+	const NativeGraphInfo		*myInfo = (const NativeGraphInfo *)theRefCon;
+	short						myNode = myInfo->fSchedule->fOrder[myInfo->fFirstNode + theIndex];
+	const NativeGraphNode		*myGraphNode = &myInfo->fGraph->fNodes[myNode];
+	const NativePixelBuffer		*mySources[kNativeMaxSources];
+	NativePixelBuffer			*myDest = NULL;
+	NativeEffectParams			myParams;
+	short						mySource;
+
+	for (mySource = 0; mySource < myGraphNode->fNumInputs; mySource++) {
+		short					myInput = myGraphNode->fInputs[mySource];
+
+		if (myInput == kNativeGraphNoInput)
+			mySources[mySource] = NULL;
+		else if (myInput < 0)
+			mySources[mySource] = myInfo->fSources[-1 - myInput];
+		else
+			mySources[mySource] = &myInfo->fBuffers[myInfo->fSchedule->fBuffers[myInput]];
+	}
+
+	if (myNode == myInfo->fGraph->fOutput)
+		myDest = myInfo->fDest;
+	else
+		myDest = &myInfo->fBuffers[myInfo->fSchedule->fBuffers[myNode]];
+
+	// each node gets its own copy of the parameters, since they hold the step number
+	myParams = myGraphNode->fParams;
+	myParams.fStep = myInfo->fStep;
+	myParams.fNumberOfSteps = myInfo->fNumberOfSteps;
+
+	return(QTNative_RenderPreparedEffect(&myParams, mySources, myGraphNode->fNumInputs, myDest, myInfo->fStates[myInfo->fFirstNode + theIndex]));
+}
+
+
+//////////
+//
+// QTNative_ReleaseGraphStates
+// Release the states of the nodes of the current round (up to the node at index theLastNode in fOrder, which isn't
+// in the round), once the round has been rendered.
+//
+//////////
+
+static void QTNative_ReleaseGraphStates (NativeGraphInfo *theInfo, short theLastNode)
+{
+	short						myIndex;
+
+	for (myIndex = theInfo->fFirstNode; myIndex < theLastNode; myIndex++) {
+		if (theInfo->fStates[myIndex] != NULL)
+			QTNative_ReleaseEffect(&theInfo->fGraph->fNodes[theInfo->fSchedule->fOrder[myIndex]].fParams, theInfo->fStates[myIndex]);
+		theInfo->fStates[myIndex] = NULL;
+	}
+}
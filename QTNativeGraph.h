@@ -0,0 +1,84 @@
+//////////
+//
+//	File:		QTNativeGraph.h
+//
+//	Contains:	Graphs of native effects, scheduled on the worker threads with recycled intermediate buffers.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeGraph__
+#define __QTNativeGraph__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// limits
+#define kNativeMaxGraphNodes				32
+#define kNativeMaxGraphSources				8
+
+// the input of a node that reads one of the pictures passed to QTNative_RenderGraph, rather than another node
+#define kNativeGraphSource(n)				(-1 - (n))
+
+// a node input that isn't connected yet
+#define kNativeGraphNoInput					0x7FFF
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a node of an effect graph: an effect, and the nodes (or graph sources) that its sources are connected to;
+// as in an effect description, each source has a name (such as 'srcA'), and the sources are passed to the
+// effect in the order in which they were first connected
+typedef struct {
+	NativeEffectParams		fParams;
+	short					fNumInputs;
+	OSType					fSourceNames[kNativeMaxSources];
+	short					fInputs[kNativeMaxSources];		// a node index, or kNativeGraphSource(n)
+} NativeGraphNode;
+
+// a directed acyclic graph of effects, whose output is the output of one of its nodes
+typedef struct {
+	short					fNumNodes;
+	short					fNumSources;					// the number of pictures the graph reads
+	short					fOutput;						// the node that renders the graph's output
+	NativeGraphNode			fNodes[kNativeMaxGraphNodes];
+} NativeEffectGraph;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_InitGraph (NativeEffectGraph *theGraph, short theNumSources);
+OSErr						QTNative_AddGraphNode (NativeEffectGraph *theGraph, const NativeEffectParams *theParams, short *theNode);
+OSErr						QTNative_ConnectGraphNode (NativeEffectGraph *theGraph, short theNode, OSType theSourceName, short theInput);
+OSErr						QTNative_SetGraphOutput (NativeEffectGraph *theGraph, short theNode);
+long						QTNative_GetGraphBufferCount (const NativeEffectGraph *theGraph);
+OSErr						QTNative_RenderGraph (const NativeEffectGraph *theGraph, long theStep, long theNumberOfSteps, const NativePixelBuffer *theSources[], NativePixelBuffer *theDest);
+
+#endif	// __QTNativeGraph__
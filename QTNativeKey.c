@@ -0,0 +1,359 @@
+//////////
+//
+//	File:		QTNativeKey.c
+//
+//	Contains:	A native chroma key compositor.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <2>	 	10/17/26	rtm		the scratch rows of each band come from the frame pool
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The chroma key effect composites the first source over the second, replacing the pixels of the first
+//	source whose color is close to a key color (typically the green or blue of a backdrop).
+//
+//	We measure how close a pixel is to the key color in chroma only (the Cb and Cr of YCbCr), so that the
+//	shadows and highlights of the backdrop are keyed as well as its flat areas. A pixel whose chroma distance
+//	from the key color is within the tolerance is replaced by the second source; one that's farther away
+//	than the tolerance plus the softness is kept; and the pixels in between (typically along the edges of the
+//	foreground) are blended, which feathers the edges. Spill suppression removes the key color's tint from the
+//	kept pixels, by pinning the key's strongest channel to the larger of the other two channels.
+//
+//	Everything happens in a single pass over the two sources: for each pixel we compute the matte value and
+//	blend right away. The matte is written out only if the caller passes a buffer for it.
+//
+//	There's an AVX2 version of the row kernel, which does 8 pixels at a time and produces exactly the same
+//	pixels as the scalar version.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeKey.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the chroma of a pixel is computed with this offset added, so that it's never negative
+#define kNativeChromaOffset				32768
+
+// the matte value of a pixel that's kept entirely
+#define kNativeMatteOpaque				256
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the settings of the chroma key, in the form the row kernels use them
+typedef struct {
+	long					fKeyCb;
+	long					fKeyCr;
+	long					fTolerance;
+	long					fScale;						// 65536 / softness
+	short					fSpillChannel;				// 0 (none), 16 (red), 8 (green), or 1 (blue)
+} NativeKeyInfo;
+
+typedef void (*NativeKeyRowProcPtr) (const unsigned int *theSrcA, const unsigned int *theSrcB, unsigned int *theDest, unsigned char *theMatte, long theWidth, const NativeKeyInfo *theInfo);
+
+
+//////////
+//
+// chroma macros
+//
+//////////
+
+#define NATIVE_CB(theRed, theGreen, theBlue)		((((theBlue) * 128) - ((theRed) * 43) - ((theGreen) * 85) + kNativeChromaOffset) >> 8)
+#define NATIVE_CR(theRed, theGreen, theBlue)		((((theRed) * 128) - ((theGreen) * 107) - ((theBlue) * 21) + kNativeChromaOffset) >> 8)
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Row kernels.
+//
+// Each of these functions keys a row of pixels held as 0xAARRGGBB values.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_ChromaKeyRowScalar
+// Key a row of pixels, one at a time.
+//
+//////////
+
+static void QTNative_ChromaKeyRowScalar (const unsigned int *theSrcA, const unsigned int *theSrcB, unsigned int *theDest, unsigned char *theMatte, long theWidth, const NativeKeyInfo *theInfo)
+{
+	long				myX;
+
+	for (myX = 0; myX < theWidth; myX++) {
+		unsigned long	myPixel = theSrcA[myX];
+		long			myRed = (myPixel >> 16) & 0xFF;
+		long			myGreen = (myPixel >> 8) & 0xFF;
+		long			myBlue = myPixel & 0xFF;
+		long			myCb = NATIVE_CB(myRed, myGreen, myBlue) - theInfo->fKeyCb;
+		long			myCr = NATIVE_CR(myRed, myGreen, myBlue) - theInfo->fKeyCr;
+		long			myDistance = ((myCb < 0) ? -myCb : myCb) + ((myCr < 0) ? -myCr : myCr) - theInfo->fTolerance;
+		long			myAlpha;
+
+		// the matte value: 0 within the tolerance, rising to kNativeMatteOpaque across the soft edge
+		myAlpha = (myDistance < 0) ? 0 : ((myDistance * theInfo->fScale) >> 8);
+		if (myAlpha > kNativeMatteOpaque)
+			myAlpha = kNativeMatteOpaque;
+
+		// pin the key's strongest channel to the larger of the other two
+		switch (theInfo->fSpillChannel) {
+			case 16:
+				myRed = (myRed < ((myGreen > myBlue) ? myGreen : myBlue)) ? myRed : ((myGreen > myBlue) ? myGreen : myBlue);
+				break;
+			case 8:
+				myGreen = (myGreen < ((myRed > myBlue) ? myRed : myBlue)) ? myGreen : ((myRed > myBlue) ? myRed : myBlue);
+				break;
+			case 1:
+				myBlue = (myBlue < ((myRed > myGreen) ? myRed : myGreen)) ? myBlue : ((myRed > myGreen) ? myRed : myGreen);
+				break;
+		}
+
+		myPixel = (myPixel & 0xFF000000UL) | ((unsigned long)myRed << 16) | ((unsigned long)myGreen << 8) | (unsigned long)myBlue;
+		theDest[myX] = (unsigned int)NATIVE_BLEND_PIXELS((unsigned long)theSrcB[myX], myPixel, myAlpha);
+
+		if (theMatte != NULL)
+			theMatte[myX] = (unsigned char)((myAlpha > 255) ? 255 : myAlpha);
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_ChromaKeyRowAVX2
+// Key a row of pixels, 8 at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ChromaKeyRowAVX2 (const unsigned int *theSrcA, const unsigned int *theSrcB, unsigned int *theDest, unsigned char *theMatte, long theWidth, const NativeKeyInfo *theInfo)
+{
+	const __m256i		myByteMask = _mm256_set1_epi32(0xFF);
+	const __m256i		myEvenMask = _mm256_set1_epi32(0x00FF00FF);
+	const __m256i		myOddMask = _mm256_set1_epi32((int)0xFF00FF00U);
+	const __m256i		myOffset = _mm256_set1_epi32(kNativeChromaOffset);
+	const __m256i		myKeyCb = _mm256_set1_epi32((int)theInfo->fKeyCb);
+	const __m256i		myKeyCr = _mm256_set1_epi32((int)theInfo->fKeyCr);
+	const __m256i		myTolerance = _mm256_set1_epi32((int)theInfo->fTolerance);
+	const __m256i		myScale = _mm256_set1_epi32((int)theInfo->fScale);
+	const __m256i		myOpaque = _mm256_set1_epi32(kNativeMatteOpaque);
+	const __m256i		myZero = _mm256_setzero_si256();
+	long				myX;
+
+	for (myX = 0; myX + 8 <= theWidth; myX += 8) {
+		__m256i			myPixelsA = _mm256_loadu_si256((const __m256i *)(theSrcA + myX));
+		__m256i			myPixelsB = _mm256_loadu_si256((const __m256i *)(theSrcB + myX));
+		__m256i			myRed = _mm256_and_si256(_mm256_srli_epi32(myPixelsA, 16), myByteMask);
+		__m256i			myGreen = _mm256_and_si256(_mm256_srli_epi32(myPixelsA, 8), myByteMask);
+		__m256i			myBlue = _mm256_and_si256(myPixelsA, myByteMask);
+		__m256i			myCb, myCr, myAlpha, myInverse, myEven, myOdd;
+
+		myCb = _mm256_sub_epi32(_mm256_slli_epi32(myBlue, 7), _mm256_add_epi32(_mm256_mullo_epi32(myRed, _mm256_set1_epi32(43)), _mm256_mullo_epi32(myGreen, _mm256_set1_epi32(85))));
+		myCb = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_add_epi32(myCb, myOffset), 8), myKeyCb);
+		myCr = _mm256_sub_epi32(_mm256_slli_epi32(myRed, 7), _mm256_add_epi32(_mm256_mullo_epi32(myGreen, _mm256_set1_epi32(107)), _mm256_mullo_epi32(myBlue, _mm256_set1_epi32(21))));
+		myCr = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_add_epi32(myCr, myOffset), 8), myKeyCr);
+
+		myAlpha = _mm256_sub_epi32(_mm256_add_epi32(_mm256_abs_epi32(myCb), _mm256_abs_epi32(myCr)), myTolerance);
+		myAlpha = _mm256_max_epi32(myAlpha, myZero);
+		myAlpha = _mm256_min_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(myAlpha, myScale), 8), myOpaque);
+
+		switch (theInfo->fSpillChannel) {
+			case 16:
+				myRed = _mm256_min_epi32(myRed, _mm256_max_epi32(myGreen, myBlue));
+				break;
+			case 8:
+				myGreen = _mm256_min_epi32(myGreen, _mm256_max_epi32(myRed, myBlue));
+				break;
+			case 1:
+				myBlue = _mm256_min_epi32(myBlue, _mm256_max_epi32(myRed, myGreen));
+				break;
+		}
+
+		myPixelsA = _mm256_or_si256(_mm256_andnot_si256(_mm256_set1_epi32(0x00FFFFFF), myPixelsA),
+									_mm256_or_si256(_mm256_slli_epi32(myRed, 16), _mm256_or_si256(_mm256_slli_epi32(myGreen, 8), myBlue)));
+
+		// NATIVE_BLEND_PIXELS(b, a, alpha), two channels at a time in each 32-bit lane
+		myInverse = _mm256_sub_epi32(myOpaque, myAlpha);
+		myEven = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(myPixelsB, myEvenMask), myInverse),
+									_mm256_mullo_epi32(_mm256_and_si256(myPixelsA, myEvenMask), myAlpha));
+		myOdd = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(myPixelsB, 8), myEvenMask), myInverse),
+									_mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(myPixelsA, 8), myEvenMask), myAlpha));
+		myPixelsA = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(myEven, 8), myEvenMask), _mm256_and_si256(myOdd, myOddMask));
+		_mm256_storeu_si256((__m256i *)(theDest + myX), myPixelsA);
+
+		if (theMatte != NULL) {
+			__m256i		myMatte = _mm256_min_epi32(myAlpha, myByteMask);
+			unsigned int	myBytes[2];
+
+			myMatte = _mm256_packus_epi32(myMatte, myMatte);
+			myMatte = _mm256_packus_epi16(myMatte, myMatte);
+			myBytes[0] = (unsigned int)_mm256_cvtsi256_si32(myMatte);
+			myBytes[1] = (unsigned int)_mm256_extract_epi32(myMatte, 4);
+			memcpy(theMatte + myX, myBytes, sizeof(myBytes));
+		}
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theWidth)
+		QTNative_ChromaKeyRowScalar(theSrcA + myX, theSrcB + myX, theDest + myX, (theMatte != NULL) ? theMatte + myX : NULL, theWidth - myX, theInfo);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Chroma key functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetChromaKey
+// Read the chroma key settings from the specified effect parameters.
+//
+//////////
+
+void QTNative_GetChromaKey (const NativeEffectParams *theParams, NativeChromaKey *theKey)
+{
+	theKey->fKeyColor = (unsigned long)QTNative_GetEffectParam(theParams, kNativeParamKeyColor, kNativeDefaultKeyColor) & 0x00FFFFFFUL;
+	theKey->fTolerance = QTNative_GetEffectParam(theParams, kNativeParamKeyTolerance, kNativeDefaultKeyTolerance);
+	theKey->fSoftness = QTNative_GetEffectParam(theParams, kNativeParamKeySoftness, kNativeDefaultKeySoftness);
+	theKey->fSuppressSpill = (QTNative_GetEffectParam(theParams, kNativeParamKeySpill, kNativeDefaultKeySpill) != 0);
+}
+
+
+//////////
+//
+// QTNative_ChromaKeyBand
+// Composite the specified rows of theSrcA over theSrcB into theDest, keying out theKey's color. If theMatte isn't
+// NULL, it must be an 8-bit buffer the size of theDest; it receives the matte (0 where theSrcB shows through,
+// 255 where theSrcA is kept).
+//
+// When a source or the destination is already in the host's 0xAARRGGBB format, its rows are used in place.
+//
+//////////
+
+OSErr QTNative_ChromaKeyBand (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theFirstRow, long theLastRow, const NativeChromaKey *theKey, NativePixelBuffer *theMatte)
+{
+	OSType					myRowFormat = QTNative_GetHostPixelFormat();
+	NativeSpanKernels		myToRowA, myToRowB, myFromRow;
+	NativeKeyRowProcPtr		myRowProc = QTNative_ChromaKeyRowScalar;
+	NativeKeyInfo			myInfo;
+	Boolean					myCopyA = (theSrcA->fPixelFormat != myRowFormat);
+	Boolean					myCopyB = (theSrcB->fPixelFormat != myRowFormat);
+	Boolean					myCopyDest = (theDest->fPixelFormat != myRowFormat);
+	unsigned int			*myRows = NULL;
+	long					myKeyRed = (long)((theKey->fKeyColor >> 16) & 0xFF);
+	long					myKeyGreen = (long)((theKey->fKeyColor >> 8) & 0xFF);
+	long					myKeyBlue = (long)(theKey->fKeyColor & 0xFF);
+	long					myWidth = theDest->fWidth;
+	long					myRow;
+
+	if ((theMatte != NULL) && ((theMatte->fPixelFormat != kNativePixelFormat_8Indexed) || (theMatte->fWidth < myWidth) || (theMatte->fHeight < theDest->fHeight)))
+		return(paramErr);
+
+	if (!QTNative_GetSpanKernels(theSrcA->fPixelFormat, myRowFormat, &myToRowA) ||
+		!QTNative_GetSpanKernels(theSrcB->fPixelFormat, myRowFormat, &myToRowB) ||
+		!QTNative_GetSpanKernels(myRowFormat, theDest->fPixelFormat, &myFromRow))
+		return(paramErr);
+
+	myInfo.fKeyCb = NATIVE_CB(myKeyRed, myKeyGreen, myKeyBlue);
+	myInfo.fKeyCr = NATIVE_CR(myKeyRed, myKeyGreen, myKeyBlue);
+	myInfo.fTolerance = (theKey->fTolerance < 0) ? 0 : (theKey->fTolerance > 510) ? 510 : theKey->fTolerance;
+	myInfo.fScale = 65536 / ((theKey->fSoftness < 1) ? 1 : (theKey->fSoftness > 510) ? 510 : theKey->fSoftness);
+
+	// the channel to pin is the key color's strongest one
+	myInfo.fSpillChannel = 0;
+	if (theKey->fSuppressSpill) {
+		if ((myKeyGreen >= myKeyRed) && (myKeyGreen >= myKeyBlue))
+			myInfo.fSpillChannel = 8;
+		else if (myKeyBlue >= myKeyRed)
+			myInfo.fSpillChannel = 1;
+		else
+			myInfo.fSpillChannel = 16;
+	}
+
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		myRowProc = QTNative_ChromaKeyRowAVX2;
+#endif
+
+	// we need a row for each buffer that isn't in the host format already
+	myRows = (unsigned int *)QTNative_NewPoolBlock(myWidth * 3 * sizeof(unsigned int));
+	if (myRows == NULL)
+		return(memFullErr);
+
+	for (myRow = theFirstRow; myRow < theLastRow; myRow++) {
+		const unsigned char	*mySrcA = QTNative_GetRowAddress(theSrcA, myRow);
+		const unsigned char	*mySrcB = QTNative_GetRowAddress(theSrcB, myRow);
+		unsigned char		*myDest = QTNative_GetRowAddress(theDest, myRow);
+		const unsigned int	*myRowA = (const unsigned int *)mySrcA;
+		const unsigned int	*myRowB = (const unsigned int *)mySrcB;
+		unsigned int		*myRowDest = (unsigned int *)myDest;
+
+		if (myCopyA) {
+			myToRowA.fConvert(mySrcA, (unsigned char *)myRows, myWidth, theSrcA->fColorTable);
+			myRowA = myRows;
+		}
+
+		if (myCopyB) {
+			myToRowB.fConvert(mySrcB, (unsigned char *)(myRows + myWidth), myWidth, theSrcB->fColorTable);
+			myRowB = myRows + myWidth;
+		}
+
+		if (myCopyDest)
+			myRowDest = myRows + (2 * myWidth);
+
+		myRowProc(myRowA, myRowB, myRowDest, (theMatte != NULL) ? QTNative_GetRowAddress(theMatte, myRow) : NULL, myWidth, &myInfo);
+
+		if (myCopyDest)
+			myFromRow.fConvert((const unsigned char *)myRowDest, myDest, myWidth, NULL);
+	}
+
+	QTNative_DisposePoolBlock(myRows);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ChromaKeyProc
+// Composite the first source over the second, keying out the key color.
+//
+//////////
+
+OSErr QTNative_ChromaKeyProc (const NativeRenderJob *theJob)
+{
+	NativeChromaKey			myKey;
+
+	QTNative_GetChromaKey(theJob->fParams, &myKey);
+
+	return(QTNative_ChromaKeyBand(theJob->fSources[0], theJob->fSources[1], theJob->fDest, theJob->fFirstRow, theJob->fLastRow, &myKey, NULL));
+}
@@ -0,0 +1,67 @@
+//////////
+//
+//	File:		QTNativeKey.h
+//
+//	Contains:	A native chroma key compositor.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeKey__
+#define __QTNativeKey__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// default values of the chroma key parameters
+#define kNativeDefaultKeyColor				0x0000FF00	// the color to key out, as 0x00RRGGBB
+#define kNativeDefaultKeyTolerance			48			// colors this close to the key color (in chroma) are replaced entirely
+#define kNativeDefaultKeySoftness			32			// colors up to this much farther away are blended
+#define kNativeDefaultKeySpill				1			// nonzero to remove the key color's tint from the kept pixels
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the settings of the chroma key
+typedef struct {
+	unsigned long			fKeyColor;
+	long					fTolerance;
+	long					fSoftness;
+	Boolean					fSuppressSpill;
+} NativeChromaKey;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void						QTNative_GetChromaKey (const NativeEffectParams *theParams, NativeChromaKey *theKey);
+OSErr						QTNative_ChromaKeyBand (const NativePixelBuffer *theSrcA, const NativePixelBuffer *theSrcB, NativePixelBuffer *theDest, long theFirstRow, long theLastRow, const NativeChromaKey *theKey, NativePixelBuffer *theMatte);
+OSErr						QTNative_ChromaKeyProc (const NativeRenderJob *theJob);
+
+#endif	// __QTNativeKey__
@@ -0,0 +1,524 @@
+//////////
+//
+//	File:		QTNativeLoader.c
+//
+//	Contains:	A background thread that loads effect sources, so that the user interface doesn't wait for them.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		stale jobs are handed back to the thread that makes the requests, which disposes of them
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	Decoding a large picture and scaling it to the size of the effect can take a noticeable time; if it's done
+//	on the main thread, the window stops updating until it's done. Instead, the main thread hands a "job" that
+//	describes the source to QTNative_RequestLoad, and carries on showing the current frame; our loader thread
+//	calls the job's load proc, and when it's done, calls the ready proc, so that the main thread knows to take
+//	the job (with QTNative_TakeLoadedJob) and install the new source. The loader thread is a thread of its own,
+//	rather than one of the worker threads (QTNativeThreads.c), so that a long decode never holds up a parallel
+//	loop; the load proc can still use parallel loops (to resample the picture, say).
+//
+//	Each source has a slot (0 for the first source, 1 for the second, and so on), and each slot has a generation
+//	number that goes up with every request. Only the newest request for a slot matters:
+//
+//		a request that hasn't started yet is disposed of as soon as a newer one arrives;
+//		a load in progress can check QTNative_IsLoadCurrent between stages, and give up if it's out of date;
+//		a job that finishes after a newer request has arrived is disposed of rather than made ready;
+//		a ready job that hasn't been taken yet is disposed of when a newer request arrives.
+//
+//	So the main thread only ever takes the result of the newest request, and a stale picture can never replace
+//	a newer one. The loader lock protects the slots; the jobs themselves belong to the loader from the time
+//	they're requested until they're taken, so neither thread needs to lock them.
+//
+//	The dispose proc is only ever called on the main thread (the thread that calls QTNative_RequestLoad and
+//	QTNative_TakeLoadedJob), since a job may hold things that only that thread can touch. A job that the loader
+//	thread finds to be stale goes onto a list of stale requests, which the main thread empties the next time it
+//	calls into the loader. Each request is wrapped in a NativeLoadRequest when it's made, so that the loader
+//	thread can put it on that list without allocating anything.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeLoader.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a request for a job to be loaded
+typedef struct NativeLoadRequest {
+	void *						fJob;
+	unsigned long				fGeneration;
+	OSErr						fErr;						// the result of the job's load proc
+	struct NativeLoadRequest *	fNext;						// the next stale request
+} NativeLoadRequest;
+
+// the state of one source slot
+typedef struct {
+	unsigned long				fGeneration;				// the generation of the newest request
+	NativeLoadRequest *			fPendingRequest;			// the newest request, if it hasn't started yet
+	NativeLoadRequest *			fReadyRequest;				// the newest finished request, if it hasn't been taken yet
+	Boolean						fLoading;					// is a job for this slot being loaded right now?
+} NativeLoadSlot;
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeLock					gNativeLoaderLock;					// protects everything below
+static NativeCondition				gNativeLoaderWork;					// signaled when there's a new request, or on shutdown
+static NativeLoadSlot				gNativeLoadSlots[kNativeMaxSources];
+static NativeLoadRequest *			gNativeStaleRequests = NULL;		// the requests the loader thread found to be stale
+static NativeLoaderProcs			gNativeLoaderProcs;
+static Boolean						gNativeLoaderStarted = false;
+static Boolean						gNativeLoaderStopping = false;
+#if defined(_WIN32)
+static HANDLE						gNativeLoaderThread = NULL;
+#else
+static pthread_t					gNativeLoaderThread;
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Loader thread functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_TakePendingRequest
+// Take a request that hasn't started yet (the one for the lowest slot, if there are several), and mark its slot
+// as loading. Return NULL if there are none. The loader lock must be held.
+//
+//////////
+
+static NativeLoadRequest *QTNative_TakePendingRequest (short *theSlot)
+{
+	NativeLoadRequest			*myRequest = NULL;
+	short						myIndex;
+
+	for (myIndex = 0; myIndex < kNativeMaxSources; myIndex++) {
+		NativeLoadSlot			*mySlot = &gNativeLoadSlots[myIndex];
+
+		if (mySlot->fPendingRequest != NULL) {
+			*theSlot = myIndex;
+			myRequest = mySlot->fPendingRequest;
+
+			mySlot->fPendingRequest = NULL;
+			mySlot->fLoading = true;
+			return(myRequest);
+		}
+	}
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTNative_LoaderThread
+// The body of the loader thread: load the pending requests, one at a time, until the loader is stopped.
+//
+//////////
+
+#if defined(_WIN32)
+static DWORD WINAPI QTNative_LoaderThread (LPVOID theParam)
+#else
+static void *QTNative_LoaderThread (void *theParam)
+#endif
+{
+	short						mySlotIndex;
+	NativeLoadRequest			*myRequest = NULL;
+	OSErr						myErr;
+
+	(void)theParam;
+
+	QTNative_Lock(&gNativeLoaderLock);
+
+	while (!gNativeLoaderStopping) {
+		NativeLoadSlot			*mySlot;
+		NativeLoadRequest		*myStaleRequest = NULL;
+		Boolean					isReady = false;
+
+		myRequest = QTNative_TakePendingRequest(&mySlotIndex);
+		if (myRequest == NULL) {
+			QTNative_WaitCondition(&gNativeLoaderWork, &gNativeLoaderLock);
+			continue;
+		}
+
+		// load the job without holding the lock, so that the main thread can make new requests meanwhile
+		QTNative_Unlock(&gNativeLoaderLock);
+		myErr = gNativeLoaderProcs.fLoad(myRequest->fJob, mySlotIndex, myRequest->fGeneration);
+		QTNative_Lock(&gNativeLoaderLock);
+
+		mySlot = &gNativeLoadSlots[mySlotIndex];
+		mySlot->fLoading = false;
+		myRequest->fErr = myErr;
+
+		if ((myRequest->fGeneration == mySlot->fGeneration) && !gNativeLoaderStopping) {
+			// the job is still wanted; it replaces any ready job that hasn't been taken
+			myStaleRequest = mySlot->fReadyRequest;
+			mySlot->fReadyRequest = myRequest;
+			isReady = true;
+		} else {
+			myStaleRequest = myRequest;
+		}
+
+		// leave the stale job for the main thread to dispose of
+		if (myStaleRequest != NULL) {
+			myStaleRequest->fNext = gNativeStaleRequests;
+			gNativeStaleRequests = myStaleRequest;
+		}
+
+		// call the ready proc without holding the lock
+		if (isReady && (gNativeLoaderProcs.fReady != NULL)) {
+			QTNative_Unlock(&gNativeLoaderLock);
+			gNativeLoaderProcs.fReady(gNativeLoaderProcs.fRefCon, mySlotIndex);
+			QTNative_Lock(&gNativeLoaderLock);
+		}
+	}
+
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	return(0);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Loader functions.
+//
+// Use these functions to start and stop the loader thread, to request loads, and to take the results.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_DisposeRequest
+// Dispose of a request and of its job. This is called only on the main thread.
+//
+//////////
+
+static void QTNative_DisposeRequest (NativeLoadRequest *theRequest)
+{
+	if (theRequest == NULL)
+		return;
+
+	gNativeLoaderProcs.fDispose(theRequest->fJob);
+	free(theRequest);
+}
+
+
+//////////
+//
+// QTNative_DisposeStaleRequests
+// Dispose of the requests that the loader thread has found to be stale. This is called only on the main thread,
+// by each of the functions below that it calls.
+//
+//////////
+
+static void QTNative_DisposeStaleRequests (void)
+{
+	NativeLoadRequest			*myRequest = NULL;
+	NativeLoadRequest			*myNext = NULL;
+
+	QTNative_Lock(&gNativeLoaderLock);
+	myRequest = gNativeStaleRequests;
+	gNativeStaleRequests = NULL;
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	while (myRequest != NULL) {
+		myNext = myRequest->fNext;
+		QTNative_DisposeRequest(myRequest);
+		myRequest = myNext;
+	}
+}
+
+
+//////////
+//
+// QTNative_StartLoader
+// Start the loader thread, which will load jobs with the specified procs.
+//
+//////////
+
+OSErr QTNative_StartLoader (const NativeLoaderProcs *theProcs)
+{
+	if (gNativeLoaderStarted)
+		return(noErr);
+
+	if ((theProcs == NULL) || (theProcs->fLoad == NULL) || (theProcs->fDispose == NULL))
+		return(paramErr);
+
+	gNativeLoaderProcs = *theProcs;
+	memset(gNativeLoadSlots, 0, sizeof(gNativeLoadSlots));
+	gNativeStaleRequests = NULL;
+
+	QTNative_InitLock(&gNativeLoaderLock);
+	QTNative_InitCondition(&gNativeLoaderWork);
+
+	gNativeLoaderStopping = false;
+
+#if defined(_WIN32)
+	gNativeLoaderThread = CreateThread(NULL, 0, QTNative_LoaderThread, NULL, 0, NULL);
+	if (gNativeLoaderThread == NULL)
+		goto bail;
+#else
+	if (pthread_create(&gNativeLoaderThread, NULL, QTNative_LoaderThread, NULL) != 0)
+		goto bail;
+#endif
+
+	gNativeLoaderStarted = true;
+	return(noErr);
+
+bail:
+	QTNative_DisposeCondition(&gNativeLoaderWork);
+	QTNative_DisposeLock(&gNativeLoaderLock);
+
+	return(memFullErr);
+}
+
+
+//////////
+//
+// QTNative_StopLoader
+// Stop the loader thread and wait for it to exit (after the load in progress, if any), and dispose of all the
+// jobs that haven't been taken.
+//
+//////////
+
+void QTNative_StopLoader (void)
+{
+	short						myIndex;
+
+	if (!gNativeLoaderStarted)
+		return;
+
+	QTNative_Lock(&gNativeLoaderLock);
+	gNativeLoaderStopping = true;
+	for (myIndex = 0; myIndex < kNativeMaxSources; myIndex++)
+		gNativeLoadSlots[myIndex].fGeneration++;
+	QTNative_BroadcastCondition(&gNativeLoaderWork);
+	QTNative_Unlock(&gNativeLoaderLock);
+
+#if defined(_WIN32)
+	WaitForSingleObject(gNativeLoaderThread, INFINITE);
+	CloseHandle(gNativeLoaderThread);
+	gNativeLoaderThread = NULL;
+#else
+	pthread_join(gNativeLoaderThread, NULL);
+#endif
+
+	QTNative_DisposeStaleRequests();
+
+	for (myIndex = 0; myIndex < kNativeMaxSources; myIndex++) {
+		NativeLoadSlot			*mySlot = &gNativeLoadSlots[myIndex];
+
+		QTNative_DisposeRequest(mySlot->fPendingRequest);
+		QTNative_DisposeRequest(mySlot->fReadyRequest);
+	}
+
+	memset(gNativeLoadSlots, 0, sizeof(gNativeLoadSlots));
+
+	QTNative_DisposeCondition(&gNativeLoaderWork);
+	QTNative_DisposeLock(&gNativeLoaderLock);
+
+	gNativeLoaderStarted = false;
+}
+
+
+//////////
+//
+// QTNative_RequestLoad
+// Ask the loader thread to load the specified job into the specified slot, superseding any earlier request for
+// that slot (including one that's finished but hasn't been taken). The loader owns the job until it's taken; if
+// the request fails, the job is disposed of at once. The generation of the request is returned through
+// theGeneration (which may be NULL).
+//
+//////////
+
+OSErr QTNative_RequestLoad (short theSlot, void *theJob, unsigned long *theGeneration)
+{
+	NativeLoadSlot				*mySlot;
+	NativeLoadRequest			*myRequest = NULL;
+	NativeLoadRequest			*myPendingRequest = NULL;
+	NativeLoadRequest			*myReadyRequest = NULL;
+
+	if ((theSlot < 0) || (theSlot >= kNativeMaxSources) || (theJob == NULL))
+		return(paramErr);
+
+	if (!gNativeLoaderStarted) {
+		gNativeLoaderProcs.fDispose(theJob);
+		return(paramErr);
+	}
+
+	QTNative_DisposeStaleRequests();
+
+	myRequest = (NativeLoadRequest *)calloc(1, sizeof(NativeLoadRequest));
+	if (myRequest == NULL) {
+		gNativeLoaderProcs.fDispose(theJob);
+		return(memFullErr);
+	}
+
+	myRequest->fJob = theJob;
+
+	mySlot = &gNativeLoadSlots[theSlot];
+
+	QTNative_Lock(&gNativeLoaderLock);
+
+	myPendingRequest = mySlot->fPendingRequest;
+	myReadyRequest = mySlot->fReadyRequest;
+	mySlot->fReadyRequest = NULL;
+
+	mySlot->fGeneration++;
+	myRequest->fGeneration = mySlot->fGeneration;
+	mySlot->fPendingRequest = myRequest;
+
+	if (theGeneration != NULL)
+		*theGeneration = mySlot->fGeneration;
+
+	QTNative_SignalCondition(&gNativeLoaderWork);
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	QTNative_DisposeRequest(myPendingRequest);
+	QTNative_DisposeRequest(myReadyRequest);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_CancelLoad
+// Cancel any request for the specified slot: a request that hasn't started is disposed of, and one in progress
+// (or ready but not taken) will never be taken.
+//
+//////////
+
+void QTNative_CancelLoad (short theSlot)
+{
+	NativeLoadSlot				*mySlot;
+	NativeLoadRequest			*myPendingRequest = NULL;
+	NativeLoadRequest			*myReadyRequest = NULL;
+
+	if ((theSlot < 0) || (theSlot >= kNativeMaxSources) || !gNativeLoaderStarted)
+		return;
+
+	QTNative_DisposeStaleRequests();
+
+	mySlot = &gNativeLoadSlots[theSlot];
+
+	QTNative_Lock(&gNativeLoaderLock);
+
+	mySlot->fGeneration++;
+
+	myPendingRequest = mySlot->fPendingRequest;
+	myReadyRequest = mySlot->fReadyRequest;
+	mySlot->fPendingRequest = NULL;
+	mySlot->fReadyRequest = NULL;
+
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	QTNative_DisposeRequest(myPendingRequest);
+	QTNative_DisposeRequest(myReadyRequest);
+}
+
+
+//////////
+//
+// QTNative_IsLoadCurrent
+// Is the specified request still the newest one for its slot? A load proc calls this to find out whether it
+// should carry on.
+//
+//////////
+
+Boolean QTNative_IsLoadCurrent (short theSlot, unsigned long theGeneration)
+{
+	Boolean						isCurrent = false;
+
+	if ((theSlot < 0) || (theSlot >= kNativeMaxSources) || !gNativeLoaderStarted)
+		return(false);
+
+	QTNative_Lock(&gNativeLoaderLock);
+	isCurrent = (gNativeLoadSlots[theSlot].fGeneration == theGeneration) && !gNativeLoaderStopping;
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	return(isCurrent);
+}
+
+
+//////////
+//
+// QTNative_IsLoadPending
+// Is there a request for the specified slot that hasn't been taken yet?
+//
+//////////
+
+Boolean QTNative_IsLoadPending (short theSlot)
+{
+	NativeLoadSlot				*mySlot;
+	Boolean						isPending = false;
+
+	if ((theSlot < 0) || (theSlot >= kNativeMaxSources) || !gNativeLoaderStarted)
+		return(false);
+
+	mySlot = &gNativeLoadSlots[theSlot];
+
+	QTNative_Lock(&gNativeLoaderLock);
+	isPending = (mySlot->fPendingRequest != NULL) || mySlot->fLoading || (mySlot->fReadyRequest != NULL);
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	return(isPending);
+}
+
+
+//////////
+//
+// QTNative_TakeLoadedJob
+// If the newest request for the specified slot has finished, take its job (which then belongs to the caller again)
+// and return true; the result of its load proc is returned through theErr. Otherwise return false.
+//
+//////////
+
+Boolean QTNative_TakeLoadedJob (short theSlot, void **theJob, OSErr *theErr)
+{
+	NativeLoadSlot				*mySlot;
+	NativeLoadRequest			*myRequest = NULL;
+
+	*theJob = NULL;
+	*theErr = noErr;
+
+	if ((theSlot < 0) || (theSlot >= kNativeMaxSources) || !gNativeLoaderStarted)
+		return(false);
+
+	QTNative_DisposeStaleRequests();
+
+	mySlot = &gNativeLoadSlots[theSlot];
+
+	QTNative_Lock(&gNativeLoaderLock);
+	myRequest = mySlot->fReadyRequest;
+	mySlot->fReadyRequest = NULL;
+	QTNative_Unlock(&gNativeLoaderLock);
+
+	if (myRequest == NULL)
+		return(false);
+
+	*theJob = myRequest->fJob;
+	*theErr = myRequest->fErr;
+	free(myRequest);
+
+	return(true);
+}
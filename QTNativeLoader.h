@@ -0,0 +1,71 @@
+//////////
+//
+//	File:		QTNativeLoader.h
+//
+//	Contains:	A background thread that loads effect sources, so that the user interface doesn't wait for them.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		the dispose proc is called only on the thread that makes the requests
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeLoader__
+#define __QTNativeLoader__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// load the source described by theJob, on the loader thread; theJob is the caller's own structure, so the result
+// goes back into it. The proc may call QTNative_IsLoadCurrent(theSlot, theGeneration) between stages and give up
+// if a newer request has made the load pointless.
+typedef OSErr (*NativeLoadProcPtr) (void *theJob, short theSlot, unsigned long theGeneration);
+
+// dispose of a job (and anything it loaded) that will never be taken; called only on the thread that makes the
+// requests, never on the loader thread
+typedef void (*NativeLoadDisposeProcPtr) (void *theJob);
+
+// tell the caller that a job is ready to be taken; called on the loader thread, so it should do no more than wake
+// up the thread that takes the jobs
+typedef void (*NativeLoadReadyProcPtr) (void *theRefCon, short theSlot);
+
+typedef struct {
+	NativeLoadProcPtr			fLoad;
+	NativeLoadDisposeProcPtr	fDispose;
+	NativeLoadReadyProcPtr		fReady;						// may be NULL, if the caller polls
+	void *						fRefCon;					// passed to fReady
+} NativeLoaderProcs;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_StartLoader (const NativeLoaderProcs *theProcs);
+void						QTNative_StopLoader (void);
+OSErr						QTNative_RequestLoad (short theSlot, void *theJob, unsigned long *theGeneration);
+void						QTNative_CancelLoad (short theSlot);
+Boolean						QTNative_IsLoadCurrent (short theSlot, unsigned long theGeneration);
+Boolean						QTNative_IsLoadPending (short theSlot);
+Boolean						QTNative_TakeLoadedJob (short theSlot, void **theJob, OSErr *theErr);
+
+#endif	// __QTNativeLoader__
@@ -0,0 +1,1390 @@
+//////////
+//
+//	File:		QTNativeMovieFile.c
+//
+//	Contains:	A portable writer of QuickTime movie files, which streams the media data to the disk and keeps the
+//				sample tables small, for effect movies and rendered transitions.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	QTEffects_CreateEffectsMovie builds its movie with the Movie Toolbox (CreateMovieFile, AddMediaSample,
+//	AddMovieResource), which we don't have on machines without QuickTime, and which keeps the whole sample table
+//	of every track in memory until the movie is saved. This file writes the same kind of movie with nothing but
+//	stdio: video tracks of compressed frames, effect tracks whose samples are effect descriptions, and the track
+//	references and input maps that connect an effect track to its sources.
+//
+//	The file is laid out as QuickTime writes it when it saves a movie in place:
+//
+//		'ftyp'		the file type ('qt  ')
+//		'wide'		eight bytes of room, in case the media data grows past 4 GB
+//		'mdat'		the media data, written as the samples are added
+//		'moov'		the movie and its tracks, written when the file is closed
+//
+//	The samples are written to the file as soon as they're added, so the media data never sits in memory. The
+//	sample tables are kept compactly: the durations are kept as runs ('stts'), and so are the chunks (a chunk
+//	is a run of samples of one track that are next to each other in the file; a track whose samples are added
+//	one after another has a single chunk). What can't be compressed that way -- the size of each sample, the
+//	offset of each chunk, the numbers of the key frames -- goes into tables that keep their newest entries in
+//	a block of memory and move them to a temporary file when the block is full. So the memory used by a track
+//	doesn't grow with the length of the movie, and an hour of frames costs no more memory than a second.
+//
+//	When the file is closed, the size of the media data is patched into the 'mdat' header (using the 'wide'
+//	atom for a 64-bit size if need be), and the 'moov' atom is written after the media data; chunk offsets past
+//	4 GB go into a 'co64' table rather than an 'stco' table. Each atom of the 'moov' atom is written by a proc
+//	that's run twice: once to count its bytes (for the atom's header), and once to write them.
+//
+//	An input map (or an effect description) is a QT atom container: a 12-byte header, then the root atom
+//	('sean'), whose children are QT atoms of 20-byte headers followed by their data or their own children. We
+//	build them the way QTEffects_AddTrackReferenceToInputMap and QTEffects_CreateEffectDescription do with
+//	the QT atom calls, and store them as QuickTime stores them, in big-endian order.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeMovieFile.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeFileTypeSize				20					// the size of the 'ftyp' atom
+#define kNativeMediaDataHeader			(kNativeFileTypeSize + 8)		// the offset of the 'mdat' header
+#define kNativeMediaDataStart			(kNativeMediaDataHeader + 8)	// the offset of the first sample
+#define kNativeAtomContainerHeader		12					// the size of the header of a QT atom container
+#define kNativeQTAtomHeader				20					// the size of the header of a QT atom
+#define kNativeImageDescriptionSize		86					// the size of an image description, without extensions
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// where the bytes of an atom go: into the file, or (if fFile is NULL) only into the count
+typedef struct {
+	FILE *					fFile;
+	unsigned long			fCount;
+	OSErr					fErr;
+} NativeAtomWriter;
+
+typedef void (*NativeAtomProcPtr) (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Byte functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_SetBigEndian32
+// Store a 32-bit number in big-endian order.
+//
+//////////
+
+static void QTNative_SetBigEndian32 (unsigned char *theBytes, unsigned long theValue)
+{
+	theBytes[0] = (unsigned char)(theValue >> 24);
+	theBytes[1] = (unsigned char)(theValue >> 16);
+	theBytes[2] = (unsigned char)(theValue >> 8);
+	theBytes[3] = (unsigned char)theValue;
+}
+
+
+//////////
+//
+// QTNative_SetBigEndian16
+// Store a 16-bit number in big-endian order.
+//
+//////////
+
+static void QTNative_SetBigEndian16 (unsigned char *theBytes, unsigned short theValue)
+{
+	theBytes[0] = (unsigned char)(theValue >> 8);
+	theBytes[1] = (unsigned char)theValue;
+}
+
+
+//////////
+//
+// QTNative_WriteFileBytes
+// Write bytes to a movie file, remembering the first error.
+//
+//////////
+
+static OSErr QTNative_WriteFileBytes (NativeMovieFile *theMovie, const void *theBytes, long theSize)
+{
+	if ((theMovie->fErr == noErr) && (theSize > 0))
+		if (fwrite(theBytes, 1, (size_t)theSize, theMovie->fFile) != (size_t)theSize)
+			theMovie->fErr = kNativeMovieWriteErr;
+
+	return(theMovie->fErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Sample table functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_AddTableEntry
+// Add an entry to one of the sample tables of a track, moving the block of entries to the table's temporary file
+// if the block is full.
+//
+//////////
+
+static OSErr QTNative_AddTableEntry (NativeMovieTable *theTable, unsigned long theValue)
+{
+	if (theTable->fBlock == NULL) {
+		theTable->fBlock = (unsigned char *)malloc(kNativeMovieTableBlock * 4);
+		if (theTable->fBlock == NULL)
+			return(memFullErr);
+	}
+
+	if (theTable->fNumInBlock == kNativeMovieTableBlock) {
+		if (theTable->fSpillFile == NULL) {
+			theTable->fSpillFile = tmpfile();
+			if (theTable->fSpillFile == NULL)
+				return(kNativeMovieWriteErr);
+		}
+
+		if (fwrite(theTable->fBlock, 4, kNativeMovieTableBlock, theTable->fSpillFile) != kNativeMovieTableBlock)
+			return(kNativeMovieWriteErr);
+
+		theTable->fNumInBlock = 0;
+	}
+
+	QTNative_SetBigEndian32(theTable->fBlock + (theTable->fNumInBlock * 4), theValue);
+	theTable->fNumInBlock++;
+	theTable->fNumEntries++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_DisposeTable
+// Dispose of a sample table and its temporary file.
+//
+//////////
+
+static void QTNative_DisposeTable (NativeMovieTable *theTable)
+{
+	if (theTable->fBlock != NULL)
+		free(theTable->fBlock);
+
+	if (theTable->fSpillFile != NULL)
+		fclose(theTable->fSpillFile);
+
+	memset(theTable, 0, sizeof(NativeMovieTable));
+}
+
+
+//////////
+//
+// QTNative_EndMovieChunk
+// Finish the chunk of a track that's being written, if any, adding an entry to its sample-to-chunk table if the chunk
+// doesn't have the same number of samples as the chunks before it.
+//
+//////////
+
+static OSErr QTNative_EndMovieChunk (NativeMovieTrack *theTrack)
+{
+	OSErr					myErr = noErr;
+
+	if (theTrack->fChunkSamples == 0)
+		return(noErr);
+
+	if (theTrack->fChunkSamples != theTrack->fLastChunkSamples) {
+		myErr = QTNative_AddTableEntry(&theTrack->fSampleToChunk, (unsigned long)theTrack->fNumChunks);
+		if (myErr == noErr)
+			myErr = QTNative_AddTableEntry(&theTrack->fSampleToChunk, (unsigned long)theTrack->fChunkSamples);
+		if (myErr == noErr)
+			myErr = QTNative_AddTableEntry(&theTrack->fSampleToChunk, 1);			// the sample description
+
+		theTrack->fLastChunkSamples = theTrack->fChunkSamples;
+	}
+
+	theTrack->fChunkSamples = 0;
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_EndMovieRun
+// Finish the run of samples of the same duration, if any, adding it to the time-to-sample table of a track.
+//
+//////////
+
+static OSErr QTNative_EndMovieRun (NativeMovieTrack *theTrack)
+{
+	OSErr					myErr = noErr;
+
+	if (theTrack->fRunCount == 0)
+		return(noErr);
+
+	myErr = QTNative_AddTableEntry(&theTrack->fTimeToSample, (unsigned long)theTrack->fRunCount);
+	if (myErr == noErr)
+		myErr = QTNative_AddTableEntry(&theTrack->fTimeToSample, (unsigned long)theTrack->fRunDuration);
+
+	theTrack->fRunCount = 0;
+	return(myErr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Atom functions.
+//
+// These functions write the 'moov' atom, through a NativeAtomWriter.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_PutBytes
+// Write bytes to an atom (or just count them).
+//
+//////////
+
+static void QTNative_PutBytes (NativeAtomWriter *theWriter, const void *theBytes, unsigned long theSize)
+{
+	theWriter->fCount += theSize;
+
+	if ((theWriter->fFile != NULL) && (theWriter->fErr == noErr) && (theSize > 0))
+		if (fwrite(theBytes, 1, (size_t)theSize, theWriter->fFile) != (size_t)theSize)
+			theWriter->fErr = kNativeMovieWriteErr;
+}
+
+
+//////////
+//
+// QTNative_Put32
+// Write a 32-bit number to an atom, in big-endian order.
+//
+//////////
+
+static void QTNative_Put32 (NativeAtomWriter *theWriter, unsigned long theValue)
+{
+	unsigned char			myBytes[4];
+
+	QTNative_SetBigEndian32(myBytes, theValue);
+	QTNative_PutBytes(theWriter, myBytes, 4);
+}
+
+
+//////////
+//
+// QTNative_Put16
+// Write a 16-bit number to an atom, in big-endian order.
+//
+//////////
+
+static void QTNative_Put16 (NativeAtomWriter *theWriter, unsigned short theValue)
+{
+	unsigned char			myBytes[2];
+
+	QTNative_SetBigEndian16(myBytes, theValue);
+	QTNative_PutBytes(theWriter, myBytes, 2);
+}
+
+
+//////////
+//
+// QTNative_PutZeros
+// Write the specified number of zero bytes to an atom.
+//
+//////////
+
+static void QTNative_PutZeros (NativeAtomWriter *theWriter, unsigned long theSize)
+{
+	static const unsigned char	kZeros[16] = {0};
+
+	while (theSize > 0) {
+		unsigned long		myCount = (theSize > sizeof(kZeros)) ? sizeof(kZeros) : theSize;
+
+		QTNative_PutBytes(theWriter, kZeros, myCount);
+		theSize -= myCount;
+	}
+}
+
+
+//////////
+//
+// QTNative_PutMatrix
+// Write the identity matrix, in the fixed-point form of the movie and track headers.
+//
+//////////
+
+static void QTNative_PutMatrix (NativeAtomWriter *theWriter)
+{
+	QTNative_Put32(theWriter, 0x00010000);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0x00010000);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, 0x40000000);
+}
+
+
+//////////
+//
+// QTNative_PutTable
+// Write the entries of a sample table, starting at the specified entry and taking every theStride'th one (so a
+// table of 64-bit chunk offsets can be written as 32-bit offsets).
+//
+//////////
+
+static void QTNative_PutTable (NativeAtomWriter *theWriter, NativeMovieTable *theTable, long theFirst, long theStride)
+{
+	unsigned char			myBlock[kNativeMovieTableBlock * 4];
+	long					myNumSpilled = theTable->fNumEntries - theTable->fNumInBlock;
+	long					myIndex;
+
+	if (theWriter->fFile == NULL) {
+		theWriter->fCount += (unsigned long)(((theTable->fNumEntries - theFirst + theStride - 1) / theStride) * 4);
+		return;
+	}
+
+	// the entries in the temporary file come first; each block there holds a whole number of strides
+	if (myNumSpilled > 0) {
+		long				myBlockIndex;
+
+		fflush(theTable->fSpillFile);
+		rewind(theTable->fSpillFile);
+
+		for (myBlockIndex = 0; myBlockIndex < myNumSpilled / kNativeMovieTableBlock; myBlockIndex++) {
+			if (fread(myBlock, 4, kNativeMovieTableBlock, theTable->fSpillFile) != kNativeMovieTableBlock) {
+				theWriter->fErr = kNativeMovieWriteErr;
+				return;
+			}
+
+			if (theStride == 1) {
+				QTNative_PutBytes(theWriter, myBlock, kNativeMovieTableBlock * 4);
+			} else {
+				for (myIndex = theFirst; myIndex < kNativeMovieTableBlock; myIndex += theStride)
+					QTNative_PutBytes(theWriter, myBlock + (myIndex * 4), 4);
+			}
+		}
+	}
+
+	if (theStride == 1) {
+		QTNative_PutBytes(theWriter, theTable->fBlock, (unsigned long)(theTable->fNumInBlock * 4));
+	} else {
+		for (myIndex = theFirst; myIndex < theTable->fNumInBlock; myIndex += theStride)
+			QTNative_PutBytes(theWriter, theTable->fBlock + (myIndex * 4), 4);
+	}
+}
+
+
+//////////
+//
+// QTNative_PutAtom
+// Write an atom whose contents are written by the specified proc: run the proc once to count the bytes, write the
+// header, and run it again to write them.
+//
+//////////
+
+static void QTNative_PutAtom (NativeAtomWriter *theWriter, OSType theType, NativeAtomProcPtr theProc, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	NativeAtomWriter		myCounter;
+
+	myCounter.fFile = NULL;
+	myCounter.fCount = 0;
+	myCounter.fErr = noErr;
+	theProc(&myCounter, theMovie, theTrack);
+
+	QTNative_Put32(theWriter, 8 + myCounter.fCount);
+	QTNative_Put32(theWriter, theType);
+
+	if (theWriter->fFile != NULL)
+		theProc(theWriter, theMovie, theTrack);
+	else
+		theWriter->fCount += myCounter.fCount;
+}
+
+
+//////////
+//
+// QTNative_GetTrackMovieDuration
+// Return the duration of a track in the time scale of the movie.
+//
+//////////
+
+static unsigned long QTNative_GetTrackMovieDuration (NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	NativeMovieOffset		myDuration = theTrack->fDuration;
+
+	return((unsigned long)(((myDuration * theMovie->fTimeScale) + (theTrack->fTimeScale / 2)) / theTrack->fTimeScale));
+}
+
+
+//////////
+//
+// QTNative_IsLargeFile
+// Is the media data too large for 32-bit chunk offsets?
+//
+//////////
+
+static Boolean QTNative_IsLargeFile (NativeMovieFile *theMovie)
+{
+	return(theMovie->fOffset > 0xFFFFFFFFUL);
+}
+
+
+//////////
+//
+// QTNative_PutMovieHeader
+// The contents of the 'mvhd' atom.
+//
+//////////
+
+static void QTNative_PutMovieHeader (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	unsigned long			myDuration = 0;
+	short					myIndex;
+
+	(void)theTrack;
+
+	for (myIndex = 0; myIndex < theMovie->fNumTracks; myIndex++)
+		if (QTNative_GetTrackMovieDuration(theMovie, theMovie->fTracks[myIndex]) > myDuration)
+			myDuration = QTNative_GetTrackMovieDuration(theMovie, theMovie->fTracks[myIndex]);
+
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, 0);						// creation time
+	QTNative_Put32(theWriter, 0);						// modification time
+	QTNative_Put32(theWriter, (unsigned long)theMovie->fTimeScale);
+	QTNative_Put32(theWriter, myDuration);
+	QTNative_Put32(theWriter, 0x00010000);				// preferred rate
+	QTNative_Put16(theWriter, 0x0100);					// preferred volume
+	QTNative_PutZeros(theWriter, 10);
+	QTNative_PutMatrix(theWriter);
+	QTNative_PutZeros(theWriter, 24);					// preview, poster, selection, and current times
+	QTNative_Put32(theWriter, (unsigned long)theMovie->fNumTracks + 1);		// next track ID
+}
+
+
+//////////
+//
+// QTNative_PutTrackHeader
+// The contents of the 'tkhd' atom.
+//
+//////////
+
+static void QTNative_PutTrackHeader (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_Put32(theWriter, 0x0000000F);				// version, and flags: enabled, in movie, in preview, in poster
+	QTNative_Put32(theWriter, 0);						// creation time
+	QTNative_Put32(theWriter, 0);						// modification time
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fTrackID);
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, QTNative_GetTrackMovieDuration(theMovie, theTrack));
+	QTNative_PutZeros(theWriter, 8);
+	QTNative_Put16(theWriter, 0);						// layer
+	QTNative_Put16(theWriter, 0);						// alternate group
+	QTNative_Put16(theWriter, 0);						// volume
+	QTNative_Put16(theWriter, 0);
+	QTNative_PutMatrix(theWriter);
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fWidth << 16);
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fHeight << 16);
+}
+
+
+//////////
+//
+// QTNative_PutEditList
+// The contents of the 'elst' atom: the whole media, from the start of the movie.
+//
+//////////
+
+static void QTNative_PutEditList (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, 1);						// number of entries
+	QTNative_Put32(theWriter, QTNative_GetTrackMovieDuration(theMovie, theTrack));
+	QTNative_Put32(theWriter, 0);						// media time
+	QTNative_Put32(theWriter, 0x00010000);				// media rate
+}
+
+
+//////////
+//
+// QTNative_PutEdits
+// The contents of the 'edts' atom.
+//
+//////////
+
+static void QTNative_PutEdits (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('elst'), QTNative_PutEditList, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutSourceReferences
+// The contents of the 'ssrc' atom: the IDs of the tracks that an effect track reads.
+//
+//////////
+
+static void QTNative_PutSourceReferences (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	short					myIndex;
+
+	(void)theMovie;
+
+	for (myIndex = 0; myIndex < theTrack->fNumRefs; myIndex++)
+		QTNative_Put32(theWriter, (unsigned long)theTrack->fRefs[myIndex]);
+}
+
+
+//////////
+//
+// QTNative_PutTrackReferences
+// The contents of the 'tref' atom.
+//
+//////////
+
+static void QTNative_PutTrackReferences (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, kNativeTrackModifierReference, QTNative_PutSourceReferences, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutInputMap
+// The contents of the 'imap' atom: the input map, as a QT atom container.
+//
+//////////
+
+static void QTNative_PutInputMap (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_PutBytes(theWriter, theTrack->fInputMap, (unsigned long)theTrack->fInputMapSize);
+}
+
+
+//////////
+//
+// QTNative_PutMediaHeader
+// The contents of the 'mdhd' atom.
+//
+//////////
+
+static void QTNative_PutMediaHeader (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, 0);						// creation time
+	QTNative_Put32(theWriter, 0);						// modification time
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fTimeScale);
+	QTNative_Put32(theWriter, theTrack->fDuration);
+	QTNative_Put16(theWriter, 0);						// language
+	QTNative_Put16(theWriter, 0);						// quality
+}
+
+
+//////////
+//
+// QTNative_PutHandler
+// Write the contents of an 'hdlr' atom.
+//
+//////////
+
+static void QTNative_PutHandler (NativeAtomWriter *theWriter, OSType theType, OSType theSubType, const char *theName)
+{
+	unsigned char			myLength = (unsigned char)strlen(theName);
+
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, theType);
+	QTNative_Put32(theWriter, theSubType);
+	QTNative_Put32(theWriter, FOUR_CHAR_CODE('appl'));	// manufacturer
+	QTNative_Put32(theWriter, 0);						// flags
+	QTNative_Put32(theWriter, 0);						// flags mask
+	QTNative_PutBytes(theWriter, &myLength, 1);			// the name, as a Pascal string
+	QTNative_PutBytes(theWriter, theName, myLength);
+}
+
+
+//////////
+//
+// QTNative_PutMediaHandler
+// The contents of the 'hdlr' atom of a video media.
+//
+//////////
+
+static void QTNative_PutMediaHandler (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+	(void)theTrack;
+
+	QTNative_PutHandler(theWriter, FOUR_CHAR_CODE('mhlr'), kNativeVideoMediaType, "Apple Video Media Handler");
+}
+
+
+//////////
+//
+// QTNative_PutDataHandler
+// The contents of the 'hdlr' atom of a media's data.
+//
+//////////
+
+static void QTNative_PutDataHandler (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+	(void)theTrack;
+
+	QTNative_PutHandler(theWriter, FOUR_CHAR_CODE('dhlr'), FOUR_CHAR_CODE('alis'), "Apple Alias Data Handler");
+}
+
+
+//////////
+//
+// QTNative_PutVideoMediaHeader
+// The contents of the 'vmhd' atom.
+//
+//////////
+
+static void QTNative_PutVideoMediaHeader (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+	(void)theTrack;
+
+	QTNative_Put32(theWriter, 0x00000001);				// version, and flags (as QuickTime writes them)
+	QTNative_Put16(theWriter, 0x0040);					// graphics mode: ditherCopy
+	QTNative_Put16(theWriter, 0x8000);					// opcolor
+	QTNative_Put16(theWriter, 0x8000);
+	QTNative_Put16(theWriter, 0x8000);
+}
+
+
+//////////
+//
+// QTNative_PutDataReferences
+// The contents of the 'dref' atom: a single reference to the movie file itself.
+//
+//////////
+
+static void QTNative_PutDataReferences (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+	(void)theTrack;
+
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, 1);						// number of entries
+	QTNative_Put32(theWriter, 12);						// an 'alis' atom with the "self reference" flag, and no alias
+	QTNative_Put32(theWriter, FOUR_CHAR_CODE('alis'));
+	QTNative_Put32(theWriter, 0x00000001);
+}
+
+
+//////////
+//
+// QTNative_PutDataInfo
+// The contents of the 'dinf' atom.
+//
+//////////
+
+static void QTNative_PutDataInfo (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('dref'), QTNative_PutDataReferences, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutSampleDescriptions
+// The contents of the 'stsd' atom: the track's only sample description.
+//
+//////////
+
+static void QTNative_PutSampleDescriptions (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);						// version and flags
+	QTNative_Put32(theWriter, 1);						// number of entries
+	QTNative_PutBytes(theWriter, theTrack->fSampleDesc, (unsigned long)theTrack->fSampleDescSize);
+}
+
+
+//////////
+//
+// QTNative_PutTimeToSample
+// The contents of the 'stts' atom.
+//
+//////////
+
+static void QTNative_PutTimeToSample (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, (unsigned long)(theTrack->fTimeToSample.fNumEntries / 2));
+	QTNative_PutTable(theWriter, &theTrack->fTimeToSample, 0, 1);
+}
+
+
+//////////
+//
+// QTNative_PutSyncSamples
+// The contents of the 'stss' atom.
+//
+//////////
+
+static void QTNative_PutSyncSamples (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fSyncSamples.fNumEntries);
+	QTNative_PutTable(theWriter, &theTrack->fSyncSamples, 0, 1);
+}
+
+
+//////////
+//
+// QTNative_PutSampleToChunk
+// The contents of the 'stsc' atom.
+//
+//////////
+
+static void QTNative_PutSampleToChunk (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, (unsigned long)(theTrack->fSampleToChunk.fNumEntries / 3));
+	QTNative_PutTable(theWriter, &theTrack->fSampleToChunk, 0, 1);
+}
+
+
+//////////
+//
+// QTNative_PutSampleSizes
+// The contents of the 'stsz' atom: a single size, if all the samples are the same size, or a table of sizes.
+//
+//////////
+
+static void QTNative_PutSampleSizes (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	(void)theMovie;
+
+	QTNative_Put32(theWriter, 0);
+	if (theTrack->fConstantSize >= 0) {
+		QTNative_Put32(theWriter, (unsigned long)theTrack->fConstantSize);
+		QTNative_Put32(theWriter, (unsigned long)theTrack->fNumSamples);
+	} else {
+		QTNative_Put32(theWriter, 0);
+		QTNative_Put32(theWriter, (unsigned long)theTrack->fNumSamples);
+		QTNative_PutTable(theWriter, &theTrack->fSampleSizes, 0, 1);
+	}
+}
+
+
+//////////
+//
+// QTNative_PutChunkOffsets
+// The contents of the 'stco' or 'co64' atom.
+//
+//////////
+
+static void QTNative_PutChunkOffsets (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_Put32(theWriter, 0);
+	QTNative_Put32(theWriter, (unsigned long)theTrack->fNumChunks);
+
+	// the table holds the high and the low word of each offset; 'stco' takes only the low words
+	if (QTNative_IsLargeFile(theMovie))
+		QTNative_PutTable(theWriter, &theTrack->fChunkOffsets, 0, 1);
+	else
+		QTNative_PutTable(theWriter, &theTrack->fChunkOffsets, 1, 2);
+}
+
+
+//////////
+//
+// QTNative_PutSampleTable
+// The contents of the 'stbl' atom.
+//
+//////////
+
+static void QTNative_PutSampleTable (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stsd'), QTNative_PutSampleDescriptions, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stts'), QTNative_PutTimeToSample, theMovie, theTrack);
+
+	// a track of nothing but key frames has no sync sample table
+	if (theTrack->fSyncSamples.fNumEntries < theTrack->fNumSamples)
+		QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stss'), QTNative_PutSyncSamples, theMovie, theTrack);
+
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stsc'), QTNative_PutSampleToChunk, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stsz'), QTNative_PutSampleSizes, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, QTNative_IsLargeFile(theMovie) ? FOUR_CHAR_CODE('co64') : FOUR_CHAR_CODE('stco'), QTNative_PutChunkOffsets, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutMediaInfo
+// The contents of the 'minf' atom.
+//
+//////////
+
+static void QTNative_PutMediaInfo (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('vmhd'), QTNative_PutVideoMediaHeader, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('hdlr'), QTNative_PutDataHandler, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('dinf'), QTNative_PutDataInfo, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('stbl'), QTNative_PutSampleTable, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutMedia
+// The contents of the 'mdia' atom.
+//
+//////////
+
+static void QTNative_PutMedia (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('mdhd'), QTNative_PutMediaHeader, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('hdlr'), QTNative_PutMediaHandler, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('minf'), QTNative_PutMediaInfo, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutTrack
+// The contents of a 'trak' atom.
+//
+//////////
+
+static void QTNative_PutTrack (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('tkhd'), QTNative_PutTrackHeader, theMovie, theTrack);
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('edts'), QTNative_PutEdits, theMovie, theTrack);
+
+	if (theTrack->fNumRefs > 0)
+		QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('tref'), QTNative_PutTrackReferences, theMovie, theTrack);
+
+	if (theTrack->fInputMapSize > 0)
+		QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('imap'), QTNative_PutInputMap, theMovie, theTrack);
+
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('mdia'), QTNative_PutMedia, theMovie, theTrack);
+}
+
+
+//////////
+//
+// QTNative_PutMovie
+// The contents of the 'moov' atom.
+//
+//////////
+
+static void QTNative_PutMovie (NativeAtomWriter *theWriter, NativeMovieFile *theMovie, NativeMovieTrack *theTrack)
+{
+	short					myIndex;
+
+	(void)theTrack;
+
+	QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('mvhd'), QTNative_PutMovieHeader, theMovie, NULL);
+
+	for (myIndex = 0; myIndex < theMovie->fNumTracks; myIndex++)
+		QTNative_PutAtom(theWriter, FOUR_CHAR_CODE('trak'), QTNative_PutTrack, theMovie, theMovie->fTracks[myIndex]);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// QT atom container functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_InitAtomContainer
+// Start a QT atom container in the specified buffer: the container header and an empty root atom.
+//
+//////////
+
+static void QTNative_InitAtomContainer (unsigned char *theBuffer, long *theSize)
+{
+	memset(theBuffer, 0, kNativeAtomContainerHeader + kNativeQTAtomHeader);
+
+	QTNative_SetBigEndian32(theBuffer + kNativeAtomContainerHeader, kNativeQTAtomHeader);
+	QTNative_SetBigEndian32(theBuffer + kNativeAtomContainerHeader + 4, FOUR_CHAR_CODE('sean'));
+	QTNative_SetBigEndian32(theBuffer + kNativeAtomContainerHeader + 8, 1);
+
+	*theSize = kNativeAtomContainerHeader + kNativeQTAtomHeader;
+}
+
+
+//////////
+//
+// QTNative_InsertAtom
+// Append a QT atom to the specified buffer, with a 4-byte big-endian value or (if theNumChildren isn't 0) room for
+// that many children; the children must be appended next. Return the offset of the new atom, or -1 if there's no
+// room.
+//
+//////////
+
+static long QTNative_InsertAtom (unsigned char *theBuffer, long *theSize, OSType theType, long theID, short theNumChildren, unsigned long theValue)
+{
+	long					myOffset = *theSize;
+	long					myAtomSize = kNativeQTAtomHeader + ((theNumChildren == 0) ? 4 : 0);
+
+	if (myOffset + myAtomSize > kNativeMaxAtomContainerSize)
+		return(-1);
+
+	memset(theBuffer + myOffset, 0, (size_t)myAtomSize);
+	QTNative_SetBigEndian32(theBuffer + myOffset, (unsigned long)myAtomSize);
+	QTNative_SetBigEndian32(theBuffer + myOffset + 4, theType);
+	QTNative_SetBigEndian32(theBuffer + myOffset + 8, (unsigned long)theID);
+	QTNative_SetBigEndian16(theBuffer + myOffset + 14, (unsigned short)theNumChildren);
+	if (theNumChildren == 0)
+		QTNative_SetBigEndian32(theBuffer + myOffset + kNativeQTAtomHeader, theValue);
+
+	*theSize += myAtomSize;
+	return(myOffset);
+}
+
+
+//////////
+//
+// QTNative_GrowAtom
+// Add the specified number of bytes to the size of the QT atom at the specified offset.
+//
+//////////
+
+static void QTNative_GrowAtom (unsigned char *theBuffer, long theOffset, long theNumBytes)
+{
+	const unsigned char		*mySize = theBuffer + theOffset;
+
+	QTNative_SetBigEndian32(theBuffer + theOffset, (((unsigned long)mySize[0] << 24) | ((unsigned long)mySize[1] << 16) | ((unsigned long)mySize[2] << 8) | mySize[3]) + (unsigned long)theNumBytes);
+}
+
+
+//////////
+//
+// QTNative_InsertRootChild
+// Append a child of the root atom of a QT atom container (see QTNative_InsertAtom), and count it in the root atom.
+//
+//////////
+
+static long QTNative_InsertRootChild (unsigned char *theBuffer, long *theSize, OSType theType, long theID, short theNumChildren, unsigned long theValue)
+{
+	unsigned char			*myRoot = theBuffer + kNativeAtomContainerHeader;
+	long					mySizeBefore = *theSize;
+	long					myOffset;
+
+	myOffset = QTNative_InsertAtom(theBuffer, theSize, theType, theID, theNumChildren, theValue);
+	if (myOffset < 0)
+		return(-1);
+
+	QTNative_GrowAtom(theBuffer, kNativeAtomContainerHeader, *theSize - mySizeBefore);
+	QTNative_SetBigEndian16(myRoot + 14, (unsigned short)(((myRoot[14] << 8) | myRoot[15]) + 1));
+
+	return(myOffset);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Movie file functions.
+//
+// Use these functions to create a movie file, to add tracks and samples to it, and to close it.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_CreateMovieFile
+// Create a movie file with the specified time scale (replacing any file of the same name), and get it ready for
+// samples.
+//
+//////////
+
+OSErr QTNative_CreateMovieFile (const char *thePath, long theTimeScale, NativeMovieFile *theMovie)
+{
+	unsigned char			myHeader[kNativeMediaDataStart];
+
+	memset(theMovie, 0, sizeof(NativeMovieFile));
+	theMovie->fLastTrack = -1;
+
+	if ((thePath == NULL) || (theTimeScale <= 0))
+		return(paramErr);
+
+	theMovie->fFile = fopen(thePath, "wb");
+	if (theMovie->fFile == NULL)
+		return(kNativeMovieWriteErr);
+
+	theMovie->fTimeScale = theTimeScale;
+
+	// the file type, some room for a 64-bit size, and the header of the media data (whose size we fill in later)
+	QTNative_SetBigEndian32(myHeader, kNativeFileTypeSize);
+	QTNative_SetBigEndian32(myHeader + 4, FOUR_CHAR_CODE('ftyp'));
+	QTNative_SetBigEndian32(myHeader + 8, FOUR_CHAR_CODE('qt  '));
+	QTNative_SetBigEndian32(myHeader + 12, 0x20050300);		// the minor version: the date of the QuickTime spec we follow
+	QTNative_SetBigEndian32(myHeader + 16, FOUR_CHAR_CODE('qt  '));
+	QTNative_SetBigEndian32(myHeader + 20, 8);
+	QTNative_SetBigEndian32(myHeader + 24, FOUR_CHAR_CODE('wide'));
+	QTNative_SetBigEndian32(myHeader + 28, 8);
+	QTNative_SetBigEndian32(myHeader + 32, FOUR_CHAR_CODE('mdat'));
+
+	if (QTNative_WriteFileBytes(theMovie, myHeader, sizeof(myHeader)) != noErr) {
+		fclose(theMovie->fFile);
+		theMovie->fFile = NULL;
+		return(kNativeMovieWriteErr);
+	}
+
+	theMovie->fOffset = kNativeMediaDataStart;
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_NewMovieTrack
+// Add a video track of the specified size to a movie file, with a media of the specified time scale. The track
+// needs a sample description (QTNative_SetTrackImageDescription) before it gets any samples.
+//
+//////////
+
+OSErr QTNative_NewMovieTrack (NativeMovieFile *theMovie, long theWidth, long theHeight, long theTimeScale, NativeMovieTrack **theTrack)
+{
+	NativeMovieTrack		*myTrack = NULL;
+
+	*theTrack = NULL;
+
+	if ((theMovie->fFile == NULL) || (theWidth <= 0) || (theHeight <= 0) || (theWidth > 0x7FFF) || (theHeight > 0x7FFF) || (theTimeScale <= 0))
+		return(paramErr);
+
+	if (theMovie->fNumTracks >= kNativeMaxMovieTracks)
+		return(paramErr);
+
+	myTrack = (NativeMovieTrack *)calloc(1, sizeof(NativeMovieTrack));
+	if (myTrack == NULL)
+		return(memFullErr);
+
+	myTrack->fTrackID = theMovie->fNumTracks + 1;
+	myTrack->fWidth = theWidth;
+	myTrack->fHeight = theHeight;
+	myTrack->fTimeScale = theTimeScale;
+	myTrack->fConstantSize = -1;
+
+	theMovie->fTracks[theMovie->fNumTracks++] = myTrack;
+
+	*theTrack = myTrack;
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_SetTrackImageDescription
+// Give a track an image description (the fields that QTEffects_MakeSampleDescription and CompressImage fill in),
+// for samples of the specified codec type and depth; an effect track has the effect type as its codec type, and a
+// depth of 0. theCompressorName may be NULL.
+//
+//////////
+
+OSErr QTNative_SetTrackImageDescription (NativeMovieTrack *theTrack, OSType theCodecType, short theDepth, const char *theCompressorName)
+{
+	unsigned char			*myDesc = theTrack->fSampleDesc;
+	size_t					myNameLength = (theCompressorName != NULL) ? strlen(theCompressorName) : 0;
+
+	if ((myNameLength > 31) || (theTrack->fNumSamples > 0))
+		return(paramErr);
+
+	memset(myDesc, 0, kNativeImageDescriptionSize);
+	QTNative_SetBigEndian32(myDesc, kNativeImageDescriptionSize);
+	QTNative_SetBigEndian32(myDesc + 4, theCodecType);
+	QTNative_SetBigEndian16(myDesc + 14, 1);							// data reference index
+	QTNative_SetBigEndian32(myDesc + 20, FOUR_CHAR_CODE('appl'));		// vendor
+	QTNative_SetBigEndian32(myDesc + 24, kNativeNormalQuality);			// temporal quality
+	QTNative_SetBigEndian32(myDesc + 28, kNativeNormalQuality);			// spatial quality
+	QTNative_SetBigEndian16(myDesc + 32, (unsigned short)theTrack->fWidth);
+	QTNative_SetBigEndian16(myDesc + 34, (unsigned short)theTrack->fHeight);
+	QTNative_SetBigEndian32(myDesc + 36, 72L << 16);					// horizontal resolution
+	QTNative_SetBigEndian32(myDesc + 40, 72L << 16);					// vertical resolution
+	QTNative_SetBigEndian16(myDesc + 48, 1);							// frame count
+	myDesc[50] = (unsigned char)myNameLength;
+	if (myNameLength > 0)
+		memcpy(myDesc + 51, theCompressorName, myNameLength);
+	QTNative_SetBigEndian16(myDesc + 82, (unsigned short)theDepth);
+	QTNative_SetBigEndian16(myDesc + 84, 0xFFFF);						// color table ID: none
+
+	theTrack->fSampleDescSize = kNativeImageDescriptionSize;
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_AddMovieSample
+// Write a sample to the media data of a movie file, and add it to the sample tables of the specified track. A sample
+// that follows a sample of the same track goes into the same chunk.
+//
+//////////
+
+OSErr QTNative_AddMovieSample (NativeMovieFile *theMovie, NativeMovieTrack *theTrack, const void *theData, long theSize, long theDuration, Boolean isSync)
+{
+	short					myIndex;
+	OSErr					myErr = noErr;
+
+	if ((theMovie->fFile == NULL) || (theTrack->fSampleDescSize == 0) || (theSize <= 0) || (theDuration <= 0))
+		return(paramErr);
+
+	if (theMovie->fErr != noErr)
+		return(theMovie->fErr);
+
+	for (myIndex = 0; myIndex < theMovie->fNumTracks; myIndex++)
+		if (theMovie->fTracks[myIndex] == theTrack)
+			break;
+	if (myIndex == theMovie->fNumTracks)
+		return(paramErr);
+
+	// start a new chunk, unless the last sample in the file belongs to this track
+	if ((theMovie->fLastTrack != myIndex) || (theTrack->fChunkSamples == 0)) {
+		myErr = QTNative_EndMovieChunk(theTrack);
+		if (myErr == noErr)
+			myErr = QTNative_AddTableEntry(&theTrack->fChunkOffsets, (unsigned long)(theMovie->fOffset >> 32));
+		if (myErr == noErr)
+			myErr = QTNative_AddTableEntry(&theTrack->fChunkOffsets, (unsigned long)(theMovie->fOffset & 0xFFFFFFFFUL));
+		if (myErr != noErr)
+			return(myErr);
+
+		theTrack->fNumChunks++;
+		theMovie->fLastTrack = myIndex;
+	}
+
+	myErr = QTNative_WriteFileBytes(theMovie, theData, theSize);
+	if (myErr != noErr)
+		return(myErr);
+
+	theMovie->fOffset += (unsigned long)theSize;
+	theTrack->fChunkSamples++;
+	theTrack->fNumSamples++;
+	theTrack->fDuration += (unsigned long)theDuration;
+
+	// the sizes go into a table only once they stop being all the same
+	if (theTrack->fNumSamples == 1) {
+		theTrack->fConstantSize = theSize;
+	} else if ((theTrack->fConstantSize >= 0) && (theSize != theTrack->fConstantSize)) {
+		long				mySample;
+
+		for (mySample = 1; (mySample < theTrack->fNumSamples) && (myErr == noErr); mySample++)
+			myErr = QTNative_AddTableEntry(&theTrack->fSampleSizes, (unsigned long)theTrack->fConstantSize);
+		theTrack->fConstantSize = -1;
+	}
+
+	if ((myErr == noErr) && (theTrack->fConstantSize < 0))
+		myErr = QTNative_AddTableEntry(&theTrack->fSampleSizes, (unsigned long)theSize);
+
+	if ((myErr == noErr) && isSync)
+		myErr = QTNative_AddTableEntry(&theTrack->fSyncSamples, (unsigned long)theTrack->fNumSamples);
+
+	// and the durations go in as runs
+	if ((myErr == noErr) && (theTrack->fRunCount > 0) && (theDuration != theTrack->fRunDuration))
+		myErr = QTNative_EndMovieRun(theTrack);
+
+	theTrack->fRunDuration = theDuration;
+	theTrack->fRunCount++;
+
+	if (myErr != noErr)
+		theMovie->fErr = myErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_AddTrackReferenceToInputMap
+// Make theSrcTrack a source of the effect track theTrack, as QTEffects_AddTrackReferenceToInputMap does: add it to
+// the track's 'ssrc' track reference, and add an input to the track's input map with the reference's index as its
+// ID, an input type of kNativeTrackModifierTypeImage, and theSrcName (the name the effect description uses for the
+// source) as its data source type.
+//
+//////////
+
+OSErr QTNative_AddTrackReferenceToInputMap (NativeMovieTrack *theTrack, const NativeMovieTrack *theSrcTrack, OSType theSrcName)
+{
+	unsigned char			myInputMap[kNativeMaxAtomContainerSize];
+	long					mySize = theTrack->fInputMapSize;
+	long					myInput;
+	long					myRefIndex;
+
+	if ((theTrack->fNumRefs >= kNativeMaxTrackRefs) || (theSrcTrack == theTrack))
+		return(paramErr);
+
+	myRefIndex = theTrack->fNumRefs + 1;
+
+	// build the new input map on the side, so that the track's map is unchanged if it doesn't fit
+	if (mySize == 0)
+		QTNative_InitAtomContainer(myInputMap, &mySize);
+	else
+		memcpy(myInputMap, theTrack->fInputMap, (size_t)mySize);
+
+	myInput = QTNative_InsertRootChild(myInputMap, &mySize, kNativeTrackModifierInput, myRefIndex, 2, 0);
+	if (myInput < 0)
+		return(paramErr);
+
+	if (QTNative_InsertAtom(myInputMap, &mySize, kNativeTrackModifierType, 1, 0, kNativeTrackModifierTypeImage) < 0)
+		return(paramErr);
+	if (QTNative_InsertAtom(myInputMap, &mySize, kNativeEffectDataSourceType, 1, 0, theSrcName) < 0)
+		return(paramErr);
+
+	// the children count toward the sizes of the input atom and the root atom
+	QTNative_GrowAtom(myInputMap, myInput, 2 * (kNativeQTAtomHeader + 4));
+	QTNative_GrowAtom(myInputMap, kNativeAtomContainerHeader, 2 * (kNativeQTAtomHeader + 4));
+
+	memcpy(theTrack->fInputMap, myInputMap, (size_t)mySize);
+	theTrack->fInputMapSize = mySize;
+	theTrack->fRefs[theTrack->fNumRefs++] = theSrcTrack->fTrackID;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_MakeEffectDescription
+// Build an effect description (the sample of an effect track) for the specified effect and parameters, as
+// QTEffects_CreateEffectDescription does, in the specified buffer of kNativeMaxAtomContainerSize bytes. A source
+// name of 0 means no source. The parameters are written as 4-byte big-endian numbers, which is how
+// QTEffects_GetNativeEffectParams reads them.
+//
+//////////
+
+OSErr QTNative_MakeEffectDescription (const NativeEffectParams *theParams, OSType theSourceName1, OSType theSourceName2, unsigned char *theBuffer, long *theSize)
+{
+	short					myIndex;
+
+	QTNative_InitAtomContainer(theBuffer, theSize);
+
+	if (QTNative_InsertRootChild(theBuffer, theSize, kNativeParameterWhatName, 1, 0, theParams->fEffectType) < 0)
+		return(paramErr);
+
+	if ((theSourceName1 != 0) && (QTNative_InsertRootChild(theBuffer, theSize, kNativeEffectSourceName, 1, 0, theSourceName1) < 0))
+		return(paramErr);
+
+	if ((theSourceName2 != 0) && (QTNative_InsertRootChild(theBuffer, theSize, kNativeEffectSourceName, 2, 0, theSourceName2) < 0))
+		return(paramErr);
+
+	for (myIndex = 0; myIndex < theParams->fNumParams; myIndex++)
+		if (QTNative_InsertRootChild(theBuffer, theSize, theParams->fParams[myIndex].fName, 1, 0, (unsigned long)theParams->fParams[myIndex].fValue) < 0)
+			return(paramErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_CloseMovieFile
+// Finish a movie file: write the 'moov' atom after the media data, fill in the size of the media data, and close
+// the file. Return the first error in writing the file, if any.
+//
+//////////
+
+OSErr QTNative_CloseMovieFile (NativeMovieFile *theMovie)
+{
+	NativeAtomWriter		myWriter;
+	NativeMovieOffset		myDataSize;
+	unsigned char			myHeader[16];
+	short					myIndex;
+	OSErr					myErr = noErr;
+
+	if (theMovie->fFile == NULL)
+		return(paramErr);
+
+	// finish the chunks and the runs of durations
+	for (myIndex = 0; myIndex < theMovie->fNumTracks; myIndex++) {
+		NativeMovieTrack	*myTrack = theMovie->fTracks[myIndex];
+
+		if (myErr == noErr)
+			myErr = QTNative_EndMovieChunk(myTrack);
+		if (myErr == noErr)
+			myErr = QTNative_EndMovieRun(myTrack);
+	}
+
+	if ((myErr != noErr) && (theMovie->fErr == noErr))
+		theMovie->fErr = myErr;
+
+	// write the movie after the media data
+	if (theMovie->fErr == noErr) {
+		myWriter.fFile = theMovie->fFile;
+		myWriter.fCount = 0;
+		myWriter.fErr = noErr;
+
+		QTNative_PutAtom(&myWriter, FOUR_CHAR_CODE('moov'), QTNative_PutMovie, theMovie, NULL);
+		theMovie->fErr = myWriter.fErr;
+	}
+
+	// fill in the size of the media data; if it's too large for 32 bits, the 'wide' atom becomes part of its header
+	if (theMovie->fErr == noErr) {
+		myDataSize = theMovie->fOffset - kNativeMediaDataHeader;
+
+		if (myDataSize <= 0xFFFFFFFFUL) {
+			QTNative_SetBigEndian32(myHeader, (unsigned long)myDataSize);
+			if ((fseek(theMovie->fFile, kNativeMediaDataHeader, SEEK_SET) != 0) || (fwrite(myHeader, 1, 4, theMovie->fFile) != 4))
+				theMovie->fErr = kNativeMovieWriteErr;
+		} else {
+			myDataSize += 8;
+			QTNative_SetBigEndian32(myHeader, 1);
+			QTNative_SetBigEndian32(myHeader + 4, FOUR_CHAR_CODE('mdat'));
+			QTNative_SetBigEndian32(myHeader + 8, (unsigned long)(myDataSize >> 32));
+			QTNative_SetBigEndian32(myHeader + 12, (unsigned long)(myDataSize & 0xFFFFFFFFUL));
+			if ((fseek(theMovie->fFile, kNativeFileTypeSize, SEEK_SET) != 0) || (fwrite(myHeader, 1, 16, theMovie->fFile) != 16))
+				theMovie->fErr = kNativeMovieWriteErr;
+		}
+	}
+
+	if ((fclose(theMovie->fFile) != 0) && (theMovie->fErr == noErr))
+		theMovie->fErr = kNativeMovieWriteErr;
+	theMovie->fFile = NULL;
+
+	// dispose of the tracks
+	for (myIndex = 0; myIndex < theMovie->fNumTracks; myIndex++) {
+		NativeMovieTrack	*myTrack = theMovie->fTracks[myIndex];
+
+		QTNative_DisposeTable(&myTrack->fSampleSizes);
+		QTNative_DisposeTable(&myTrack->fChunkOffsets);
+		QTNative_DisposeTable(&myTrack->fTimeToSample);
+		QTNative_DisposeTable(&myTrack->fSampleToChunk);
+		QTNative_DisposeTable(&myTrack->fSyncSamples);
+		free(myTrack);
+		theMovie->fTracks[myIndex] = NULL;
+	}
+
+	theMovie->fNumTracks = 0;
+	return(theMovie->fErr);
+}
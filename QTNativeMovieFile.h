@@ -0,0 +1,141 @@
+//////////
+//
+//	File:		QTNativeMovieFile.h
+//
+//	Contains:	A portable writer of QuickTime movie files, which streams the media data to the disk and keeps the
+//				sample tables small, for effect movies and rendered transitions.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeMovieFile__
+#define __QTNativeMovieFile__
+
+#include <stdio.h>
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// media types, codec types, and the atoms that tie an effect track to its sources (the same values as QuickTime's
+// VideoMediaType, kRawCodecType, kTrackModifierReference, kTrackModifierInput, kTrackModifierType,
+// kTrackModifierTypeImage, kEffectDataSourceType, kParameterWhatName, and kEffectSourceName)
+#define kNativeVideoMediaType				FOUR_CHAR_CODE('vide')
+#define kNativeRawCodecType					FOUR_CHAR_CODE('raw ')
+#define kNativeTrackModifierReference		FOUR_CHAR_CODE('ssrc')
+#define kNativeTrackModifierInput			0x0000696E			// 'in'
+#define kNativeTrackModifierType			0x00007479			// 'ty'
+#define kNativeTrackModifierTypeImage		FOUR_CHAR_CODE('vide')
+#define kNativeEffectDataSourceType			FOUR_CHAR_CODE('dtst')
+#define kNativeParameterWhatName			FOUR_CHAR_CODE('what')
+#define kNativeEffectSourceName				FOUR_CHAR_CODE('src ')
+
+// the quality recorded in an image description (same value as QuickTime's codecNormalQuality)
+#define kNativeNormalQuality				0x00000200
+
+// limits
+#define kNativeMaxMovieTracks				8
+#define kNativeMaxTrackRefs					4
+#define kNativeMaxSampleDescSize			256			// the largest sample description of a track
+#define kNativeMaxAtomContainerSize			1024		// the largest input map or effect description
+#define kNativeMovieTableBlock				4096		// the entries of a sample table kept in memory (see QTNativeMovieFile.c)
+
+// the error returned when the movie file can't be written (same value as the Mac OS ioErr)
+#define kNativeMovieWriteErr				-36
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// an offset in a movie file, which may be larger than 4 GB
+#if defined(_WIN32)
+typedef unsigned __int64			NativeMovieOffset;
+#else
+typedef unsigned long long			NativeMovieOffset;
+#endif
+
+// one table of a track's sample tables: 32-bit big-endian entries, the newest ones in a block of memory and the
+// rest in a temporary file
+typedef struct {
+	unsigned char *			fBlock;						// room for kNativeMovieTableBlock entries, or NULL
+	long					fNumInBlock;
+	long					fNumEntries;				// all the entries, in the block and in the file
+	FILE *					fSpillFile;					// the entries that didn't fit in the block, or NULL
+} NativeMovieTable;
+
+// a track of a movie file that's being written
+typedef struct {
+	long					fTrackID;
+	long					fWidth;
+	long					fHeight;
+	long					fTimeScale;					// the time scale of the track's media
+	unsigned long			fDuration;					// the duration of the media so far, in fTimeScale units
+	unsigned char			fSampleDesc[kNativeMaxSampleDescSize];
+	long					fSampleDescSize;
+
+	long					fNumSamples;
+	long					fNumChunks;
+	long					fChunkSamples;				// the samples in the chunk being written, if any
+	long					fLastChunkSamples;			// the samples per chunk in the last entry of fSampleToChunk
+	long					fRunCount;					// the samples in the current run of equal durations
+	long					fRunDuration;
+	long					fConstantSize;				// the size of every sample so far, or -1 once they differ
+	NativeMovieTable		fSampleSizes;				// 'stsz': the size of each sample
+	NativeMovieTable		fChunkOffsets;				// 'stco' or 'co64': the high and low words of each chunk's offset
+	NativeMovieTable		fTimeToSample;				// 'stts': runs of samples with the same duration
+	NativeMovieTable		fSampleToChunk;				// 'stsc': runs of chunks with the same number of samples
+	NativeMovieTable		fSyncSamples;				// 'stss': the numbers of the key frames
+
+	long					fRefs[kNativeMaxTrackRefs];	// the track IDs in the 'ssrc' track reference
+	short					fNumRefs;
+	unsigned char			fInputMap[kNativeMaxAtomContainerSize];
+	long					fInputMapSize;				// 0 if the track has no input map
+} NativeMovieTrack;
+
+// a movie file that's being written
+typedef struct {
+	FILE *					fFile;
+	long					fTimeScale;					// the time scale of the movie
+	NativeMovieOffset		fOffset;					// the offset of the next byte of media data
+	NativeMovieTrack *		fTracks[kNativeMaxMovieTracks];
+	short					fNumTracks;
+	short					fLastTrack;					// the index of the track of the last sample, or -1
+	OSErr					fErr;						// the first error in writing the file
+} NativeMovieFile;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_CreateMovieFile (const char *thePath, long theTimeScale, NativeMovieFile *theMovie);
+OSErr						QTNative_CloseMovieFile (NativeMovieFile *theMovie);
+OSErr						QTNative_NewMovieTrack (NativeMovieFile *theMovie, long theWidth, long theHeight, long theTimeScale, NativeMovieTrack **theTrack);
+OSErr						QTNative_SetTrackImageDescription (NativeMovieTrack *theTrack, OSType theCodecType, short theDepth, const char *theCompressorName);
+OSErr						QTNative_AddMovieSample (NativeMovieFile *theMovie, NativeMovieTrack *theTrack, const void *theData, long theSize, long theDuration, Boolean isSync);
+OSErr						QTNative_AddTrackReferenceToInputMap (NativeMovieTrack *theTrack, const NativeMovieTrack *theSrcTrack, OSType theSrcName);
+OSErr						QTNative_MakeEffectDescription (const NativeEffectParams *theParams, OSType theSourceName1, OSType theSourceName2, unsigned char *theBuffer, long *theSize);
+
+#endif	// __QTNativeMovieFile__
@@ -0,0 +1,494 @@
+//////////
+//
+//	File:		QTNativeNoise.c
+//
+//	Contains:	A native film noise filter, and the counter-based random numbers it uses.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	10/17/26	rtm		rows are addressed with QTNative_GetRowAddress, which honors the fFirstRow of a buffer
+//	   <3>	 	10/17/26	rtm		the scratch row of each band comes from the frame pool
+//	   <2>	 	10/17/26	rtm		use QTNative_UseAVX2Kernels and QTNative_GetHostPixelFormat
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	This file implements the film noise filter natively: it fades the colors of the source toward sepia, adds
+//	grain, and then draws dust, hairs, and scratches over it.
+//
+//	Every random number is a pure function of the filter's seed, the frame number, a stream number, and a
+//	counter (for instance, the index of a pixel or of a dust speck): we hash the first three into a key, and
+//	then hash the key together with the counter. Nothing is carried from one random number to the next, so
+//	any frame (and any band of rows of a frame) can be rendered on its own, in any order, on any thread, and
+//	the result is always bit-for-bit the same. Dust, hairs, and scratches are drawn only where they cross the
+//	band being rendered.
+//
+//	The grain is computed for every pixel, so that's the loop worth vectorizing; there's an AVX2 version
+//	(which hashes 8 pixels at a time) along with the portable scalar version, and both produce the same pixels.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeNoise.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeHairSegments				8			// the number of straight pieces in a hair
+#define kNativeScratchLife				24			// the number of frames that a scratch stays in one place
+#define kNativeReferenceHeight			360			// the frame height for which the sizes of the damage are given
+
+#define kNativeDustAlpha				192			// the opacity of the damage, out of 256
+#define kNativeHairAlpha				224
+#define kNativeScratchAlpha				160
+
+#define kNativeDarkDamage				0xFF181410UL
+#define kNativeLightDamage				0xFFF0ECE4UL
+
+
+//////////
+//
+// data types
+//
+//////////
+
+typedef void (*NativeGrainRowProcPtr) (unsigned int *theRow, long theCount, unsigned int theKey, unsigned long theFirstCounter, long theFade, long theGrain);
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+// the unit steps for the 16 directions a hair can take, in 1/256ths of a pixel
+static const short					gNativeDirections[16][2] = {
+	{256, 0}, {237, 98}, {181, 181}, {98, 237}, {0, 256}, {-98, 237}, {-181, 181}, {-237, 98},
+	{-256, 0}, {-237, -98}, {-181, -181}, {-98, -237}, {0, -256}, {98, -237}, {181, -181}, {237, -98}
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Random number functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_HashInt
+// Scramble the bits of a 32-bit value (this is the "lowbias32" integer hash).
+//
+//////////
+
+unsigned int QTNative_HashInt (unsigned int theValue)
+{
+	theValue ^= theValue >> 16;
+	theValue *= 0x7FEB352DU;
+	theValue ^= theValue >> 15;
+	theValue *= 0x846CA68BU;
+	theValue ^= theValue >> 16;
+
+	return(theValue);
+}
+
+
+//////////
+//
+// QTNative_GetRandomKey
+// Return the key for the random numbers of the specified stream in the specified frame.
+//
+//////////
+
+unsigned int QTNative_GetRandomKey (unsigned long theSeed, long theFrame, long theStream)
+{
+	unsigned int		myKey;
+
+	myKey = QTNative_HashInt((unsigned int)theSeed ^ 0x9E3779B9U);
+	myKey = QTNative_HashInt(myKey ^ (unsigned int)theFrame);
+	myKey = QTNative_HashInt(myKey ^ ((unsigned int)theStream * 0x85EBCA6BU));
+
+	return(myKey);
+}
+
+
+//////////
+//
+// QTNative_Random
+// Return the random number with the specified counter in the stream with the specified key.
+//
+//////////
+
+unsigned int QTNative_Random (unsigned int theKey, unsigned long theCounter)
+{
+	return(QTNative_HashInt(theKey ^ QTNative_HashInt((unsigned int)theCounter)));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Grain kernels.
+//
+// Each of these functions fades and adds grain to a row of pixels held as 0xAARRGGBB values. The grain for
+// the pixel with counter n is drawn from the grain stream with counter n.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_FilmGrainRowScalar
+// Fade and add grain to a row of pixels, one at a time.
+//
+//////////
+
+static void QTNative_FilmGrainRowScalar (unsigned int *theRow, long theCount, unsigned int theKey, unsigned long theFirstCounter, long theFade, long theGrain)
+{
+	long				myX;
+
+	for (myX = 0; myX < theCount; myX++) {
+		unsigned int	myPixel = theRow[myX];
+		long			myRed = (myPixel >> 16) & 0xFF;
+		long			myGreen = (myPixel >> 8) & 0xFF;
+		long			myBlue = myPixel & 0xFF;
+		long			myLuma = ((myRed * 77) + (myGreen * 150) + (myBlue * 29)) >> 8;
+		long			myNoise;
+
+		// fade toward a sepia tone with the same brightness
+		myRed = ((myRed * (256 - theFade)) + (((myLuma + 32 > 255) ? 255 : myLuma + 32) * theFade)) >> 8;
+		myGreen = ((myGreen * (256 - theFade)) + (myLuma * theFade)) >> 8;
+		myBlue = ((myBlue * (256 - theFade)) + (((myLuma < 32) ? 0 : myLuma - 32) * theFade)) >> 8;
+
+		// add the grain, which is the same for all three channels
+		myNoise = ((long)(QTNative_Random(theKey, theFirstCounter + myX) >> 24) * theGrain * 2) >> 8;
+		myNoise -= theGrain;
+
+		myRed += myNoise;
+		myGreen += myNoise;
+		myBlue += myNoise;
+
+		myRed = (myRed < 0) ? 0 : (myRed > 255) ? 255 : myRed;
+		myGreen = (myGreen < 0) ? 0 : (myGreen > 255) ? 255 : myGreen;
+		myBlue = (myBlue < 0) ? 0 : (myBlue > 255) ? 255 : myBlue;
+
+		theRow[myX] = (myPixel & 0xFF000000U) | ((unsigned int)myRed << 16) | ((unsigned int)myGreen << 8) | (unsigned int)myBlue;
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_HashIntAVX2
+// Do what QTNative_HashInt does, to 8 values at once.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static __m256i QTNative_HashIntAVX2 (__m256i theValues)
+{
+	theValues = _mm256_xor_si256(theValues, _mm256_srli_epi32(theValues, 16));
+	theValues = _mm256_mullo_epi32(theValues, _mm256_set1_epi32((int)0x7FEB352DU));
+	theValues = _mm256_xor_si256(theValues, _mm256_srli_epi32(theValues, 15));
+	theValues = _mm256_mullo_epi32(theValues, _mm256_set1_epi32((int)0x846CA68BU));
+	theValues = _mm256_xor_si256(theValues, _mm256_srli_epi32(theValues, 16));
+
+	return(theValues);
+}
+
+
+//////////
+//
+// QTNative_FilmGrainRowAVX2
+// Fade and add grain to a row of pixels, 8 at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_FilmGrainRowAVX2 (unsigned int *theRow, long theCount, unsigned int theKey, unsigned long theFirstCounter, long theFade, long theGrain)
+{
+	const __m256i		myByteMask = _mm256_set1_epi32(0xFF);
+	const __m256i		myAlphaMask = _mm256_set1_epi32((int)0xFF000000U);
+	const __m256i		myZero = _mm256_setzero_si256();
+	const __m256i		myMax = _mm256_set1_epi32(255);
+	const __m256i		my32 = _mm256_set1_epi32(32);
+	const __m256i		myKeep = _mm256_set1_epi32(256 - theFade);
+	const __m256i		myFade = _mm256_set1_epi32(theFade);
+	const __m256i		myGrain = _mm256_set1_epi32(theGrain);
+	const __m256i		myGrain2 = _mm256_set1_epi32(theGrain * 2);
+	const __m256i		myKey = _mm256_set1_epi32((int)theKey);
+	const __m256i		myLanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	long				myX;
+
+	for (myX = 0; myX + 8 <= theCount; myX += 8) {
+		__m256i			myPixels = _mm256_loadu_si256((const __m256i *)(theRow + myX));
+		__m256i			myRed = _mm256_and_si256(_mm256_srli_epi32(myPixels, 16), myByteMask);
+		__m256i			myGreen = _mm256_and_si256(_mm256_srli_epi32(myPixels, 8), myByteMask);
+		__m256i			myBlue = _mm256_and_si256(myPixels, myByteMask);
+		__m256i			myLuma, myCounters, myNoise;
+
+		myLuma = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myRed, _mm256_set1_epi32(77)),
+													_mm256_mullo_epi32(myGreen, _mm256_set1_epi32(150))),
+													_mm256_mullo_epi32(myBlue, _mm256_set1_epi32(29)));
+		myLuma = _mm256_srli_epi32(myLuma, 8);
+
+		myRed = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myRed, myKeep),
+								_mm256_mullo_epi32(_mm256_min_epi32(_mm256_add_epi32(myLuma, my32), myMax), myFade)), 8);
+		myGreen = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myGreen, myKeep), _mm256_mullo_epi32(myLuma, myFade)), 8);
+		myBlue = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(myBlue, myKeep),
+								_mm256_mullo_epi32(_mm256_max_epi32(_mm256_sub_epi32(myLuma, my32), myZero), myFade)), 8);
+
+		// the grain: QTNative_Random(theKey, counter) for the counters of these 8 pixels
+		myCounters = _mm256_add_epi32(_mm256_set1_epi32((int)(unsigned int)(theFirstCounter + myX)), myLanes);
+		myNoise = QTNative_HashIntAVX2(_mm256_xor_si256(myKey, QTNative_HashIntAVX2(myCounters)));
+		myNoise = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(myNoise, 24), myGrain2), 8);
+		myNoise = _mm256_sub_epi32(myNoise, myGrain);
+
+		myRed = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(myRed, myNoise), myZero), myMax);
+		myGreen = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(myGreen, myNoise), myZero), myMax);
+		myBlue = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(myBlue, myNoise), myZero), myMax);
+
+		myPixels = _mm256_or_si256(_mm256_and_si256(myPixels, myAlphaMask),
+									_mm256_or_si256(_mm256_slli_epi32(myRed, 16), _mm256_or_si256(_mm256_slli_epi32(myGreen, 8), myBlue)));
+		_mm256_storeu_si256((__m256i *)(theRow + myX), myPixels);
+	}
+
+	// finish the row with the scalar kernel
+	if (myX < theCount)
+		QTNative_FilmGrainRowScalar(theRow + myX, theCount - myX, theKey, theFirstCounter + myX, theFade, theGrain);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// QTNative_GetFilmGrainRowProc
+// Return the grain kernel to use.
+//
+//////////
+
+static NativeGrainRowProcPtr QTNative_GetFilmGrainRowProc (void)
+{
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		return(QTNative_FilmGrainRowAVX2);
+#endif
+
+	return(QTNative_FilmGrainRowScalar);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Damage functions.
+//
+// Each of these functions draws one kind of damage over the band of rows described by a NativeRenderJob.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_ShadePixel
+// Blend the specified color over one pixel of the destination, if that pixel lies in the band being rendered.
+//
+//////////
+
+static void QTNative_ShadePixel (const NativeRenderJob *theJob, long theX, long theY, unsigned long theColor, long theAlpha)
+{
+	unsigned long		myPixel;
+
+	if ((theY < theJob->fFirstRow) || (theY >= theJob->fLastRow) || (theX < 0) || (theX >= theJob->fDest->fWidth))
+		return;
+
+	myPixel = QTNative_GetPixel(theJob->fDest, theX, theY);
+	myPixel = NATIVE_BLEND_PIXELS(myPixel, theColor, theAlpha);
+	QTNative_SetPixel(theJob->fDest, theX, theY, myPixel);
+}
+
+
+//////////
+//
+// QTNative_DrawDust
+// Draw the dust specks: small dark or light dots, in different places in every frame.
+//
+//////////
+
+static void QTNative_DrawDust (const NativeRenderJob *theJob, unsigned long theSeed, long theFrame, long theNumSpecks)
+{
+	unsigned int		myKey = QTNative_GetRandomKey(theSeed, theFrame, kNativeNoiseStreamDust);
+	long				myWidth = theJob->fDest->fWidth;
+	long				myHeight = theJob->fDest->fHeight;
+	long				myIndex;
+
+	for (myIndex = 0; myIndex < theNumSpecks; myIndex++) {
+		long			myX = (long)(QTNative_Random(myKey, (myIndex * 4) + 0) % (unsigned int)myWidth);
+		long			myY = (long)(QTNative_Random(myKey, (myIndex * 4) + 1) % (unsigned int)myHeight);
+		unsigned int	mySize = QTNative_Random(myKey, (myIndex * 4) + 2);
+		unsigned long	myColor = (QTNative_Random(myKey, (myIndex * 4) + 3) & 1) ? kNativeDarkDamage : kNativeLightDamage;
+		long			myRadius = (((1 + (long)(mySize % 3)) * myHeight) + kNativeReferenceHeight - 1) / kNativeReferenceHeight;
+		long			myDX, myDY;
+
+		// skip specks that don't reach the band
+		if ((myY + myRadius < theJob->fFirstRow) || (myY - myRadius >= theJob->fLastRow))
+			continue;
+
+		for (myDY = -myRadius; myDY <= myRadius; myDY++)
+			for (myDX = -myRadius; myDX <= myRadius; myDX++)
+				if ((myDX * myDX) + (myDY * myDY) <= myRadius * myRadius)
+					QTNative_ShadePixel(theJob, myX + myDX, myY + myDY, myColor, kNativeDustAlpha);
+	}
+}
+
+
+//////////
+//
+// QTNative_DrawHairs
+// Draw the hairs: thin dark curves, in different places in every frame.
+//
+//////////
+
+static void QTNative_DrawHairs (const NativeRenderJob *theJob, unsigned long theSeed, long theFrame, long theNumHairs)
+{
+	unsigned int		myKey = QTNative_GetRandomKey(theSeed, theFrame, kNativeNoiseStreamHair);
+	long				myWidth = theJob->fDest->fWidth;
+	long				myHeight = theJob->fDest->fHeight;
+	long				mySegmentLength = (myHeight / 40 < 2) ? 2 : (myHeight / 40);
+	long				myIndex;
+
+	for (myIndex = 0; myIndex < theNumHairs; myIndex++) {
+		unsigned long	myCounter = myIndex * (kNativeHairSegments + 3);
+		long			myX = (long)(QTNative_Random(myKey, myCounter + 0) % (unsigned int)myWidth) << 8;
+		long			myY = (long)(QTNative_Random(myKey, myCounter + 1) % (unsigned int)myHeight) << 8;
+		long			myDirection = (long)(QTNative_Random(myKey, myCounter + 2) & 15);
+		long			mySegment, myStep;
+
+		// skip hairs that can't reach the band
+		if (((myY >> 8) + (kNativeHairSegments * mySegmentLength) < theJob->fFirstRow) ||
+			((myY >> 8) - (kNativeHairSegments * mySegmentLength) >= theJob->fLastRow))
+			continue;
+
+		// each segment turns a little (or not at all) from the direction of the one before it
+		for (mySegment = 0; mySegment < kNativeHairSegments; mySegment++) {
+			myDirection = (myDirection + (long)(QTNative_Random(myKey, myCounter + 3 + mySegment) % 3) + 15) & 15;
+
+			for (myStep = 0; myStep < mySegmentLength; myStep++) {
+				myX += gNativeDirections[myDirection][0];
+				myY += gNativeDirections[myDirection][1];
+				QTNative_ShadePixel(theJob, myX >> 8, myY >> 8, kNativeDarkDamage, kNativeHairAlpha);
+			}
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_DrawScratches
+// Draw the scratches: light vertical lines that run the height of the frame. A scratch stays in about the same
+// place for kNativeScratchLife frames, then moves somewhere else (or goes away for a while).
+//
+//////////
+
+static void QTNative_DrawScratches (const NativeRenderJob *theJob, unsigned long theSeed, long theFrame, long theNumScratches)
+{
+	unsigned int		myFixedKey = QTNative_GetRandomKey(theSeed, 0, kNativeNoiseStreamScratch);
+	long				myWidth = theJob->fDest->fWidth;
+	long				myIndex;
+	long				myY;
+
+	for (myIndex = 0; myIndex < theNumScratches; myIndex++) {
+		long			myOffset = (long)(QTNative_Random(myFixedKey, myIndex) % kNativeScratchLife);
+		long			myEpoch = (theFrame + myOffset) / kNativeScratchLife;
+		long			myAge = (theFrame + myOffset) % kNativeScratchLife;
+		unsigned int	myKey = QTNative_GetRandomKey(theSeed, myEpoch, kNativeNoiseStreamScratch);
+		unsigned int	myPlace = QTNative_Random(myKey, (myIndex * 2) + 0);
+		unsigned int	myDrift = QTNative_Random(myKey, (myIndex * 2) + 1);
+		long			myX;
+
+		// in some epochs the scratch isn't there at all
+		if (myPlace & 0x80000000U)
+			continue;
+
+		myX = (long)(myPlace % (unsigned int)myWidth) + (myAge * ((long)(myDrift & 3) - 1));
+
+		for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+			// the scratch wanders a pixel to either side every few rows
+			long		myJitter = (long)(QTNative_Random(myKey, 0x10000UL + (myIndex * 0x10000UL) + (myY >> 3)) % 3) - 1;
+
+			QTNative_ShadePixel(theJob, myX + myJitter, myY, kNativeLightDamage, kNativeScratchAlpha);
+		}
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Effect procedure.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_FilmNoiseProc
+// Make the first source look like old film. The step number is used as the frame number.
+//
+//////////
+
+OSErr QTNative_FilmNoiseProc (const NativeRenderJob *theJob)
+{
+	const NativePixelBuffer		*mySrc = theJob->fSources[0];
+	NativePixelBuffer			*myDest = theJob->fDest;
+	const NativeEffectParams	*myParams = theJob->fParams;
+	unsigned long				mySeed = (unsigned long)QTNative_GetEffectParam(myParams, kNativeParamSeed, kNativeDefaultSeed);
+	long						myFrame = myParams->fStep;
+	long						myFade = QTNative_GetEffectParam(myParams, kNativeParamFade, kNativeDefaultFade);
+	long						myGrain = QTNative_GetEffectParam(myParams, kNativeParamGrain, kNativeDefaultGrain);
+	OSType						myRowFormat = QTNative_GetHostPixelFormat();
+	NativeSpanKernels			myToRow, myFromRow;
+	NativeGrainRowProcPtr		myGrainProc = QTNative_GetFilmGrainRowProc();
+	unsigned int				myGrainKey = QTNative_GetRandomKey(mySeed, myFrame, kNativeNoiseStreamGrain);
+	unsigned int				*myRow = NULL;
+	long						myY;
+
+	myFade = (myFade < 0) ? 0 : (myFade > 256) ? 256 : myFade;
+	myGrain = (myGrain < 0) ? 0 : (myGrain > 255) ? 255 : myGrain;
+
+	// we work on each row as 0xAARRGGBB values
+	if (!QTNative_GetSpanKernels(mySrc->fPixelFormat, myRowFormat, &myToRow) || !QTNative_GetSpanKernels(myRowFormat, myDest->fPixelFormat, &myFromRow))
+		return(paramErr);
+
+	myRow = (unsigned int *)QTNative_NewPoolBlock(myDest->fWidth * sizeof(unsigned int));
+	if (myRow == NULL)
+		return(memFullErr);
+
+	// fade the colors and add the grain
+	for (myY = theJob->fFirstRow; myY < theJob->fLastRow; myY++) {
+		myToRow.fConvert(QTNative_GetRowAddress(mySrc, myY), (unsigned char *)myRow, myDest->fWidth, mySrc->fColorTable);
+		myGrainProc(myRow, myDest->fWidth, myGrainKey, (unsigned long)myY * (unsigned long)myDest->fWidth, myFade, myGrain);
+		myFromRow.fConvert((const unsigned char *)myRow, QTNative_GetRowAddress(myDest, myY), myDest->fWidth, NULL);
+	}
+
+	QTNative_DisposePoolBlock(myRow);
+
+	// draw the damage
+	QTNative_DrawScratches(theJob, mySeed, myFrame, QTNative_GetEffectParam(myParams, kNativeParamScratches, kNativeDefaultScratches));
+	QTNative_DrawDust(theJob, mySeed, myFrame, QTNative_GetEffectParam(myParams, kNativeParamDust, kNativeDefaultDust));
+	QTNative_DrawHairs(theJob, mySeed, myFrame, QTNative_GetEffectParam(myParams, kNativeParamHair, kNativeDefaultHair));
+
+	return(noErr);
+}
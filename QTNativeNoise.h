@@ -0,0 +1,63 @@
+//////////
+//
+//	File:		QTNativeNoise.h
+//
+//	Contains:	A native film noise filter, and the counter-based random numbers it uses.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeNoise__
+#define __QTNativeNoise__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the random number streams used by the film noise filter; each kind of damage draws its own numbers,
+// so that changing (for instance) the amount of dust doesn't move the hairs
+#define kNativeNoiseStreamGrain				1
+#define kNativeNoiseStreamDust				2
+#define kNativeNoiseStreamHair				3
+#define kNativeNoiseStreamScratch			4
+
+// default values of the film noise parameters
+#define kNativeDefaultDust					16			// dust specks per frame
+#define kNativeDefaultHair					2			// hairs per frame
+#define kNativeDefaultScratches				2			// scratches on the film
+#define kNativeDefaultFade					64			// how far the colors fade toward sepia, out of 256
+#define kNativeDefaultGrain					16			// the amplitude of the grain, in levels
+#define kNativeDefaultSeed					0
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+unsigned int				QTNative_HashInt (unsigned int theValue);
+unsigned int				QTNative_GetRandomKey (unsigned long theSeed, long theFrame, long theStream);
+unsigned int				QTNative_Random (unsigned int theKey, unsigned long theCounter);
+
+OSErr						QTNative_FilmNoiseProc (const NativeRenderJob *theJob);
+
+#endif	// __QTNativeNoise__
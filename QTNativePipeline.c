@@ -0,0 +1,320 @@
+//////////
+//
+//	File:		QTNativePipeline.c
+//
+//	Contains:	Fused pipelines of native effects, rendered one band at a time.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <6>	 	10/17/26	rtm		a scratch buffer points at its first row, and says which row of the frame that is in fFirstRow
+//	   <5>	 	10/17/26	rtm		the bands are 64 times as tall as the halo, so the halo rows add only a few percent
+//	   <4>	 	10/17/26	rtm		the states of the stages are kept in the info and put in the jobs, and released after the step
+//	   <3>	 	10/17/26	rtm		the scratch buffers of each band come from the frame pool
+//	   <2>	 	10/17/26	rtm		stages with state are prepared (with QTNative_PrepareEffect) before the bands are rendered
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A compound effect (a transition with a filter or two layered over it, such as the film noise track that
+//	QTEffects_AddFilmNoiseToMovie adds) could be rendered one effect at a time, each into a whole intermediate
+//	frame. But then every stage writes a whole frame out to memory and the next stage reads it back in, and
+//	for a large frame that traffic costs more than the arithmetic of the effects themselves.
+//
+//	Instead, QTNative_RenderPipeline splits the destination into bands of rows and runs all the stages for one
+//	band before moving on to the next; the intermediate rows of a band go into small scratch buffers that stay
+//	in the processor's cache. Two scratch buffers are enough, since each stage reads only the output of the
+//	stage just before it.
+//
+//	A stage that reads rows above and below its band (a blur, for instance) needs the stage before it to render
+//	those rows too; so each stage renders its band plus a halo of rows as tall as the sum of the halos of all
+//	the later stages. The rows of the halo are rendered by both of the bands they touch; that's the price of
+//	keeping the bands independent, so that they can be rendered in parallel on the worker threads.
+//
+//	The intermediate rows are kept in the host's 32-bit pixel format, so each stage reads and writes them
+//	with a plain copy (see QTNativeFormats.c). A fused pipeline produces exactly the same pixels as rendering
+//	the stages one after another into whole frames of that format.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativePipeline.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the bands are at least 2 * kNativeHaloRatio times as tall as the halo of the first stage
+#define kNativeHaloRatio				32
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a pipeline being rendered in bands of rows on the worker threads
+typedef struct {
+	short						fNumStages;
+	NativeEffectParams			fStages[kNativeMaxStages];		// the stages, with the step to render filled in
+	NativeEffectProcPtr			fProcs[kNativeMaxStages];
+	void *						fStates[kNativeMaxStages];		// the states that QTNative_PrepareEffect returned
+	long						fHalos[kNativeMaxStages];		// the rows above and below a band that each stage renders
+	const NativePixelBuffer *	fSources[kNativeMaxSources];
+	NativePixelBuffer *			fDest;
+	long						fBandHeight;
+} NativePipelineInfo;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static OSErr						QTNative_RenderPipelineBand (void *theRefCon, long theIndex);
+
+
+//////////
+//
+// QTNative_InitPipeline
+// Initialize a pipeline, with no stages.
+//
+//////////
+
+void QTNative_InitPipeline (NativePipeline *thePipeline)
+{
+	memset(thePipeline, 0, sizeof(NativePipeline));
+}
+
+
+//////////
+//
+// QTNative_AddPipelineStage
+// Add a stage to the end of a pipeline. Any effect can be the first stage; each later stage must be a one-source effect.
+//
+//////////
+
+OSErr QTNative_AddPipelineStage (NativePipeline *thePipeline, const NativeEffectParams *theParams)
+{
+	const NativeEffectEntry		*myEntry = NULL;
+
+	if ((thePipeline == NULL) || (theParams == NULL))
+		return(paramErr);
+
+	if (thePipeline->fNumStages >= kNativeMaxStages)
+		return(paramErr);
+
+	if (!QTNative_CanRenderEffect(theParams))
+		return(paramErr);
+
+	myEntry = QTNative_FindEffect(theParams->fEffectType);
+	if ((thePipeline->fNumStages > 0) && (myEntry->fNumSources != 1))
+		return(paramErr);
+
+	thePipeline->fStages[thePipeline->fNumStages] = *theParams;
+	thePipeline->fNumStages++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_RenderPipeline
+// Render one step of a pipeline into the specified destination buffer.
+//
+// The sources are passed to the first stage, and so are subject to the same rules as for QTNative_RenderEffect.
+//
+//////////
+
+OSErr QTNative_RenderPipeline (const NativePipeline *thePipeline, long theStep, long theNumberOfSteps, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest)
+{
+	NativePipelineInfo			myInfo;
+	NativePixelBuffer			myStageBuffer;
+	const NativeEffectEntry		*myEntry = NULL;
+	long						myNumBands;
+	short						myIndex;
+	OSErr						myErr = noErr;
+
+	if ((thePipeline == NULL) || (thePipeline->fNumStages <= 0) || (thePipeline->fNumStages > kNativeMaxStages))
+		return(paramErr);
+
+	if ((theDest == NULL) || (theDest->fBaseAddr == NULL) || (theDest->fPixelFormat == kNativePixelFormat_8Indexed))
+		return(paramErr);
+
+	if (theNumberOfSteps <= 0)
+		return(paramErr);
+
+	memset(&myInfo, 0, sizeof(myInfo));
+	myInfo.fNumStages = thePipeline->fNumStages;
+	myInfo.fDest = theDest;
+
+	for (myIndex = 0; myIndex < thePipeline->fNumStages; myIndex++) {
+		myInfo.fStages[myIndex] = thePipeline->fStages[myIndex];
+		myInfo.fStages[myIndex].fStep = theStep;
+		myInfo.fStages[myIndex].fNumberOfSteps = theNumberOfSteps;
+	}
+
+	// a single stage is just an effect
+	if (myInfo.fNumStages == 1)
+		return(QTNative_RenderEffect(&myInfo.fStages[0], theSources, theNumSources, theDest));
+
+	for (myIndex = 0; myIndex < myInfo.fNumStages; myIndex++) {
+		myEntry = QTNative_FindEffect(myInfo.fStages[myIndex].fEffectType);
+		if (myEntry == NULL)
+			return(paramErr);
+		if ((myIndex > 0) && (myEntry->fNumSources != 1))
+			return(paramErr);
+
+		myInfo.fProcs[myIndex] = myEntry->fProc;
+	}
+
+	// check the sources of the first stage
+	myEntry = QTNative_FindEffect(myInfo.fStages[0].fEffectType);
+	if ((theNumSources < myEntry->fNumSources) || (theNumSources > kNativeMaxSources))
+		return(paramErr);
+
+	for (myIndex = 0; myIndex < myEntry->fNumSources; myIndex++) {
+		const NativePixelBuffer		*mySource = theSources[myIndex];
+
+		if ((mySource == NULL) || (mySource->fBaseAddr == NULL))
+			return(paramErr);
+		if (QTNative_GetBytesPerPixel(mySource->fPixelFormat) == 0)
+			return(paramErr);
+		if ((mySource->fWidth < theDest->fWidth) || (mySource->fHeight < theDest->fHeight))
+			return(paramErr);
+
+		myInfo.fSources[myIndex] = mySource;
+	}
+
+	// work out the halo of each stage, from the last stage back to the first
+	myInfo.fHalos[myInfo.fNumStages - 1] = 0;
+	for (myIndex = myInfo.fNumStages - 2; myIndex >= 0; myIndex--)
+		myInfo.fHalos[myIndex] = myInfo.fHalos[myIndex + 1] + QTNative_GetEffectHalo(&myInfo.fStages[myIndex + 1]);
+
+	// pick the band height so that a band of intermediate rows fits in the cache; but since the halo rows are
+	// rendered twice by the earlier stages, we make the bands tall enough that the halos add only a few percent
+	// (at most a 32nd) to the work of those stages
+	myStageBuffer.fBaseAddr = NULL;
+	myStageBuffer.fRowBytes = theDest->fWidth * 4;
+	myStageBuffer.fWidth = theDest->fWidth;
+	myStageBuffer.fHeight = theDest->fHeight;
+	myStageBuffer.fFirstRow = 0;
+	myStageBuffer.fPixelFormat = QTNative_GetHostPixelFormat();
+	myStageBuffer.fColorTable = NULL;
+
+	myInfo.fBandHeight = QTNative_GetHaloBandHeight(&myStageBuffer, kNativeHaloRatio * myInfo.fHalos[0]);
+	myNumBands = (theDest->fHeight + myInfo.fBandHeight - 1) / myInfo.fBandHeight;
+
+	// the bands call the effect procedures directly, so bring the state of each stage up to this step first;
+	// the states stay pinned until all the bands are done
+	for (myIndex = 0; myIndex < myInfo.fNumStages; myIndex++) {
+		myErr = QTNative_PrepareEffect(&myInfo.fStages[myIndex], theDest, &myInfo.fStates[myIndex]);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+	myErr = QTNative_ParallelFor(myNumBands, QTNative_RenderPipelineBand, &myInfo);
+
+bail:
+	for (myIndex = 0; myIndex < myInfo.fNumStages; myIndex++)
+		QTNative_ReleaseEffect(&myInfo.fStages[myIndex], myInfo.fStates[myIndex]);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_RenderPipelineBand
+// Render one band of rows of a pipeline step through all the stages; this is called on a worker thread by
+// QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_RenderPipelineBand (void *theRefCon, long theIndex)
+{
+	const NativePipelineInfo	*myInfo = (const NativePipelineInfo *)theRefCon;
+	NativePixelBuffer			*myDest = myInfo->fDest;
+	NativePixelBuffer			myStageBuffers[2];
+	NativeRenderJob				myJob;
+	unsigned char				*myScratch = NULL;
+	long						myRowBytes = QTNative_GetPoolRowBytes(myDest->fWidth, 4);
+	long						myFirstRow, myLastRow;
+	long						myNumRows;
+	short						myStage;
+	OSErr						myErr = noErr;
+
+	myFirstRow = theIndex * myInfo->fBandHeight;
+	myLastRow = myFirstRow + myInfo->fBandHeight;
+	if (myLastRow > myDest->fHeight)
+		myLastRow = myDest->fHeight;
+
+	// the first stage has the tallest halo, so its rows fit in either scratch buffer
+	myNumRows = (myLastRow - myFirstRow) + (2 * myInfo->fHalos[0]);
+	if (myNumRows > myDest->fHeight)
+		myNumRows = myDest->fHeight;
+
+	myScratch = (unsigned char *)QTNative_NewPoolBlock(myNumRows * myRowBytes * 2);
+	if (myScratch == NULL)
+		return(memFullErr);
+
+	memset(&myJob, 0, sizeof(myJob));
+
+	for (myStage = 0; myStage < myInfo->fNumStages; myStage++) {
+		NativePixelBuffer		*myStageBuffer = &myStageBuffers[myStage & 1];
+
+		myJob.fParams = &myInfo->fStages[myStage];
+		myJob.fState = myInfo->fStates[myStage];
+		myJob.fFirstRow = myFirstRow - myInfo->fHalos[myStage];
+		myJob.fLastRow = myLastRow + myInfo->fHalos[myStage];
+		if (myJob.fFirstRow < 0)
+			myJob.fFirstRow = 0;
+		if (myJob.fLastRow > myDest->fHeight)
+			myJob.fLastRow = myDest->fHeight;
+
+		if (myStage == 0) {
+			myJob.fSources[0] = myInfo->fSources[0];
+			myJob.fSources[1] = myInfo->fSources[1];
+			myJob.fSources[2] = myInfo->fSources[2];
+		} else {
+			myJob.fSources[0] = &myStageBuffers[(myStage - 1) & 1];
+			myJob.fSources[1] = NULL;
+			myJob.fSources[2] = NULL;
+		}
+
+		if (myStage == myInfo->fNumStages - 1) {
+			myJob.fDest = myDest;
+		} else {
+			// a scratch buffer looks to the effects like a whole frame, but only holds the rows this stage
+			// renders, starting with row fFirstRow; only rows fFirstRow through fLastRow - 1 are ever touched
+			myStageBuffer->fBaseAddr = myScratch + ((myStage & 1) * myNumRows * myRowBytes);
+			myStageBuffer->fRowBytes = myRowBytes;
+			myStageBuffer->fWidth = myDest->fWidth;
+			myStageBuffer->fHeight = myDest->fHeight;
+			myStageBuffer->fFirstRow = myJob.fFirstRow;
+			myStageBuffer->fPixelFormat = QTNative_GetHostPixelFormat();
+			myStageBuffer->fColorTable = NULL;
+			myJob.fDest = myStageBuffer;
+		}
+
+		myErr = myInfo->fProcs[myStage](&myJob);
+		if (myErr != noErr)
+			break;
+	}
+
+	QTNative_DisposePoolBlock(myScratch);
+
+	return(myErr);
+}
@@ -0,0 +1,63 @@
+//////////
+//
+//	File:		QTNativePipeline.h
+//
+//	Contains:	Fused pipelines of native effects, rendered one band at a time.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativePipeline__
+#define __QTNativePipeline__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// limits
+#define kNativeMaxStages					4
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a chain of effects: the first stage reads the pipeline's sources, and each later stage is a one-source
+// effect (a filter) that reads the output of the stage before it; all the stages share the same time
+typedef struct {
+	short					fNumStages;
+	NativeEffectParams		fStages[kNativeMaxStages];
+} NativePipeline;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void						QTNative_InitPipeline (NativePipeline *thePipeline);
+OSErr						QTNative_AddPipelineStage (NativePipeline *thePipeline, const NativeEffectParams *theParams);
+OSErr						QTNative_RenderPipeline (const NativePipeline *thePipeline, long theStep, long theNumberOfSteps, const NativePixelBuffer *theSources[], short theNumSources, NativePixelBuffer *theDest);
+
+#endif	// __QTNativePipeline__
@@ -0,0 +1,776 @@
+//////////
+//
+//	File:		QTNativeRawFile.c
+//
+//	Contains:	Memory-mapped files of raw frames (PPM, PGM, PAM, or a simple headered dump), used as effect
+//				sources without copying their pixels.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	10/17/26	rtm		documented why netpbm files must have 8-bit samples
+//	   <2>	 	10/17/26	rtm		documented the limit on the size of a file: its offsets are longs, and it's mapped in one view
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A raw frame file is mapped into memory as a whole, and a frame is described by a pixel buffer that points
+//	straight into the mapped pages; nothing is decoded or copied, and the operating system reads the pages
+//	from the disk only when the renderer first touches them. On a 64-bit system other than Windows, a batch
+//	job can run through a file of frames larger than memory, with QTNative_PrefetchRawFileFrame reading ahead
+//	of the renderer and QTNative_ReleaseRawFileFrame giving back the pages of the frames it's done with.
+//
+//	Since the frame offsets are longs and the whole file is mapped in a single view, a file can be no larger
+//	than LONG_MAX bytes, and must fit in the free address space of the process. Where longs are 32 bits (on
+//	Windows, and on any 32-bit system), that's 2GB at most, and in a 32-bit process usually a good deal less;
+//	QTNative_OpenRawFile refuses a larger file with kNativeNotRawFileErr, or fails with memFullErr if it can't
+//	be mapped. Mapping a window of frames at a time would lift the limit, at the cost of pixel buffers that
+//	don't stay valid for as long as the file is open.
+//
+//	We understand these kinds of files:
+//
+//		binary PPM (P6)		24-bit RGB
+//		binary PGM (P5)		8-bit gray, which we treat as 8-bit indexed pixels with no color table
+//		PAM (P7)			RGB, RGB_ALPHA (32-bit RGBA), or GRAYSCALE tuples
+//		raw frame dump		any native pixel format, with padded rows (see QTNativeRawFile.h)
+//
+//	A netpbm file may hold several images one after another (as written by "ffmpeg -f image2pipe", say);
+//	they become the frames of the file, as long as they all have the same size and format. Only a maximum
+//	value of 255 (one byte per sample) is supported, since the frames are handed to the renderer straight from
+//	the mapped pages; a 16-bit file (or one with any other maximum value) is refused with kNativeNotRawFileErr,
+//	and has to be converted to 8 bits first (with "pamdepth 255", say).
+//
+//	The rows of a netpbm image are packed, and its header is of any length, so its pixels are usually not
+//	aligned; a raw frame dump lets the writer pad the rows and the frames so that they're aligned for the
+//	vector kernels (QTNative_MakeRawFileHeader does that). The fAlignment field of an open file tells how
+//	well aligned its rows really are.
+//
+//	The file is mapped copy-on-write, so that anyone who scribbles on a frame gets private pages rather than
+//	a crash or a changed file.
+//
+//	We use file mappings on Windows and mmap everywhere else.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeRawFile.h"
+
+#include <ctype.h>
+#include <limits.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeMaxPNMToken				32				// the longest keyword in a PAM header that we care about
+#define kNativeInitialFrameOffsets		16
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static OSErr					QTNative_MapFile (const char *thePath, NativeRawFile *theFile);
+static void						QTNative_UnmapFile (NativeRawFile *theFile);
+static OSErr					QTNative_ParseRawFileDump (NativeRawFile *theFile);
+static OSErr					QTNative_ParsePNMFile (NativeRawFile *theFile);
+static long						QTNative_ParsePNMHeader (const NativeRawFile *theFile, long theOffset, long *theWidth, long *theHeight, OSType *thePixelFormat);
+static Boolean					QTNative_ReadPNMToken (const NativeRawFile *theFile, long *theOffset, char *theToken);
+static Boolean					QTNative_ReadPNMNumber (const NativeRawFile *theFile, long *theOffset, long *theNumber);
+static OSErr					QTNative_AddFrameOffset (NativeRawFile *theFile, long theOffset, long *theCapacity);
+static unsigned long			QTNative_ReadBigEndian32 (const unsigned char *thePtr);
+static void						QTNative_WriteBigEndian32 (unsigned char *thePtr, unsigned long theValue);
+static long						QTNative_GetAddressAlignment (unsigned long theAddress);
+
+
+//////////
+//
+// QTNative_OpenRawFile
+// Open the raw frame file at the specified path, and map it into memory.
+//
+// Return kNativeNotRawFileErr if the file isn't one that we understand, so that the caller can try some other
+// way of reading it. The caller is responsible for calling QTNative_CloseRawFile if this returns noErr.
+//
+//////////
+
+OSErr QTNative_OpenRawFile (const char *thePath, NativeRawFile *theFile)
+{
+	long				myRowLength;
+	long				myFrame;
+	OSErr				myErr = noErr;
+
+	memset(theFile, 0, sizeof(NativeRawFile));
+
+	if (thePath == NULL)
+		return(paramErr);
+
+	myErr = QTNative_MapFile(thePath, theFile);
+	if (myErr != noErr)
+		return(myErr);
+
+	if ((theFile->fDataSize >= kNativeRawFileHeaderSize) && (QTNative_ReadBigEndian32(theFile->fData) == kNativeRawFileMagic))
+		myErr = QTNative_ParseRawFileDump(theFile);
+	else if ((theFile->fDataSize >= 2) && (theFile->fData[0] == 'P'))
+		myErr = QTNative_ParsePNMFile(theFile);
+	else
+		myErr = kNativeNotRawFileErr;
+
+	if (myErr != noErr)
+		goto bail;
+
+	// work out the alignment of the rows: the largest power of 2 that divides both the row length and the address of each frame
+	myRowLength = QTNative_GetAddressAlignment((unsigned long)theFile->fRowBytes);
+	theFile->fAlignment = kNativeRawFileAlignment;
+	if (theFile->fAlignment > myRowLength)
+		theFile->fAlignment = myRowLength;
+
+	for (myFrame = 0; myFrame < theFile->fNumFrames; myFrame++) {
+		long			myAlignment = QTNative_GetAddressAlignment((unsigned long)(theFile->fData + theFile->fFrameOffsets[myFrame]));
+
+		if (theFile->fAlignment > myAlignment)
+			theFile->fAlignment = myAlignment;
+	}
+
+#if !defined(_WIN32)
+	// most batch jobs read the frames in order
+	madvise(theFile->fData, theFile->fDataSize, MADV_SEQUENTIAL);
+#endif
+
+bail:
+	if (myErr != noErr)
+		QTNative_CloseRawFile(theFile);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_CloseRawFile
+// Unmap a raw frame file opened by QTNative_OpenRawFile.
+//
+// Any pixel buffers returned by QTNative_GetRawFileFrame for the file are no longer valid.
+//
+//////////
+
+void QTNative_CloseRawFile (NativeRawFile *theFile)
+{
+	QTNative_UnmapFile(theFile);
+
+	if (theFile->fFrameOffsets != NULL)
+		free(theFile->fFrameOffsets);
+
+	memset(theFile, 0, sizeof(NativeRawFile));
+}
+
+
+//////////
+//
+// QTNative_GetRawFileFrame
+// Set up a pixel buffer that describes the specified frame of a raw frame file, in place.
+//
+// The pixels aren't copied; the buffer points into the mapped file, and stays valid until the file is closed.
+// It must not be passed to QTNative_DisposePixelBuffer.
+//
+//////////
+
+OSErr QTNative_GetRawFileFrame (const NativeRawFile *theFile, long theIndex, NativePixelBuffer *theBuffer)
+{
+	memset(theBuffer, 0, sizeof(NativePixelBuffer));
+
+	if ((theFile->fData == NULL) || (theIndex < 0) || (theIndex >= theFile->fNumFrames))
+		return(paramErr);
+
+	theBuffer->fBaseAddr = theFile->fData + theFile->fFrameOffsets[theIndex];
+	theBuffer->fRowBytes = theFile->fRowBytes;
+	theBuffer->fWidth = theFile->fWidth;
+	theBuffer->fHeight = theFile->fHeight;
+	theBuffer->fPixelFormat = theFile->fPixelFormat;
+	theBuffer->fColorTable = NULL;								// 8-bit pixels are gray levels
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_PrefetchRawFileFrame
+// Ask the operating system to start reading the pages of the specified frame of a raw frame file, so that
+// they're in memory by the time the renderer gets to them.
+//
+//////////
+
+void QTNative_PrefetchRawFileFrame (const NativeRawFile *theFile, long theIndex)
+{
+#if defined(_WIN32)
+	// the hint we'd need (PrefetchVirtualMemory) isn't available on older versions of Windows, so we rely on the
+	// read-ahead of the file cache
+	(void)theFile;
+	(void)theIndex;
+#else
+	unsigned long		myStart;
+	unsigned long		myEnd;
+	unsigned long		myPageSize = (unsigned long)sysconf(_SC_PAGESIZE);
+
+	if ((theFile->fData == NULL) || (theIndex < 0) || (theIndex >= theFile->fNumFrames))
+		return;
+
+	myStart = (unsigned long)theFile->fFrameOffsets[theIndex] & ~(myPageSize - 1);
+	myEnd = (unsigned long)theFile->fFrameOffsets[theIndex] + (unsigned long)(theFile->fRowBytes * theFile->fHeight);
+	if (myEnd > theFile->fDataSize)
+		myEnd = theFile->fDataSize;
+
+	madvise(theFile->fData + myStart, myEnd - myStart, MADV_WILLNEED);
+#endif
+}
+
+
+//////////
+//
+// QTNative_ReleaseRawFileFrame
+// Tell the operating system that the pages of the specified frame of a raw frame file won't be needed again
+// soon, so that streaming through a large file doesn't push everything else out of memory.
+//
+// The frame can still be read afterwards; its pages are simply read from the file again.
+//
+//////////
+
+void QTNative_ReleaseRawFileFrame (const NativeRawFile *theFile, long theIndex)
+{
+#if defined(_WIN32)
+	// Windows trims the pages of a mapped file from the working set on its own
+	(void)theFile;
+	(void)theIndex;
+#else
+	unsigned long		myStart;
+	unsigned long		myEnd;
+	unsigned long		myPageSize = (unsigned long)sysconf(_SC_PAGESIZE);
+
+	if ((theFile->fData == NULL) || (theIndex < 0) || (theIndex >= theFile->fNumFrames))
+		return;
+
+	// release only the pages that lie entirely within the frame, since its neighbors may share the others
+	myStart = ((unsigned long)theFile->fFrameOffsets[theIndex] + myPageSize - 1) & ~(myPageSize - 1);
+	myEnd = ((unsigned long)theFile->fFrameOffsets[theIndex] + (unsigned long)(theFile->fRowBytes * theFile->fHeight)) & ~(myPageSize - 1);
+
+	if (myEnd > myStart)
+		madvise(theFile->fData + myStart, myEnd - myStart, MADV_DONTNEED);
+#endif
+}
+
+
+//////////
+//
+// QTNative_MakeRawFileHeader
+// Fill in the header of a raw frame dump that holds the specified number of frames, each with the size,
+// format, and row bytes of theFormat.
+//
+// The frames follow the header at the next kNativeRawFileAlignment boundary, and each frame is padded to a
+// multiple of kNativeRawFileAlignment bytes; the writer must pad them the same way.
+//
+//////////
+
+void QTNative_MakeRawFileHeader (const NativePixelBuffer *theFormat, long theNumFrames, unsigned char theHeader[kNativeRawFileHeaderSize])
+{
+	unsigned long		myDataOffset = (kNativeRawFileHeaderSize + kNativeRawFileAlignment - 1) & ~(kNativeRawFileAlignment - 1);
+	unsigned long		myFrameStride = ((unsigned long)(theFormat->fRowBytes * theFormat->fHeight) + kNativeRawFileAlignment - 1) & ~(kNativeRawFileAlignment - 1);
+
+	QTNative_WriteBigEndian32(theHeader + 0, kNativeRawFileMagic);
+	QTNative_WriteBigEndian32(theHeader + 4, kNativeRawFileVersion);
+	QTNative_WriteBigEndian32(theHeader + 8, (unsigned long)theFormat->fWidth);
+	QTNative_WriteBigEndian32(theHeader + 12, (unsigned long)theFormat->fHeight);
+	QTNative_WriteBigEndian32(theHeader + 16, (unsigned long)theFormat->fRowBytes);
+	QTNative_WriteBigEndian32(theHeader + 20, theFormat->fPixelFormat);
+	QTNative_WriteBigEndian32(theHeader + 24, (unsigned long)theNumFrames);
+	QTNative_WriteBigEndian32(theHeader + 28, myDataOffset);
+	QTNative_WriteBigEndian32(theHeader + 32, myFrameStride);
+}
+
+
+//////////
+//
+// QTNative_MapFile
+// Map the whole of the file at the specified path into memory, copy-on-write.
+//
+//////////
+
+static OSErr QTNative_MapFile (const char *thePath, NativeRawFile *theFile)
+{
+#if defined(_WIN32)
+	HANDLE				myFile = INVALID_HANDLE_VALUE;
+	HANDLE				myMapping = NULL;
+	DWORD				mySizeHigh = 0;
+	DWORD				mySizeLow;
+	void *				myData = NULL;
+	OSErr				myErr = kNativeNotRawFileErr;
+
+	myFile = CreateFileA(thePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (myFile == INVALID_HANDLE_VALUE)
+		goto bail;
+
+	// an empty file can't be mapped, and one larger than 2GB can't be described by our offsets
+	mySizeLow = GetFileSize(myFile, &mySizeHigh);
+	if ((mySizeLow == INVALID_FILE_SIZE) || (mySizeHigh != 0) || (mySizeLow == 0) || (mySizeLow > (DWORD)LONG_MAX))
+		goto bail;
+
+	myErr = memFullErr;
+	myMapping = CreateFileMappingA(myFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (myMapping == NULL)
+		goto bail;
+
+	myData = MapViewOfFile(myMapping, FILE_MAP_COPY, 0, 0, 0);
+	if (myData == NULL)
+		goto bail;
+
+	theFile->fData = (unsigned char *)myData;
+	theFile->fDataSize = mySizeLow;
+	theFile->fFile = (void *)myFile;
+	theFile->fMapping = (void *)myMapping;
+	myErr = noErr;
+
+bail:
+	if (myErr != noErr) {
+		if (myMapping != NULL)
+			CloseHandle(myMapping);
+		if (myFile != INVALID_HANDLE_VALUE)
+			CloseHandle(myFile);
+	}
+
+	return(myErr);
+#else
+	struct stat			myInfo;
+	void *				myData;
+	int					myFile;
+	OSErr				myErr = kNativeNotRawFileErr;
+
+	myFile = open(thePath, O_RDONLY);
+	if (myFile < 0)
+		return(kNativeNotRawFileErr);
+
+	// an empty file can't be mapped, and one larger than LONG_MAX can't be described by our offsets
+	if ((fstat(myFile, &myInfo) != 0) || !S_ISREG(myInfo.st_mode) || (myInfo.st_size <= 0) || ((unsigned long)myInfo.st_size > (unsigned long)LONG_MAX))
+		goto bail;
+
+	myErr = memFullErr;
+	myData = mmap(NULL, (size_t)myInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, myFile, 0);
+	if (myData == MAP_FAILED)
+		goto bail;
+
+	theFile->fData = (unsigned char *)myData;
+	theFile->fDataSize = (unsigned long)myInfo.st_size;
+	myErr = noErr;
+
+bail:
+	// the mapping keeps the file open for us
+	close(myFile);
+
+	return(myErr);
+#endif
+}
+
+
+//////////
+//
+// QTNative_UnmapFile
+// Unmap a file mapped by QTNative_MapFile.
+//
+//////////
+
+static void QTNative_UnmapFile (NativeRawFile *theFile)
+{
+#if defined(_WIN32)
+	if (theFile->fData != NULL)
+		UnmapViewOfFile(theFile->fData);
+	if (theFile->fMapping != NULL)
+		CloseHandle((HANDLE)theFile->fMapping);
+	if (theFile->fFile != NULL)
+		CloseHandle((HANDLE)theFile->fFile);
+#else
+	if (theFile->fData != NULL)
+		munmap(theFile->fData, theFile->fDataSize);
+#endif
+
+	theFile->fData = NULL;
+	theFile->fDataSize = 0;
+	theFile->fMapping = NULL;
+	theFile->fFile = NULL;
+}
+
+
+//////////
+//
+// QTNative_ParseRawFileDump
+// Read the header of a raw frame dump, and work out where its frames are.
+//
+//////////
+
+static OSErr QTNative_ParseRawFileDump (NativeRawFile *theFile)
+{
+	const unsigned char *	myHeader = theFile->fData;
+	unsigned long			myDataOffset;
+	unsigned long			myFrameStride;
+	unsigned long			myFrameSize;
+	unsigned long			myNumFrames;
+	long					myBytesPerPixel;
+	long					myFrame;
+
+	if (QTNative_ReadBigEndian32(myHeader + 4) != kNativeRawFileVersion)
+		return(kNativeNotRawFileErr);
+
+	theFile->fKind = kNativeRawFileDump;
+	theFile->fWidth = (long)QTNative_ReadBigEndian32(myHeader + 8);
+	theFile->fHeight = (long)QTNative_ReadBigEndian32(myHeader + 12);
+	theFile->fRowBytes = (long)QTNative_ReadBigEndian32(myHeader + 16);
+	theFile->fPixelFormat = (OSType)QTNative_ReadBigEndian32(myHeader + 20);
+	myNumFrames = QTNative_ReadBigEndian32(myHeader + 24);
+	myDataOffset = QTNative_ReadBigEndian32(myHeader + 28);
+	myFrameStride = QTNative_ReadBigEndian32(myHeader + 32);
+
+	myBytesPerPixel = QTNative_GetBytesPerPixel(theFile->fPixelFormat);
+	if ((myBytesPerPixel == 0) || (theFile->fWidth <= 0) || (theFile->fWidth > kNativeMaxRawFileSize) || (theFile->fHeight <= 0) || (theFile->fHeight > kNativeMaxRawFileSize))
+		return(kNativeNotRawFileErr);
+
+	if ((theFile->fRowBytes < theFile->fWidth * myBytesPerPixel) || (myNumFrames == 0) || (myDataOffset < kNativeRawFileHeaderSize))
+		return(kNativeNotRawFileErr);
+
+	// make sure that every frame lies within the file (a truncated file loses its last frames, rather than failing)
+	if ((unsigned long)theFile->fRowBytes > (theFile->fDataSize / (unsigned long)theFile->fHeight))
+		return(kNativeNotRawFileErr);
+
+	myFrameSize = (unsigned long)theFile->fRowBytes * (unsigned long)theFile->fHeight;
+	if ((myFrameStride < myFrameSize) || (myDataOffset > theFile->fDataSize) || (theFile->fDataSize - myDataOffset < myFrameSize))
+		return(kNativeNotRawFileErr);
+
+	if (myNumFrames > ((theFile->fDataSize - myDataOffset - myFrameSize) / myFrameStride) + 1)
+		myNumFrames = ((theFile->fDataSize - myDataOffset - myFrameSize) / myFrameStride) + 1;
+
+	theFile->fFrameOffsets = (long *)malloc(myNumFrames * sizeof(long));
+	if (theFile->fFrameOffsets == NULL)
+		return(memFullErr);
+
+	for (myFrame = 0; myFrame < (long)myNumFrames; myFrame++)
+		theFile->fFrameOffsets[myFrame] = (long)(myDataOffset + (myFrame * myFrameStride));
+
+	theFile->fNumFrames = (long)myNumFrames;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ParsePNMFile
+// Read the headers of the images in a netpbm file, and make each image a frame.
+//
+//////////
+
+static OSErr QTNative_ParsePNMFile (NativeRawFile *theFile)
+{
+	long				myCapacity = 0;
+	long				myOffset = 0;
+	long				myFrameSize;
+	OSErr				myErr = noErr;
+
+	while (myOffset < (long)theFile->fDataSize) {
+		long			myWidth;
+		long			myHeight;
+		OSType			myPixelFormat;
+		long			myDataOffset;
+
+		myDataOffset = QTNative_ParsePNMHeader(theFile, myOffset, &myWidth, &myHeight, &myPixelFormat);
+		if (myDataOffset < 0)
+			break;
+
+		if (theFile->fNumFrames == 0) {
+			theFile->fWidth = myWidth;
+			theFile->fHeight = myHeight;
+			theFile->fPixelFormat = myPixelFormat;
+			theFile->fRowBytes = myWidth * QTNative_GetBytesPerPixel(myPixelFormat);
+		} else if ((myWidth != theFile->fWidth) || (myHeight != theFile->fHeight) || (myPixelFormat != theFile->fPixelFormat)) {
+			// a different image ends the frames
+			break;
+		}
+
+		// stop at a truncated image
+		myFrameSize = theFile->fRowBytes * theFile->fHeight;
+		if (myFrameSize > (long)theFile->fDataSize - myDataOffset)
+			break;
+
+		myErr = QTNative_AddFrameOffset(theFile, myDataOffset, &myCapacity);
+		if (myErr != noErr)
+			return(myErr);
+
+		myOffset = myDataOffset + myFrameSize;
+
+		// skip any whitespace between images
+		while ((myOffset < (long)theFile->fDataSize) && isspace(theFile->fData[myOffset]))
+			myOffset++;
+	}
+
+	if (theFile->fNumFrames == 0)
+		return(kNativeNotRawFileErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ParsePNMHeader
+// Read the netpbm header at the specified offset in a raw frame file.
+//
+// Return the offset of the pixels that follow the header, or -1 if the header isn't one that we understand.
+//
+//////////
+
+static long QTNative_ParsePNMHeader (const NativeRawFile *theFile, long theOffset, long *theWidth, long *theHeight, OSType *thePixelFormat)
+{
+	const unsigned char *	myData = theFile->fData;
+	long					myMaxValue = 0;
+	long					myDepth = 0;
+	char					myTupleType[kNativeMaxPNMToken];
+
+	*theWidth = 0;
+	*theHeight = 0;
+
+	if ((theOffset + 2 > (long)theFile->fDataSize) || (myData[theOffset] != 'P'))
+		return(-1);
+
+	switch (myData[theOffset + 1]) {
+		case '5':
+		case '6':
+			*thePixelFormat = (myData[theOffset + 1] == '5') ? kNativePixelFormat_8Indexed : kNativePixelFormat_24RGB;
+			theOffset += 2;
+
+			if (!QTNative_ReadPNMNumber(theFile, &theOffset, theWidth) ||
+				!QTNative_ReadPNMNumber(theFile, &theOffset, theHeight) ||
+				!QTNative_ReadPNMNumber(theFile, &theOffset, &myMaxValue))
+				return(-1);
+
+			// exactly one whitespace character separates the header from the pixels
+			if ((theOffset >= (long)theFile->fDataSize) || !isspace(myData[theOffset]))
+				return(-1);
+
+			theOffset++;
+			break;
+
+		case '7':
+			theOffset += 2;
+			myTupleType[0] = '\0';
+
+			for (;;) {
+				char			myToken[kNativeMaxPNMToken];
+
+				if (!QTNative_ReadPNMToken(theFile, &theOffset, myToken))
+					return(-1);
+
+				if (strcmp(myToken, "ENDHDR") == 0)
+					break;
+
+				if (strcmp(myToken, "WIDTH") == 0) {
+					if (!QTNative_ReadPNMNumber(theFile, &theOffset, theWidth))
+						return(-1);
+				} else if (strcmp(myToken, "HEIGHT") == 0) {
+					if (!QTNative_ReadPNMNumber(theFile, &theOffset, theHeight))
+						return(-1);
+				} else if (strcmp(myToken, "DEPTH") == 0) {
+					if (!QTNative_ReadPNMNumber(theFile, &theOffset, &myDepth))
+						return(-1);
+				} else if (strcmp(myToken, "MAXVAL") == 0) {
+					if (!QTNative_ReadPNMNumber(theFile, &theOffset, &myMaxValue))
+						return(-1);
+				} else if (strcmp(myToken, "TUPLTYPE") == 0) {
+					if (!QTNative_ReadPNMToken(theFile, &theOffset, myTupleType))
+						return(-1);
+				} else {
+					return(-1);
+				}
+			}
+
+			// the line with ENDHDR ends with a newline
+			if ((theOffset >= (long)theFile->fDataSize) || (myData[theOffset] != '\n'))
+				return(-1);
+
+			theOffset++;
+
+			// the depth decides the format; the tuple type, if any, must agree with it
+			if ((myDepth == 1) && ((myTupleType[0] == '\0') || (strcmp(myTupleType, "GRAYSCALE") == 0)))
+				*thePixelFormat = kNativePixelFormat_8Indexed;
+			else if ((myDepth == 3) && ((myTupleType[0] == '\0') || (strcmp(myTupleType, "RGB") == 0)))
+				*thePixelFormat = kNativePixelFormat_24RGB;
+			else if ((myDepth == 4) && ((myTupleType[0] == '\0') || (strcmp(myTupleType, "RGB_ALPHA") == 0)))
+				*thePixelFormat = kNativePixelFormat_32RGBA;
+			else
+				return(-1);
+			break;
+
+		default:
+			return(-1);
+	}
+
+	if ((myMaxValue != 255) || (*theWidth <= 0) || (*theWidth > kNativeMaxRawFileSize) || (*theHeight <= 0) || (*theHeight > kNativeMaxRawFileSize))
+		return(-1);
+
+	return(theOffset);
+}
+
+
+//////////
+//
+// QTNative_ReadPNMToken
+// Read the next token (a run of characters other than whitespace) from a netpbm header, skipping whitespace
+// and comments before it.
+//
+// A token that's too long to be one we understand is truncated, which keeps it from matching anything.
+//
+//////////
+
+static Boolean QTNative_ReadPNMToken (const NativeRawFile *theFile, long *theOffset, char *theToken)
+{
+	const unsigned char *	myData = theFile->fData;
+	long					mySize = (long)theFile->fDataSize;
+	long					myOffset = *theOffset;
+	long					myLength = 0;
+
+	// skip whitespace and comments, which run from a '#' to the end of the line
+	while (myOffset < mySize) {
+		if (myData[myOffset] == '#') {
+			while ((myOffset < mySize) && (myData[myOffset] != '\n'))
+				myOffset++;
+		} else if (isspace(myData[myOffset])) {
+			myOffset++;
+		} else {
+			break;
+		}
+	}
+
+	while ((myOffset < mySize) && !isspace(myData[myOffset])) {
+		if (myLength < kNativeMaxPNMToken - 1)
+			theToken[myLength++] = (char)myData[myOffset];
+		myOffset++;
+	}
+
+	theToken[myLength] = '\0';
+	*theOffset = myOffset;
+
+	return(myLength > 0);
+}
+
+
+//////////
+//
+// QTNative_ReadPNMNumber
+// Read the next token from a netpbm header, as a decimal number.
+//
+//////////
+
+static Boolean QTNative_ReadPNMNumber (const NativeRawFile *theFile, long *theOffset, long *theNumber)
+{
+	char				myToken[kNativeMaxPNMToken];
+	long				myNumber = 0;
+	short				myIndex;
+
+	if (!QTNative_ReadPNMToken(theFile, theOffset, myToken))
+		return(false);
+
+	for (myIndex = 0; myToken[myIndex] != '\0'; myIndex++) {
+		if ((myToken[myIndex] < '0') || (myToken[myIndex] > '9') || (myNumber > (LONG_MAX / 10) - 1))
+			return(false);
+
+		myNumber = (myNumber * 10) + (myToken[myIndex] - '0');
+	}
+
+	*theNumber = myNumber;
+
+	return(true);
+}
+
+
+//////////
+//
+// QTNative_AddFrameOffset
+// Add the offset of another frame to the list of frames of a raw frame file, growing the list if necessary.
+//
+//////////
+
+static OSErr QTNative_AddFrameOffset (NativeRawFile *theFile, long theOffset, long *theCapacity)
+{
+	if (theFile->fNumFrames == *theCapacity) {
+		long			myCapacity = (*theCapacity == 0) ? kNativeInitialFrameOffsets : *theCapacity * 2;
+		long *			myOffsets = (long *)realloc(theFile->fFrameOffsets, myCapacity * sizeof(long));
+
+		if (myOffsets == NULL)
+			return(memFullErr);
+
+		theFile->fFrameOffsets = myOffsets;
+		*theCapacity = myCapacity;
+	}
+
+	theFile->fFrameOffsets[theFile->fNumFrames++] = theOffset;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ReadBigEndian32
+// Read a 32-bit big-endian number.
+//
+//////////
+
+static unsigned long QTNative_ReadBigEndian32 (const unsigned char *thePtr)
+{
+	return(((unsigned long)thePtr[0] << 24) | ((unsigned long)thePtr[1] << 16) | ((unsigned long)thePtr[2] << 8) | (unsigned long)thePtr[3]);
+}
+
+
+//////////
+//
+// QTNative_WriteBigEndian32
+// Write a 32-bit big-endian number.
+//
+//////////
+
+static void QTNative_WriteBigEndian32 (unsigned char *thePtr, unsigned long theValue)
+{
+	thePtr[0] = (unsigned char)(theValue >> 24);
+	thePtr[1] = (unsigned char)(theValue >> 16);
+	thePtr[2] = (unsigned char)(theValue >> 8);
+	thePtr[3] = (unsigned char)theValue;
+}
+
+
+//////////
+//
+// QTNative_GetAddressAlignment
+// Return the largest power of 2 (up to kNativeRawFileAlignment) that divides the specified address or length.
+//
+//////////
+
+static long QTNative_GetAddressAlignment (unsigned long theAddress)
+{
+	long				myAlignment = 1;
+
+	while ((myAlignment < kNativeRawFileAlignment) && ((theAddress & myAlignment) == 0))
+		myAlignment <<= 1;
+
+	return(myAlignment);
+}
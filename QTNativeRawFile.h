@@ -0,0 +1,107 @@
+//////////
+//
+//	File:		QTNativeRawFile.h
+//
+//	Contains:	Memory-mapped files of raw frames (PPM, PGM, PAM, or a simple headered dump), used as effect
+//				sources without copying their pixels.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		documented the limit on the size of a file (see QTNativeRawFile.c)
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeRawFile__
+#define __QTNativeRawFile__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// the layout of a raw frame dump: a header of 32-bit big-endian numbers, followed by the frames
+//
+//		offset	contents
+//		0		kNativeRawFileMagic
+//		4		kNativeRawFileVersion
+//		8		the width of each frame, in pixels
+//		12		the height of each frame
+//		16		the number of bytes in each row (at least width times the bytes per pixel)
+//		20		the pixel format (a kNativePixelFormat_ constant; 8-bit pixels are gray levels)
+//		24		the number of frames
+//		28		the offset of the first frame from the start of the file
+//		32		the offset from the start of one frame to the start of the next
+//
+// the frames should start on a kNativeRawFileAlignment boundary, so that the rows the effects read are aligned
+#define kNativeRawFileMagic					FOUR_CHAR_CODE('QTRF')
+#define kNativeRawFileVersion				1
+#define kNativeRawFileHeaderSize			36
+#define kNativeRawFileAlignment				64
+
+// kinds of raw frame files
+#define kNativeRawFileDump					FOUR_CHAR_CODE('QTRF')
+#define kNativeRawFilePPM					FOUR_CHAR_CODE('PPM ')
+#define kNativeRawFilePGM					FOUR_CHAR_CODE('PGM ')
+#define kNativeRawFilePAM					FOUR_CHAR_CODE('PAM ')
+
+// the error returned by QTNative_OpenRawFile for a file that isn't a raw frame file, so that the caller can try
+// another way of reading it (same value as QuickTime's noMovieFound)
+#define kNativeNotRawFileErr				-2048
+
+// limits
+#define kNativeMaxRawFileSize				32768		// the largest width or height of a frame
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// an open raw frame file; the frames are read directly from the mapped pages of the file
+typedef struct {
+	OSType					fKind;
+	long					fWidth;
+	long					fHeight;
+	long					fRowBytes;
+	OSType					fPixelFormat;
+	long					fAlignment;					// the largest power of 2 (up to kNativeRawFileAlignment) that
+														// divides the address of every row of every frame
+	long					fNumFrames;
+	long *					fFrameOffsets;				// the offset of each frame from the start of the file
+	unsigned char *			fData;						// the mapped file
+	unsigned long			fDataSize;					// at most LONG_MAX (so 2GB where longs are 32 bits)
+	void *					fFile;						// the platform's handles for the file and its mapping
+	void *					fMapping;
+} NativeRawFile;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_OpenRawFile (const char *thePath, NativeRawFile *theFile);
+void						QTNative_CloseRawFile (NativeRawFile *theFile);
+OSErr						QTNative_GetRawFileFrame (const NativeRawFile *theFile, long theIndex, NativePixelBuffer *theBuffer);
+void						QTNative_PrefetchRawFileFrame (const NativeRawFile *theFile, long theIndex);
+void						QTNative_ReleaseRawFileFrame (const NativeRawFile *theFile, long theIndex);
+void						QTNative_MakeRawFileHeader (const NativePixelBuffer *theFormat, long theNumFrames, unsigned char theHeader[kNativeRawFileHeaderSize]);
+
+#endif	// __QTNativeRawFile__
@@ -0,0 +1,680 @@
+//////////
+//
+//	File:		QTNativeResample.c
+//
+//	Contains:	A separable resampler, for scaling pictures to the size of the effect.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	10/17/26	rtm		the scratch rows of each band come from the frame pool
+//	   <3>	 	10/17/26	rtm		the source and destination rows are read and written with QTNative_ReadHostRow and
+//									QTNative_WriteHostRows, so pictures in the Y'CbCr formats are scaled too
+//	   <2>	 	10/17/26	rtm		added the bicubic and Lanczos filters, AVX2 versions of the passes, and
+//									QTNative_GetResampleFilter, which picks a filter for a QuickTime quality level
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A picture is resampled in two passes: first each row is scaled to the new width, into an intermediate
+//	image that is as wide as the destination and as tall as the source; then each column of that is scaled
+//	to the new height. Each destination pixel is a weighted sum of a few neighboring source pixels; the
+//	weights depend only on the pixel's column (or row), so they're worked out once for each column and each
+//	row, into a table, before any pixels are touched.
+//
+//	There are three filters: a triangle (bilinear), which is the cheapest; a cubic, which is sharper; and
+//	Lanczos-3 (a windowed sinc reaching 3 pixels on either side), which keeps the most detail, at the cost of
+//	a little ringing around hard edges. QTNative_GetResampleFilter maps a QuickTime quality level to one of them.
+//
+//	When a picture is shrunk, the filter is widened by the same factor, so that every source pixel contributes
+//	to the result; that's what keeps a shrunken photo from sparkling with aliasing.
+//
+//	The weights are fixed-point numbers that add up to exactly 1 << kNativeResampleBits. Pixels are filtered
+//	one byte at a time in the host's 32-bit format, so the order of the channels doesn't matter; sources and
+//	destinations in other formats (including Y'CbCr) are converted a row at a time as they're read and
+//	written (see QTNativeConvert.c), which is how QTNative_ConvertAndScalePixelBuffer converts and scales in
+//	one pass. The destination rows are written in pairs, since 4:2:0 rows share their chroma. The
+//	intermediate image is kept at 8 bits per channel.
+//
+//	The AVX2 versions of the passes multiply two taps at once (with vpmaddwd), and produce exactly the same
+//	pixels as the scalar versions. Both passes are split into bands of rows, which are rendered in
+//	parallel on the worker threads.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeResample.h"
+#include "QTNativeBlend.h"
+#include "QTNativeCPU.h"
+#include "QTNativeConvert.h"
+#include "QTNativeFormats.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeThreads.h"
+
+#include <math.h>
+
+#if NATIVE_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeResampleRound			(1L << (kNativeResampleBits - 1))
+
+// the constant of the cubic filter (-0.5 makes it the Catmull-Rom spline)
+#define kNativeCubicSharpness			-0.5
+
+#define kNativePi						3.14159265358979323846
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the filter weights for each destination column (or row): destination pixel i is the sum, for each tap t, of
+// fWeights[(i * fNumTaps) + t] times source pixel fStarts[i] + t
+typedef struct {
+	long						fNumTaps;
+	long *						fStarts;
+	short *						fWeights;
+} NativeResampleTable;
+
+typedef void (*NativeResampleRowProcPtr) (const unsigned int *theSrc, unsigned int *theDest, long theWidth, const NativeResampleTable *theTable);
+typedef void (*NativeResampleColumnsProcPtr) (const unsigned char *theSrc, long theRowBytes, unsigned char *theDest, long theCount, const short *theWeights, long theNumTaps, int *theSums);
+
+// the pass kernels to use
+typedef struct {
+	NativeResampleRowProcPtr		fRowPass;
+	NativeResampleColumnsProcPtr	fColumnPass;
+} NativeResampleKernels;
+
+// a picture being resampled on the worker threads
+typedef struct {
+	const NativePixelBuffer *	fSrc;
+	NativePixelBuffer *			fDest;
+	NativeResampleTable			fColumns;					// the weights of the row pass
+	NativeResampleTable			fRows;						// the weights of the column pass
+	unsigned char *				fMiddle;					// the intermediate image, in the host's 32-bit format
+	long						fMiddleRowBytes;
+	long						fBandHeight;				// the number of rows in each band of the current pass
+	const NativeResampleKernels	*fKernels;
+} NativeResampleInfo;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+static OSErr						QTNative_ResampleRowBand (void *theRefCon, long theIndex);
+static OSErr						QTNative_ResampleColumnBand (void *theRefCon, long theIndex);
+static void							QTNative_ResampleRowScalar (const unsigned int *theSrc, unsigned int *theDest, long theWidth, const NativeResampleTable *theTable);
+static void							QTNative_ResampleColumnsScalar (const unsigned char *theSrc, long theRowBytes, unsigned char *theDest, long theCount, const short *theWeights, long theNumTaps, int *theSums);
+#if NATIVE_HAS_AVX2
+static void							QTNative_ResampleRowAVX2 (const unsigned int *theSrc, unsigned int *theDest, long theWidth, const NativeResampleTable *theTable);
+static void							QTNative_ResampleColumnsAVX2 (const unsigned char *theSrc, long theRowBytes, unsigned char *theDest, long theCount, const short *theWeights, long theNumTaps, int *theSums);
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static const NativeResampleKernels	gNativeResampleScalar = {
+	QTNative_ResampleRowScalar,
+	QTNative_ResampleColumnsScalar
+};
+
+#if NATIVE_HAS_AVX2
+static const NativeResampleKernels	gNativeResampleAVX2 = {
+	QTNative_ResampleRowAVX2,
+	QTNative_ResampleColumnsAVX2
+};
+#endif
+
+
+//////////
+//
+// QTNative_GetResampleKernels
+// Return the pass kernels to use.
+//
+//////////
+
+static const NativeResampleKernels *QTNative_GetResampleKernels (void)
+{
+#if NATIVE_HAS_AVX2
+	if (QTNative_UseAVX2Kernels())
+		return(&gNativeResampleAVX2);
+#endif
+
+	return(&gNativeResampleScalar);
+}
+
+
+//////////
+//
+// QTNative_GetFilterRadius
+// Return the number of source pixels on either side of the center that the specified filter reaches, at full size.
+//
+//////////
+
+static double QTNative_GetFilterRadius (short theFilter)
+{
+	switch (theFilter) {
+		case kNativeResampleBicubic:
+			return(2.0);
+
+		case kNativeResampleLanczos3:
+			return(3.0);
+
+		case kNativeResampleBilinear:
+		default:
+			return(1.0);
+	}
+}
+
+
+//////////
+//
+// QTNative_EvaluateFilter
+// Return the weight that the specified filter gives to a pixel at the specified distance from the center.
+//
+//////////
+
+static double QTNative_EvaluateFilter (short theFilter, double theDistance)
+{
+	double				myA = kNativeCubicSharpness;
+	double				myX = fabs(theDistance);
+
+	switch (theFilter) {
+		case kNativeResampleBicubic:
+			if (myX < 1.0)
+				return((((myA + 2.0) * myX) - (myA + 3.0)) * myX * myX + 1.0);
+			if (myX < 2.0)
+				return((((myA * myX) - (5.0 * myA)) * myX + (8.0 * myA)) * myX - (4.0 * myA));
+			return(0.0);
+
+		case kNativeResampleLanczos3:
+			if (myX < 1.0e-8)
+				return(1.0);
+			if (myX < 3.0)
+				return((3.0 * sin(kNativePi * myX) * sin(kNativePi * myX / 3.0)) / (kNativePi * kNativePi * myX * myX));
+			return(0.0);
+
+		case kNativeResampleBilinear:
+		default:
+			return((myX < 1.0) ? 1.0 - myX : 0.0);
+	}
+}
+
+
+//////////
+//
+// QTNative_DisposeResampleTable
+// Free the memory used by a table of filter weights.
+//
+//////////
+
+static void QTNative_DisposeResampleTable (NativeResampleTable *theTable)
+{
+	free(theTable->fStarts);
+	free(theTable->fWeights);
+
+	theTable->fStarts = NULL;
+	theTable->fWeights = NULL;
+}
+
+
+//////////
+//
+// QTNative_NewResampleTable
+// Work out the filter weights for scaling a row (or column) of theSrcSize pixels to theDestSize pixels.
+//
+// Taps that fall beyond the edges of the source are folded onto the nearest edge pixel.
+//
+//////////
+
+static OSErr QTNative_NewResampleTable (long theSrcSize, long theDestSize, short theFilter, NativeResampleTable *theTable)
+{
+	double				myScale = (double)theSrcSize / (double)theDestSize;
+	double				myStretch = (myScale > 1.0) ? myScale : 1.0;
+	double				mySupport = QTNative_GetFilterRadius(theFilter) * myStretch;
+	double				*myValues = NULL;
+	long				myIndex;
+	long				myTap;
+
+	memset(theTable, 0, sizeof(NativeResampleTable));
+
+	theTable->fNumTaps = (long)ceil(2.0 * mySupport) + 3;
+	if (theTable->fNumTaps > theSrcSize)
+		theTable->fNumTaps = theSrcSize;
+
+	theTable->fStarts = (long *)malloc((size_t)theDestSize * sizeof(long));
+	theTable->fWeights = (short *)calloc((size_t)theDestSize * theTable->fNumTaps, sizeof(short));
+	myValues = (double *)malloc((size_t)theTable->fNumTaps * sizeof(double));
+	if ((theTable->fStarts == NULL) || (theTable->fWeights == NULL) || (myValues == NULL)) {
+		QTNative_DisposeResampleTable(theTable);
+		free(myValues);
+		return(memFullErr);
+	}
+
+	for (myIndex = 0; myIndex < theDestSize; myIndex++) {
+		double			myCenter = ((myIndex + 0.5) * myScale) - 0.5;
+		long			myFirst = (long)floor(myCenter - mySupport);
+		long			myLast = (long)ceil(myCenter + mySupport);
+		long			myStart = myFirst;
+		short			*myWeights = theTable->fWeights + (myIndex * theTable->fNumTaps);
+		double			myTotal = 0.0;
+		long			mySum = 0;
+		long			myLargest = 0;
+		long			myPixel;
+
+		if (myStart > theSrcSize - theTable->fNumTaps)
+			myStart = theSrcSize - theTable->fNumTaps;
+		if (myStart < 0)
+			myStart = 0;
+
+		for (myTap = 0; myTap < theTable->fNumTaps; myTap++)
+			myValues[myTap] = 0.0;
+
+		for (myPixel = myFirst; myPixel <= myLast; myPixel++) {
+			double		myValue = QTNative_EvaluateFilter(theFilter, (myPixel - myCenter) / myStretch);
+			long		mySource = (myPixel < 0) ? 0 : (myPixel >= theSrcSize) ? theSrcSize - 1 : myPixel;
+
+			myValues[mySource - myStart] += myValue;
+			myTotal += myValue;
+		}
+
+		// scale the weights so that they add up to exactly 1.0; any rounding error goes to the largest weight
+		for (myTap = 0; myTap < theTable->fNumTaps; myTap++) {
+			myWeights[myTap] = (short)floor(((myValues[myTap] / myTotal) * (1L << kNativeResampleBits)) + 0.5);
+			mySum += myWeights[myTap];
+			if (myWeights[myTap] > myWeights[myLargest])
+				myLargest = myTap;
+		}
+
+		myWeights[myLargest] = (short)(myWeights[myLargest] + ((1L << kNativeResampleBits) - mySum));
+		theTable->fStarts[myIndex] = myStart;
+	}
+
+	free(myValues);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_ResampleRowScalar
+// Scale a row of host-format pixels to the destination width.
+//
+//////////
+
+static void QTNative_ResampleRowScalar (const unsigned int *theSrc, unsigned int *theDest, long theWidth, const NativeResampleTable *theTable)
+{
+	long				myX;
+	long				myTap;
+	short				myChannel;
+
+	for (myX = 0; myX < theWidth; myX++) {
+		const unsigned char		*myPixels = (const unsigned char *)(theSrc + theTable->fStarts[myX]);
+		const short				*myWeights = theTable->fWeights + (myX * theTable->fNumTaps);
+		unsigned char			*myResult = (unsigned char *)(theDest + myX);
+
+		for (myChannel = 0; myChannel < 4; myChannel++) {
+			long				mySum = kNativeResampleRound;
+
+			for (myTap = 0; myTap < theTable->fNumTaps; myTap++)
+				mySum += myWeights[myTap] * myPixels[(4 * myTap) + myChannel];
+
+			mySum >>= kNativeResampleBits;
+			myResult[myChannel] = (unsigned char)((mySum < 0) ? 0 : (mySum > 255) ? 255 : mySum);
+		}
+	}
+}
+
+
+//////////
+//
+// QTNative_ResampleColumnsScalar
+// Compute a row of the destination from some rows of the intermediate image: each byte of the result is the
+// weighted sum of the bytes at the same position in theNumTaps consecutive rows, starting at theSrc.
+//
+//////////
+
+static void QTNative_ResampleColumnsScalar (const unsigned char *theSrc, long theRowBytes, unsigned char *theDest, long theCount, const short *theWeights, long theNumTaps, int *theSums)
+{
+	long				myIndex;
+	long				myTap;
+
+	for (myIndex = 0; myIndex < theCount; myIndex++)
+		theSums[myIndex] = kNativeResampleRound;
+
+	for (myTap = 0; myTap < theNumTaps; myTap++) {
+		const unsigned char		*myRow = theSrc + (myTap * theRowBytes);
+		int						myWeight = theWeights[myTap];
+
+		if (myWeight == 0)
+			continue;
+
+		for (myIndex = 0; myIndex < theCount; myIndex++)
+			theSums[myIndex] += myWeight * myRow[myIndex];
+	}
+
+	for (myIndex = 0; myIndex < theCount; myIndex++) {
+		int						mySum = theSums[myIndex] >> kNativeResampleBits;
+
+		theDest[myIndex] = (unsigned char)((mySum < 0) ? 0 : (mySum > 255) ? 255 : mySum);
+	}
+}
+
+
+#if NATIVE_HAS_AVX2
+//////////
+//
+// QTNative_ResampleRowAVX2
+// Do what QTNative_ResampleRowScalar does, two taps (all four channels of two pixels) at a time.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ResampleRowAVX2 (const unsigned int *theSrc, unsigned int *theDest, long theWidth, const NativeResampleTable *theTable)
+{
+	__m128i				myRound = _mm_set1_epi32(kNativeResampleRound);
+	long				myX;
+	long				myTap;
+
+	for (myX = 0; myX < theWidth; myX++) {
+		const unsigned int		*myPixels = theSrc + theTable->fStarts[myX];
+		const short				*myWeights = theTable->fWeights + (myX * theTable->fNumTaps);
+		__m128i					mySums = myRound;
+
+		// interleave the channels of two pixels (a0 b0 a1 b1 ...), and multiply them by the pair of weights
+		for (myTap = 0; myTap + 1 < theTable->fNumTaps; myTap += 2) {
+			__m128i				myPair = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)myPixels[myTap]), _mm_cvtsi32_si128((int)myPixels[myTap + 1]));
+			__m128i				myWeightPair = _mm_set1_epi32((int)(((unsigned int)(unsigned short)myWeights[myTap + 1] << 16) | (unsigned short)myWeights[myTap]));
+
+			mySums = _mm_add_epi32(mySums, _mm_madd_epi16(_mm_cvtepu8_epi16(myPair), myWeightPair));
+		}
+
+		if (myTap < theTable->fNumTaps)
+			mySums = _mm_add_epi32(mySums, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)myPixels[myTap])), _mm_set1_epi32(myWeights[myTap])));
+
+		mySums = _mm_srai_epi32(mySums, kNativeResampleBits);
+		mySums = _mm_packs_epi32(mySums, mySums);
+		theDest[myX] = (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(mySums, mySums));
+	}
+}
+
+
+//////////
+//
+// QTNative_ResampleColumnsAVX2
+// Do what QTNative_ResampleColumnsScalar does, for 32 bytes at a time; the sums are kept in registers, so theSums is
+// only used by the scalar kernel, for the last few bytes.
+//
+//////////
+
+NATIVE_TARGET("avx2")
+static void QTNative_ResampleColumnsAVX2 (const unsigned char *theSrc, long theRowBytes, unsigned char *theDest, long theCount, const short *theWeights, long theNumTaps, int *theSums)
+{
+	__m256i				myRound = _mm256_set1_epi32(kNativeResampleRound);
+	__m256i				myOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	long				myIndex;
+	long				myTap;
+
+	for (myIndex = 0; myIndex + 32 <= theCount; myIndex += 32) {
+		__m256i			mySums0 = myRound;
+		__m256i			mySums1 = myRound;
+		__m256i			mySums2 = myRound;
+		__m256i			mySums3 = myRound;
+		__m256i			myBytes;
+
+		for (myTap = 0; myTap < theNumTaps; myTap += 2) {
+			const unsigned char	*myRowA = theSrc + (myTap * theRowBytes) + myIndex;
+			const unsigned char	*myRowB = (myTap + 1 < theNumTaps) ? myRowA + theRowBytes : myRowA;
+			short				myWeightB = (myTap + 1 < theNumTaps) ? theWeights[myTap + 1] : 0;
+			__m256i				myWeightPair = _mm256_set1_epi32((int)(((unsigned int)(unsigned short)myWeightB << 16) | (unsigned short)theWeights[myTap]));
+			__m128i				myA, myB;
+
+			myA = _mm_loadu_si128((const __m128i *)myRowA);
+			myB = _mm_loadu_si128((const __m128i *)myRowB);
+			mySums0 = _mm256_add_epi32(mySums0, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(myA, myB)), myWeightPair));
+			mySums1 = _mm256_add_epi32(mySums1, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpackhi_epi8(myA, myB)), myWeightPair));
+
+			myA = _mm_loadu_si128((const __m128i *)(myRowA + 16));
+			myB = _mm_loadu_si128((const __m128i *)(myRowB + 16));
+			mySums2 = _mm256_add_epi32(mySums2, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(myA, myB)), myWeightPair));
+			mySums3 = _mm256_add_epi32(mySums3, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpackhi_epi8(myA, myB)), myWeightPair));
+		}
+
+		// the packs work within each 128-bit lane, so the bytes come out in groups of four that need reordering
+		mySums0 = _mm256_srai_epi32(mySums0, kNativeResampleBits);
+		mySums1 = _mm256_srai_epi32(mySums1, kNativeResampleBits);
+		mySums2 = _mm256_srai_epi32(mySums2, kNativeResampleBits);
+		mySums3 = _mm256_srai_epi32(mySums3, kNativeResampleBits);
+
+		myBytes = _mm256_packus_epi16(_mm256_packs_epi32(mySums0, mySums1), _mm256_packs_epi32(mySums2, mySums3));
+		_mm256_storeu_si256((__m256i *)(theDest + myIndex), _mm256_permutevar8x32_epi32(myBytes, myOrder));
+	}
+
+	// finish the row with the scalar kernel
+	if (myIndex < theCount)
+		QTNative_ResampleColumnsScalar(theSrc + myIndex, theRowBytes, theDest + myIndex, theCount - myIndex, theWeights, theNumTaps, theSums);
+}
+#endif	// NATIVE_HAS_AVX2
+
+
+//////////
+//
+// QTNative_ResamplePixelBuffer
+// Scale the source picture to the size of the destination buffer, with the specified filter.
+//
+// The source can be in any format that the native renderer understands, or one of the Y'CbCr formats; the
+// destination can be in any of them except 8-bit indexed.
+//
+//////////
+
+OSErr QTNative_ResamplePixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest, short theFilter)
+{
+	NativeResampleInfo			myInfo;
+	NativePixelBuffer			myMiddle;
+	OSErr						myErr = noErr;
+
+	if ((theSrc == NULL) || (theSrc->fBaseAddr == NULL) || (theDest == NULL) || (theDest->fBaseAddr == NULL))
+		return(paramErr);
+
+	if (!QTNative_CanConvertPixelFormat(theSrc->fPixelFormat) || !QTNative_CanConvertPixelFormat(theDest->fPixelFormat))
+		return(paramErr);
+
+	if (theDest->fPixelFormat == kNativePixelFormat_8Indexed)
+		return(paramErr);
+
+	if ((theFilter != kNativeResampleBilinear) && (theFilter != kNativeResampleBicubic) && (theFilter != kNativeResampleLanczos3))
+		return(paramErr);
+
+	if ((theSrc->fWidth > kNativeMaxResampleSize) || (theSrc->fHeight > kNativeMaxResampleSize) ||
+		(theDest->fWidth > kNativeMaxResampleSize) || (theDest->fHeight > kNativeMaxResampleSize))
+		return(paramErr);
+
+	if ((theSrc->fWidth <= 0) || (theSrc->fHeight <= 0) || (theDest->fWidth <= 0) || (theDest->fHeight <= 0))
+		return(paramErr);
+
+	memset(&myInfo, 0, sizeof(myInfo));
+	myInfo.fSrc = theSrc;
+	myInfo.fDest = theDest;
+	myInfo.fKernels = QTNative_GetResampleKernels();
+
+	myErr = QTNative_NewResampleTable(theSrc->fWidth, theDest->fWidth, theFilter, &myInfo.fColumns);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTNative_NewResampleTable(theSrc->fHeight, theDest->fHeight, theFilter, &myInfo.fRows);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTNative_NewPixelBuffer(&myMiddle, theDest->fWidth, theSrc->fHeight, QTNative_GetHostPixelFormat());
+	if (myErr != noErr)
+		goto bail;
+
+	myInfo.fMiddle = myMiddle.fBaseAddr;
+	myInfo.fMiddleRowBytes = myMiddle.fRowBytes;
+
+	// scale the rows into the intermediate image, and then the columns into the destination
+	myInfo.fBandHeight = QTNative_GetBandHeight(&myMiddle);
+	myErr = QTNative_ParallelFor((theSrc->fHeight + myInfo.fBandHeight - 1) / myInfo.fBandHeight, QTNative_ResampleRowBand, &myInfo);
+
+	if (myErr == noErr) {
+		myInfo.fBandHeight = (QTNative_GetBandHeight(theDest) + 1) & ~1L;
+		myErr = QTNative_ParallelFor((theDest->fHeight + myInfo.fBandHeight - 1) / myInfo.fBandHeight, QTNative_ResampleColumnBand, &myInfo);
+	}
+
+	QTNative_DisposePixelBuffer(&myMiddle);
+
+bail:
+	QTNative_DisposeResampleTable(&myInfo.fColumns);
+	QTNative_DisposeResampleTable(&myInfo.fRows);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_ResampleRowBand
+// Scale one band of rows of the source into the intermediate image; this is called on a worker thread by
+// QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_ResampleRowBand (void *theRefCon, long theIndex)
+{
+	const NativeResampleInfo	*myInfo = (const NativeResampleInfo *)theRefCon;
+	const NativePixelBuffer		*mySrc = myInfo->fSrc;
+	unsigned int				*myRow = NULL;
+	long						myFirstRow = theIndex * myInfo->fBandHeight;
+	long						myLastRow = myFirstRow + myInfo->fBandHeight;
+	long						myY;
+	OSErr						myErr = noErr;
+
+	if (myLastRow > mySrc->fHeight)
+		myLastRow = mySrc->fHeight;
+
+	myRow = (unsigned int *)QTNative_NewPoolBlock(mySrc->fWidth * sizeof(unsigned int));
+	if (myRow == NULL)
+		return(memFullErr);
+
+	for (myY = myFirstRow; (myY < myLastRow) && (myErr == noErr); myY++) {
+		myErr = QTNative_ReadHostRow(mySrc, myY, myRow);
+		if (myErr == noErr)
+			myInfo->fKernels->fRowPass(myRow, (unsigned int *)(myInfo->fMiddle + (myY * myInfo->fMiddleRowBytes)), myInfo->fDest->fWidth, &myInfo->fColumns);
+	}
+
+	QTNative_DisposePoolBlock(myRow);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_ResampleColumnBand
+// Scale the columns of the intermediate image into one band of rows of the destination, two rows at a time;
+// this is called on a worker thread by QTNative_ParallelFor.
+//
+//////////
+
+static OSErr QTNative_ResampleColumnBand (void *theRefCon, long theIndex)
+{
+	const NativeResampleInfo	*myInfo = (const NativeResampleInfo *)theRefCon;
+	NativePixelBuffer			*myDest = myInfo->fDest;
+	unsigned char				*myRows = NULL;
+	int							*mySums = NULL;
+	long						myCount = myDest->fWidth * 4;
+	long						myFirstRow = theIndex * myInfo->fBandHeight;
+	long						myLastRow = myFirstRow + myInfo->fBandHeight;
+	long						myY, myPair;
+	OSErr						myErr = noErr;
+
+	if (myLastRow > myDest->fHeight)
+		myLastRow = myDest->fHeight;
+
+	myRows = (unsigned char *)QTNative_NewPoolBlock(myCount * 2);
+	mySums = (int *)QTNative_NewPoolBlock(myCount * sizeof(int));
+	if ((myRows == NULL) || (mySums == NULL)) {
+		QTNative_DisposePoolBlock(myRows);
+		QTNative_DisposePoolBlock(mySums);
+		return(memFullErr);
+	}
+
+	for (myY = myFirstRow; (myY < myLastRow) && (myErr == noErr); myY += 2) {
+		long					myNumRows = (myY + 1 < myLastRow) ? 2 : 1;
+
+		for (myPair = 0; myPair < myNumRows; myPair++)
+			myInfo->fKernels->fColumnPass(myInfo->fMiddle + (myInfo->fRows.fStarts[myY + myPair] * myInfo->fMiddleRowBytes), myInfo->fMiddleRowBytes,
+										  myRows + (myPair * myCount), myCount, myInfo->fRows.fWeights + ((myY + myPair) * myInfo->fRows.fNumTaps),
+										  myInfo->fRows.fNumTaps, mySums);
+
+		myErr = QTNative_WriteHostRows(myDest, myY, (const unsigned int *)myRows, (myNumRows == 2) ? (const unsigned int *)(myRows + myCount) : NULL);
+	}
+
+	QTNative_DisposePoolBlock(myRows);
+	QTNative_DisposePoolBlock(mySums);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_GetDecodeShift
+// Return how many times (up to kNativeMaxDecodeShift) a picture of the specified size can be halved in each direction
+// while still being at least as large as the destination; the picture can be decoded at that reduced size (which,
+// for a JPEG image, is much faster than decoding it at full size), and then resampled to the destination size.
+//
+//////////
+
+short QTNative_GetDecodeShift (long theSrcWidth, long theSrcHeight, long theDestWidth, long theDestHeight)
+{
+	short				myShift = 0;
+
+	while ((myShift < kNativeMaxDecodeShift) &&
+		   ((theSrcWidth >> (myShift + 1)) >= theDestWidth) &&
+		   ((theSrcHeight >> (myShift + 1)) >= theDestHeight))
+		myShift++;
+
+	return(myShift);
+}
+
+
+//////////
+//
+// QTNative_GetResampleFilter
+// Return the resampling filter to use for the specified QuickTime quality level (codecLowQuality through
+// codecLosslessQuality).
+//
+//////////
+
+short QTNative_GetResampleFilter (long theQuality)
+{
+	if (theQuality >= kNativeQualityLanczos3)
+		return(kNativeResampleLanczos3);
+
+	if (theQuality >= kNativeQualityBicubic)
+		return(kNativeResampleBicubic);
+
+	return(kNativeResampleBilinear);
+}
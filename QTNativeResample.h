@@ -0,0 +1,65 @@
+//////////
+//
+//	File:		QTNativeResample.h
+//
+//	Contains:	A separable resampler, for scaling pictures to the size of the effect.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeResample__
+#define __QTNativeResample__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// resampling filters
+#define kNativeResampleBilinear				0			// a triangle, widened when shrinking so that every source pixel counts
+#define kNativeResampleBicubic				1			// a Catmull-Rom cubic
+#define kNativeResampleLanczos3				2			// a sinc windowed by a sinc three times as wide
+
+// the QuickTime quality levels at which QTNative_GetResampleFilter switches to a better filter (codecNormalQuality
+// and codecHighQuality)
+#define kNativeQualityBicubic				0x00000200
+#define kNativeQualityLanczos3				0x00000300
+
+// the filter weights are fixed-point numbers with this many fraction bits
+#define kNativeResampleBits					14
+
+// the most that an image is shrunk while it's being decoded, as a power of 2 (1/8 size)
+#define kNativeMaxDecodeShift				3
+
+// the largest picture (in either direction) that can be resampled, or resampled to; 8K video is 7680 x 4320
+#define kNativeMaxResampleSize				8192
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_ResamplePixelBuffer (const NativePixelBuffer *theSrc, NativePixelBuffer *theDest, short theFilter);
+short						QTNative_GetResampleFilter (long theQuality);
+short						QTNative_GetDecodeShift (long theSrcWidth, long theSrcHeight, long theDestWidth, long theDestHeight);
+
+#endif	// __QTNativeResample__
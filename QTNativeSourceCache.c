@@ -0,0 +1,348 @@
+//////////
+//
+//	File:		QTNativeSourceCache.c
+//
+//	Contains:	A memory-limited cache of decoded source pictures, already fitted to the size of the effect.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	Picking a picture as an effect source means importing the file, decoding it, and scaling it to the size of
+//	the effect, which for a large photo can take much longer than rendering the effect itself. Users tend to
+//	swap the same few pictures back and forth, so this file keeps the fitted pixels of recently picked
+//	pictures; picking one of them again is then just a copy.
+//
+//	A cached picture is found by a NativeSourceKey, which holds the full pathname of the file, the time it was
+//	last modified (so that a picture that's been edited since is decoded again), and the size and depth it was
+//	fitted to. QTNative_GetSourceKey fills one in from the file.
+//
+//	The cache holds at most a fixed number of bytes of pixels; when adding a picture would go over that limit,
+//	we discard the least recently used pictures first. Like the frame cache (QTNativeFrameCache.c), it is not
+//	thread-safe; it should be used only from the main thread.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeSourceCache.h"
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a cached picture
+typedef struct NativeCachedSource {
+	NativeSourceKey					fKey;					// fKey.fPath points to our own copy of the pathname
+	NativePixelBuffer				fSource;
+	unsigned long					fColorTable[256];		// a copy of the color table of an indexed picture
+	struct NativeCachedSource *		fPrev;					// the next more recently used picture
+	struct NativeCachedSource *		fNext;					// the next less recently used picture
+} NativeCachedSource;
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeCachedSource *			gNativeSourceHead = NULL;				// the most recently used picture
+static NativeCachedSource *			gNativeSourceTail = NULL;				// the least recently used picture
+static long							gNativeSourceBytes = 0;					// the number of bytes of pixels in the cache
+static long							gNativeSourceLimit = kNativeDefaultSourceCacheSize;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Cache list functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_UnlinkCachedSource
+// Remove the specified picture from the list of cached pictures.
+//
+//////////
+
+static void QTNative_UnlinkCachedSource (NativeCachedSource *theEntry)
+{
+	if (theEntry->fPrev != NULL)
+		theEntry->fPrev->fNext = theEntry->fNext;
+	else
+		gNativeSourceHead = theEntry->fNext;
+
+	if (theEntry->fNext != NULL)
+		theEntry->fNext->fPrev = theEntry->fPrev;
+	else
+		gNativeSourceTail = theEntry->fPrev;
+
+	theEntry->fPrev = NULL;
+	theEntry->fNext = NULL;
+}
+
+
+//////////
+//
+// QTNative_LinkCachedSource
+// Add the specified picture to the front (the most recently used end) of the list of cached pictures.
+//
+//////////
+
+static void QTNative_LinkCachedSource (NativeCachedSource *theEntry)
+{
+	theEntry->fPrev = NULL;
+	theEntry->fNext = gNativeSourceHead;
+
+	if (gNativeSourceHead != NULL)
+		gNativeSourceHead->fPrev = theEntry;
+	else
+		gNativeSourceTail = theEntry;
+
+	gNativeSourceHead = theEntry;
+}
+
+
+//////////
+//
+// QTNative_DisposeCachedSource
+// Remove the specified picture from the cache and dispose of it.
+//
+//////////
+
+static void QTNative_DisposeCachedSource (NativeCachedSource *theEntry)
+{
+	QTNative_UnlinkCachedSource(theEntry);
+
+	gNativeSourceBytes -= theEntry->fSource.fRowBytes * theEntry->fSource.fHeight;
+
+	QTNative_DisposePixelBuffer(&theEntry->fSource);
+	free((void *)theEntry->fKey.fPath);
+	free(theEntry);
+}
+
+
+//////////
+//
+// QTNative_TrimSourceCache
+// Discard the least recently used pictures until the cache holds no more than the specified number of bytes.
+//
+//////////
+
+static void QTNative_TrimSourceCache (long theNumBytes)
+{
+	while ((gNativeSourceTail != NULL) && (gNativeSourceBytes > theNumBytes))
+		QTNative_DisposeCachedSource(gNativeSourceTail);
+}
+
+
+//////////
+//
+// QTNative_EqualSourceKeys
+// Are the specified keys the same?
+//
+//////////
+
+static Boolean QTNative_EqualSourceKeys (const NativeSourceKey *theKey1, const NativeSourceKey *theKey2)
+{
+	return((theKey1->fModTime == theKey2->fModTime) &&
+			(theKey1->fWidth == theKey2->fWidth) &&
+			(theKey1->fHeight == theKey2->fHeight) &&
+			(theKey1->fDepth == theKey2->fDepth) &&
+			(strcmp(theKey1->fPath, theKey2->fPath) == 0));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Source cache functions.
+//
+// Use these functions to add decoded pictures to the cache and to find them again.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetSourceKey
+// Fill in the key for the specified picture file, fitted to the specified size and depth. The key points to thePath,
+// so the pathname must outlive it.
+//
+//////////
+
+OSErr QTNative_GetSourceKey (const char *thePath, long theWidth, long theHeight, short theDepth, NativeSourceKey *theKey)
+{
+	struct stat				myInfo;
+
+	memset(theKey, 0, sizeof(NativeSourceKey));
+
+	if ((thePath == NULL) || (stat(thePath, &myInfo) != 0))
+		return(paramErr);
+
+	theKey->fPath = thePath;
+	theKey->fModTime = (unsigned long)myInfo.st_mtime;
+	theKey->fWidth = theWidth;
+	theKey->fHeight = theHeight;
+	theKey->fDepth = theDepth;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_SetSourceCacheLimit
+// Set the maximum number of bytes of pixels that the cache may hold; 0 turns the cache off.
+//
+//////////
+
+void QTNative_SetSourceCacheLimit (long theNumBytes)
+{
+	gNativeSourceLimit = (theNumBytes < 0) ? 0 : theNumBytes;
+	QTNative_TrimSourceCache(gNativeSourceLimit);
+}
+
+
+//////////
+//
+// QTNative_GetSourceCacheLimit
+// Return the maximum number of bytes of pixels that the cache may hold.
+//
+//////////
+
+long QTNative_GetSourceCacheLimit (void)
+{
+	return(gNativeSourceLimit);
+}
+
+
+//////////
+//
+// QTNative_FlushSourceCache
+// Discard all the cached pictures.
+//
+//////////
+
+void QTNative_FlushSourceCache (void)
+{
+	QTNative_TrimSourceCache(0);
+}
+
+
+//////////
+//
+// QTNative_FindCachedSource
+// Return the cached picture with the specified key, or NULL if there is none.
+//
+// The returned buffer belongs to the cache; it remains valid until the next call to QTNative_AddCachedSource,
+// QTNative_SetSourceCacheLimit, or QTNative_FlushSourceCache.
+//
+//////////
+
+const NativePixelBuffer *QTNative_FindCachedSource (const NativeSourceKey *theKey)
+{
+	NativeCachedSource		*myEntry;
+
+	for (myEntry = gNativeSourceHead; myEntry != NULL; myEntry = myEntry->fNext) {
+		if (QTNative_EqualSourceKeys(&myEntry->fKey, theKey)) {
+			// move the picture to the front of the list, since it's now the most recently used
+			if (myEntry != gNativeSourceHead) {
+				QTNative_UnlinkCachedSource(myEntry);
+				QTNative_LinkCachedSource(myEntry);
+			}
+
+			return(&myEntry->fSource);
+		}
+	}
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTNative_AddCachedSource
+// Add a copy of the specified decoded picture to the cache, discarding older pictures if necessary. An older
+// version of the same file (at the same size and depth) is discarded too, since it can't be found any more.
+//
+// It's not an error for a picture not to be cached (for instance, because it's larger than the limit).
+//
+//////////
+
+OSErr QTNative_AddCachedSource (const NativeSourceKey *theKey, const NativePixelBuffer *theSource)
+{
+	NativeCachedSource		*myEntry = NULL;
+	NativeCachedSource		*myNext = NULL;
+	char					*myPath = NULL;
+	long					myNumBytes;
+	OSErr					myErr = noErr;
+
+	if ((theKey->fPath == NULL) || (theKey->fWidth != theSource->fWidth) || (theKey->fHeight != theSource->fHeight))
+		return(paramErr);
+
+	// if we already have this picture, there's nothing to add
+	if (QTNative_FindCachedSource(theKey) != NULL)
+		return(noErr);
+
+	for (myEntry = gNativeSourceHead; myEntry != NULL; myEntry = myNext) {
+		myNext = myEntry->fNext;
+		if ((myEntry->fKey.fWidth == theKey->fWidth) && (myEntry->fKey.fHeight == theKey->fHeight) &&
+			(myEntry->fKey.fDepth == theKey->fDepth) && (strcmp(myEntry->fKey.fPath, theKey->fPath) == 0))
+			QTNative_DisposeCachedSource(myEntry);
+	}
+
+	myEntry = (NativeCachedSource *)calloc(1, sizeof(NativeCachedSource));
+	if (myEntry == NULL)
+		return(memFullErr);
+
+	myErr = QTNative_NewPixelBuffer(&myEntry->fSource, theSource->fWidth, theSource->fHeight, theSource->fPixelFormat);
+	if (myErr != noErr)
+		goto bail;
+
+	myNumBytes = myEntry->fSource.fRowBytes * myEntry->fSource.fHeight;
+	if (myNumBytes > gNativeSourceLimit)
+		goto bail;
+
+	myPath = (char *)malloc(strlen(theKey->fPath) + 1);
+	if (myPath == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	strcpy(myPath, theKey->fPath);
+
+	// make room for the new picture
+	QTNative_TrimSourceCache(gNativeSourceLimit - myNumBytes);
+
+	myEntry->fKey = *theKey;
+	myEntry->fKey.fPath = myPath;
+	QTNative_CopyPixelBuffer(theSource, &myEntry->fSource);
+
+	if (theSource->fColorTable != NULL) {
+		memcpy(myEntry->fColorTable, theSource->fColorTable, sizeof(myEntry->fColorTable));
+		myEntry->fSource.fColorTable = myEntry->fColorTable;
+	}
+
+	QTNative_LinkCachedSource(myEntry);
+	gNativeSourceBytes += myNumBytes;
+
+	return(noErr);
+
+bail:
+	QTNative_DisposePixelBuffer(&myEntry->fSource);
+	free(myEntry);
+
+	return(myErr);
+}
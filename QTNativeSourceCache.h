@@ -0,0 +1,68 @@
+//////////
+//
+//	File:		QTNativeSourceCache.h
+//
+//	Contains:	A memory-limited cache of decoded source pictures, already fitted to the size of the effect.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeSourceCache__
+#define __QTNativeSourceCache__
+
+#include "QTNativeEffects.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeDefaultSourceCacheSize		(16L * 1024L * 1024L)		// the default limit on the memory used by cached pictures
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// everything that determines the pixels of a decoded picture
+typedef struct {
+	const char *			fPath;							// the full pathname of the picture file
+	unsigned long			fModTime;						// the time the file was last modified, in seconds
+	long					fWidth;							// the size the picture was fitted to
+	long					fHeight;
+	short					fDepth;							// the depth of the GWorld it was drawn into
+} NativeSourceKey;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_GetSourceKey (const char *thePath, long theWidth, long theHeight, short theDepth, NativeSourceKey *theKey);
+
+void						QTNative_SetSourceCacheLimit (long theNumBytes);
+long						QTNative_GetSourceCacheLimit (void);
+void						QTNative_FlushSourceCache (void);
+const NativePixelBuffer *	QTNative_FindCachedSource (const NativeSourceKey *theKey);
+OSErr						QTNative_AddCachedSource (const NativeSourceKey *theKey, const NativePixelBuffer *theSource);
+
+#endif	// __QTNativeSourceCache__
@@ -0,0 +1,425 @@
+//////////
+//
+//	File:		QTNativeStream.c
+//
+//	Contains:	Streams of rendered frames (YUV4MPEG2 or raw RGBA) written to a pipe or a file as each frame is done,
+//				so that an encoder can run at the same time as the renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	A movie file can't be read until it's finished, so an encoder that works from one has to wait for the whole
+//	transition to be rendered. A stream instead writes each frame to a pipe (the standard output, say, or a
+//	named pipe) as soon as it's rendered, so that a program such as "ffmpeg -i -" or "x264 --demuxer y4m -"
+//	encodes the frames while we render the next ones. We write two kinds of streams:
+//
+//		YUV4MPEG2 (.y4m)	a header line with the size and frame rate; then, for each frame, a "FRAME" line
+//							followed by the Y', Cb, and Cr planes of a 4:2:0 frame (BT.601, video range)
+//		raw RGBA			nothing but the frames, each one width * height packed 32-bit RGBA pixels
+//
+//	Each stream has a writer thread of its own, and a fixed number of slots for frames that wait to be written.
+//	QTNative_WriteStreamFrame converts a rendered frame into the slot for its frame number (on the caller's
+//	thread, and without holding the stream's lock), marks the slot ready, and returns; the writer thread writes
+//	the ready slots in order of frame number. So several threads can render frames at once and hand them over
+//	out of order, and the slots put them back in order.
+//
+//	The slots are also what bounds the buffering: a frame whose slot is still taken (because the frame one
+//	"lap" earlier hasn't been written yet) waits in QTNative_WriteStreamFrame until it's free. When the reader
+//	falls behind, the pipe fills up, the writer thread blocks in fwrite, the slots fill up, and then the
+//	renderer blocks too; so the renderer never runs more than a few frames ahead of the encoder, however
+//	long the transition is.
+//
+//	If a write fails (typically because the reader has exited and the pipe is broken), the stream remembers
+//	the error, stops writing, and returns kNativeStreamWriteErr from every later call, so that the renderer
+//	can stop rather than render frames that nobody will read. On systems with signals we ignore SIGPIPE, so
+//	that a broken pipe is an error from fwrite rather than the end of the process.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeStream.h"
+#include "QTNativeConvert.h"
+#include "QTNativeFramePool.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <signal.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeStreamBufferSize			(256L * 1024L)		// the size of the stdio buffer of a stream
+
+
+//////////
+//
+// QTNative_WriteStreamBytes
+// Write the specified rows of bytes to a stream.
+//
+//////////
+
+static OSErr QTNative_WriteStreamBytes (FILE *theFile, const unsigned char *theBytes, long theRowBytes, long theWidth, long theHeight)
+{
+	long						myRow;
+
+	for (myRow = 0; myRow < theHeight; myRow++)
+		if (fwrite(theBytes + (myRow * theRowBytes), 1, (size_t)theWidth, theFile) != (size_t)theWidth)
+			return(kNativeStreamWriteErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_WriteStreamSlot
+// Write a frame that's ready in one of the slots of a stream, and flush it, so that the reader gets it right away.
+//
+//////////
+
+static OSErr QTNative_WriteStreamSlot (NativeStream *theStream, const NativePixelBuffer *theFrame)
+{
+	unsigned char				*myCb = NULL;
+	unsigned char				*myCr = NULL;
+	long						myChromaRowBytes;
+	OSErr						myErr = noErr;
+
+	if (theStream->fKind == kNativeStreamY4M) {
+		QTNative_GetChromaPlanes(theFrame, &myCb, &myCr, &myChromaRowBytes);
+
+		if (fputs("FRAME\n", theStream->fFile) == EOF)
+			return(kNativeStreamWriteErr);
+
+		myErr = QTNative_WriteStreamBytes(theStream->fFile, theFrame->fBaseAddr, theFrame->fRowBytes, theFrame->fWidth, theFrame->fHeight);
+		if (myErr == noErr)
+			myErr = QTNative_WriteStreamBytes(theStream->fFile, myCb, myChromaRowBytes, (theFrame->fWidth + 1) / 2, (theFrame->fHeight + 1) / 2);
+		if (myErr == noErr)
+			myErr = QTNative_WriteStreamBytes(theStream->fFile, myCr, myChromaRowBytes, (theFrame->fWidth + 1) / 2, (theFrame->fHeight + 1) / 2);
+	} else {
+		myErr = QTNative_WriteStreamBytes(theStream->fFile, theFrame->fBaseAddr, theFrame->fRowBytes, theFrame->fWidth * 4, theFrame->fHeight);
+	}
+
+	if ((myErr == noErr) && (fflush(theStream->fFile) != 0))
+		myErr = kNativeStreamWriteErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_StreamWriterThread
+// The body of the writer thread of a stream: write the ready slots in order of frame number, until the stream is
+// closing and the next frame isn't ready, or until a write fails.
+//
+//////////
+
+#if defined(_WIN32)
+static DWORD WINAPI QTNative_StreamWriterThread (LPVOID theParam)
+#else
+static void *QTNative_StreamWriterThread (void *theParam)
+#endif
+{
+	NativeStream				*myStream = (NativeStream *)theParam;
+	long						mySlot;
+	OSErr						myErr;
+
+	QTNative_Lock(&myStream->fLock);
+
+	while (myStream->fErr == noErr) {
+		mySlot = myStream->fNextFrame % myStream->fNumSlots;
+
+		if (!myStream->fSlotIsReady[mySlot]) {
+			if (myStream->fClosing)
+				break;
+
+			QTNative_WaitCondition(&myStream->fFrameReady, &myStream->fLock);
+			continue;
+		}
+
+		// write the frame without holding the lock, so that the renderer can fill the other slots meanwhile
+		QTNative_Unlock(&myStream->fLock);
+		myErr = QTNative_WriteStreamSlot(myStream, &myStream->fSlots[mySlot]);
+		QTNative_Lock(&myStream->fLock);
+
+		if (myErr == noErr) {
+			myStream->fSlotIsReady[mySlot] = false;
+			myStream->fNextFrame++;
+			myStream->fFramesWritten++;
+		} else {
+			myStream->fErr = myErr;
+		}
+
+		QTNative_BroadcastCondition(&myStream->fFrameWritten);
+	}
+
+	QTNative_Unlock(&myStream->fLock);
+
+#if defined(_WIN32)
+	return(0);
+#else
+	return(NULL);
+#endif
+}
+
+
+//////////
+//
+// QTNative_DisposeStreamSlots
+// Dispose of the slots of a stream, and close its file (unless it's the standard output, which is only flushed).
+//
+//////////
+
+static void QTNative_DisposeStreamSlots (NativeStream *theStream)
+{
+	long						myIndex;
+
+	if (theStream->fSlots != NULL) {
+		for (myIndex = 0; myIndex < theStream->fNumSlots; myIndex++)
+			QTNative_DisposePixelBuffer(&theStream->fSlots[myIndex]);
+		free(theStream->fSlots);
+		theStream->fSlots = NULL;
+	}
+
+	if (theStream->fSlotIsReady != NULL) {
+		free(theStream->fSlotIsReady);
+		theStream->fSlotIsReady = NULL;
+	}
+
+	if (theStream->fFile != NULL) {
+		if (theStream->fIsStdOut) {
+			if ((fflush(theStream->fFile) != 0) && (theStream->fErr == noErr))
+				theStream->fErr = kNativeStreamWriteErr;
+		} else {
+			if ((fclose(theStream->fFile) != 0) && (theStream->fErr == noErr))
+				theStream->fErr = kNativeStreamWriteErr;
+		}
+		theStream->fFile = NULL;
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Stream functions.
+//
+// Use these functions to open a stream, to hand it frames, and to close it.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_OpenStream
+// Open a stream of the specified kind, writing to the specified file or named pipe ("-" means the standard output),
+// and start its writer thread. For a YUV4MPEG2 stream, the header is written right away, with the frame rate
+// theRateNum / theRateDen frames per second. theNumSlots is the number of frames that may wait to be written
+// (0 for kNativeDefaultStreamFrames).
+//
+// Opening a named pipe waits until another program opens it for reading.
+//
+//////////
+
+OSErr QTNative_OpenStream (const char *thePath, OSType theKind, long theWidth, long theHeight, long theRateNum, long theRateDen, long theNumSlots, NativeStream *theStream)
+{
+	long						myIndex;
+	OSErr						myErr = noErr;
+
+	memset(theStream, 0, sizeof(NativeStream));
+
+	if ((thePath == NULL) || (theWidth <= 0) || (theHeight <= 0) || (theRateNum <= 0) || (theRateDen <= 0))
+		return(paramErr);
+
+	if ((theKind != kNativeStreamY4M) && (theKind != kNativeStreamRGBA))
+		return(paramErr);
+
+	if (theNumSlots <= 0)
+		theNumSlots = kNativeDefaultStreamFrames;
+	if (theNumSlots > kNativeMaxStreamFrames)
+		theNumSlots = kNativeMaxStreamFrames;
+
+	theStream->fKind = theKind;
+	theStream->fWidth = theWidth;
+	theStream->fHeight = theHeight;
+	theStream->fNumSlots = theNumSlots;
+
+#if !defined(_WIN32)
+	// a reader that goes away should make our writes fail, not kill us
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	// open the file
+	if (strcmp(thePath, "-") == 0) {
+#if defined(_WIN32)
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		theStream->fFile = stdout;
+		theStream->fIsStdOut = true;
+	} else {
+		theStream->fFile = fopen(thePath, "wb");
+		if (theStream->fFile == NULL)
+			return(kNativeStreamWriteErr);
+	}
+
+	setvbuf(theStream->fFile, NULL, _IOFBF, (size_t)kNativeStreamBufferSize);
+
+	// allocate the slots, in the format of the stream
+	theStream->fSlots = (NativePixelBuffer *)calloc((size_t)theNumSlots, sizeof(NativePixelBuffer));
+	theStream->fSlotIsReady = (Boolean *)calloc((size_t)theNumSlots, sizeof(Boolean));
+	if ((theStream->fSlots == NULL) || (theStream->fSlotIsReady == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	for (myIndex = 0; myIndex < theNumSlots; myIndex++) {
+		if (theKind == kNativeStreamY4M)
+			myErr = QTNative_NewYUVPixelBuffer(&theStream->fSlots[myIndex], theWidth, theHeight, kNativePixelFormat_YUV420);
+		else
+			myErr = QTNative_NewPixelBuffer(&theStream->fSlots[myIndex], theWidth, theHeight, kNativePixelFormat_32RGBA);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+	// write the header; the chroma samples are sited at the centers of the pixels they cover, as with JPEG
+	if (theKind == kNativeStreamY4M) {
+		if (fprintf(theStream->fFile, "YUV4MPEG2 W%ld H%ld F%ld:%ld Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", theWidth, theHeight, theRateNum, theRateDen) < 0) {
+			myErr = kNativeStreamWriteErr;
+			goto bail;
+		}
+	}
+
+	// start the writer thread
+	QTNative_InitLock(&theStream->fLock);
+	QTNative_InitCondition(&theStream->fFrameReady);
+	QTNative_InitCondition(&theStream->fFrameWritten);
+
+#if defined(_WIN32)
+	theStream->fThread = CreateThread(NULL, 0, QTNative_StreamWriterThread, theStream, 0, NULL);
+	if (theStream->fThread == NULL)
+		myErr = memFullErr;
+#else
+	if (pthread_create(&theStream->fThread, NULL, QTNative_StreamWriterThread, theStream) != 0)
+		myErr = memFullErr;
+#endif
+
+	if (myErr != noErr) {
+		QTNative_DisposeCondition(&theStream->fFrameWritten);
+		QTNative_DisposeCondition(&theStream->fFrameReady);
+		QTNative_DisposeLock(&theStream->fLock);
+	}
+
+bail:
+	if (myErr != noErr)
+		QTNative_DisposeStreamSlots(theStream);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTNative_WriteStreamFrame
+// Hand a rendered frame to a stream; theFrame is its frame number, counting from 0. The frame is converted to the
+// format of the stream (it must be the size of the stream), and written by the writer thread once all the frames
+// before it have been written; the caller may reuse theSrc as soon as we return.
+//
+// Frames may be handed over by several threads at once, and in any order, but each frame number only once. If the
+// frame is too far ahead of the frames being written, we wait until its slot is free; that's the backpressure that
+// keeps a fast renderer from getting ahead of a slow reader. (So the threads that render a stream's frames must not
+// all be waiting on frames that are ahead of one that none of them will render.)
+//
+//////////
+
+OSErr QTNative_WriteStreamFrame (NativeStream *theStream, long theFrame, const NativePixelBuffer *theSrc)
+{
+	long						mySlot;
+	OSErr						myErr = noErr;
+
+	if ((theStream->fSlots == NULL) || (theFrame < 0))
+		return(paramErr);
+
+	if ((theSrc->fWidth != theStream->fWidth) || (theSrc->fHeight != theStream->fHeight))
+		return(paramErr);
+
+	mySlot = theFrame % theStream->fNumSlots;
+
+	// wait for the slot to be free
+	QTNative_Lock(&theStream->fLock);
+
+	while ((theStream->fErr == noErr) && (theFrame >= theStream->fNextFrame + theStream->fNumSlots))
+		QTNative_WaitCondition(&theStream->fFrameWritten, &theStream->fLock);
+
+	if (theStream->fErr != noErr)
+		myErr = theStream->fErr;
+	else if ((theFrame < theStream->fNextFrame) || theStream->fSlotIsReady[mySlot])
+		myErr = paramErr;				// the frame has been handed over already
+
+	QTNative_Unlock(&theStream->fLock);
+
+	if (myErr != noErr)
+		return(myErr);
+
+	// the slot is ours until it's marked ready, so we can fill it without holding the lock
+	myErr = QTNative_ConvertPixelBuffer(theSrc, &theStream->fSlots[mySlot]);
+	if (myErr != noErr)
+		return(myErr);
+
+	QTNative_Lock(&theStream->fLock);
+	theStream->fSlotIsReady[mySlot] = true;
+	QTNative_SignalCondition(&theStream->fFrameReady);
+	QTNative_Unlock(&theStream->fLock);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_CloseStream
+// Write the frames that are ready, stop the writer thread, and close a stream. Frames that follow a frame that was
+// never handed over are not written. Return the first error in writing the stream, if any.
+//
+//////////
+
+OSErr QTNative_CloseStream (NativeStream *theStream)
+{
+	OSErr						myErr;
+
+	if (theStream->fSlots == NULL)
+		return(paramErr);
+
+	QTNative_Lock(&theStream->fLock);
+	theStream->fClosing = true;
+	QTNative_SignalCondition(&theStream->fFrameReady);
+	QTNative_Unlock(&theStream->fLock);
+
+#if defined(_WIN32)
+	WaitForSingleObject(theStream->fThread, INFINITE);
+	CloseHandle(theStream->fThread);
+	theStream->fThread = NULL;
+#else
+	pthread_join(theStream->fThread, NULL);
+#endif
+
+	QTNative_DisposeCondition(&theStream->fFrameWritten);
+	QTNative_DisposeCondition(&theStream->fFrameReady);
+	QTNative_DisposeLock(&theStream->fLock);
+
+	QTNative_DisposeStreamSlots(theStream);
+
+	myErr = theStream->fErr;
+	return(myErr);
+}
@@ -0,0 +1,92 @@
+//////////
+//
+//	File:		QTNativeStream.h
+//
+//	Contains:	Streams of rendered frames (YUV4MPEG2 or raw RGBA) written to a pipe or a file as each frame is done,
+//				so that an encoder can run at the same time as the renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeStream__
+#define __QTNativeStream__
+
+#include <stdio.h>
+#include "QTNativeEffects.h"
+#include "QTNativeThreads.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+// kinds of streams
+#define kNativeStreamY4M					FOUR_CHAR_CODE('YUV4')		// YUV4MPEG2: a header, then "FRAME" and 4:2:0 planes
+#define kNativeStreamRGBA					FOUR_CHAR_CODE('RGBA')		// packed 32-bit RGBA frames, with no header at all
+
+// limits
+#define kNativeDefaultStreamFrames			8			// the frames that may wait to be written, by default
+#define kNativeMaxStreamFrames				64
+
+// the error returned once a stream can't be written (the reader has gone away, say), so that the renderer can
+// stop (same value as the Mac OS ioErr)
+#define kNativeStreamWriteErr				-36
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// an open stream; the frames are written in order by a thread of its own
+typedef struct {
+	OSType					fKind;
+	long					fWidth;
+	long					fHeight;
+	FILE *					fFile;
+	Boolean					fIsStdOut;					// true if fFile is the standard output, which we don't close
+	long					fNumSlots;
+	NativePixelBuffer *		fSlots;						// a frame that waits to be written is in slot (frame % fNumSlots),
+	Boolean *				fSlotIsReady;				// already converted to the format of the stream
+	long					fNextFrame;					// the number of the next frame to write
+	long					fFramesWritten;
+	OSErr					fErr;						// the first error in writing; once it's set, nothing more is written
+	Boolean					fClosing;
+	NativeLock				fLock;						// protects the fields above from fNextFrame down
+	NativeCondition			fFrameReady;				// signalled when a slot becomes ready (or the stream is closing)
+	NativeCondition			fFrameWritten;				// broadcast when a slot becomes free (or there's an error)
+#if defined(_WIN32)
+	HANDLE					fThread;
+#else
+	pthread_t				fThread;
+#endif
+} NativeStream;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_OpenStream (const char *thePath, OSType theKind, long theWidth, long theHeight, long theRateNum, long theRateDen, long theNumSlots, NativeStream *theStream);
+OSErr						QTNative_WriteStreamFrame (NativeStream *theStream, long theFrame, const NativePixelBuffer *theSrc);
+OSErr						QTNative_CloseStream (NativeStream *theStream);
+
+#endif	// __QTNativeStream__
@@ -0,0 +1,520 @@
+//////////
+//
+//	File:		QTNativeThreads.c
+//
+//	Contains:	A pool of worker threads for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/17/26	rtm		the tasks of a loop are now divided among the threads, which steal from one another
+//									when they run out (see QTNative_TakeTask)
+//	   <1>	 	10/17/26	rtm		first file
+//
+//	The native renderer splits its work into parallel loops: a loop has a number of independent tasks, and
+//	QTNative_ParallelFor returns once all of them have been performed. The tasks are shared among a pool of
+//	worker threads, which we create once (in QTNative_StartThreads) and keep around until QTNative_StopThreads.
+//
+//	The thread that calls QTNative_ParallelFor also performs tasks from its own loop, rather than just waiting
+//	for the workers; this means that a task may itself call QTNative_ParallelFor without any risk of deadlock,
+//	and that everything still works (serially) when there are no worker threads at all.
+//
+//	The tasks of a loop are handed out by work stealing. Each thread that takes part in the loop starts out
+//	with its own contiguous range of task numbers, which it works through from the front; a thread that runs
+//	out of tasks steals the back half of the largest range that's left. So neighboring tasks (for instance,
+//	neighboring bands of rows of a frame) tend to be done by the same thread, and a thread that's slowed down
+//	doesn't hold up the whole loop. Since each task is a fair amount of work (a band of rows, or a whole
+//	frame), the ranges are simply protected by the pool's lock.
+//
+//	We use Win32 threads on Windows and POSIX threads everywhere else.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTNativeThreads.h"
+#include "QTNativeCPU.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kNativeMaxThreads				64
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a range of task numbers that belongs to one thread
+typedef struct {
+	long						fNextTask;					// the next task to perform
+	long						fEndTask;					// one past the last task in the range
+} NativeTaskRange;
+
+// a parallel loop that is in progress
+typedef struct NativeTaskGroup {
+	NativeTaskProcPtr			fProc;
+	void *						fRefCon;
+	long						fCount;						// the number of tasks in the loop
+	long						fNumDone;					// the number of tasks finished
+	OSErr						fErr;						// the first error returned by a task
+	NativeTaskRange				fRanges[kNativeMaxThreads + 1];	// the tasks not yet handed out, for each thread slot
+	struct NativeTaskGroup *	fNextGroup;					// the next loop in the list of loops with tasks to hand out
+} NativeTaskGroup;
+
+#if defined(_WIN32)
+typedef HANDLE						NativeThread;
+typedef DWORD						NativeThreadID;
+#else
+typedef pthread_t					NativeThread;
+typedef pthread_t					NativeThreadID;
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static NativeLock					gNativePoolLock;					// protects everything below
+static NativeCondition				gNativePoolWork;					// signaled when there are new tasks, or on shutdown
+static NativeCondition				gNativePoolDone;					// signaled when a loop finishes
+static NativeTaskGroup *			gNativeGroups = NULL;				// the loops that have tasks to hand out
+static NativeThread					gNativeThreads[kNativeMaxThreads];
+static NativeThreadID				gNativeThreadIDs[kNativeMaxThreads];
+static long							gNativeThreadSlots[kNativeMaxThreads];	// the slot of each worker thread
+static long							gNativeNumThreads = 0;
+static Boolean						gNativePoolStarted = false;
+static Boolean						gNativePoolStopping = false;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Lock and condition functions.
+//
+// These are thin wrappers around the native synchronization primitives.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void QTNative_InitLock (NativeLock *theLock)
+{
+#if defined(_WIN32)
+	InitializeCriticalSection(theLock);
+#else
+	pthread_mutex_init(theLock, NULL);
+#endif
+}
+
+void QTNative_DisposeLock (NativeLock *theLock)
+{
+#if defined(_WIN32)
+	DeleteCriticalSection(theLock);
+#else
+	pthread_mutex_destroy(theLock);
+#endif
+}
+
+void QTNative_Lock (NativeLock *theLock)
+{
+#if defined(_WIN32)
+	EnterCriticalSection(theLock);
+#else
+	pthread_mutex_lock(theLock);
+#endif
+}
+
+void QTNative_Unlock (NativeLock *theLock)
+{
+#if defined(_WIN32)
+	LeaveCriticalSection(theLock);
+#else
+	pthread_mutex_unlock(theLock);
+#endif
+}
+
+void QTNative_InitCondition (NativeCondition *theCondition)
+{
+#if defined(_WIN32)
+	InitializeConditionVariable(theCondition);
+#else
+	pthread_cond_init(theCondition, NULL);
+#endif
+}
+
+void QTNative_DisposeCondition (NativeCondition *theCondition)
+{
+#if defined(_WIN32)
+	// Win32 condition variables don't need to be disposed of
+	(void)theCondition;
+#else
+	pthread_cond_destroy(theCondition);
+#endif
+}
+
+void QTNative_WaitCondition (NativeCondition *theCondition, NativeLock *theLock)
+{
+#if defined(_WIN32)
+	SleepConditionVariableCS(theCondition, theLock, INFINITE);
+#else
+	pthread_cond_wait(theCondition, theLock);
+#endif
+}
+
+void QTNative_SignalCondition (NativeCondition *theCondition)
+{
+#if defined(_WIN32)
+	WakeConditionVariable(theCondition);
+#else
+	pthread_cond_signal(theCondition);
+#endif
+}
+
+void QTNative_BroadcastCondition (NativeCondition *theCondition)
+{
+#if defined(_WIN32)
+	WakeAllConditionVariable(theCondition);
+#else
+	pthread_cond_broadcast(theCondition);
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Task functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_GetThreadSlot
+// Return the slot of the current thread in the task ranges of a loop: worker thread n uses slot n + 1,
+// and any other thread uses slot 0.
+//
+//////////
+
+static long QTNative_GetThreadSlot (void)
+{
+	long				myIndex;
+
+	for (myIndex = 0; myIndex < gNativeNumThreads; myIndex++) {
+#if defined(_WIN32)
+		if (gNativeThreadIDs[myIndex] == GetCurrentThreadId())
+			return(myIndex + 1);
+#else
+		if (pthread_equal(gNativeThreadIDs[myIndex], pthread_self()))
+			return(myIndex + 1);
+#endif
+	}
+
+	return(0);
+}
+
+
+//////////
+//
+// QTNative_RemoveGroup
+// Remove the specified loop from the list of loops with tasks to hand out. The pool lock must be held.
+//
+//////////
+
+static void QTNative_RemoveGroup (NativeTaskGroup *theGroup)
+{
+	NativeTaskGroup		**myLink = &gNativeGroups;
+
+	while (*myLink != NULL) {
+		if (*myLink == theGroup) {
+			*myLink = theGroup->fNextGroup;
+			return;
+		}
+
+		myLink = &(*myLink)->fNextGroup;
+	}
+}
+
+
+//////////
+//
+// QTNative_TakeTask
+// Take the next task of the specified loop for the thread in the specified slot: the next task in its own
+// range if there is one, otherwise a task stolen from the largest range that's left. Return false (and remove
+// the loop from the list of loops with tasks to hand out) if there are no tasks left. The pool lock must be held.
+//
+//////////
+
+static Boolean QTNative_TakeTask (NativeTaskGroup *theGroup, long theSlot, long *theTask)
+{
+	NativeTaskRange		*myRange = &theGroup->fRanges[theSlot];
+	NativeTaskRange		*myVictim = NULL;
+	long				myLargest = 0;
+	long				myMiddle;
+	long				myIndex;
+
+	if (myRange->fNextTask < myRange->fEndTask) {
+		*theTask = myRange->fNextTask++;
+		return(true);
+	}
+
+	// find the range with the most tasks left
+	for (myIndex = 0; myIndex <= gNativeNumThreads; myIndex++) {
+		long			myNumLeft = theGroup->fRanges[myIndex].fEndTask - theGroup->fRanges[myIndex].fNextTask;
+
+		if (myNumLeft > myLargest) {
+			myLargest = myNumLeft;
+			myVictim = &theGroup->fRanges[myIndex];
+		}
+	}
+
+	if (myVictim == NULL) {
+		QTNative_RemoveGroup(theGroup);
+		return(false);
+	}
+
+	// steal the back half of that range; we perform the first stolen task now and keep the rest as our own range
+	myMiddle = myVictim->fNextTask + (myLargest / 2);
+
+	myRange->fNextTask = myMiddle + 1;
+	myRange->fEndTask = myVictim->fEndTask;
+	myVictim->fEndTask = myMiddle;
+
+	*theTask = myMiddle;
+	return(true);
+}
+
+
+//////////
+//
+// QTNative_PerformTask
+// Perform the specified task and record its completion. The pool lock must be held; it's released
+// while the task runs.
+//
+//////////
+
+static void QTNative_PerformTask (NativeTaskGroup *theGroup, long theTask)
+{
+	OSErr				myErr;
+
+	QTNative_Unlock(&gNativePoolLock);
+	myErr = theGroup->fProc(theGroup->fRefCon, theTask);
+	QTNative_Lock(&gNativePoolLock);
+
+	if ((myErr != noErr) && (theGroup->fErr == noErr))
+		theGroup->fErr = myErr;
+
+	theGroup->fNumDone++;
+	if (theGroup->fNumDone == theGroup->fCount)
+		QTNative_BroadcastCondition(&gNativePoolDone);
+}
+
+
+//////////
+//
+// QTNative_WorkerThread
+// The body of each worker thread: perform tasks from any loop until the pool is stopped.
+//
+//////////
+
+#if defined(_WIN32)
+static DWORD WINAPI QTNative_WorkerThread (LPVOID theParam)
+#else
+static void *QTNative_WorkerThread (void *theParam)
+#endif
+{
+	NativeTaskGroup		*myGroup;
+	long				mySlot = *(long *)theParam;
+	long				myTask;
+
+	QTNative_Lock(&gNativePoolLock);
+
+	while (!gNativePoolStopping) {
+		// help with the most recently started loop that still has tasks to hand out; that's usually a loop
+		// started by one of the tasks of an older loop, which can't finish until the newer loop does
+		myGroup = gNativeGroups;
+		if (myGroup == NULL)
+			QTNative_WaitCondition(&gNativePoolWork, &gNativePoolLock);
+		else if (QTNative_TakeTask(myGroup, mySlot, &myTask))
+			QTNative_PerformTask(myGroup, myTask);
+	}
+
+	QTNative_Unlock(&gNativePoolLock);
+
+	return(0);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Thread pool functions.
+//
+// Use these functions to start and stop the worker threads and to run parallel loops.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTNative_StartThreads
+// Start the worker threads. If theNumThreads is 0, we start one fewer thread than there are processors
+// (since the thread that calls QTNative_ParallelFor does its share of the work too).
+//
+//////////
+
+OSErr QTNative_StartThreads (long theNumThreads)
+{
+	if (gNativePoolStarted)
+		return(noErr);
+
+	if (theNumThreads <= 0)
+		theNumThreads = QTNative_GetNumberOfCPUs() - 1;
+	if (theNumThreads > kNativeMaxThreads)
+		theNumThreads = kNativeMaxThreads;
+
+	QTNative_InitLock(&gNativePoolLock);
+	QTNative_InitCondition(&gNativePoolWork);
+	QTNative_InitCondition(&gNativePoolDone);
+
+	gNativeGroups = NULL;
+	gNativePoolStopping = false;
+	gNativePoolStarted = true;
+
+	for (gNativeNumThreads = 0; gNativeNumThreads < theNumThreads; gNativeNumThreads++) {
+		gNativeThreadSlots[gNativeNumThreads] = gNativeNumThreads + 1;
+#if defined(_WIN32)
+		gNativeThreads[gNativeNumThreads] = CreateThread(NULL, 0, QTNative_WorkerThread, &gNativeThreadSlots[gNativeNumThreads], 0, &gNativeThreadIDs[gNativeNumThreads]);
+		if (gNativeThreads[gNativeNumThreads] == NULL)
+			break;
+#else
+		if (pthread_create(&gNativeThreads[gNativeNumThreads], NULL, QTNative_WorkerThread, &gNativeThreadSlots[gNativeNumThreads]) != 0)
+			break;
+		gNativeThreadIDs[gNativeNumThreads] = gNativeThreads[gNativeNumThreads];
+#endif
+	}
+
+	// it's not an error to end up with fewer threads than we asked for; the loops just run more slowly
+	return(noErr);
+}
+
+
+//////////
+//
+// QTNative_StopThreads
+// Stop the worker threads and wait for them to exit. No parallel loops may be running.
+//
+//////////
+
+void QTNative_StopThreads (void)
+{
+	long				myIndex;
+
+	if (!gNativePoolStarted)
+		return;
+
+	QTNative_Lock(&gNativePoolLock);
+	gNativePoolStopping = true;
+	QTNative_BroadcastCondition(&gNativePoolWork);
+	QTNative_Unlock(&gNativePoolLock);
+
+	for (myIndex = 0; myIndex < gNativeNumThreads; myIndex++) {
+#if defined(_WIN32)
+		WaitForSingleObject(gNativeThreads[myIndex], INFINITE);
+		CloseHandle(gNativeThreads[myIndex]);
+#else
+		pthread_join(gNativeThreads[myIndex], NULL);
+#endif
+	}
+
+	QTNative_DisposeCondition(&gNativePoolDone);
+	QTNative_DisposeCondition(&gNativePoolWork);
+	QTNative_DisposeLock(&gNativePoolLock);
+
+	gNativeNumThreads = 0;
+	gNativePoolStarted = false;
+}
+
+
+//////////
+//
+// QTNative_GetNumberOfThreads
+// Return the number of threads that can work on a parallel loop (the workers plus the calling thread).
+//
+//////////
+
+long QTNative_GetNumberOfThreads (void)
+{
+	return(gNativeNumThreads + 1);
+}
+
+
+//////////
+//
+// QTNative_ParallelFor
+// Perform tasks 0 through theCount - 1 by calling theProc, in any order and on any threads, and return once
+// they have all finished. The result is the first error returned by a task, or noErr.
+//
+//////////
+
+OSErr QTNative_ParallelFor (long theCount, NativeTaskProcPtr theProc, void *theRefCon)
+{
+	NativeTaskGroup		myGroup;
+	long				myNumSlots = gNativeNumThreads + 1;
+	long				mySlot;
+	long				myTask;
+	OSErr				myErr = noErr;
+
+	if (theCount <= 0)
+		return(noErr);
+
+	// without worker threads (or with only one task), just do the work here
+	if ((gNativeNumThreads == 0) || (theCount == 1)) {
+		for (myTask = 0; myTask < theCount; myTask++) {
+			OSErr		myTaskErr = theProc(theRefCon, myTask);
+
+			if ((myTaskErr != noErr) && (myErr == noErr))
+				myErr = myTaskErr;
+		}
+
+		return(myErr);
+	}
+
+	myGroup.fProc = theProc;
+	myGroup.fRefCon = theRefCon;
+	myGroup.fCount = theCount;
+	myGroup.fNumDone = 0;
+	myGroup.fErr = noErr;
+
+	// give each thread an equal share of the tasks to start with
+	for (mySlot = 0; mySlot < myNumSlots; mySlot++) {
+		myGroup.fRanges[mySlot].fNextTask = (theCount * mySlot) / myNumSlots;
+		myGroup.fRanges[mySlot].fEndTask = (theCount * (mySlot + 1)) / myNumSlots;
+	}
+
+	mySlot = QTNative_GetThreadSlot();
+
+	QTNative_Lock(&gNativePoolLock);
+
+	// make the loop's tasks available to the workers
+	myGroup.fNextGroup = gNativeGroups;
+	gNativeGroups = &myGroup;
+	QTNative_BroadcastCondition(&gNativePoolWork);
+
+	// do our share of the tasks, and then wait for the workers to finish theirs
+	while (QTNative_TakeTask(&myGroup, mySlot, &myTask))
+		QTNative_PerformTask(&myGroup, myTask);
+
+	while (myGroup.fNumDone < myGroup.fCount)
+		QTNative_WaitCondition(&gNativePoolDone, &gNativePoolLock);
+
+	QTNative_Unlock(&gNativePoolLock);
+
+	return(myGroup.fErr);
+}
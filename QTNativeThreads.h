@@ -0,0 +1,75 @@
+//////////
+//
+//	File:		QTNativeThreads.h
+//
+//	Contains:	A pool of worker threads for the native effects renderer.
+//				All utilities start with the prefix "QTNative_".
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/17/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTNativeThreads__
+#define __QTNativeThreads__
+
+#include "QTNativeEffects.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// perform task number theIndex of a parallel loop
+typedef OSErr (*NativeTaskProcPtr) (void *theRefCon, long theIndex);
+
+// a mutual exclusion lock and a condition variable, for code that needs to coordinate with the worker threads
+#if defined(_WIN32)
+typedef CRITICAL_SECTION			NativeLock;
+typedef CONDITION_VARIABLE			NativeCondition;
+#else
+typedef pthread_mutex_t				NativeLock;
+typedef pthread_cond_t				NativeCondition;
+#endif
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr						QTNative_StartThreads (long theNumThreads);
+void						QTNative_StopThreads (void);
+long						QTNative_GetNumberOfThreads (void);
+OSErr						QTNative_ParallelFor (long theCount, NativeTaskProcPtr theProc, void *theRefCon);
+
+void						QTNative_InitLock (NativeLock *theLock);
+void						QTNative_DisposeLock (NativeLock *theLock);
+void						QTNative_Lock (NativeLock *theLock);
+void						QTNative_Unlock (NativeLock *theLock);
+void						QTNative_InitCondition (NativeCondition *theCondition);
+void						QTNative_DisposeCondition (NativeCondition *theCondition);
+void						QTNative_WaitCondition (NativeCondition *theCondition, NativeLock *theLock);
+void						QTNative_SignalCondition (NativeCondition *theCondition);
+void						QTNative_BroadcastCondition (NativeCondition *theCondition);
+
+#endif	// __QTNativeThreads__
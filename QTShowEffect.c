@@ -13,6 +13,47 @@
 //
 //	Change History (most recent first):
 //
+//	   <56>	 	10/17/26	rtm		QTEffects_GetRawFileAsGWorld uses the mapped pages as the GWorld's pixels only for the 16-bit and
+//									32-bit ARGB formats; the other formats are resampled into a new GWorld
+//	   <55>	 	10/17/26	rtm		the loader thread decodes a picture with the ICM into a native pixel buffer, and never touches a
+//									GWorld; QTEffects_InstallLoadedSources makes the GWorld, and disposes of the stale jobs
+//	   <54>	 	10/17/26	rtm		QTEffects_GetNativeEffectParams passes the chroma key's RGBColor key color on to the native renderer
+//	   <53>	 	10/17/26	rtm		the frame cache compares the effect description byte for byte, and knows the sources by their GWorlds
+//									and a generation number that QTEffects_SourceChanged bumps, instead of by hash values of their pixels
+//	   <52>	 	10/17/26	rtm		QTEffects_AddVideoTrackFromGWorld compresses the source picture with the native Animation encoder
+//									(QTNativeAnimation.c), which encodes bands of rows in parallel, instead of CompressImage; see
+//									QTEffects_CompressGWorldNatively
+//	   <51>	 	10/17/26	rtm		the native renderer's frames and scratch rows come from a pool of aligned blocks (QTNativeFramePool.c);
+//									so do the pixels of the offscreen GWorlds that the renderer, the picture decoder, and the
+//									movie export draw into (see QTEffects_NewPooledGWorld)
+//	   <50>	 	10/17/26	rtm		pictures picked with the Get First Picture and Get Second Picture menu items are decoded on a
+//									background thread (see QTEffects_GetPictureInBackground and QTNativeLoader.c), and installed
+//									by QTEffects_ProcessEffect when they're ready; the current frame stays up meanwhile
+//	   <49>	 	10/17/26	rtm		a picture picked as a source is kept, decoded and fitted, in a cache of recently used pictures
+//									(QTNativeSourceCache.c), so picking it again doesn't import and decode it again
+//	   <48>	 	10/17/26	rtm		QTEffects_AddVideoTrackFromGWorld converts (and if need be scales) the source picture to
+//									32 bits with the native conversion kernels (QTNativeConvert.c), instead of CopyBits
+//	   <47>	 	10/17/26	rtm		a raw frame file (PPM, PGM, PAM, or a raw frame dump) chosen as a source is mapped into memory;
+//									if it's the right size and format, the source GWorld uses its pages as pixels (see
+//									QTEffects_GetRawFileAsGWorld and QTEffects_DisposeSourceGWorld)
+//	   <46>	 	10/17/26	rtm		source pictures are now scaled to fit by the native resampler (bilinear, bicubic, or Lanczos-3,
+//									set by kSourceResampleQuality), in QTEffects_GetPictResourceAsGWorld too
+//	   <45>	 	10/17/26	rtm		QTEffects_GetPictureAsGWorld now decodes a large image at a power-of-two fraction of its size
+//									and resamples it to the size of the GWorld (see QTEffects_DrawImporterIntoGWorld)
+//	   <44>	 	10/17/26	rtm		the fire and water simulations save checkpoints every kNativeCheckpointInterval steps, so
+//									that stepping back, palindrome looping, and scrubbing don't rerun them from the start
+//	   <43>	 	10/17/26	rtm		the fire, clouds, and water ripple effects are now rendered natively (see QTNativeGenerators.c);
+//									the fire and water simulations are freed at shutdown
+//	   <42>	 	10/17/26	rtm		the native renderer now renders a pipeline of effects (see QTNativePipeline.c); if
+//									ALLOW_COMPOUND_EFFECTS is set, the film noise filter is layered over the current effect
+//									in the main effects window, just as it is in the movie built by QTEffects_MakeEffectMovie
+//	   <41>	 	10/17/26	rtm		natively rendered steps are now kept in a frame cache (see QTNativeFrameCache.c), so that
+//									looping, palindrome playback, and redrawing the window don't render them again
+//	   <40>	 	10/17/26	rtm		in fast mode, QTEffects_ProcessEffect now renders natively implemented effects several
+//									steps at a time on worker threads (see QTNativeThreads.c)
+//	   <39>	 	10/17/26	rtm		QTEffects_Init now selects the native blending kernels (see QTNativeBlend.c)
+//	   <38>	 	10/17/26	rtm		added QTEffects_RunNativeEffect, to render effects that have a native implementation
+//									(see QTNativeEffects.c) without going through the effect component
 //	   <37>	 	03/19/01	rtm		added MacSetPort call to QTEffects_HandleEffectsDialogEvents (so GlobalToLocal
 //									would work correctly)
 //	   <36>	 	09/01/00	rtm		made gChooseDialog global, so we can just hide and show it instead of rebuilding
@@ -99,8 +140,9 @@
 //	NOTE:
 //	If you set the compiler flag ALLOW_COMPOUND_EFFECTS to 1, then the Build Effect Movie menu item will add
 //	the film noise filter to whatever two-source effect you've already chosen when it builds the movie; this is
-//	intended to illustrate how to work with compound (or "stacked") effects. QTShowEffect does not yet provide
-//	a mechanism to allow the user to add a compound effect to the one shown in the main effects display window.
+//	intended to illustrate how to work with compound (or "stacked") effects. When the effect is rendered natively,
+//	the main effects display window shows the film noise filter layered over the effect as well; the two effects
+//	are rendered together, one band of rows at a time (see QTNativePipeline.c).
 //
 //////////
 
@@ -145,6 +187,23 @@ StateInformation			gCurrentState;					// holds information about the current sta
 int							gNumberOfSteps = k30StepsCount;
 MenuHandle					gSubPanelPopUpMenu = NULL;		// menu handle for subpanel pop-up menu in custom dialog box
 ControlHandle				gSubPanelPopUpControl = NULL;	// control handle for subpanel pop-up menu in custom dialog box
+#if USES_NATIVE_RENDERER
+GWorldPtr					gNativeGW = NULL;				// the GWorld that receives the natively rendered effect steps
+void *						gNativeGWPixels = NULL;			// the pixels of gNativeGW, if they came from the frame pool
+NativeEffectParams			gNativeParams;					// the parameters of the current effect, for the native renderer
+NativePipeline				gNativePipeline;				// the current effect and any filters layered over it, for the native renderer
+unsigned long				gGW1ColorTable[256];			// the color tables of the source GWorlds (for indexed pixel formats)
+unsigned long				gGW2ColorTable[256];
+unsigned long				gNativeEffectKey = 0;			// a hash value of the current effect and its parameters, for the frame cache
+void *						gNativeEffectDesc = NULL;		// a copy of the current effect description, for the frame cache
+long						gNativeEffectDescSize = 0;
+unsigned long				gNativeSourceGenerations[kNumSources] = {0, 0};
+															// change whenever a source GWorld gets a new picture, for the frame cache
+unsigned long				gNativeLastGeneration = 0;		// the last generation number handed out
+GWorldPtr					gMappedSourceGWs[kNumMappedSources] = {NULL, NULL};
+															// the source GWorlds whose pixels are the pages of a raw frame file
+NativeRawFile				gMappedSourceFiles[kNumMappedSources];	// the mapped files behind those GWorlds
+#endif
 
 extern ModalFilterUPP		gModalFilterUPP;
 
@@ -208,6 +267,27 @@ OSErr QTEffects_Init (void)
 	gCurrentState.fEffectSequenceID  = 0L;
 	gCurrentState.fTimeBase          = NULL;
 	
+#if USES_NATIVE_RENDERER
+	// pick the fastest native blending kernels that this processor supports
+	QTNative_InitBlendKernels();
+	
+	// start keeping the frames and scratch rows that the native renderer frees, so it can use them again
+	QTNative_StartFramePool();
+	QTNative_SetFramePoolLimit(kNativeFramePoolSize);
+	
+	// start the worker threads for the native renderer
+	QTNative_StartThreads(0);
+	
+	// set the size of the cache of rendered steps
+	QTNative_SetFrameCacheLimit(kNativeFrameCacheSize);
+	
+	// set the size of the cache of decoded source pictures
+	QTNative_SetSourceCacheLimit(kNativeSourceCacheSize);
+	
+	// set how often the fire and water simulations save their state, so that seeking costs a bounded number of steps
+	QTNative_SetCheckpointInterval(kNativeCheckpointInterval);
+#endif
+
 	// create the pop-up menu for the Select Effect dialog box
 	myErr = QTEffects_InitializePopUpMenu(&gSelectEffectPopup);
 	if (myErr != noErr)
@@ -271,6 +351,24 @@ OSErr QTEffects_Init (void)
 		
 #endif
 
+#if USES_NATIVE_RENDERER
+	// start the thread that decodes source pictures in the background; on Windows, the thread wakes up the effects
+	// window when a picture is ready, so that the window procedure installs it (on MacOS, null events do that)
+	{
+		NativeLoaderProcs		myProcs;
+
+		myProcs.fLoad = QTEffects_LoadSourceJob;
+		myProcs.fDispose = QTEffects_DisposeSourceJob;
+		myProcs.fReady = QTEffects_SourceJobReady;
+#if TARGET_OS_WIN32
+		myProcs.fRefCon = (void *)myWindow;
+#else
+		myProcs.fRefCon = NULL;
+#endif
+		QTNative_StartLoader(&myProcs);
+	}
+#endif
+
 bail:
 
 #if TARGET_OS_MAC	
@@ -303,6 +401,11 @@ OSErr QTEffects_Stop (void)
 {
 	OSErr				myErr = noErr;
 
+#if USES_NATIVE_RENDERER
+	// stop decoding source pictures in the background, before the window the loader wakes up goes away
+	QTNative_StopLoader();
+#endif
+
 	// close the main effects window
 #if TARGET_OS_WIN32
 	if (gMainWindow != NULL)
@@ -328,11 +431,24 @@ OSErr QTEffects_Stop (void)
 		DisposeHandle((Handle)gGW2Desc);
 
 	if (gGW1 != NULL)
-		DisposeGWorld(gGW1);
+		QTEffects_DisposeSourceGWorld(gGW1);
 		
 	if (gGW2 != NULL)
-		DisposeGWorld(gGW2);
+		QTEffects_DisposeSourceGWorld(gGW2);
+		
+#if USES_NATIVE_RENDERER
+	if (gNativeGW != NULL)
+		QTEffects_DisposePooledGWorld(gNativeGW, gNativeGWPixels);
 		
+	QTNative_StopThreads();
+	QTNative_FlushFrameCache();
+	if (gNativeEffectDesc != NULL)
+		free(gNativeEffectDesc);
+	QTNative_FlushSourceCache();
+	QTNative_FlushGenerators();
+	QTNative_StopFramePool();
+#endif
+
 	if (gCurrentState.fSampleDescription != NULL)
 		DisposeHandle((Handle)gCurrentState.fSampleDescription);
 		
@@ -371,8 +487,23 @@ void QTEffects_ProcessEffect (void)
 {
 	OSErr		myErr = noErr;
 	
+#if USES_NATIVE_RENDERER
+	// install any source pictures that the background loader has finished decoding
+	QTEffects_InstallLoadedSources();
+	
+#endif
 	// if we are in "fast mode", play the effect forward thru to completion
 	if (gCurrentState.fShowingEffect && gFastEffectDisplay) {
+#if USES_NATIVE_RENDERER
+		// if the current effect has a native implementation, render several steps at once on the worker threads
+		if ((gCurrentState.fEffectDescription != NULL) && QTNative_CanRenderEffect(&gNativeParams)) {
+			myErr = QTEffects_RunNativeEffectSteps(1, gNumberOfSteps);
+			if (myErr != noErr)
+				return;
+				
+			gCurrentState.fTime = gNumberOfSteps + 1;
+		} else
+#endif
 		for (gCurrentState.fTime = 1; gCurrentState.fTime <= gNumberOfSteps; gCurrentState.fTime++) {
 			myErr = QTEffects_RunEffect(gCurrentState.fTime);
 			if (myErr != noErr)
@@ -1353,6 +1484,15 @@ OSErr QTEffects_SetUpEffectSequence (void)
 	PixMapHandle				mySrcPixMap;
 	PixMapHandle				myDstPixMap;
  	
+#if USES_NATIVE_RENDERER
+	// get the parameters of the current effect, in case we render it natively
+	QTEffects_GetNativeEffectParams(gCurrentState.fEffectDescription, gCurrentState.fEffectType, &gNativeParams);
+	QTEffects_BuildNativePipeline();
+	
+	// the effect or its sources may have changed, so any cached steps we have may be out of date
+	QTEffects_UpdateNativeFrameKeys();
+#endif
+
 	// if an effect sequence is already set up, end it
 	if (gCurrentState.fEffectSequenceID != 0L) {
 		CDSequenceEnd(gCurrentState.fEffectSequenceID);
@@ -1495,6 +1635,12 @@ OSErr QTEffects_RunEffect (TimeValue theTime)
 	OSErr						myErr = noErr;
 	ICMFrameTimeRecord			myFrameTime;
 
+#if USES_NATIVE_RENDERER
+	// if the current effect has a native implementation, render it ourselves
+	if ((gCurrentState.fEffectDescription != NULL) && QTNative_CanRenderEffect(&gNativeParams))
+		return(QTEffects_RunNativeEffect(theTime));
+#endif
+
 	// assertions
 	if ((gCurrentState.fEffectDescription == NULL) || (gCurrentState.fEffectSequenceID == 0L))
 		goto bail;
@@ -1540,228 +1686,1681 @@ bail:
 }
 
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-// General imaging utilities.
-//
-// Use these functions to draw pictures into GWorlds and do other imaging operations.
-//
-///////////////////////////////////////////////////////////////////////////////////////////////////////////
-
+#if USES_NATIVE_RENDERER
 //////////
 //
-// QTEffects_GetPictResourceAsGWorld
-// Create a new GWorld of the specified size and bit depth; then draw the specified PICT resource into it.
-// The new GWorld is returned through the theGW parameter.
-//
+// QTEffects_RunNativeEffect
+// Run the effect: render a single step of the current effect with the native renderer, and then copy it into
+// the main effects window.
+// 
 //////////
 
-OSErr QTEffects_GetPictResourceAsGWorld (short theResID, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+OSErr QTEffects_RunNativeEffect (TimeValue theTime)
 {
-	PicHandle				myHandle = NULL;
-	PixMapHandle			myPixMap = NULL;
-	CGrafPtr				mySavedPort;
-	GDHandle				mySavedDevice;
-	Rect					myRect;
-	OSErr					myErr = noErr;
+	NativePixelBuffer			mySrc1;
+	NativePixelBuffer			mySrc2;
+	NativePixelBuffer			myDest;
+	const NativePixelBuffer		*mySources[2];
+	const NativePixelBuffer		*myFrame = NULL;
+	NativeFrameKey				myKey;
+	OSErr						myErr = noErr;
 
-	// get the current drawing environment
-	GetGWorld(&mySavedPort, &mySavedDevice);
+	myErr = QTEffects_GetNativeBuffers(&mySrc1, &mySrc2, &myDest);
+	if (myErr != noErr)
+		goto bail;
 
-	// read the specified PICT resource from the application's resource file
-	myHandle = GetPicture(theResID);
-	if (myHandle == NULL) {
-		myErr = ResError();
-		if (myErr == noErr)
-			myErr = resNotFound;
+	// if we've already rendered this step, just copy it
+	QTEffects_GetNativeFrameKey(theTime, &myDest, &myKey);
+	myFrame = QTNative_FindCachedFrame(&myKey);
+	if (myFrame != NULL) {
+		myErr = QTNative_CopyPixelBuffer(myFrame, &myDest);
+		if (myErr != noErr)
+			goto bail;
+
+		QTEffects_DrawNativeGWorld();
 		goto bail;
 	}
 
-	// set the size of the GWorld
-	MacSetRect(&myRect, 0, 0, theWidth, theHeight);
+	mySources[0] = &mySrc1;
+	mySources[1] = &mySrc2;
 
-	// allocate a new GWorld
-	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	// render the specified step
+	myErr = QTNative_RenderPipeline(&gNativePipeline, theTime, gNumberOfSteps, mySources, 2, &myDest);
 	if (myErr != noErr)
 		goto bail;
-	
-	SetGWorld(*theGW, NULL);
 
-	// get a handle to the offscreen pixel image and lock it
-	myPixMap = GetGWorldPixMap(*theGW);
-	LockPixels(myPixMap);
+	QTNative_AddCachedFrame(&myKey, &myDest);
 
-	EraseRect(&myRect);
-	DrawPicture(myHandle, &myRect);
-	
-	if (myPixMap != NULL)
-		UnlockPixels(myPixMap);
-	
-bail:
-	// restore the previous port and device
-	SetGWorld(mySavedPort, mySavedDevice);
+	QTEffects_DrawNativeGWorld();
 
-	if (myHandle != NULL)
-		ReleaseResource((Handle)myHandle);
-	
+bail:
 	return(myErr);
 }
 
 
 //////////
 //
-// QTEffects_GetPictureAsGWorld
-// Prompt the user to select a picture, create a new GWorld of the specified size and bit depth,
-// and then draw the picture into it. The new GWorld is returned through the theGW parameter.
+// QTEffects_RunNativeEffectSteps
+// Run the effect: render the specified steps of the current effect with the native renderer, and copy each of
+// them, in order, into the main effects window.
 //
+// If the steps of the effect don't depend on one another, we render a batch of steps at a time, one step per
+// thread, into buffers of their own; then we show the steps of that batch one after the other. Steps that are
+// already in the frame cache aren't rendered again. Otherwise, we just render the steps one at a time.
+// 
 //////////
 
-OSErr QTEffects_GetPictureAsGWorld (short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+OSErr QTEffects_RunNativeEffectSteps (TimeValue theFirstStep, TimeValue theLastStep)
 {
-	FSSpec						myFSSpec;
-	OSType 						myTypeList[] = {kQTFileTypeQuickTimeImage};
-	short						myNumTypes = 1;
-	GraphicsImportComponent		myImporter = NULL;
-	Rect						myRect;
-	QTFrameFileFilterUPP		myFileFilterUPP = NULL;
-	OSErr						myErr = paramErr;
+	const NativeEffectEntry		*myEntry = NULL;
+	NativeStepsInformation		myInfo;
+	NativePixelBuffer			mySrc1;
+	NativePixelBuffer			mySrc2;
+	NativePixelBuffer			myDest;
+	NativePixelBuffer			*mySteps = NULL;
+	TimeValue					*myStepNumbers = NULL;
+	const NativePixelBuffer		*myFrame = NULL;
+	NativeFrameKey				myKey;
+	long						myBatchSize = 0;
+	long						myNumToRender;
+	long						myRendered;
+	long						myIndex;
+	TimeValue					myFirstStep;
+	TimeValue					myLastStep;
+	TimeValue					myStep;
+	OSErr						myErr = noErr;
 
-#if TARGET_OS_MAC
-	myNumTypes = 0;
-#endif
+	myEntry = QTNative_FindEffect(gCurrentState.fEffectType);
+	if (myEntry == NULL)
+		return(paramErr);
+
+	// if each step depends on the ones before it, there's nothing to do in parallel
+	if (!(myEntry->fFlags & kNativeEffectFlagTimeIndependent) || (QTNative_GetNumberOfThreads() < 2)) {
+		for (myStep = theFirstStep; myStep <= theLastStep; myStep++) {
+			myErr = QTEffects_RunNativeEffect(myStep);
+			if (myErr != noErr)
+				goto bail;
+		}
 
-	// have the user select an image file
-	myFileFilterUPP = QTFrame_GetFileFilterUPP((ProcPtr)QTFrame_FilterFiles);
-	myErr = QTFrame_GetOneFileWithPreview(myNumTypes, (QTFrameTypeListPtr)myTypeList, &myFSSpec, myFileFilterUPP);
-	if (myErr != noErr)
 		goto bail;
-		
-	// get a graphics importer for the image file
-	myErr = GetGraphicsImporterForFile(&myFSSpec, &myImporter);
+	}
+
+	myErr = QTEffects_GetNativeBuffers(&mySrc1, &mySrc2, &myDest);
 	if (myErr != noErr)
 		goto bail;
 
-	if (*theGW != NULL) {
-		DisposeGWorld(*theGW);
-		*theGW = NULL;
+	// allocate one buffer for each thread; a batch has as many steps as there are threads
+	myBatchSize = QTNative_GetNumberOfThreads();
+	mySteps = (NativePixelBuffer *)calloc((size_t)myBatchSize, sizeof(NativePixelBuffer));
+	myStepNumbers = (TimeValue *)calloc((size_t)myBatchSize, sizeof(TimeValue));
+	if ((mySteps == NULL) || (myStepNumbers == NULL)) {
+		myErr = memFullErr;
+		goto bail;
 	}
-	
-	// set the size of the GWorld
-	MacSetRect(&myRect, 0, 0, theWidth, theHeight);
 
-	// allocate a new GWorld
-	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
-	if (myErr != noErr)
-		goto bail;
-	
-	// draw the picture into the GWorld
-	GraphicsImportSetGWorld(myImporter, *theGW, NULL);
-	GraphicsImportSetBoundsRect(myImporter, &myRect);
-	GraphicsImportDraw(myImporter);
+	for (myIndex = 0; myIndex < myBatchSize; myIndex++) {
+		myErr = QTNative_NewPixelBuffer(&mySteps[myIndex], myDest.fWidth, myDest.fHeight, myDest.fPixelFormat);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+	myInfo.fPipeline = &gNativePipeline;
+	myInfo.fNumberOfSteps = gNumberOfSteps;
+	myInfo.fSources[0] = &mySrc1;
+	myInfo.fSources[1] = &mySrc2;
+	myInfo.fSteps = mySteps;
+	myInfo.fStepNumbers = myStepNumbers;
+
+	for (myFirstStep = theFirstStep; myFirstStep <= theLastStep; myFirstStep += myBatchSize) {
+		myLastStep = myFirstStep + myBatchSize - 1;
+		if (myLastStep > theLastStep)
+			myLastStep = theLastStep;
+
+		// find the steps of this batch that aren't in the frame cache, and render them in parallel
+		myNumToRender = 0;
+		for (myStep = myFirstStep; myStep <= myLastStep; myStep++) {
+			QTEffects_GetNativeFrameKey(myStep, &myDest, &myKey);
+			if (QTNative_FindCachedFrame(&myKey) == NULL)
+				myStepNumbers[myNumToRender++] = myStep;
+		}
+
+		myErr = QTNative_ParallelFor(myNumToRender, QTEffects_RenderNativeStep, &myInfo);
+		if (myErr != noErr)
+			goto bail;
+
+		// show the steps in order
+		myRendered = 0;
+		for (myStep = myFirstStep; myStep <= myLastStep; myStep++) {
+			QTEffects_GetNativeFrameKey(myStep, &myDest, &myKey);
+
+			if ((myRendered < myNumToRender) && (myStepNumbers[myRendered] == myStep)) {
+				myErr = QTNative_CopyPixelBuffer(&mySteps[myRendered++], &myDest);
+				QTNative_AddCachedFrame(&myKey, &myDest);
+			} else if ((myFrame = QTNative_FindCachedFrame(&myKey)) != NULL) {
+				myErr = QTNative_CopyPixelBuffer(myFrame, &myDest);
+			} else {
+				// the step was in the cache, but it's been pushed out by the steps we just added; render it again
+				myErr = QTEffects_RunNativeEffect(myStep);
+				if (myErr != noErr)
+					goto bail;
+
+				continue;
+			}
+
+			if (myErr != noErr)
+				goto bail;
+
+			QTEffects_DrawNativeGWorld();
+		}
+	}
 
 bail:
-	if (myFileFilterUPP != NULL)
-		DisposeNavObjectFilterUPP(myFileFilterUPP);
+	if (mySteps != NULL) {
+		for (myIndex = 0; myIndex < myBatchSize; myIndex++)
+			QTNative_DisposePixelBuffer(&mySteps[myIndex]);
+		free(mySteps);
+	}
+
+	if (myStepNumbers != NULL)
+		free(myStepNumbers);
 
-	if (myImporter != NULL)
-		CloseComponent(myImporter);
-	
 	return(myErr);
 }
 
 
 //////////
 //
-// QTEffects_AddVideoTrackFromGWorld
-// Add to the specified movie a video track for the specified picture resource.
+// QTEffects_RenderNativeStep
+// Render one step of a batch of effect steps; this is called on a worker thread by QTNative_ParallelFor.
+// 
+//////////
+
+static OSErr QTEffects_RenderNativeStep (void *theRefCon, long theIndex)
+{
+	NativeStepsInformation		*myInfo = (NativeStepsInformation *)theRefCon;
+
+	return(QTNative_RenderPipeline(myInfo->fPipeline, myInfo->fStepNumbers[theIndex], myInfo->fNumberOfSteps, myInfo->fSources, 2, &myInfo->fSteps[theIndex]));
+}
+
+
+//////////
 //
+// QTEffects_GetNativeBuffers
+// Describe the source GWorlds and the GWorld that receives the rendered steps to the native renderer,
+// allocating the latter if necessary.
+// 
 //////////
 
-OSErr QTEffects_AddVideoTrackFromGWorld (Movie *theMovie, GWorldPtr theGW, Track *theSourceTrack, long theStartTime, short theWidth, short theHeight)
+OSErr QTEffects_GetNativeBuffers (NativePixelBuffer *theSrc1, NativePixelBuffer *theSrc2, NativePixelBuffer *theDest)
 {
-	Media						myMedia;
-	ImageDescriptionHandle		myDesc = NULL;
-	Rect						myRect;
-	Rect						myRect2;
-	Rect						myRect3;
-	long						mySize;
-	Handle						myData = NULL;
-	Ptr							myDataPtr = NULL;
-	GWorldPtr					myGWorld = NULL;
-	CGrafPtr 					mySavedPort = NULL;
-	GDHandle 					mySavedGDevice = NULL;
-	PicHandle					myHandle = NULL;
-	PixMapHandle				mySrcPixMap = NULL;
-	PixMapHandle				myDstPixMap = NULL;
+	Rect						myRectNative;
 	OSErr						myErr = noErr;
-	
-	// get the current port and device
-	GetGWorld(&mySavedPort, &mySavedGDevice);
-	
-	// create a video track in the movie
-	*theSourceTrack = NewMovieTrack(*theMovie, FixRatio(theWidth, 1), FixRatio(theHeight, 1), kNoVolume);
-	myMedia = NewTrackMedia(*theSourceTrack, VideoMediaType, kOneSecond, NULL, 0);
-	
-	// get the rectangle for the movie
-	GetMovieBox(*theMovie, &myRect);
-	
-	// begin editing the new track
-	BeginMediaEdits(myMedia);
-		
-	// create a new GWorld; we draw the picture into this GWorld and then compress it
-	// (note that we are creating a picture with the maximum bit depth)
-	myErr = NewGWorld(&myGWorld, 32, &myRect, NULL, NULL, 0L);
+
+	// assertions
+	if ((gGW1 == NULL) || (gGW2 == NULL) || (gMainWindow == NULL))
+		return(paramErr);
+
+	// allocate the GWorld that receives the rendered steps; it's always 32 bits deep, whatever the depth of the sources;
+	// like the source GWorlds, this GWorld stays locked for as long as it exists
+	if (gNativeGW == NULL) {
+		MacSetRect(&myRectNative, 0, 0, kWidth, kHeight);
+		myErr = QTEffects_NewPooledGWorld(&gNativeGW, &myRectNative, &gNativeGWPixels);
+		if (myErr != noErr)
+			goto bail;
+
+		LockPixels(GetGWorldPixMap(gNativeGW));
+	}
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(gGW1, theSrc1, gGW1ColorTable);
 	if (myErr != noErr)
 		goto bail;
-	
-	mySrcPixMap = GetGWorldPixMap(theGW);
-	// LockPixels(mySrcPixMap);
-	
-	myDstPixMap = GetGWorldPixMap(myGWorld);
-	LockPixels(myDstPixMap);
-	
-	// create a new image description; CompressImage will fill in the fields of this structure
-	myDesc = (ImageDescriptionHandle)NewHandle(4);
-	
-	SetGWorld(myGWorld, NULL);
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(gGW2, theSrc2, gGW2ColorTable);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(gNativeGW, theDest, NULL);
+
+bail:
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_DrawNativeGWorld
+// Copy the most recently rendered step into the main effects window.
+// 
+//////////
+
+void QTEffects_DrawNativeGWorld (void)
+{
+	CGrafPtr 					mySavedPort = NULL;
+	GDHandle					mySavedGDevice = NULL;
+	Rect						myRectNative;
+	Rect						myRectMain;
+
+	if ((gNativeGW == NULL) || (gMainWindow == NULL))
+		return;
+
+	GetGWorld(&mySavedPort, &mySavedGDevice);
+
 #if TARGET_OS_MAC
-	GetPortBounds(theGW, &myRect2);
-	GetPortBounds(myGWorld, &myRect3);
+	MacSetPort((GrafPtr)GetWindowPort(gMainWindow));
+
+	GetPortBounds(gNativeGW, &myRectNative);
+	GetPortBounds(GetWindowPort(gMainWindow), &myRectMain);
 #endif
 #if TARGET_OS_WIN32
-	myRect2 = theGW->portRect;
-	myRect3 = myGWorld->portRect;
+	MacSetPort((GrafPtr)gMainWindow);
+
+	myRectNative = gNativeGW->portRect;
+	myRectMain = gMainWindow->portRect;
 #endif
 
-	// copy the image from the specified GWorld into the new GWorld
-	CopyBits(	
-				(BitMapPtr)*mySrcPixMap,
-				(BitMapPtr)*myDstPixMap,
-				&myRect2,
-				&myRect3,
+	CopyBits(	(BitMapPtr)*GetGWorldPixMap(gNativeGW),
+				(BitMapPtr)*GetGWorldPixMap(GetWindowPort(gMainWindow)),
+				&myRectNative,
+				&myRectMain,
 				srcCopy,
 				NULL);
 
-	// restore the original port and device
 	SetGWorld(mySavedPort, mySavedGDevice);
-	
-	myErr = GetMaxCompressionSize(myDstPixMap, &myRect, 0, codecNormalQuality, kAnimationCodecType, anyCodec, &mySize);
-	if (myErr != noErr)
-		goto bail;
-		
-	myData = NewHandle(mySize);
-	if (myData == NULL)
-		goto bail;
-		
-	HLockHi(myData);
-#if TARGET_CPU_68K
-	myDataPtr = StripAddress(*myData);
-#else
-	myDataPtr = *myData;
-#endif
-	myErr = CompressImage(myDstPixMap, &myRect, codecNormalQuality, kAnimationCodecType, myDesc, myDataPtr);
-	if (myErr != noErr)
+}
+
+
+//////////
+//
+// QTEffects_BuildNativePipeline
+// Build the pipeline of effects that the native renderer renders: the current effect, followed by any filters
+// layered over it.
+// 
+//////////
+
+void QTEffects_BuildNativePipeline (void)
+{
+#if ALLOW_COMPOUND_EFFECTS
+	NativeEffectParams			myNoiseParams;
+#endif
+
+	QTNative_InitPipeline(&gNativePipeline);
+
+	if (QTNative_AddPipelineStage(&gNativePipeline, &gNativeParams) != noErr)
+		return;
+
+#if ALLOW_COMPOUND_EFFECTS
+	// layer the film noise filter (with its default parameters) over the effect, as QTEffects_AddFilmNoiseToMovie does
+	QTNative_InitEffectParams(&myNoiseParams, kNativeFilmNoiseType);
+	QTNative_AddPipelineStage(&gNativePipeline, &myNoiseParams);
+#endif
+}
+
+
+//////////
+//
+// QTEffects_UpdateNativeFrameKeys
+// Compute the values that identify the current effect in the frame cache.
+//
+// The effect is identified by the contents of its effect description (together with the parameters we read
+// from it), and the sources by their GWorlds and generation numbers (see QTEffects_SourceChanged); so whenever
+// the user changes the effect, its parameters, or the pictures, the keys change and the steps rendered earlier
+// won't be found in the cache.
+// 
+//////////
+
+void QTEffects_UpdateNativeFrameKeys (void)
+{
+	unsigned long				myStageKey;
+	long						mySize;
+	short						myIndex;
+
+	gNativeEffectKey = QTNative_GetEffectParamsKey(&gNativeParams);
+
+	// the filters layered over the effect change the rendered steps too
+	for (myIndex = 1; myIndex < gNativePipeline.fNumStages; myIndex++) {
+		myStageKey = QTNative_GetEffectParamsKey(&gNativePipeline.fStages[myIndex]);
+		gNativeEffectKey = QTNative_HashBytes(&myStageKey, sizeof(myStageKey), gNativeEffectKey);
+	}
+
+	// keep a copy of the effect description, which the cache compares byte for byte (a hash value can collide)
+	if (gNativeEffectDesc != NULL)
+		free(gNativeEffectDesc);
+	gNativeEffectDesc = NULL;
+	gNativeEffectDescSize = 0;
+
+	if (gCurrentState.fEffectDescription != NULL) {
+		mySize = GetHandleSize((Handle)gCurrentState.fEffectDescription);
+
+		HLock((Handle)gCurrentState.fEffectDescription);
+		gNativeEffectKey = QTNative_HashBytes(*(Handle)gCurrentState.fEffectDescription, mySize, gNativeEffectKey);
+
+		gNativeEffectDesc = malloc(mySize);
+		if (gNativeEffectDesc != NULL) {
+			memcpy(gNativeEffectDesc, *(Handle)gCurrentState.fEffectDescription, mySize);
+			gNativeEffectDescSize = mySize;
+		} else {
+			// without a copy of the description, the steps of this effect can't be told apart from those of
+			// another one, so they aren't cached (the frame cache rejects a negative size)
+			gNativeEffectDescSize = -1;
+		}
+		HUnlock((Handle)gCurrentState.fEffectDescription);
+	}
+}
+
+
+//////////
+//
+// QTEffects_GetNativeFrameKey
+// Fill in the frame cache key for the specified step of the current effect.
+// 
+//////////
+
+void QTEffects_GetNativeFrameKey (TimeValue theStep, const NativePixelBuffer *theDest, NativeFrameKey *theKey)
+{
+	memset(theKey, 0, sizeof(NativeFrameKey));
+
+	theKey->fEffectDesc = gNativeEffectDesc;
+	theKey->fEffectDescSize = gNativeEffectDescSize;
+	theKey->fEffectKey = gNativeEffectKey;
+	theKey->fSourceIDs[kFirstSource] = gGW1;
+	theKey->fSourceIDs[kSecondSource] = gGW2;
+	theKey->fSourceGenerations[kFirstSource] = gNativeSourceGenerations[kFirstSource];
+	theKey->fSourceGenerations[kSecondSource] = gNativeSourceGenerations[kSecondSource];
+	theKey->fStep = theStep;
+	theKey->fNumberOfSteps = gNumberOfSteps;
+	theKey->fWidth = theDest->fWidth;
+	theKey->fHeight = theDest->fHeight;
+	theKey->fPixelFormat = theDest->fPixelFormat;
+}
+
+
+//////////
+//
+// QTEffects_GetNativeEffectParams
+// Fill in a native effect parameter block from the specified effect description.
+//
+// Each effect parameter is stored in an atom in the effect description; the atom type is the parameter name
+// and the atom data is a big-endian integer. We skip the atoms that identify the effect and its sources, and
+// any other atoms whose data isn't a simple integer. The one color we use, the key color of the chroma key,
+// is an RGBColor, which we pass on as 0x00RRGGBB.
+// 
+//////////
+
+OSErr QTEffects_GetNativeEffectParams (QTAtomContainer theEffectDesc, OSType theEffectType, NativeEffectParams *theParams)
+{
+	QTAtom					myAtom = 0L;
+	QTAtomType				myType;
+	long					mySize;
+	long					myValue;
+	unsigned char			myData[sizeof(RGBColor)];
+	OSErr					myErr = noErr;
+
+	QTNative_InitEffectParams(theParams, theEffectType);
+
+	if (theEffectDesc == NULL)
+		return(paramErr);
+
+	while (true) {
+		myErr = QTNextChildAnyType(theEffectDesc, kParentAtomIsContainer, myAtom, &myAtom);
+		if ((myErr != noErr) || (myAtom == 0L))
+			break;
+
+		myErr = QTGetAtomTypeAndID(theEffectDesc, myAtom, &myType, NULL);
+		if (myErr != noErr)
+			break;
+
+		if ((myType == kParameterWhatName) || (myType == kEffectSourceName))
+			continue;
+
+		// read the atom data; this fails for any atom larger than an RGBColor, which we're happy to skip
+		if (QTCopyAtomDataToPtr(theEffectDesc, myAtom, true, sizeof(myData), myData, &mySize) != noErr)
+			continue;
+
+		switch (mySize) {
+			case 1:
+				myValue = myData[0];
+				break;
+			case 2:
+				myValue = (short)((myData[0] << 8) | myData[1]);
+				break;
+			case 4:
+				myValue = (long)(((unsigned long)myData[0] << 24) | ((unsigned long)myData[1] << 16) | ((unsigned long)myData[2] << 8) | myData[3]);
+				break;
+			case 6:
+				// an RGBColor holds big-endian 16-bit components, of which we keep the high bytes
+				if (myType != kNativeParamKeyColor)
+					continue;
+				myValue = (long)(((unsigned long)myData[0] << 16) | ((unsigned long)myData[2] << 8) | myData[4]);
+				break;
+			default:
+				continue;
+		}
+
+		QTNative_SetEffectParam(theParams, myType, myValue);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTEffects_GetGWorldAsPixelBuffer
+// Describe the pixels of the specified GWorld to the native renderer. The GWorld's pixels must be locked.
+//
+// If the GWorld has an indexed pixel format, its color table is copied into theColorTable, which must
+// have room for 256 entries.
+// 
+//////////
+
+OSErr QTEffects_GetGWorldAsPixelBuffer (GWorldPtr theGW, NativePixelBuffer *theBuffer, unsigned long *theColorTable)
+{
+	PixMapHandle			myPixMap = NULL;
+	Rect					myRect;
+
+	memset(theBuffer, 0, sizeof(NativePixelBuffer));
+
+	if (theGW == NULL)
+		return(paramErr);
+
+	myPixMap = GetGWorldPixMap(theGW);
+	if (myPixMap == NULL)
+		return(paramErr);
+
+#if TARGET_OS_MAC
+	GetPortBounds(theGW, &myRect);
+#endif
+#if TARGET_OS_WIN32
+	myRect = theGW->portRect;
+#endif
+
+	theBuffer->fBaseAddr = (unsigned char *)GetPixBaseAddr(myPixMap);
+	theBuffer->fRowBytes = QTGetPixMapHandleRowBytes(myPixMap);
+	theBuffer->fWidth = myRect.right - myRect.left;
+	theBuffer->fHeight = myRect.bottom - myRect.top;
+
+	// older pixel maps have no pixel format, just a depth; those are always big-endian
+	theBuffer->fPixelFormat = (**myPixMap).pixelFormat;
+	if (theBuffer->fPixelFormat == 0)
+		theBuffer->fPixelFormat = (**myPixMap).pixelSize;
+
+	if (QTNative_GetBytesPerPixel(theBuffer->fPixelFormat) == 0)
+		return(paramErr);
+
+	if (theBuffer->fBaseAddr == NULL)
+		return(paramErr);
+
+	// convert the color table of an indexed pixel map into the form used by the native renderer
+	if (theBuffer->fPixelFormat == kNativePixelFormat_8Indexed) {
+		CTabHandle			myCTab = (**myPixMap).pmTable;
+		short				myIndex;
+
+		if ((theColorTable == NULL) || (myCTab == NULL))
+			return(paramErr);
+
+		memset(theColorTable, 0, 256 * sizeof(unsigned long));
+		for (myIndex = 0; (myIndex <= (**myCTab).ctSize) && (myIndex < 256); myIndex++) {
+			RGBColor		myColor = (**myCTab).ctTable[myIndex].rgb;
+
+			theColorTable[myIndex] = 0xFF000000UL |
+									 ((unsigned long)(myColor.red >> 8) << 16) |
+									 ((unsigned long)(myColor.green >> 8) << 8) |
+									 (unsigned long)(myColor.blue >> 8);
+		}
+
+		theBuffer->fColorTable = theColorTable;
+	}
+
+	return(noErr);
+}
+#endif	// USES_NATIVE_RENDERER
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// General imaging utilities.
+//
+// Use these functions to draw pictures into GWorlds and do other imaging operations.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTEffects_GetPictResourceAsGWorld
+// Create a new GWorld of the specified size and bit depth; then draw the specified PICT resource into it.
+// The new GWorld is returned through the theGW parameter.
+//
+//////////
+
+OSErr QTEffects_GetPictResourceAsGWorld (short theResID, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+{
+	PicHandle				myHandle = NULL;
+	PixMapHandle			myPixMap = NULL;
+	GWorldPtr				myPictGW = NULL;
+	void					*myPictPixels = NULL;
+	CGrafPtr				mySavedPort;
+	GDHandle				mySavedDevice;
+	Rect					myRect;
+	Rect					myPictRect;
+	OSErr					myErr = noErr;
+
+	// get the current drawing environment
+	GetGWorld(&mySavedPort, &mySavedDevice);
+
+	// read the specified PICT resource from the application's resource file
+	myHandle = GetPicture(theResID);
+	if (myHandle == NULL) {
+		myErr = ResError();
+		if (myErr == noErr)
+			myErr = resNotFound;
+		goto bail;
+	}
+
+	// set the size of the GWorld
+	MacSetRect(&myRect, 0, 0, theWidth, theHeight);
+
+	// allocate a new GWorld
+	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	if (myErr != noErr)
+		goto bail;
+	
+	SetGWorld(*theGW, NULL);
+
+	// get a handle to the offscreen pixel image and lock it
+	myPixMap = GetGWorldPixMap(*theGW);
+	LockPixels(myPixMap);
+
+	EraseRect(&myRect);
+
+	// if the picture isn't the size of the GWorld, draw it at its own size (up to the largest size the resampler
+	// handles) and resample it to fit; otherwise, just draw it
+	myPictRect = (**myHandle).picFrame;
+	MacOffsetRect(&myPictRect, -myPictRect.left, -myPictRect.top);
+	if (myPictRect.right > kNativeMaxResampleSize)
+		myPictRect.right = kNativeMaxResampleSize;
+	if (myPictRect.bottom > kNativeMaxResampleSize)
+		myPictRect.bottom = kNativeMaxResampleSize;
+
+	if (!MacEqualRect(&myPictRect, &myRect) && !EmptyRect(&myPictRect) &&
+		(QTEffects_NewPooledGWorld(&myPictGW, &myPictRect, &myPictPixels) == noErr)) {
+		SetGWorld(myPictGW, NULL);
+		LockPixels(GetGWorldPixMap(myPictGW));
+		EraseRect(&myPictRect);
+		DrawPicture(myHandle, &myPictRect);
+		SetGWorld(*theGW, NULL);
+
+		QTEffects_ResampleGWorld(myPictGW, *theGW);
+	} else {
+		DrawPicture(myHandle, &myRect);
+	}
+	
+	if (myPixMap != NULL)
+		UnlockPixels(myPixMap);
+	
+bail:
+	// restore the previous port and device
+	SetGWorld(mySavedPort, mySavedDevice);
+
+	if (myPictGW != NULL)
+		QTEffects_DisposePooledGWorld(myPictGW, myPictPixels);
+
+	if (myHandle != NULL)
+		ReleaseResource((Handle)myHandle);
+	
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_GetPictureAsGWorld
+// Prompt the user to select a picture, create a new GWorld of the specified size and bit depth,
+// and then draw the picture into it. The new GWorld is returned through the theGW parameter.
+//
+// If the picture was picked recently (and hasn't changed since), its fitted pixels are taken from the source
+// cache instead of being decoded again.
+//
+//////////
+
+OSErr QTEffects_GetPictureAsGWorld (short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+{
+	FSSpec						myFSSpec;
+	OSErr						myErr = paramErr;
+
+	// have the user select an image file
+	myErr = QTEffects_SelectPictureFile(&myFSSpec);
+	if (myErr != noErr)
+		return(myErr);
+
+	return(QTEffects_GetPictureFileAsGWorld(&myFSSpec, theWidth, theHeight, theDepth, theGW));
+}
+
+
+//////////
+//
+// QTEffects_SelectPictureFile
+// Prompt the user to select a picture file.
+//
+//////////
+
+OSErr QTEffects_SelectPictureFile (FSSpec *theFSSpec)
+{
+	OSType 						myTypeList[] = {kQTFileTypeQuickTimeImage};
+	short						myNumTypes = 1;
+	QTFrameFileFilterUPP		myFileFilterUPP = NULL;
+	OSErr						myErr = paramErr;
+
+#if TARGET_OS_MAC
+	myNumTypes = 0;
+#endif
+
+	myFileFilterUPP = QTFrame_GetFileFilterUPP((ProcPtr)QTFrame_FilterFiles);
+	myErr = QTFrame_GetOneFileWithPreview(myNumTypes, (QTFrameTypeListPtr)myTypeList, theFSSpec, myFileFilterUPP);
+
+	if (myFileFilterUPP != NULL)
+		DisposeNavObjectFilterUPP(myFileFilterUPP);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_GetPictureFileAsGWorld
+// Create a new GWorld of the specified size and bit depth, and draw the picture in the specified file into it.
+// The new GWorld is returned through the theGW parameter.
+//
+//////////
+
+OSErr QTEffects_GetPictureFileAsGWorld (FSSpec *theFSSpec, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+{
+	GraphicsImportComponent		myImporter = NULL;
+	Rect						myRect;
+#if USES_NATIVE_RENDERER
+	NativeSourceKey				myKey;
+	char						myPath[kMaxSourcePathLength];
+	Boolean						myHaveKey = false;
+#endif
+	OSErr						myErr = paramErr;
+
+#if USES_NATIVE_RENDERER
+	// a file of raw frames is mapped into memory, rather than imported
+	myErr = QTEffects_GetRawFileAsGWorld(theFSSpec, theWidth, theHeight, theDepth, theGW);
+	if (myErr != kNativeNotRawFileErr)
+		goto bail;
+
+	// a picture we've already decoded at this size and depth is taken from the source cache
+	if (QTEffects_GetSourcePath(theFSSpec, myPath, sizeof(myPath)) == noErr)
+		myHaveKey = (QTNative_GetSourceKey(myPath, theWidth, theHeight, theDepth, &myKey) == noErr);
+
+	if (myHaveKey) {
+		myErr = QTEffects_GetCachedSourceAsGWorld(&myKey, theGW);
+		if (myErr == noErr)
+			goto bail;
+	}
+#endif
+
+	// get a graphics importer for the image file
+	myErr = GetGraphicsImporterForFile(theFSSpec, &myImporter);
+	if (myErr != noErr)
+		goto bail;
+
+	if (*theGW != NULL) {
+		QTEffects_DisposeSourceGWorld(*theGW);
+		*theGW = NULL;
+	}
+	
+	// set the size of the GWorld
+	MacSetRect(&myRect, 0, 0, theWidth, theHeight);
+
+	// allocate a new GWorld
+	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	if (myErr != noErr)
+		goto bail;
+	
+	// draw the picture into the GWorld
+	myErr = QTEffects_DrawImporterIntoGWorld(myImporter, *theGW);
+
+#if USES_NATIVE_RENDERER
+	// keep a copy of the fitted picture, in case it's picked again
+	if ((myErr == noErr) && myHaveKey)
+		QTEffects_AddGWorldToSourceCache(&myKey, *theGW);
+#endif
+
+bail:
+	if (myImporter != NULL)
+		CloseComponent(myImporter);
+	
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_DisposeSourceGWorld
+// Dispose of a GWorld created by QTEffects_GetPictureAsGWorld, and of the raw frame file behind it, if any.
+//
+//////////
+
+void QTEffects_DisposeSourceGWorld (GWorldPtr theGW)
+{
+#if USES_NATIVE_RENDERER
+	short						myIndex;
+
+	for (myIndex = 0; myIndex < kNumMappedSources; myIndex++) {
+		if (gMappedSourceGWs[myIndex] == theGW) {
+			// the GWorld doesn't own its pixels, so it must go before the file
+			DisposeGWorld(theGW);
+			QTNative_CloseRawFile(&gMappedSourceFiles[myIndex]);
+			gMappedSourceGWs[myIndex] = NULL;
+			return;
+		}
+	}
+#endif
+
+	DisposeGWorld(theGW);
+}
+
+
+#if USES_NATIVE_RENDERER
+//////////
+//
+// QTEffects_GetRawFileAsGWorld
+// Create a new GWorld of the specified size that holds the first frame of the specified raw frame file (see
+// QTNativeRawFile.c). Return kNativeNotRawFileErr if the file isn't a raw frame file, and leave *theGW alone.
+//
+// If the frame is already the right size, and is in a pixel format that QuickDraw understands, with suitably
+// aligned rows, the GWorld simply uses the mapped pages of the file as its pixels; nothing is copied, and the
+// file stays mapped until the GWorld is disposed of (by QTEffects_DisposeSourceGWorld). Otherwise the frame is
+// resampled into a new GWorld of the specified depth, and the file is closed.
+//
+//////////
+
+OSErr QTEffects_GetRawFileAsGWorld (FSSpec *theFSSpec, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW)
+{
+	NativeRawFile				myFile;
+	NativePixelBuffer			myFrame;
+	NativePixelBuffer			myDest;
+	unsigned long				myColorTable[256];
+	GWorldPtr					myFrameGW = NULL;
+	Rect						myRect;
+	Rect						myFrameRect;
+	char						myPath[kMaxSourcePathLength];
+	short						myIndex;
+	OSErr						myErr = noErr;
+
+	if (QTEffects_GetSourcePath(theFSSpec, myPath, sizeof(myPath)) != noErr)
+		return(kNativeNotRawFileErr);
+
+	myErr = QTNative_OpenRawFile(myPath, &myFile);
+	if (myErr != noErr)
+		return(myErr);
+
+	QTNative_GetRawFileFrame(&myFile, 0, &myFrame);
+
+	if (*theGW != NULL) {
+		QTEffects_DisposeSourceGWorld(*theGW);
+		*theGW = NULL;
+	}
+
+	MacSetRect(&myRect, 0, 0, theWidth, theHeight);
+	MacSetRect(&myFrameRect, 0, 0, myFrame.fWidth, myFrame.fHeight);
+
+	// find a free slot for the mapping
+	for (myIndex = 0; myIndex < kNumMappedSources; myIndex++)
+		if (gMappedSourceGWs[myIndex] == NULL)
+			break;
+
+	// QuickDraw can draw from the mapped pages only if they're in one of its own pixel formats (16-bit big-endian
+	// 555 or 32-bit ARGB), with rows that start on 4-byte boundaries; any other format is resampled below
+	if (MacEqualRect(&myFrameRect, &myRect) && (myIndex < kNumMappedSources) && (myFile.fAlignment >= 4) && (myFrame.fRowBytes <= kMaxPixMapRowBytes) &&
+		((myFrame.fPixelFormat == kNativePixelFormat_16BE555) || (myFrame.fPixelFormat == kNativePixelFormat_32ARGB))) {
+		if (QTNewGWorldFromPtr(&myFrameGW, myFrame.fPixelFormat, &myFrameRect, NULL, NULL, 0, myFrame.fBaseAddr, myFrame.fRowBytes) == noErr) {
+			gMappedSourceGWs[myIndex] = myFrameGW;
+			gMappedSourceFiles[myIndex] = myFile;
+			*theGW = myFrameGW;
+			return(noErr);
+		}
+	}
+
+	// otherwise, resample the frame into a new GWorld
+	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	if (myErr != noErr)
+		goto bail;
+
+	LockPixels(GetGWorldPixMap(*theGW));
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(*theGW, &myDest, myColorTable);
+	if (myErr == noErr)
+		myErr = QTNative_ResamplePixelBuffer(&myFrame, &myDest, QTNative_GetResampleFilter(kSourceResampleQuality));
+
+	// the native resampler can't write indexed pixels, so use a 32-bit GWorld instead
+	if (myErr != noErr) {
+		DisposeGWorld(*theGW);
+		*theGW = NULL;
+
+		myErr = QTNewGWorld(theGW, k32ARGBPixelFormat, &myRect, NULL, NULL, kICMTempThenAppMemory);
+		if (myErr != noErr)
+			goto bail;
+
+		LockPixels(GetGWorldPixMap(*theGW));
+
+		myErr = QTEffects_GetGWorldAsPixelBuffer(*theGW, &myDest, myColorTable);
+		if (myErr == noErr)
+			myErr = QTNative_ResamplePixelBuffer(&myFrame, &myDest, QTNative_GetResampleFilter(kSourceResampleQuality));
+	}
+
+	UnlockPixels(GetGWorldPixMap(*theGW));
+
+bail:
+	if ((myErr != noErr) && (*theGW != NULL)) {
+		DisposeGWorld(*theGW);
+		*theGW = NULL;
+	}
+
+	QTNative_CloseRawFile(&myFile);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_GetCachedSourceAsGWorld
+// Create a new GWorld that holds the cached picture with the specified key (see QTNativeSourceCache.c). Return
+// paramErr if there is no such picture, and leave *theGW alone.
+//
+//////////
+
+OSErr QTEffects_GetCachedSourceAsGWorld (const NativeSourceKey *theKey, GWorldPtr *theGW)
+{
+	const NativePixelBuffer		*mySource = NULL;
+	NativePixelBuffer			myDest;
+	unsigned long				myColorTable[256];
+	Rect						myRect;
+	OSErr						myErr = noErr;
+
+	mySource = QTNative_FindCachedSource(theKey);
+	if (mySource == NULL)
+		return(paramErr);
+
+	if (*theGW != NULL) {
+		QTEffects_DisposeSourceGWorld(*theGW);
+		*theGW = NULL;
+	}
+
+	// a GWorld of the same depth has the same pixel format (and the same default color table) as the one the
+	// picture was drawn into
+	MacSetRect(&myRect, 0, 0, theKey->fWidth, theKey->fHeight);
+
+	myErr = QTNewGWorld(theGW, theKey->fDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	if (myErr != noErr)
+		goto bail;
+
+	LockPixels(GetGWorldPixMap(*theGW));
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(*theGW, &myDest, myColorTable);
+	if (myErr == noErr)
+		myErr = QTNative_CopyPixelBuffer(mySource, &myDest);
+
+	UnlockPixels(GetGWorldPixMap(*theGW));
+
+bail:
+	if ((myErr != noErr) && (*theGW != NULL)) {
+		DisposeGWorld(*theGW);
+		*theGW = NULL;
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_GetSourcePath
+// Get the full pathname of the specified file, as a C string, for the native file and cache functions.
+//
+//////////
+
+OSErr QTEffects_GetSourcePath (FSSpec *theFSSpec, char *thePath, long theLength)
+{
+	OSErr						myErr = noErr;
+
+#if TARGET_OS_MAC
+	{
+		FSRef					myFSRef;
+
+		myErr = FSpMakeFSRef(theFSSpec, &myFSRef);
+		if (myErr == noErr)
+			myErr = FSRefMakePath(&myFSRef, (UInt8 *)thePath, theLength);
+	}
+#endif
+#if TARGET_OS_WIN32
+	myErr = FSSpecToNativePathName(theFSSpec, thePath, theLength, kFullNativePath);
+#endif
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_AddGWorldToSourceCache
+// Add a copy of the picture in the specified GWorld to the source cache, under the specified key.
+//
+//////////
+
+void QTEffects_AddGWorldToSourceCache (const NativeSourceKey *theKey, GWorldPtr theGW)
+{
+	NativePixelBuffer			myBuffer;
+	unsigned long				myColorTable[256];
+
+	LockPixels(GetGWorldPixMap(theGW));
+	if (QTEffects_GetGWorldAsPixelBuffer(theGW, &myBuffer, myColorTable) == noErr)
+		QTNative_AddCachedSource(theKey, &myBuffer);
+	UnlockPixels(GetGWorldPixMap(theGW));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Background loading functions.
+//
+// Use these functions to decode source pictures on the loader thread (see QTNativeLoader.c), so that the
+// effects window keeps running while a large picture is decoded.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////
+//
+// QTEffects_GetPictureInBackground
+// Prompt the user to select a picture for the specified source (kFirstSource or kSecondSource), and start decoding
+// it on the loader thread; QTEffects_InstallLoadedSources replaces the source with it when it's ready.
+//
+// A raw frame file or a picture in the source cache is quick to get, so it replaces the source right away.
+//
+//////////
+
+OSErr QTEffects_GetPictureInBackground (short theSource, short theWidth, short theHeight, short theDepth)
+{
+	FSSpec						myFSSpec;
+	SourceLoadJob				*myJob = NULL;
+	GWorldPtr					*mySourceGW = (theSource == kFirstSource) ? &gGW1 : &gGW2;
+	OSErr						myErr = noErr;
+
+	myErr = QTEffects_SelectPictureFile(&myFSSpec);
+	if (myErr != noErr)
+		goto bail;
+
+	// whatever was being decoded for this source is of no use now
+	QTNative_CancelLoad(theSource);
+
+	// a file of raw frames is mapped into memory, rather than imported
+	myErr = QTEffects_GetRawFileAsGWorld(&myFSSpec, theWidth, theHeight, theDepth, mySourceGW);
+	if (myErr != kNativeNotRawFileErr)
+		goto bail;
+
+	myJob = (SourceLoadJob *)calloc(1, sizeof(SourceLoadJob));
+	if (myJob == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myJob->fFSSpec = myFSSpec;
+	myJob->fWidth = theWidth;
+	myJob->fHeight = theHeight;
+	myJob->fDepth = theDepth;
+
+	if (QTEffects_GetSourcePath(&myFSSpec, myJob->fPath, sizeof(myJob->fPath)) == noErr)
+		myJob->fHaveKey = (QTNative_GetSourceKey(myJob->fPath, theWidth, theHeight, theDepth, &myJob->fKey) == noErr);
+
+	// a picture we've already decoded at this size and depth is taken from the source cache
+	if (myJob->fHaveKey) {
+		myErr = QTEffects_GetCachedSourceAsGWorld(&myJob->fKey, mySourceGW);
+		if (myErr == noErr)
+			goto bail;
+	}
+
+	// otherwise, hand the picture to the loader thread, which owns the job from now on
+	myErr = QTNative_RequestLoad(theSource, myJob, NULL);
+	myJob = NULL;
+	if (myErr == noErr)
+		return(noErr);
+
+	// if there's no loader thread, decode the picture here
+	myErr = QTEffects_GetPictureFileAsGWorld(&myFSSpec, theWidth, theHeight, theDepth, mySourceGW);
+
+bail:
+	if (myJob != NULL)
+		QTEffects_DisposeSourceJob(myJob);
+
+	if (myErr == noErr)
+		QTEffects_SourceChanged(theSource);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_InstallLoadedSources
+// Replace each source for which the loader thread has finished decoding a picture with that picture. This is
+// called on the main thread, so the renderer never sees a source change in the middle of a step; the GWorld of
+// the new picture is made here too, since QuickDraw may only be used on the main thread. (Taking the jobs also
+// disposes of any that the loader thread found to be stale; see QTNativeLoader.c.)
+//
+//////////
+
+void QTEffects_InstallLoadedSources (void)
+{
+	SourceLoadJob				*myJob = NULL;
+	GWorldPtr					*mySourceGW = NULL;
+	GWorldPtr					myGW = NULL;
+	short						mySource;
+	OSErr						myErr = noErr;
+
+	for (mySource = kFirstSource; mySource < kNumSources; mySource++) {
+		if (!QTNative_TakeLoadedJob(mySource, (void **)&myJob, &myErr))
+			continue;
+
+		mySourceGW = (mySource == kFirstSource) ? &gGW1 : &gGW2;
+		myGW = NULL;
+
+		// the loader thread only decodes the picture into native pixels; the GWorld is made here
+		if (myErr == noErr)
+			myErr = QTEffects_GetPixelBufferAsGWorld(&myJob->fPixels, myJob->fDepth, &myGW);
+
+		if (myErr == noErr) {
+			// keep a copy of the fitted picture, in case it's picked again
+			if (myJob->fHaveKey)
+				QTEffects_AddGWorldToSourceCache(&myJob->fKey, myGW);
+
+			if (*mySourceGW != NULL)
+				QTEffects_DisposeSourceGWorld(*mySourceGW);
+
+			*mySourceGW = myGW;
+		} else {
+			// the loader thread couldn't decode the picture (perhaps because its importer or its decompressor
+			// isn't thread-safe), so decode it here
+			myErr = QTEffects_GetPictureFileAsGWorld(&myJob->fFSSpec, myJob->fWidth, myJob->fHeight, myJob->fDepth, mySourceGW);
+		}
+
+		if (myErr == noErr)
+			QTEffects_SourceChanged(mySource);
+
+		QTEffects_DisposeSourceJob(myJob);
+	}
+}
+
+
+//////////
+//
+// QTEffects_SourceChanged
+// Set things up again for a new picture in the specified source.
+//
+//////////
+
+void QTEffects_SourceChanged (short theSource)
+{
+	GWorldPtr					mySourceGW = (theSource == kFirstSource) ? gGW1 : gGW2;
+
+#if USES_NATIVE_RENDERER
+	// the steps rendered from the old picture mustn't be found in the frame cache, even if the new GWorld
+	// happens to have the same address as the old one
+	gNativeSourceGenerations[theSource] = ++gNativeLastGeneration;
+	
+#endif
+	// we need to refresh image descriptions, etc.
+	LockPixels(GetGWorldPixMap(mySourceGW));
+	QTEffects_SetUpEffectSequence();
+	QTEffects_DrawEffectsWindow();
+}
+
+
+//////////
+//
+// QTEffects_LoadSourceJob
+// Decode the picture described by the specified job into a native pixel buffer, fitted to the job's size. This is
+// called on the loader thread, so it mustn't use QuickDraw: no GWorlds, no CopyBits.
+//
+//////////
+
+static OSErr QTEffects_LoadSourceJob (void *theJob, short theSource, unsigned long theGeneration)
+{
+	SourceLoadJob				*myJob = (SourceLoadJob *)theJob;
+	GraphicsImportComponent		myImporter = NULL;
+	OSErr						myErr = noErr;
+
+	// QuickTime must be told about a thread before the thread calls it, and then we may open only the components
+	// that say they're thread-safe; for any other importer, we fail and let the main thread do the work
+	myErr = EnterMoviesOnThread(0);
+	if (myErr != noErr)
+		return(myErr);
+
+	CSSetComponentsThreadMode(kCSAcceptThreadSafeComponentsOnlyMode);
+
+	myErr = GetGraphicsImporterForFile(&myJob->fFSSpec, &myImporter);
+	if (myErr != noErr)
+		goto bail;
+
+	// don't bother decoding a picture that's been superseded
+	if (!QTNative_IsLoadCurrent(theSource, theGeneration)) {
+		myErr = userCanceledErr;
+		goto bail;
+	}
+
+	myErr = QTEffects_DecodeImporterIntoPixelBuffer(myImporter, myJob->fWidth, myJob->fHeight, &myJob->fPixels);
+
+bail:
+	if (myImporter != NULL)
+		CloseComponent(myImporter);
+
+	ExitMoviesOnThread();
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_DisposeSourceJob
+// Dispose of the specified job, and of the picture in it, if any. This is called on the main thread.
+//
+//////////
+
+static void QTEffects_DisposeSourceJob (void *theJob)
+{
+	SourceLoadJob				*myJob = (SourceLoadJob *)theJob;
+
+	QTNative_DisposePixelBuffer(&myJob->fPixels);
+
+	free(myJob);
+}
+
+
+//////////
+//
+// QTEffects_SourceJobReady
+// Tell the main thread that a picture is ready to be installed. This is called on the loader thread.
+//
+//////////
+
+static void QTEffects_SourceJobReady (void *theRefCon, short theSource)
+{
+#if TARGET_OS_WIN32
+	// any message makes the effects window procedure call QTEffects_ProcessEffect
+	if (theRefCon != NULL)
+		PostMessage((HWND)theRefCon, WM_NULL, 0, 0);
+#endif
+
+	// on MacOS, there's nothing to do: null events keep coming while the application is idle, and each one
+	// calls QTEffects_ProcessEffect
+}
+
+
+//////////
+//
+// QTEffects_DecodeImporterIntoPixelBuffer
+// Decode the image of the specified graphics importer into a new 32-bit native pixel buffer of the specified size,
+// scaled to fill it. This is called on the loader thread, so the image is handed straight to its decompressor (the
+// importer would draw it with QuickDraw); an image that has no decompressor of its own (or whose decompressor isn't
+// thread-safe) makes this fail, and the main thread then draws it with QTEffects_DrawImporterIntoGWorld.
+//
+// As in QTEffects_DrawImporterIntoGWorld, a large image is decoded at a power-of-two fraction of its size, and then
+// resampled by the native resampler.
+//
+//////////
+
+static OSErr QTEffects_DecodeImporterIntoPixelBuffer (GraphicsImportComponent theImporter, short theWidth, short theHeight, NativePixelBuffer *theBuffer)
+{
+	ImageDescriptionHandle		myDesc = NULL;
+	char						*myData = NULL;
+	unsigned long				myOffset;
+	unsigned long				mySize;
+	NativePixelBuffer			myDecodeBuffer;
+	NativePixelBuffer			*myTarget = theBuffer;
+	PixMap						myPixMap;
+	PixMapPtr					myPixMapPtr = &myPixMap;
+	Rect						myDecodeRect;
+	short						myShift;
+	OSErr						myErr = noErr;
+
+	memset(&myDecodeBuffer, 0, sizeof(myDecodeBuffer));
+
+	myErr = QTNative_NewPixelBuffer(theBuffer, theWidth, theHeight, kNativePixelFormat_32ARGB);
+	if (myErr != noErr)
+		goto bail;
+
+	// read the compressed image
+	myErr = GraphicsImportGetImageDescription(theImporter, &myDesc);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = GraphicsImportGetDataOffsetAndSize(theImporter, &myOffset, &mySize);
+	if (myErr != noErr)
+		goto bail;
+
+	myData = (char *)malloc((size_t)mySize);
+	if (myData == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myErr = GraphicsImportReadData(theImporter, myData, myOffset, mySize);
+	if (myErr != noErr)
+		goto bail;
+
+	// decode the image at the smallest power-of-two fraction of its size that's still at least as large as the buffer;
+	// if that's the size of the buffer, there's nothing to scale
+	myShift = QTNative_GetDecodeShift((**myDesc).width, (**myDesc).height, theWidth, theHeight);
+
+	MacSetRect(&myDecodeRect, 0, 0, (**myDesc).width >> myShift, (**myDesc).height >> myShift);
+
+	if ((myDecodeRect.right != theWidth) || (myDecodeRect.bottom != theHeight)) {
+		myErr = QTNative_NewPixelBuffer(&myDecodeBuffer, myDecodeRect.right, myDecodeRect.bottom, kNativePixelFormat_32ARGB);
+		if (myErr != noErr)
+			goto bail;
+
+		myTarget = &myDecodeBuffer;
+	}
+
+	myErr = QTEffects_GetPixelBufferAsPixMap(myTarget, &myPixMap);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = DecompressImage(myData, myDesc, &myPixMapPtr, NULL, &myDecodeRect, srcCopy, NULL);
+	if (myErr != noErr)
+		goto bail;
+
+	// resample the decoded image to the size of the buffer
+	if (myTarget != theBuffer)
+		myErr = QTNative_ResamplePixelBuffer(myTarget, theBuffer, QTNative_GetResampleFilter(kSourceResampleQuality));
+
+bail:
+	if (myErr != noErr)
+		QTNative_DisposePixelBuffer(theBuffer);
+
+	QTNative_DisposePixelBuffer(&myDecodeBuffer);
+
+	if (myData != NULL)
+		free(myData);
+
+	if (myDesc != NULL)
+		DisposeHandle((Handle)myDesc);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_GetPixelBufferAsPixMap
+// Describe the pixels of the specified 32-bit native pixel buffer to the Image Compression Manager. Unlike a GWorld,
+// a pixel map is just a record, so this may be called on any thread; but the buffer's rows must be short enough for
+// the rowBytes field of a pixel map.
+//
+//////////
+
+static OSErr QTEffects_GetPixelBufferAsPixMap (const NativePixelBuffer *theBuffer, PixMap *thePixMap)
+{
+	memset(thePixMap, 0, sizeof(PixMap));
+
+	if ((theBuffer->fPixelFormat != kNativePixelFormat_32ARGB) || (theBuffer->fRowBytes > kMaxPixMapRowBytes))
+		return(paramErr);
+
+	thePixMap->baseAddr = (Ptr)theBuffer->fBaseAddr;
+	thePixMap->rowBytes = (short)(theBuffer->fRowBytes | 0x8000);		// the high bit marks a pixel map
+	MacSetRect(&thePixMap->bounds, 0, 0, theBuffer->fWidth, theBuffer->fHeight);
+	thePixMap->hRes = 72L << 16;
+	thePixMap->vRes = 72L << 16;
+	thePixMap->pixelType = RGBDirect;
+	thePixMap->pixelSize = 32;
+	thePixMap->cmpCount = 3;
+	thePixMap->cmpSize = 8;
+	thePixMap->pixelFormat = k32ARGBPixelFormat;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTEffects_GetPixelBufferAsGWorld
+// Create a new GWorld of the specified depth, the size of the specified 32-bit native pixel buffer, and copy the
+// buffer into it. This uses QuickDraw, so it must be called on the main thread.
+//
+//////////
+
+OSErr QTEffects_GetPixelBufferAsGWorld (const NativePixelBuffer *theBuffer, short theDepth, GWorldPtr *theGW)
+{
+	GWorldPtr					myBufferGW = NULL;
+	Rect						myRect;
+	OSErr						myErr = noErr;
+
+	*theGW = NULL;
+
+	if ((theBuffer->fBaseAddr == NULL) || (theBuffer->fPixelFormat != kNativePixelFormat_32ARGB) || (theBuffer->fRowBytes > kMaxPixMapRowBytes))
+		return(paramErr);
+
+	MacSetRect(&myRect, 0, 0, theBuffer->fWidth, theBuffer->fHeight);
+
+	myErr = QTNewGWorld(theGW, theDepth, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	if (myErr != noErr)
+		goto bail;
+
+	// a GWorld that uses the buffer's pixels, so that QTEffects_ResampleGWorld can copy them (with QuickDraw, if the
+	// new GWorld is indexed)
+	myErr = QTNewGWorldFromPtr(&myBufferGW, k32ARGBPixelFormat, &myRect, NULL, NULL, 0, (Ptr)theBuffer->fBaseAddr, theBuffer->fRowBytes);
+	if (myErr != noErr)
+		goto bail;
+
+	QTEffects_ResampleGWorld(myBufferGW, *theGW);
+
+bail:
+	if (myBufferGW != NULL)
+		DisposeGWorld(myBufferGW);
+
+	if ((myErr != noErr) && (*theGW != NULL)) {
+		DisposeGWorld(*theGW);
+		*theGW = NULL;
+	}
+
+	return(myErr);
+}
+#endif	// USES_NATIVE_RENDERER
+
+
+//////////
+//
+// QTEffects_DrawImporterIntoGWorld
+// Draw the image of the specified graphics importer into the specified GWorld, scaled to fill it.
+//
+// A large image (a photo from a digital camera, say) is decoded at a fraction of its natural size (a half,
+// a quarter, or an eighth, whichever is the smallest that's still at least as large as the GWorld), and then
+// resampled to the size of the GWorld. The JPEG decompressor can decode at those sizes directly from the DCT
+// coefficients, and other decompressors can skip pixels, so that's much faster than decoding every pixel and
+// throwing most of them away; and the native resampler gives a smoother result than the importer's scaling.
+//
+//////////
+
+OSErr QTEffects_DrawImporterIntoGWorld (GraphicsImportComponent theImporter, GWorldPtr theGW)
+{
+	GWorldPtr					myDecodeGW = NULL;
+	void						*myDecodePixels = NULL;
+	Rect						myRect;
+	Rect						myNaturalRect;
+	Rect						myDecodeRect;
+	short						myShift;
+	OSErr						myErr = noErr;
+
+#if TARGET_OS_MAC
+	GetPortBounds(theGW, &myRect);
+#endif
+#if TARGET_OS_WIN32
+	myRect = theGW->portRect;
+#endif
+
+	myErr = GraphicsImportGetNaturalBounds(theImporter, &myNaturalRect);
+	if (myErr != noErr)
+		goto bail;
+
+	// if the image is already the size of the GWorld, there's nothing to scale
+	if (((myNaturalRect.right - myNaturalRect.left) == (myRect.right - myRect.left)) &&
+		((myNaturalRect.bottom - myNaturalRect.top) == (myRect.bottom - myRect.top))) {
+		GraphicsImportSetGWorld(theImporter, theGW, NULL);
+		GraphicsImportSetBoundsRect(theImporter, &myRect);
+		myErr = GraphicsImportDraw(theImporter);
+		goto bail;
+	}
+
+	// decode the image at the smallest power-of-two fraction of its size that's still at least as large as the GWorld
+	myShift = QTNative_GetDecodeShift(myNaturalRect.right - myNaturalRect.left, myNaturalRect.bottom - myNaturalRect.top,
+									  myRect.right - myRect.left, myRect.bottom - myRect.top);
+
+	MacSetRect(&myDecodeRect, 0, 0, (myNaturalRect.right - myNaturalRect.left) >> myShift, (myNaturalRect.bottom - myNaturalRect.top) >> myShift);
+
+	myErr = QTEffects_NewPooledGWorld(&myDecodeGW, &myDecodeRect, &myDecodePixels);
+	if (myErr != noErr)
+		goto bail;
+
+	LockPixels(GetGWorldPixMap(myDecodeGW));
+
+	GraphicsImportSetGWorld(theImporter, myDecodeGW, NULL);
+	GraphicsImportSetBoundsRect(theImporter, &myDecodeRect);
+	myErr = GraphicsImportDraw(theImporter);
+	if (myErr != noErr)
+		goto bail;
+
+	// resample the decoded image to the size of the GWorld
+	QTEffects_ResampleGWorld(myDecodeGW, theGW);
+
+bail:
+	if (myDecodeGW != NULL)
+		QTEffects_DisposePooledGWorld(myDecodeGW, myDecodePixels);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTEffects_ResampleGWorld
+// Scale the picture in the source GWorld to fill the destination GWorld, with the native resampler (using the filter
+// for kSourceResampleQuality). The native resampler can't write into an indexed GWorld, so QuickDraw does that.
+//
+//////////
+
+void QTEffects_ResampleGWorld (GWorldPtr theSrcGW, GWorldPtr theDestGW)
+{
+	Rect						mySrcRect;
+	Rect						myDestRect;
+	OSErr						myErr = paramErr;
+
+#if TARGET_OS_MAC
+	GetPortBounds(theSrcGW, &mySrcRect);
+	GetPortBounds(theDestGW, &myDestRect);
+#endif
+#if TARGET_OS_WIN32
+	mySrcRect = theSrcGW->portRect;
+	myDestRect = theDestGW->portRect;
+#endif
+
+	LockPixels(GetGWorldPixMap(theSrcGW));
+	LockPixels(GetGWorldPixMap(theDestGW));
+
+#if USES_NATIVE_RENDERER
+	{
+		NativePixelBuffer		mySrc;
+		NativePixelBuffer		myDest;
+		unsigned long			mySrcColorTable[256];
+		unsigned long			myDestColorTable[256];
+
+		myErr = QTEffects_GetGWorldAsPixelBuffer(theSrcGW, &mySrc, mySrcColorTable);
+		if (myErr == noErr)
+			myErr = QTEffects_GetGWorldAsPixelBuffer(theDestGW, &myDest, myDestColorTable);
+		if (myErr == noErr)
+			myErr = QTNative_ResamplePixelBuffer(&mySrc, &myDest, QTNative_GetResampleFilter(kSourceResampleQuality));
+	}
+#endif
+
+	if (myErr != noErr)
+		CopyBits(	(BitMapPtr)*GetGWorldPixMap(theSrcGW),
+					(BitMapPtr)*GetGWorldPixMap(theDestGW),
+					&mySrcRect,
+					&myDestRect,
+					ditherCopy,
+					NULL);
+}
+
+
+//////////
+//
+// QTEffects_NewPooledGWorld
+// Create a 32-bit GWorld of the specified size whose pixels come from the native frame pool, so that its rows
+// start on kNativePoolAlignment boundaries and its pixels are used again once it's disposed of; return the pixels
+// through thePixels. If the rows are too long for a pixel map, or the pool has no memory, QuickTime allocates the
+// pixels instead, and thePixels is NULL. Dispose of the GWorld with QTEffects_DisposePooledGWorld.
+//
+//////////
+
+OSErr QTEffects_NewPooledGWorld (GWorldPtr *theGW, const Rect *theRect, void **thePixels)
+{
+	long						myRowBytes;
+	OSErr						myErr = noErr;
+
+	*theGW = NULL;
+	*thePixels = NULL;
+
+	myRowBytes = QTNative_GetPoolRowBytes(theRect->right - theRect->left, 4);
+	if (myRowBytes <= kMaxPixMapRowBytes)
+		*thePixels = QTNative_NewPoolBlock(myRowBytes * (theRect->bottom - theRect->top));
+
+	if (*thePixels != NULL) {
+		myErr = QTNewGWorldFromPtr(theGW, k32ARGBPixelFormat, theRect, NULL, NULL, 0, (Ptr)*thePixels, myRowBytes);
+		if (myErr == noErr)
+			return(noErr);
+
+		QTNative_DisposePoolBlock(*thePixels);
+		*thePixels = NULL;
+	}
+
+	return(QTNewGWorld(theGW, k32ARGBPixelFormat, theRect, NULL, NULL, kICMTempThenAppMemory));
+}
+
+
+//////////
+//
+// QTEffects_DisposePooledGWorld
+// Dispose of a GWorld created by QTEffects_NewPooledGWorld, giving its pixels back to the frame pool.
+//
+//////////
+
+void QTEffects_DisposePooledGWorld (GWorldPtr theGW, void *thePixels)
+{
+	if (theGW != NULL)
+		DisposeGWorld(theGW);
+
+	QTNative_DisposePoolBlock(thePixels);
+}
+
+
+//////////
+//
+// QTEffects_AddVideoTrackFromGWorld
+// Add to the specified movie a video track for the specified picture resource.
+//
+//////////
+
+OSErr QTEffects_AddVideoTrackFromGWorld (Movie *theMovie, GWorldPtr theGW, Track *theSourceTrack, long theStartTime, short theWidth, short theHeight)
+{
+	Media						myMedia;
+	ImageDescriptionHandle		myDesc = NULL;
+	Rect						myRect;
+	Rect						myRect2;
+	Rect						myRect3;
+	long						mySize;
+	Handle						myData = NULL;
+	Ptr							myDataPtr = NULL;
+	GWorldPtr					myGWorld = NULL;
+	void						*myPixels = NULL;
+	CGrafPtr 					mySavedPort = NULL;
+	GDHandle 					mySavedGDevice = NULL;
+	PicHandle					myHandle = NULL;
+	PixMapHandle				mySrcPixMap = NULL;
+	PixMapHandle				myDstPixMap = NULL;
+	OSErr						myErr = noErr;
+	
+	// get the current port and device
+	GetGWorld(&mySavedPort, &mySavedGDevice);
+	
+	// create a video track in the movie
+	*theSourceTrack = NewMovieTrack(*theMovie, FixRatio(theWidth, 1), FixRatio(theHeight, 1), kNoVolume);
+	myMedia = NewTrackMedia(*theSourceTrack, VideoMediaType, kOneSecond, NULL, 0);
+	
+	// get the rectangle for the movie
+	GetMovieBox(*theMovie, &myRect);
+	
+	// begin editing the new track
+	BeginMediaEdits(myMedia);
+		
+	// create a new GWorld; we draw the picture into this GWorld and then compress it
+	// (note that we are creating a picture with the maximum bit depth)
+	myErr = QTEffects_NewPooledGWorld(&myGWorld, &myRect, &myPixels);
+	if (myErr != noErr)
 		goto bail;
+	
+	mySrcPixMap = GetGWorldPixMap(theGW);
+	// LockPixels(mySrcPixMap);
+	
+	myDstPixMap = GetGWorldPixMap(myGWorld);
+	LockPixels(myDstPixMap);
+	
+	// create a new image description; CompressImage will fill in the fields of this structure
+	myDesc = (ImageDescriptionHandle)NewHandle(4);
+	
+	SetGWorld(myGWorld, NULL);
+#if TARGET_OS_MAC
+	GetPortBounds(theGW, &myRect2);
+	GetPortBounds(myGWorld, &myRect3);
+#endif
+#if TARGET_OS_WIN32
+	myRect2 = theGW->portRect;
+	myRect3 = myGWorld->portRect;
+#endif
+
+	// copy the image from the specified GWorld into the new GWorld; the native conversion kernels change the pixel
+	// format (and scale the image, if the sizes differ) much faster than CopyBits, which does it if they can't
+#if USES_NATIVE_RENDERER
+	{
+		NativePixelBuffer		mySrc;
+		NativePixelBuffer		myDest;
+		unsigned long			mySrcColorTable[256];
+		unsigned long			myDestColorTable[256];
+
+		myErr = QTEffects_GetGWorldAsPixelBuffer(theGW, &mySrc, mySrcColorTable);
+		if (myErr == noErr)
+			myErr = QTEffects_GetGWorldAsPixelBuffer(myGWorld, &myDest, myDestColorTable);
+		if (myErr == noErr)
+			myErr = QTNative_ConvertAndScalePixelBuffer(&mySrc, &myDest, QTNative_GetResampleFilter(kSourceResampleQuality));
+	}
+
+	if (myErr != noErr)
+#endif
+	CopyBits(	
+				(BitMapPtr)*mySrcPixMap,
+				(BitMapPtr)*myDstPixMap,
+				&myRect2,
+				&myRect3,
+				srcCopy,
+				NULL);
+
+	// restore the original port and device
+	SetGWorld(mySavedPort, mySavedGDevice);
+	
+	// compress the picture with the native Animation encoder; if it can't, CompressImage does it
+#if USES_NATIVE_RENDERER
+	myErr = QTEffects_CompressGWorldNatively(myGWorld, myDesc, &myData);
+	if (myErr != noErr)
+#endif
+	{
+		myErr = GetMaxCompressionSize(myDstPixMap, &myRect, 0, codecNormalQuality, kAnimationCodecType, anyCodec, &mySize);
+		if (myErr != noErr)
+			goto bail;
+			
+		myData = NewHandle(mySize);
+		if (myData == NULL)
+			goto bail;
+			
+		HLockHi(myData);
+#if TARGET_CPU_68K
+		myDataPtr = StripAddress(*myData);
+#else
+		myDataPtr = *myData;
+#endif
+		myErr = CompressImage(myDstPixMap, &myRect, codecNormalQuality, kAnimationCodecType, myDesc, myDataPtr);
+		if (myErr != noErr)
+			goto bail;
+	}
 		
 	myErr = AddMediaSample(myMedia, myData, 0, (**myDesc).dataSize, kEffectMovieDuration, (SampleDescriptionHandle)myDesc, 1, 0, NULL);
 	if (myErr != noErr)
@@ -1792,12 +3391,86 @@ bail:
 		UnlockPixels(myDstPixMap);
 		
 	if (myGWorld != NULL)
-		DisposeGWorld(myGWorld);
+		QTEffects_DisposePooledGWorld(myGWorld, myPixels);
 	
 	return(myErr);
 }
 
 
+#if USES_NATIVE_RENDERER
+//////////
+//
+// QTEffects_CompressGWorldNatively
+// Compress the picture in the specified 32-bit GWorld with the native Animation encoder, as CompressImage does
+// with kAnimationCodecType; fill in the specified image description, and return the compressed data in a new handle.
+//
+//////////
+
+OSErr QTEffects_CompressGWorldNatively (GWorldPtr theGW, ImageDescriptionHandle theDesc, Handle *theData)
+{
+	NativeAnimationEncoder		myEncoder;
+	NativePixelBuffer			myFrame;
+	unsigned long				myColorTable[256];
+	const unsigned char			*mySample = NULL;
+	long						mySize;
+	Boolean						isKeyFrame;
+	OSErr						myErr = noErr;
+
+	*theData = NULL;
+	memset(&myEncoder, 0, sizeof(myEncoder));
+
+	myErr = QTEffects_GetGWorldAsPixelBuffer(theGW, &myFrame, myColorTable);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTNative_NewAnimationEncoder(myFrame.fWidth, myFrame.fHeight, &myEncoder);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTNative_EncodeAnimationFrame(&myEncoder, &myFrame, &mySample, &mySize, &isKeyFrame);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = PtrToHand(mySample, theData, mySize);
+	if (myErr != noErr)
+		goto bail;
+
+	// describe the data just as CompressImage would
+	SetHandleSize((Handle)theDesc, sizeof(ImageDescription));
+	myErr = MemError();
+	if (myErr != noErr)
+		goto bail;
+
+	memset(*theDesc, 0, sizeof(ImageDescription));
+	(**theDesc).idSize = sizeof(ImageDescription);
+	(**theDesc).cType = kAnimationCodecType;
+	(**theDesc).vendor = kAppleManufacturer;
+	(**theDesc).temporalQuality = codecNormalQuality;
+	(**theDesc).spatialQuality = codecNormalQuality;
+	(**theDesc).width = (short)myFrame.fWidth;
+	(**theDesc).height = (short)myFrame.fHeight;
+	(**theDesc).hRes = 72L << 16;
+	(**theDesc).vRes = 72L << 16;
+	(**theDesc).dataSize = mySize;
+	(**theDesc).frameCount = 1;
+	(**theDesc).name[0] = (unsigned char)strlen(kNativeAnimationCompressorName);
+	memcpy(&(**theDesc).name[1], kNativeAnimationCompressorName, (**theDesc).name[0]);
+	(**theDesc).depth = kNativeAnimationDepth;
+	(**theDesc).clutID = -1;
+
+bail:
+	if ((myErr != noErr) && (*theData != NULL)) {
+		DisposeHandle(*theData);
+		*theData = NULL;
+	}
+
+	QTNative_DisposeAnimationEncoder(&myEncoder);
+
+	return(myErr);
+}
+#endif
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Movie utilities.
@@ -101,6 +101,82 @@ SOURCE=".\Common Files\ComFramework.c"
 # End Source File
 # Begin Source File
 
+SOURCE=.\QTNativeAnimation.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeBlend.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvert.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvolve.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeCPU.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeEffects.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFormats.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFrameCache.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFramePool.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGenerators.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGraph.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeKey.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeLoader.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeNoise.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativePipeline.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeRawFile.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeResample.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeSourceCache.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeThreads.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\QTShowEffect.c
 # End Source File
 # Begin Source File
@@ -160,6 +236,82 @@ SOURCE=".\Application Files\ComApplication.h"
 # End Source File
 # Begin Source File
 
+SOURCE=.\QTNativeAnimation.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeBlend.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvert.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeConvolve.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeCPU.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeEffects.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFormats.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFrameCache.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeFramePool.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGenerators.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeGraph.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeKey.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeLoader.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeNoise.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativePipeline.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeRawFile.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeResample.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeSourceCache.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTNativeThreads.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\QTShowEffect.h
 # End Source File
 # Begin Source File
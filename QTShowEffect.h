@@ -51,6 +51,20 @@
 #include "WinFramework.h"
 #endif
 
+#include "QTNativeEffects.h"
+#include "QTNativeAnimation.h"
+#include "QTNativeBlend.h"
+#include "QTNativeConvert.h"
+#include "QTNativeFrameCache.h"
+#include "QTNativeFramePool.h"
+#include "QTNativeGenerators.h"
+#include "QTNativeLoader.h"
+#include "QTNativePipeline.h"
+#include "QTNativeRawFile.h"
+#include "QTNativeResample.h"
+#include "QTNativeSourceCache.h"
+#include "QTNativeThreads.h"
+
 
 //////////
 //
@@ -60,6 +74,7 @@
 
 #define USES_MAKE_IMAGE_DESC_FOR_EFFECT	1		// use MakeImageDescriptionForEffect (QT 4.0 and later)
 #define ALLOW_COMPOUND_EFFECTS			0		// add a compound effect to the output effects movie?
+#define USES_NATIVE_RENDERER			1		// render effects that have a native implementation without the effect component?
 
 
 //////////
@@ -124,6 +139,19 @@
 #define kEffectMovieDuration			(5 * kOneSecond)
 #define k30StepsCount					30
 #define kWindowOffset					75
+#define kNativeFrameCacheSize			(32L * 1024L * 1024L)		// the most memory we use for cached effect steps
+#define kNativeSourceCacheSize			(16L * 1024L * 1024L)		// the most memory we use for cached source pictures
+#define kNativeFramePoolSize			(64L * 1024L * 1024L)		// the most memory we keep in freed frames and scratch rows
+#define kNativeCheckpointInterval		16							// the number of steps between checkpoints of the fire and water effects
+#define kSourceResampleQuality			codecHighQuality			// the quality of the filter that scales source pictures to fit
+#define kNumMappedSources				2							// the number of source GWorlds that can use the pages of a raw frame file
+#define kMaxSourcePathLength			1024
+#define kMaxPixMapRowBytes				0x3FFE						// the high bits of a pixel map's rowBytes are flags
+
+// the sources of the effect, as numbered by the background loader
+#define kFirstSource					0
+#define kSecondSource					1
+#define kNumSources						2
 
 #define kSaveEffectMoviePrompt			"Save effect movie file as:"
 #define kSaveEffectMovieFileName		"Effect.mov"
@@ -159,6 +187,29 @@ typedef struct {
 	TimeValue				fTime;
 } StateInformation;
 
+#if USES_NATIVE_RENDERER
+// a structure to hold information about a batch of effect steps that are being rendered in parallel
+typedef struct {
+	const NativePipeline	*fPipeline;						// the effects to render
+	long					fNumberOfSteps;
+	const NativePixelBuffer	*fSources[2];
+	NativePixelBuffer		*fSteps;						// one buffer for each step in the batch
+	TimeValue				*fStepNumbers;					// the step rendered into each buffer
+} NativeStepsInformation;
+
+// a source picture to be decoded by the background loader (see QTEffects_GetPictureInBackground)
+typedef struct {
+	FSSpec					fFSSpec;
+	char					fPath[kMaxSourcePathLength];
+	NativeSourceKey			fKey;							// fKey.fPath points to fPath
+	Boolean					fHaveKey;						// false if the file has no pathname
+	short					fWidth;
+	short					fHeight;
+	short					fDepth;
+	NativePixelBuffer		fPixels;						// the decoded picture, fitted to fWidth by fHeight, in 32-bit ARGB
+} SourceLoadJob;
+#endif
+
 
 //////////
 //
@@ -196,10 +247,47 @@ OSErr						QTEffects_AddTrackReferenceToInputMap (QTAtomContainer theInputMap, T
 OSErr						QTEffects_SetUpEffectSequence (void);
 ImageDescriptionHandle		QTEffects_MakeSampleDescription (OSType theEffectType, short theWidth, short theHeight);
 OSErr						QTEffects_RunEffect (TimeValue theTime);
+#if USES_NATIVE_RENDERER
+OSErr						QTEffects_RunNativeEffect (TimeValue theTime);
+OSErr						QTEffects_RunNativeEffectSteps (TimeValue theFirstStep, TimeValue theLastStep);
+static OSErr				QTEffects_RenderNativeStep (void *theRefCon, long theIndex);
+OSErr						QTEffects_GetNativeBuffers (NativePixelBuffer *theSrc1, NativePixelBuffer *theSrc2, NativePixelBuffer *theDest);
+void						QTEffects_DrawNativeGWorld (void);
+void						QTEffects_BuildNativePipeline (void);
+void						QTEffects_UpdateNativeFrameKeys (void);
+void						QTEffects_GetNativeFrameKey (TimeValue theStep, const NativePixelBuffer *theDest, NativeFrameKey *theKey);
+OSErr						QTEffects_GetNativeEffectParams (QTAtomContainer theEffectDesc, OSType theEffectType, NativeEffectParams *theParams);
+OSErr						QTEffects_GetGWorldAsPixelBuffer (GWorldPtr theGW, NativePixelBuffer *theBuffer, unsigned long *theColorTable);
+#endif
 
 OSErr						QTEffects_GetPictResourceAsGWorld (short theResID, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW);
 OSErr						QTEffects_GetPictureAsGWorld (short theWidth, short theHeight, short theDepth, GWorldPtr *theGW);
+OSErr						QTEffects_SelectPictureFile (FSSpec *theFSSpec);
+OSErr						QTEffects_GetPictureFileAsGWorld (FSSpec *theFSSpec, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW);
+void						QTEffects_DisposeSourceGWorld (GWorldPtr theGW);
+#if USES_NATIVE_RENDERER
+OSErr						QTEffects_GetRawFileAsGWorld (FSSpec *theFSSpec, short theWidth, short theHeight, short theDepth, GWorldPtr *theGW);
+OSErr						QTEffects_GetCachedSourceAsGWorld (const NativeSourceKey *theKey, GWorldPtr *theGW);
+OSErr						QTEffects_GetSourcePath (FSSpec *theFSSpec, char *thePath, long theLength);
+void						QTEffects_AddGWorldToSourceCache (const NativeSourceKey *theKey, GWorldPtr theGW);
+OSErr						QTEffects_GetPictureInBackground (short theSource, short theWidth, short theHeight, short theDepth);
+void						QTEffects_InstallLoadedSources (void);
+void						QTEffects_SourceChanged (short theSource);
+static OSErr				QTEffects_LoadSourceJob (void *theJob, short theSource, unsigned long theGeneration);
+static void					QTEffects_DisposeSourceJob (void *theJob);
+static void					QTEffects_SourceJobReady (void *theRefCon, short theSource);
+static OSErr				QTEffects_DecodeImporterIntoPixelBuffer (GraphicsImportComponent theImporter, short theWidth, short theHeight, NativePixelBuffer *theBuffer);
+static OSErr				QTEffects_GetPixelBufferAsPixMap (const NativePixelBuffer *theBuffer, PixMap *thePixMap);
+OSErr						QTEffects_GetPixelBufferAsGWorld (const NativePixelBuffer *theBuffer, short theDepth, GWorldPtr *theGW);
+#endif
+OSErr						QTEffects_DrawImporterIntoGWorld (GraphicsImportComponent theImporter, GWorldPtr theGW);
+void						QTEffects_ResampleGWorld (GWorldPtr theSrcGW, GWorldPtr theDestGW);
+OSErr						QTEffects_NewPooledGWorld (GWorldPtr *theGW, const Rect *theRect, void **thePixels);
+void						QTEffects_DisposePooledGWorld (GWorldPtr theGW, void *thePixels);
 OSErr						QTEffects_AddVideoTrackFromGWorld (Movie *theMovie, GWorldPtr theGW, Track *theSourceTrack, long theStartTime, short theWidth, short theHeight);
+#if USES_NATIVE_RENDERER
+OSErr						QTEffects_CompressGWorldNatively (GWorldPtr theGW, ImageDescriptionHandle theDesc, Handle *theData);
+#endif
 
 void						QTEffects_CreateEffectsMovie (OSType theEffectType, QTAtomContainer theEffectDesc, short theWidth, short theHeight);
 void						QTEffects_NewCreateEffectsMovie (OSType theEffectType, QTAtomContainer theEffectDesc, short theWidth, short theHeight);
@@ -53,6 +53,25 @@ ALL : "$(OutDir)\resource.frk\$(TargetName)" "$(OUTDIR)\QTShowEffect.exe"
 CLEAN :
 	-@erase "$(INTDIR)\ComApplication.obj"
 	-@erase "$(INTDIR)\ComFramework.obj"
+	-@erase "$(INTDIR)\QTNativeAnimation.obj"
+	-@erase "$(INTDIR)\QTNativeBlend.obj"
+	-@erase "$(INTDIR)\QTNativeConvert.obj"
+	-@erase "$(INTDIR)\QTNativeConvolve.obj"
+	-@erase "$(INTDIR)\QTNativeCPU.obj"
+	-@erase "$(INTDIR)\QTNativeEffects.obj"
+	-@erase "$(INTDIR)\QTNativeFormats.obj"
+	-@erase "$(INTDIR)\QTNativeFrameCache.obj"
+	-@erase "$(INTDIR)\QTNativeFramePool.obj"
+	-@erase "$(INTDIR)\QTNativeGenerators.obj"
+	-@erase "$(INTDIR)\QTNativeGraph.obj"
+	-@erase "$(INTDIR)\QTNativeKey.obj"
+	-@erase "$(INTDIR)\QTNativeLoader.obj"
+	-@erase "$(INTDIR)\QTNativeNoise.obj"
+	-@erase "$(INTDIR)\QTNativePipeline.obj"
+	-@erase "$(INTDIR)\QTNativeRawFile.obj"
+	-@erase "$(INTDIR)\QTNativeResample.obj"
+	-@erase "$(INTDIR)\QTNativeSourceCache.obj"
+	-@erase "$(INTDIR)\QTNativeThreads.obj"
 	-@erase "$(INTDIR)\QTShowEffect.obj"
 	-@erase "$(INTDIR)\QTShowEffect.res"
 	-@erase "$(INTDIR)\QTUtilities.obj"
@@ -85,6 +104,25 @@ LINK32_FLAGS=..\..\QTDevWin\Libraries\qtmlclient.lib kernel32.lib user32.lib\
 LINK32_OBJS= \
 	"$(INTDIR)\ComApplication.obj" \
 	"$(INTDIR)\ComFramework.obj" \
+	"$(INTDIR)\QTNativeAnimation.obj" \
+	"$(INTDIR)\QTNativeBlend.obj" \
+	"$(INTDIR)\QTNativeConvert.obj" \
+	"$(INTDIR)\QTNativeConvolve.obj" \
+	"$(INTDIR)\QTNativeCPU.obj" \
+	"$(INTDIR)\QTNativeEffects.obj" \
+	"$(INTDIR)\QTNativeFormats.obj" \
+	"$(INTDIR)\QTNativeFrameCache.obj" \
+	"$(INTDIR)\QTNativeFramePool.obj" \
+	"$(INTDIR)\QTNativeGenerators.obj" \
+	"$(INTDIR)\QTNativeGraph.obj" \
+	"$(INTDIR)\QTNativeKey.obj" \
+	"$(INTDIR)\QTNativeLoader.obj" \
+	"$(INTDIR)\QTNativeNoise.obj" \
+	"$(INTDIR)\QTNativePipeline.obj" \
+	"$(INTDIR)\QTNativeRawFile.obj" \
+	"$(INTDIR)\QTNativeResample.obj" \
+	"$(INTDIR)\QTNativeSourceCache.obj" \
+	"$(INTDIR)\QTNativeThreads.obj" \
 	"$(INTDIR)\QTShowEffect.obj" \
 	"$(INTDIR)\QTShowEffect.res" \
 	"$(INTDIR)\QTUtilities.obj" \
@@ -117,6 +155,25 @@ ALL : "$(OutDir)\resource.frk\$(TargetName)" "$(OUTDIR)\QTShowEffect.exe"
 CLEAN :
 	-@erase "$(INTDIR)\ComApplication.obj"
 	-@erase "$(INTDIR)\ComFramework.obj"
+	-@erase "$(INTDIR)\QTNativeAnimation.obj"
+	-@erase "$(INTDIR)\QTNativeBlend.obj"
+	-@erase "$(INTDIR)\QTNativeConvert.obj"
+	-@erase "$(INTDIR)\QTNativeConvolve.obj"
+	-@erase "$(INTDIR)\QTNativeCPU.obj"
+	-@erase "$(INTDIR)\QTNativeEffects.obj"
+	-@erase "$(INTDIR)\QTNativeFormats.obj"
+	-@erase "$(INTDIR)\QTNativeFrameCache.obj"
+	-@erase "$(INTDIR)\QTNativeFramePool.obj"
+	-@erase "$(INTDIR)\QTNativeGenerators.obj"
+	-@erase "$(INTDIR)\QTNativeGraph.obj"
+	-@erase "$(INTDIR)\QTNativeKey.obj"
+	-@erase "$(INTDIR)\QTNativeLoader.obj"
+	-@erase "$(INTDIR)\QTNativeNoise.obj"
+	-@erase "$(INTDIR)\QTNativePipeline.obj"
+	-@erase "$(INTDIR)\QTNativeRawFile.obj"
+	-@erase "$(INTDIR)\QTNativeResample.obj"
+	-@erase "$(INTDIR)\QTNativeSourceCache.obj"
+	-@erase "$(INTDIR)\QTNativeThreads.obj"
 	-@erase "$(INTDIR)\QTShowEffect.obj"
 	-@erase "$(INTDIR)\QTShowEffect.res"
 	-@erase "$(INTDIR)\QTUtilities.obj"
@@ -152,6 +209,25 @@ LINK32_FLAGS=..\..\QTDevWin\Libraries\qtmlclient.lib kernel32.lib user32.lib\
 LINK32_OBJS= \
 	"$(INTDIR)\ComApplication.obj" \
 	"$(INTDIR)\ComFramework.obj" \
+	"$(INTDIR)\QTNativeAnimation.obj" \
+	"$(INTDIR)\QTNativeBlend.obj" \
+	"$(INTDIR)\QTNativeConvert.obj" \
+	"$(INTDIR)\QTNativeConvolve.obj" \
+	"$(INTDIR)\QTNativeCPU.obj" \
+	"$(INTDIR)\QTNativeEffects.obj" \
+	"$(INTDIR)\QTNativeFormats.obj" \
+	"$(INTDIR)\QTNativeFrameCache.obj" \
+	"$(INTDIR)\QTNativeFramePool.obj" \
+	"$(INTDIR)\QTNativeGenerators.obj" \
+	"$(INTDIR)\QTNativeGraph.obj" \
+	"$(INTDIR)\QTNativeKey.obj" \
+	"$(INTDIR)\QTNativeLoader.obj" \
+	"$(INTDIR)\QTNativeNoise.obj" \
+	"$(INTDIR)\QTNativePipeline.obj" \
+	"$(INTDIR)\QTNativeRawFile.obj" \
+	"$(INTDIR)\QTNativeResample.obj" \
+	"$(INTDIR)\QTNativeSourceCache.obj" \
+	"$(INTDIR)\QTNativeThreads.obj" \
 	"$(INTDIR)\QTShowEffect.obj" \
 	"$(INTDIR)\QTShowEffect.res" \
 	"$(INTDIR)\QTUtilities.obj" \
@@ -282,6 +358,19 @@ DEP_CPP_COMAP=\
 	".\Common Files\QTUtilities.h"\
 	".\Common Files\WinFramework.h"\
 	".\common files\winprefix.h"\
+	".\QTNativeAnimation.h"\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvert.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFrameCache.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeGenerators.h"\
+	".\QTNativeLoader.h"\
+	".\QTNativePipeline.h"\
+	".\QTNativeRawFile.h"\
+	".\QTNativeResample.h"\
+	".\QTNativeSourceCache.h"\
+	".\QTNativeThreads.h"\
 	".\QTShowEffect.h"\
 	
 
@@ -372,6 +461,8 @@ DEP_CPP_COMAP=\
 	".\Common Files\QTUtilities.h"\
 	".\Common Files\WinFramework.h"\
 	".\common files\winprefix.h"\
+	".\QTNativeBlend.h"\
+	".\QTNativeEffects.h"\
 	".\QTShowEffect.h"\
 	
 
@@ -541,6 +632,248 @@ DEP_CPP_COMFR=\
 
 !ENDIF 
 
+SOURCE=.\QTNativeEffects.c
+DEP_CPP_QTNAT=\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvolve.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeGenerators.h"\
+	".\QTNativeKey.h"\
+	".\QTNativeNoise.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeEffects.obj" : $(SOURCE) $(DEP_CPP_QTNAT) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeBlend.c
+DEP_CPP_QTNATI=\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	
+
+"$(INTDIR)\QTNativeBlend.obj" : $(SOURCE) $(DEP_CPP_QTNATI) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeCPU.c
+DEP_CPP_QTNATIV=\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	
+
+"$(INTDIR)\QTNativeCPU.obj" : $(SOURCE) $(DEP_CPP_QTNATIV) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeThreads.c
+DEP_CPP_QTNATIVE=\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeThreads.obj" : $(SOURCE) $(DEP_CPP_QTNATIVE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeFrameCache.c
+DEP_CPP_QTNATIVEF=\
+	".\QTNativeEffects.h"\
+	".\QTNativeFrameCache.h"\
+	
+
+"$(INTDIR)\QTNativeFrameCache.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEF) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeFormats.c
+DEP_CPP_QTNATIVEFO=\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	
+
+"$(INTDIR)\QTNativeFormats.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEFO) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeNoise.c
+DEP_CPP_QTNATIVEN=\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeNoise.h"\
+	
+
+"$(INTDIR)\QTNativeNoise.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEN) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeConvolve.c
+DEP_CPP_QTNATIVEC=\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvolve.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	
+
+"$(INTDIR)\QTNativeConvolve.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEC) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeKey.c
+DEP_CPP_QTNATIVEK=\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeKey.h"\
+	
+
+"$(INTDIR)\QTNativeKey.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEK) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativePipeline.c
+DEP_CPP_QTNATIVEP=\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativePipeline.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativePipeline.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEP) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeGraph.c
+DEP_CPP_QTNATIVEG=\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeGraph.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeGraph.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEG) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeGenerators.c
+DEP_CPP_QTNATIVEGE=\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeGenerators.h"\
+	".\QTNativeNoise.h"\
+	
+
+"$(INTDIR)\QTNativeGenerators.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEGE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeResample.c
+DEP_CPP_QTNATIVER=\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvert.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeResample.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeResample.obj" : $(SOURCE) $(DEP_CPP_QTNATIVER) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeRawFile.c
+DEP_CPP_QTNATIVERA=\
+	".\QTNativeEffects.h"\
+	".\QTNativeRawFile.h"\
+	
+
+"$(INTDIR)\QTNativeRawFile.obj" : $(SOURCE) $(DEP_CPP_QTNATIVERA) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeConvert.c
+DEP_CPP_QTNATIVECO=\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvert.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeResample.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeConvert.obj" : $(SOURCE) $(DEP_CPP_QTNATIVECO) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeSourceCache.c
+DEP_CPP_QTNATIVES=\
+	".\QTNativeEffects.h"\
+	".\QTNativeSourceCache.h"\
+	
+
+"$(INTDIR)\QTNativeSourceCache.obj" : $(SOURCE) $(DEP_CPP_QTNATIVES) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeLoader.c
+DEP_CPP_QTNATIVEL=\
+	".\QTNativeEffects.h"\
+	".\QTNativeLoader.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeLoader.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEL) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeFramePool.c
+DEP_CPP_QTNATIVEFR=\
+	".\QTNativeEffects.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeFramePool.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEFR) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTNativeAnimation.c
+DEP_CPP_QTNATIVEA=\
+	".\QTNativeAnimation.h"\
+	".\QTNativeBlend.h"\
+	".\QTNativeCPU.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFormats.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeThreads.h"\
+	
+
+"$(INTDIR)\QTNativeAnimation.obj" : $(SOURCE) $(DEP_CPP_QTNATIVEA) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
 SOURCE=.\QTShowEffect.c
 
 !IF  "$(CFG)" == "QTShowEffect - Win32 Release"
@@ -626,6 +959,19 @@ DEP_CPP_QTSHO=\
 	".\Common Files\QTUtilities.h"\
 	".\Common Files\WinFramework.h"\
 	".\common files\winprefix.h"\
+	".\QTNativeAnimation.h"\
+	".\QTNativeBlend.h"\
+	".\QTNativeConvert.h"\
+	".\QTNativeEffects.h"\
+	".\QTNativeFrameCache.h"\
+	".\QTNativeFramePool.h"\
+	".\QTNativeGenerators.h"\
+	".\QTNativeLoader.h"\
+	".\QTNativePipeline.h"\
+	".\QTNativeRawFile.h"\
+	".\QTNativeResample.h"\
+	".\QTNativeSourceCache.h"\
+	".\QTNativeThreads.h"\
 	".\QTShowEffect.h"\
 	
 
@@ -715,6 +1061,8 @@ DEP_CPP_QTSHO=\
 	".\Common Files\QTUtilities.h"\
 	".\Common Files\WinFramework.h"\
 	".\common files\winprefix.h"\
+	".\QTNativeBlend.h"\
+	".\QTNativeEffects.h"\
 	".\QTShowEffect.h"\
 	
 